@@ -211,6 +211,27 @@
       return (!isNaN(i) && (i >= 0) && (i < dy.length)) ? dy[i] : value;
    }
 
+   // restore array, compressed by TBufferJSON
+   // zeros are not stored, values of segment N are in vN starting from position pN,
+   // or vN is single value repeated nN times
+   JSROOT.JSONR_decode_arr = function(value) {
+      var arr = new Array(value.len), i, k, p, v, n, suffix;
+      for (i = 0; i < value.len; ++i) arr[i] = 0;
+      for (k = 0; ; ++k) {
+         suffix = k ? k : "";
+         p = value["p" + suffix];
+         if (p === undefined) break;
+         v = value["v" + suffix];
+         n = value["n" + suffix];
+         if (n !== undefined) {
+            for (i = 0; i < n; ++i) arr[p + i] = v;
+         } else {
+            for (i = 0; i < v.length; ++i) arr[p + i] = v[i];
+         }
+      }
+      return arr;
+   }
+
    // replace all references inside object
    // object should not be null
    // This is part of the JSON-R code, found on
@@ -226,8 +247,12 @@
                 if ((fld.length > 5) && (fld.indexOf("$ref:") === 0))
                    value[i] = this.JSONR_unref_str(fld, dy);
              } else
-             if ((typeof fld === 'object') && (fld !== null))
-                this.JSONR_unref_obj(fld, dy);
+             if ((typeof fld === 'object') && (fld !== null)) {
+                if ('$arr' in fld)
+                   value[i] = this.JSONR_decode_arr(fld);
+                else
+                   this.JSONR_unref_obj(fld, dy);
+             }
           }
           return;
       }
@@ -250,8 +275,12 @@
             if ((fld.length > 5) && (fld.indexOf("$ref:") === 0))
                value[i] = this.JSONR_unref_str(fld, dy);
          } else
-         if ((typeof fld === 'object') && (fld !== null))
-            this.JSONR_unref_obj(fld, dy);
+         if ((typeof fld === 'object') && (fld !== null)) {
+            if ('$arr' in fld)
+               value[i] = this.JSONR_decode_arr(fld);
+            else
+               this.JSONR_unref_obj(fld, dy);
+         }
       }
 
       return value;
@@ -259,8 +288,10 @@
 
    /// Should be used to reintroduce objects references, produced by TBufferJSON
    JSROOT.JSONR_unref = function(value) {
-      if ((typeof value === 'object') && (value !== null))
+      if ((typeof value === 'object') && (value !== null)) {
+         if ('$arr' in value) return this.JSONR_decode_arr(value);
          this.JSONR_unref_obj(value, []);
+      }
       return value;
    }
 
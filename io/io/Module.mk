@@ -44,7 +44,7 @@ include/%.h:    $(IODIRI)/%.h
 $(IOLIB):       $(IOO) $(IODO) $(ORDER_) $(MAINLIBS) $(IOLIBDEP)
 		@$(MAKELIB) $(PLATFORM) $(LD) "$(LDFLAGS)" \
 		   "$(SOFLAGS)" libRIO.$(SOEXT) $@ "$(IOO) $(IODO)" \
-		   "$(IOLIBEXTRA)"
+		   "$(IOLIBEXTRA) $(TBBLIBDIR) $(TBBLIB)"
 
 $(call pcmrule,IO)
 	$(noop)
@@ -72,3 +72,6 @@ distclean-$(MODNAME): clean-$(MODNAME)
 distclean::     distclean-$(MODNAME)
 
 ##### extra rules ######
+ifeq ($(BUILDTBB),yes)
+$(IOO): CXXFLAGS += $(TBBINCDIR:%=-I%)
+endif
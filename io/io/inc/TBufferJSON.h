@@ -23,6 +23,7 @@
 #endif
 
 #include <map>
+#include <iosfwd>
 
 class TVirtualStreamerInfo;
 class TStreamerInfo;
@@ -49,6 +50,9 @@ public:
    static Int_t     ExportToFile(const char* filename, const TObject *obj, const char* option = 0);
    static Int_t     ExportToFile(const char* filename, const void *obj, const TClass *cl, const char* option = 0);
 
+   static Long64_t  ExportToStream(std::ostream &os, const TObject *obj, Int_t compact = 0);
+   static Long64_t  ExportToStream(std::ostream &os, const void *obj, const TClass *cl, Int_t compact = 0);
+
    // suppress class writing/reading
 
    virtual TClass  *ReadClass(const TClass *cl = 0, UInt_t *objTag = 0);
@@ -451,6 +455,11 @@ protected:
 
    void              AppendOutput(const char *line0, const char *line1 = 0);
 
+   template <typename T>
+   Bool_t            JsonWriteArrayCompress(const T *vname, Int_t arrsize, const char *typname);
+
+   void              FlushSink();
+
    TString                   fOutBuffer;    //!  main output buffer for json code
    TString                  *fOutput;       //!  current output buffer for json code
    TString                   fValue;        //!  buffer for current value
@@ -459,6 +468,9 @@ protected:
    TObjArray                 fStack;        //!  stack of streamer infos
    Bool_t                    fExpectedChain; //!   flag to resolve situation when several elements of same basic type stored as FastArray
    Int_t                     fCompact;       //!  0 - no any compression, 1 - no spaces in the begin, 2 - no new lines, 3 - no spaces at all
+   Bool_t                    fArrayCompact;  //!  arrays written without zeros and with repeated values coded once
+   std::ostream             *fSink;          //!  stream where main output is flushed (see ExportToStream)
+   Long64_t                  fSinkLength;    //!  number of bytes written to the sink
    TString                   fSemicolon;     //!  depending from compression level, " : " or ":"
    TString                   fArraySepar;    //!  depending from compression level, ", " or ","
    TString                   fNumericLocale; //!  stored value of setlocale(LC_NUMERIC), which should be recovered at the end
@@ -26,10 +26,17 @@
 #endif
 
 class TList;
+class TCollection;
 class TBrowser;
 class TKey;
 class TFile;
 
+namespace ROOT {
+namespace Internal {
+   class TKeysIndex;
+}
+}
+
 class TDirectoryFile : public TDirectory {
 
 protected:
@@ -45,9 +52,15 @@ protected:
    Long64_t    fSeekKeys;        ///< Location of Keys record on file
    TFile      *fFile;            ///< Pointer to current file in memory
    TList      *fKeys;            ///< Pointer to keys list in memory
+   mutable ROOT::Internal::TKeysIndex *fKeysIndex; ///<!Keys record whose TKeys are created on demand (lazy key loading)
+
+   static Int_t fgLazyKeys;      ///< If 1 the TKeys are created on demand, -1 until TFile.LazyKeys is read
 
    virtual void         CleanTargets();
    void Init(TClass *cl = 0);
+   void                 DeleteKeysIndex();
+   void                 LoadAllKeys() const;
+   Int_t                GetNkeysOfClass(const char *classname) const;
 
 private:
    TDirectoryFile(const TDirectoryFile &directory);  //Directories cannot be copied
@@ -88,10 +101,11 @@ public:
    const TDatime      &GetCreationDate() const { return fDatimeC; }
    virtual TFile      *GetFile() const { return fFile; }
    virtual TKey       *GetKey(const char *name, Short_t cycle=9999) const;
-   virtual TList      *GetListOfKeys() const { return fKeys; }
+   static Bool_t       GetLazyKeys();
+   virtual TList      *GetListOfKeys() const { if (fKeysIndex) LoadAllKeys(); return fKeys; }
    const TDatime      &GetModificationDate() const { return fDatimeM; }
    virtual Int_t       GetNbytesKeys() const { return fNbytesKeys; }
-   virtual Int_t       GetNkeys() const { return fKeys->GetSize(); }
+   virtual Int_t       GetNkeys() const;
    virtual Long64_t    GetSeekDir() const { return fSeekDir; }
    virtual Long64_t    GetSeekParent() const { return fSeekParent; }
    virtual Long64_t    GetSeekKeys() const { return fSeekKeys; }
@@ -105,6 +119,7 @@ public:
    virtual void        Purge(Short_t nkeep=1);
    virtual void        ReadAll(Option_t *option="");
    virtual Int_t       ReadKeys(Bool_t forceRead=kTRUE);
+   Int_t               ReadObjects(const TCollection *keys, TCollection *objects = 0, Option_t *option = "");
    virtual Int_t       ReadTObject(TObject *obj, const char *keyname);
    virtual void        ResetAfterMerge(TFileMergeInfo *);
    virtual void        rmdir(const char *name);
@@ -112,6 +127,7 @@ public:
    virtual void        SaveSelf(Bool_t force = kFALSE);
    virtual Int_t       SaveObjectAs(const TObject *obj, const char *filename="", Option_t *option="") const;
    virtual void        SetBufferSize(Int_t bufsize);
+   static void         SetLazyKeys(Bool_t lazy = kTRUE);
    void                SetModified() {fModified = kTRUE;}
    void                SetSeekDir(Long64_t v) { fSeekDir = v; }
    virtual void        SetTRefAction(TObject *ref, TObject *parent);
@@ -42,6 +42,12 @@ class TProcessID;
 class TStopwatch;
 class TFilePrefetch;
 
+namespace ROOT {
+namespace Internal {
+   class TFreeIndex;
+}
+}
+
 class TFile : public TDirectoryFile {
   friend class TDirectoryFile;
   friend class TFilePrefetch;
@@ -78,6 +84,7 @@ protected:
    TString          fOption;         ///<File options
    Char_t           fUnits;          ///<Number of bytes for file pointers
    TList           *fFree;           ///<Free segments linked list table
+   ROOT::Internal::TFreeIndex *fFreeIndex; ///<!Index of the free segments by position and by size
    TArrayC         *fClassIndex;     ///<!Index of TStreamerInfo classes written to this file
    TObjArray       *fProcessIDs;     ///<!Array of pointers to TProcessIDs
    Long64_t         fOffset;         ///<!Seek offset cache
@@ -92,6 +99,7 @@ protected:
    Bool_t           fInitDone : 1;   ///<!True if the file has been initialized
    Bool_t           fMustFlush : 1;  ///<!True if the file buffers must be flushed
    Bool_t           fIsPcmFile : 1;  ///<!True if the file is a ROOT pcm file.
+   Bool_t           fChangeTracking : 1; ///<!True if unchanged objects are not written again
    TFileOpenHandle *fAsyncHandle;    ///<!For proper automatic cleanup
    EAsyncOpenStatus fAsyncOpenStatus; ///<!Status of an asynchronous open request
    TUrl             fUrl;            ///<!URL of file
@@ -118,6 +126,8 @@ protected:
    Bool_t        FlushWriteCache();
    Int_t         ReadBufferViaCache(char *buf, Int_t len);
    Int_t         WriteBufferViaCache(const char *buf, Int_t len);
+   ROOT::Internal::TFreeIndex *GetFreeIndex();
+   void          DeleteFreeIndex();
 
    // Creating projects
    Int_t         MakeProjectParMake(const char *packname, const char *filename);
@@ -166,6 +176,7 @@ public:
    TFile(const char *fname, Option_t *option="", const char *ftitle="", Int_t compress=1);
    virtual ~TFile();
    virtual void        Close(Option_t *option=""); // *MENU*
+   virtual Long64_t    Compact();
    virtual void        Copy(TObject &) const { MayNotUse("Copy(TObject &)"); }
    virtual Bool_t      Cp(const char *dst, Bool_t progressbar = kTRUE,UInt_t buffersize = 1000000);
    virtual TKey*       CreateKey(TDirectory* mother, const TObject* obj, const char* name, Int_t bufsize);
@@ -180,6 +191,7 @@ public:
    TArchiveFile       *GetArchive() const { return fArchive; }
    Long64_t            GetArchiveOffset() const { return fArchiveOffset; }
    Int_t               GetBestBuffer() const;
+           TFree      *GetBestFree(Int_t nbytes, Long64_t before = -1);
    virtual Int_t       GetBytesToPrefetch() const;
    TFileCacheRead     *GetCacheRead(TObject* tree = 0) const;
    TFileCacheWrite    *GetCacheWrite() const;
@@ -217,6 +229,7 @@ public:
    virtual void        IncrementProcessIDs() { fNProcessIDs++; }
    virtual Bool_t      IsArchive() const { return fIsArchive; }
            Bool_t      IsBinary() const { return TestBit(kBinaryFile); }
+           Bool_t      IsChangeTracking() const { return fChangeTracking; }
            Bool_t      IsRaw() const { return !fIsRootFile; }
    virtual Bool_t      IsOpen() const;
    virtual void        ls(Option_t *option="") const;
@@ -240,6 +253,7 @@ public:
    virtual void        Seek(Long64_t offset, ERelativeTo pos = kBeg);
    virtual void        SetCacheRead(TFileCacheRead *cache, TObject* tree = 0, ECacheAction action = kDisconnect);
    virtual void        SetCacheWrite(TFileCacheWrite *cache);
+   virtual void        SetChangeTracking(Bool_t on = kTRUE);
    virtual void        SetCompressionAlgorithm(Int_t algorithm=0);
    virtual void        SetCompressionLevel(Int_t level=1);
    virtual void        SetCompressionSettings(Int_t settings=1);
@@ -250,6 +264,7 @@ public:
    virtual void        ShowStreamerInfo();
    virtual Int_t       Sizeof() const;
    void                SumBuffer(Int_t bufsize);
+           void        UseFree(TFree *segment, Int_t nbytes);
    virtual Bool_t      WriteBuffer(const char *buf, Int_t len);
    virtual Int_t       Write(const char *name=0, Int_t opt=0, Int_t bufsiz=0);
    virtual Int_t       Write(const char *name=0, Int_t opt=0, Int_t bufsiz=0) const;
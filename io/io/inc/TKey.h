@@ -51,6 +51,7 @@ protected:
    TBuffer    *fBufferRef;   ///< Pointer to the TBuffer object
    UShort_t    fPidOffset;   ///<!Offset to be added to the pid index in this key/buffer.  This is actually saved in the high bits of fSeekPdir
    TDirectory *fMotherDir;   ///<!pointer to mother directory
+   ULong64_t   fChecksum;    ///<!Checksum of the object buffer, set when the file tracks changes
 
    virtual Int_t    Read(const char *name) { return TObject::Read(name); }
    virtual void     Create(Int_t nbytes, TFile* f = 0);
@@ -75,6 +76,7 @@ protected:
    virtual void        DeleteBuffer();
    virtual void        FillBuffer(char *&buffer);
    virtual const char *GetClassName() const {return fClassName.Data();}
+           ULong64_t   GetChecksum() const {return fChecksum;}
    virtual const char *GetIconName() const;
    virtual const char *GetTitle() const;
    virtual char       *GetBuffer() const {return fBuffer+fKeylen;}
@@ -93,16 +95,19 @@ protected:
    virtual ULong_t     Hash() const;
    virtual void        IncrementPidOffset(UShort_t offset);
            Bool_t      IsFolder() const;
+           Bool_t      IsUnchanged(const TObject *obj) const;
    virtual void        Keep();
    virtual void        ls(Option_t *option="") const;
    virtual void        Print(Option_t *option="") const;
    virtual Int_t       Read(TObject *obj);
    virtual TObject    *ReadObj();
    virtual TObject    *ReadObjWithBuffer(char *bufferRead);
+           TObject    *ReadObjFromBuffer(char *buffer);
    virtual void       *ReadObjectAny(const TClass *expectedClass);
    virtual void        ReadBuffer(char *&buffer);
            void        ReadKeyBuffer(char *&buffer);
    virtual Bool_t      ReadFile();
+           Bool_t      Relocate();
    virtual void        SetBuffer() { fBuffer = new char[fNbytes];}
    virtual void        SetParent(const TObject *parent);
            void        SetMotherDir(TDirectory* dir) { fMotherDir = dir; }
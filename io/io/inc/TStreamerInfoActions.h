@@ -13,6 +13,7 @@
 #define ROOT_TStreamerInfoActions
 
 #include <vector>
+#include <atomic>
 
 #include "TStreamerInfo.h"
 #include <assert.h>
@@ -129,9 +130,15 @@ namespace TStreamerInfoActions {
 
    typedef std::vector<TConfiguredAction> ActionContainer_t;
    class TActionSequence : public TObject {
-      TActionSequence() {};
+      TActionSequence() : fStreamerInfo(0), fLoopConfig(0), fCompiled(0), fNCalls(0) {};
+
+      static Int_t fgCodeGenerationThreshold; ///< Number of applications of a sequence before code is generated for it (0 disables the code generation, -1 means not yet read from gEnv)
+
    public:
-      TActionSequence(TVirtualStreamerInfo *info, UInt_t maxdata) : fStreamerInfo(info), fLoopConfig(0) { fActions.reserve(maxdata); };
+      /// Signature of the function generated by Cling for an object-wise sequence.
+      typedef Int_t (*TCompiledSequence_t)(TBuffer &buf, void *obj, const TActionSequence &sequence);
+
+      TActionSequence(TVirtualStreamerInfo *info, UInt_t maxdata) : fStreamerInfo(info), fLoopConfig(0), fCompiled(0), fNCalls(0) { fActions.reserve(maxdata); };
       ~TActionSequence() {
          delete fLoopConfig;
       }
@@ -147,7 +154,29 @@ namespace TStreamerInfoActions {
       TVirtualStreamerInfo *fStreamerInfo; ///< StreamerInfo used to derive these actions.
       TLoopConfiguration   *fLoopConfig;   ///< If this is a bundle of memberwise streaming action, this configures the looping
       ActionContainer_t     fActions;
+      mutable std::atomic<TCompiledSequence_t> fCompiled; ///<! Code generated for this sequence (0 if none)
+      mutable std::atomic<Int_t> fNCalls;    ///<! Number of applications of the sequence so far, -1 once the code generation has been attempted
+
+      /// Return the function generated for this sequence, if any. Counts the
+      /// applications of the sequence and generates the function once the
+      /// threshold set by SetCodeGenerationThreshold() is reached. Several
+      /// threads may stream with the same sequence, only one of them generates
+      /// the function.
+      TCompiledSequence_t GetCompiledSequence() const {
+         if (fNCalls.load() < 0 || fgCodeGenerationThreshold == 0) return fCompiled.load();
+         return CountAndCompile();
+      }
+      TCompiledSequence_t CountAndCompile() const;
+      Bool_t Compile() const;
+
+      static void  SetCodeGenerationThreshold(Int_t ncalls);
+      static Int_t GetCodeGenerationThreshold();
 
+      void ClearActions() {
+         fActions.clear();
+         fCompiled = 0;
+         fNCalls = 0;
+      }
       void AddToOffset(Int_t delta);
 
       TActionSequence *CreateCopy();
@@ -0,0 +1,367 @@
+// @(#)root/io:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// BswapCopy                                                            //
+//                                                                      //
+// Array kernels of TBufferFile, see BswapCopy.h.                       //
+//                                                                      //
+// The portable versions convert one element at a time. On x86 with     //
+// gcc (>= 4.9) or clang, the byte swaps are also compiled for SSSE3    //
+// (pshufb, 16 bytes at a time) and AVX2 (32 bytes at a time), and the  //
+// Float16 packing for SSSE3 (4 elements at a time); the first call     //
+// selects the best version supported by the processor. All versions    //
+// give bit for bit the same results.                                   //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#include "BswapCopy.h"
+
+#include <string.h>
+
+#if defined(R__BYTESWAP) && (defined(__x86_64__) || defined(__i386__)) && !defined(__INTEL_COMPILER) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define R__BSWAPCOPY_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+// Portable versions.
+
+inline UShort_t Bswap(UShort_t x)
+{
+   return (UShort_t)((x >> 8) | (x << 8));
+}
+
+inline UInt_t Bswap(UInt_t x)
+{
+   return (x >> 24) | ((x >> 8) & 0x0000ff00U) | ((x << 8) & 0x00ff0000U) | (x << 24);
+}
+
+inline ULong64_t Bswap(ULong64_t x)
+{
+   return ((ULong64_t)Bswap((UInt_t)x) << 32) | Bswap((UInt_t)(x >> 32));
+}
+
+template <typename T>
+void BswapCopyScalar(void *to, const void *from, Long64_t n)
+{
+   char *out = (char*)to;
+   const char *in = (const char*)from;
+   for (Long64_t i = 0; i < n; ++i, out += sizeof(T), in += sizeof(T)) {
+      T x;
+      memcpy(&x, in, sizeof(T));
+      x = Bswap(x);
+      memcpy(out, &x, sizeof(T));
+   }
+}
+
+// Truncate the float f to 1 byte of exponent and 2 bytes of sign and
+// mantissa, as in TBufferFile::WriteFloat16.
+inline void PackOne(char *buf, Float_t f, Int_t nbits)
+{
+   UInt_t bits;
+   memcpy(&bits, &f, sizeof(bits));
+   UChar_t  theExp = (UChar_t)(0x000000ff & (bits >> 23));
+   UShort_t theMan = ((1<<(nbits+1))-1) & (bits>>(23-nbits-1));
+   theMan++;
+   theMan = theMan>>1;
+   if (theMan&1<<nbits) theMan = (1<<nbits) - 1;
+   if (f < 0) theMan |= 1<<(nbits+1);
+   buf[0] = (char)theExp;
+   buf[1] = (char)(theMan >> 8);
+   buf[2] = (char)(theMan & 0xff);
+}
+
+// Inverse of PackOne, as in TBufferFile::ReadWithNbits.
+inline Float_t UnpackOne(const char *buf, Int_t nbits)
+{
+   UInt_t   theExp = (UChar_t)buf[0];
+   UShort_t theMan = (UShort_t)(((UChar_t)buf[1] << 8) | (UChar_t)buf[2]);
+   UInt_t bits = theExp << 23;
+   bits |= (theMan & ((1<<(nbits+1))-1)) << (23-nbits);
+   Float_t f;
+   memcpy(&f, &bits, sizeof(f));
+   if (1<<(nbits+1) & theMan) f = -f;
+   return f;
+}
+
+template <typename T>
+void PackScalar(char *buf, const T *x, Long64_t n, Int_t nbits)
+{
+   for (Long64_t i = 0; i < n; ++i, buf += 3) PackOne(buf, (Float_t)x[i], nbits);
+}
+
+template <typename T>
+void UnpackScalar(const char *buf, T *x, Long64_t n, Int_t nbits)
+{
+   for (Long64_t i = 0; i < n; ++i, buf += 3) x[i] = UnpackOne(buf, nbits);
+}
+
+#ifdef R__BSWAPCOPY_X86
+
+////////////////////////////////////////////////////////////////////////////////
+// SSSE3 and AVX2 versions.
+
+// pshufb mask reversing the bytes of each element of size bytes.
+inline __m128i __attribute__((target("ssse3"))) SwapMask(int size)
+{
+   char m[16];
+   for (int i = 0; i < 16; ++i) m[i] = (char)((i / size) * size + size - 1 - i % size);
+   return _mm_loadu_si128((const __m128i*)m);
+}
+
+template <typename T>
+void __attribute__((target("ssse3"))) BswapCopySsse3(void *to, const void *from, Long64_t n)
+{
+   const __m128i mask = SwapMask(sizeof(T));
+   const Long64_t nvec = n - n % (16 / sizeof(T));
+   char *out = (char*)to;
+   const char *in = (const char*)from;
+   for (Long64_t i = 0; i < nvec; i += 16 / sizeof(T), out += 16, in += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i*)in);
+      _mm_storeu_si128((__m128i*)out, _mm_shuffle_epi8(v, mask));
+   }
+   BswapCopyScalar<T>(out, in, n - nvec);
+}
+
+template <typename T>
+void __attribute__((target("avx2"))) BswapCopyAvx2(void *to, const void *from, Long64_t n)
+{
+   // vpshufb shuffles within each 128 bits lane: the same mask is used for both.
+   const __m128i half = SwapMask(sizeof(T));
+   const __m256i mask = _mm256_inserti128_si256(_mm256_castsi128_si256(half), half, 1);
+   const Long64_t nvec = n - n % (64 / sizeof(T));
+   char *out = (char*)to;
+   const char *in = (const char*)from;
+   for (Long64_t i = 0; i < nvec; i += 64 / sizeof(T), out += 64, in += 64) {
+      __m256i v0 = _mm256_loadu_si256((const __m256i*)in);
+      __m256i v1 = _mm256_loadu_si256((const __m256i*)(in + 32));
+      _mm256_storeu_si256((__m256i*)out, _mm256_shuffle_epi8(v0, mask));
+      _mm256_storeu_si256((__m256i*)(out + 32), _mm256_shuffle_epi8(v1, mask));
+   }
+   BswapCopySsse3<T>(out, in, n - nvec);
+}
+
+// Pack 4 floats into 12 bytes, see PackOne.
+inline void __attribute__((target("ssse3"))) PackFour(char *buf, __m128 f, Int_t nbits)
+{
+   const __m128i bits   = _mm_castps_si128(f);
+   const __m128i byte   = _mm_set1_epi32(0xff);
+   const __m128i ushort = _mm_set1_epi32(0xffff);
+   const __m128i one    = _mm_set1_epi32(1);
+   const __m128i top    = _mm_set1_epi32(1<<nbits);
+   const __m128i theExp = _mm_and_si128(_mm_srli_epi32(bits, 23), byte);
+   __m128i theMan = _mm_and_si128(_mm_srl_epi32(bits, _mm_cvtsi32_si128(23-nbits-1)),
+                                  _mm_set1_epi32(((1<<(nbits+1))-1) & 0xffff));
+   theMan = _mm_srli_epi32(_mm_and_si128(_mm_add_epi32(theMan, one), ushort), 1);
+   const __m128i overflow = _mm_cmpeq_epi32(_mm_and_si128(theMan, top), top);
+   theMan = _mm_or_si128(_mm_andnot_si128(overflow, theMan), _mm_and_si128(overflow, _mm_sub_epi32(top, one)));
+   const __m128i negative = _mm_castps_si128(_mm_cmplt_ps(f, _mm_setzero_ps()));
+   theMan = _mm_and_si128(_mm_or_si128(theMan, _mm_and_si128(negative, _mm_set1_epi32(1<<(nbits+1)))), ushort);
+   // Each lane holds exp, mantissa high byte, mantissa low byte, 0.
+   const __m128i lanes = _mm_or_si128(theExp, _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(theMan, 8), 8),
+                                                            _mm_slli_epi32(_mm_and_si128(theMan, byte), 16)));
+   const __m128i packed = _mm_shuffle_epi8(lanes, _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1));
+   _mm_storel_epi64((__m128i*)buf, packed);
+   const Int_t last = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+   memcpy(buf + 8, &last, 4);
+}
+
+// Unpack 12 bytes into 4 floats, see UnpackOne.
+inline __m128 __attribute__((target("ssse3"))) UnpackFour(const char *buf, Int_t nbits)
+{
+   Int_t last;
+   memcpy(&last, buf + 8, 4);
+   const __m128i packed = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)buf), _mm_cvtsi32_si128(last));
+   // Each lane becomes exp << 16 | mantissa.
+   const __m128i lanes = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1));
+   const __m128i theMan = _mm_and_si128(lanes, _mm_set1_epi32(0xffff));
+   const __m128i theExp = _mm_srli_epi32(lanes, 16);
+   __m128i bits = _mm_slli_epi32(theExp, 23);
+   bits = _mm_or_si128(bits, _mm_sll_epi32(_mm_and_si128(theMan, _mm_set1_epi32((1<<(nbits+1))-1)),
+                                           _mm_cvtsi32_si128(23-nbits)));
+   const __m128i sign = _mm_set1_epi32((1<<(nbits+1)) & 0xffff);
+   const __m128i negative = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(theMan, sign), sign),
+                                          _mm_cmpgt_epi32(sign, _mm_setzero_si128()));
+   bits = _mm_xor_si128(bits, _mm_and_si128(negative, _mm_set1_epi32(0x80000000)));
+   return _mm_castsi128_ps(bits);
+}
+
+void __attribute__((target("ssse3"))) PackSsse3(char *buf, const Float_t *f, Long64_t n, Int_t nbits)
+{
+   const Long64_t nvec = n - n % 4;
+   for (Long64_t i = 0; i < nvec; i += 4, buf += 12) PackFour(buf, _mm_loadu_ps(f + i), nbits);
+   PackScalar(buf, f + nvec, n - nvec, nbits);
+}
+
+void __attribute__((target("ssse3"))) PackSsse3(char *buf, const Double_t *d, Long64_t n, Int_t nbits)
+{
+   const Long64_t nvec = n - n % 4;
+   for (Long64_t i = 0; i < nvec; i += 4, buf += 12) {
+      const __m128 f = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(d + i)), _mm_cvtpd_ps(_mm_loadu_pd(d + i + 2)));
+      PackFour(buf, f, nbits);
+   }
+   PackScalar(buf, d + nvec, n - nvec, nbits);
+}
+
+void __attribute__((target("ssse3"))) UnpackSsse3(const char *buf, Float_t *f, Long64_t n, Int_t nbits)
+{
+   const Long64_t nvec = n - n % 4;
+   for (Long64_t i = 0; i < nvec; i += 4, buf += 12) _mm_storeu_ps(f + i, UnpackFour(buf, nbits));
+   UnpackScalar(buf, f + nvec, n - nvec, nbits);
+}
+
+void __attribute__((target("ssse3"))) UnpackSsse3(const char *buf, Double_t *d, Long64_t n, Int_t nbits)
+{
+   const Long64_t nvec = n - n % 4;
+   for (Long64_t i = 0; i < nvec; i += 4, buf += 12) {
+      const __m128 f = UnpackFour(buf, nbits);
+      _mm_storeu_pd(d + i, _mm_cvtps_pd(f));
+      _mm_storeu_pd(d + i + 2, _mm_cvtps_pd(_mm_movehl_ps(f, f)));
+   }
+   UnpackScalar(buf, d + nvec, n - nvec, nbits);
+}
+
+#endif // R__BSWAPCOPY_X86
+
+////////////////////////////////////////////////////////////////////////////////
+// Selection of the versions.
+
+struct TKernels {
+   void (*fCopy16)(void*, const void*, Long64_t);
+   void (*fCopy32)(void*, const void*, Long64_t);
+   void (*fCopy64)(void*, const void*, Long64_t);
+   void (*fPackFloat)(char*, const Float_t*, Long64_t, Int_t);
+   void (*fPackDouble)(char*, const Double_t*, Long64_t, Int_t);
+   void (*fUnpackFloat)(const char*, Float_t*, Long64_t, Int_t);
+   void (*fUnpackDouble)(const char*, Double_t*, Long64_t, Int_t);
+   const char *fName;
+};
+
+TKernels SelectKernels()
+{
+   TKernels k;
+   k.fCopy16 = BswapCopyScalar<UShort_t>;
+   k.fCopy32 = BswapCopyScalar<UInt_t>;
+   k.fCopy64 = BswapCopyScalar<ULong64_t>;
+   k.fPackFloat = PackScalar<Float_t>;
+   k.fPackDouble = PackScalar<Double_t>;
+   k.fUnpackFloat = UnpackScalar<Float_t>;
+   k.fUnpackDouble = UnpackScalar<Double_t>;
+   k.fName = "scalar";
+#ifdef R__BSWAPCOPY_X86
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("ssse3")) {
+      k.fCopy16 = BswapCopySsse3<UShort_t>;
+      k.fCopy32 = BswapCopySsse3<UInt_t>;
+      k.fCopy64 = BswapCopySsse3<ULong64_t>;
+      k.fPackFloat = PackSsse3;
+      k.fPackDouble = PackSsse3;
+      k.fUnpackFloat = UnpackSsse3;
+      k.fUnpackDouble = UnpackSsse3;
+      k.fName = "ssse3";
+   }
+   if (__builtin_cpu_supports("avx2")) {
+      k.fCopy16 = BswapCopyAvx2<UShort_t>;
+      k.fCopy32 = BswapCopyAvx2<UInt_t>;
+      k.fCopy64 = BswapCopyAvx2<ULong64_t>;
+      k.fName = "avx2";
+   }
+#endif
+   return k;
+}
+
+const TKernels &GetKernels()
+{
+   static const TKernels kernels = SelectKernels();
+   return kernels;
+}
+
+// The vectorised packing handles the mantissa sizes allowed for Float16_t
+// and Double32_t; anything else keeps the portable code.
+inline Bool_t IsVectorNbits(Int_t nbits)
+{
+   return nbits > 0 && nbits <= 16;
+}
+
+} // unnamed namespace
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy n elements of 2 bytes, reversing their byte order.
+
+void ROOT::Internal::BswapCopy16(void *to, const void *from, Long64_t n)
+{
+   GetKernels().fCopy16(to, from, n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy n elements of 4 bytes, reversing their byte order.
+
+void ROOT::Internal::BswapCopy32(void *to, const void *from, Long64_t n)
+{
+   GetKernels().fCopy32(to, from, n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy n elements of 8 bytes, reversing their byte order.
+
+void ROOT::Internal::BswapCopy64(void *to, const void *from, Long64_t n)
+{
+   GetKernels().fCopy64(to, from, n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write n floats to buf (3*n bytes) with their mantissa truncated to nbits.
+
+void ROOT::Internal::PackFloat16(char *buf, const Float_t *f, Long64_t n, Int_t nbits)
+{
+   if (IsVectorNbits(nbits)) GetKernels().fPackFloat(buf, f, n, nbits);
+   else PackScalar(buf, f, n, nbits);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write n doubles to buf (3*n bytes) as floats with their mantissa truncated to nbits.
+
+void ROOT::Internal::PackFloat16(char *buf, const Double_t *d, Long64_t n, Int_t nbits)
+{
+   if (IsVectorNbits(nbits)) GetKernels().fPackDouble(buf, d, n, nbits);
+   else PackScalar(buf, d, n, nbits);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read n floats written by PackFloat16 from buf.
+
+void ROOT::Internal::UnpackFloat16(const char *buf, Float_t *f, Long64_t n, Int_t nbits)
+{
+   if (IsVectorNbits(nbits)) GetKernels().fUnpackFloat(buf, f, n, nbits);
+   else UnpackScalar(buf, f, n, nbits);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read n doubles written by PackFloat16 from buf.
+
+void ROOT::Internal::UnpackFloat16(const char *buf, Double_t *d, Long64_t n, Int_t nbits)
+{
+   if (IsVectorNbits(nbits)) GetKernels().fUnpackDouble(buf, d, n, nbits);
+   else UnpackScalar(buf, d, n, nbits);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Name of the version of the kernels selected for this processor
+/// ("scalar", "ssse3" or "avx2").
+
+const char *ROOT::Internal::GetBswapCopyImplementation()
+{
+   return GetKernels().fName;
+}
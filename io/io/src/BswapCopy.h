@@ -0,0 +1,56 @@
+// @(#)root/io:$Id$
+
+/*************************************************************************
+ * Copyright (C) 1995-2016, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOT_BswapCopy
+#define ROOT_BswapCopy
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// BswapCopy                                                            //
+//                                                                      //
+// Array kernels of TBufferFile, private to libRIO.                     //
+//                                                                      //
+// BswapCopy16/32/64 copy n elements of 2, 4 or 8 bytes from 'from' to  //
+// 'to' reversing the byte order of each element, like a loop on        //
+// tobuf/frombuf would. The buffers may be unaligned but must not       //
+// overlap.                                                             //
+//                                                                      //
+// PackFloat16/UnpackFloat16 convert n floats (or doubles) to and from  //
+// the 3 bytes (exponent, then sign and mantissa truncated to nbits)    //
+// representation used by Float16_t and Double32_t when no range is     //
+// given, see TBufferFile::WriteFloat16.                                //
+//                                                                      //
+// On x86 the implementation (SSSE3 or AVX2) is chosen at run time      //
+// according to the capabilities of the processor.                      //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+namespace ROOT {
+namespace Internal {
+
+   void BswapCopy16(void *to, const void *from, Long64_t n);
+   void BswapCopy32(void *to, const void *from, Long64_t n);
+   void BswapCopy64(void *to, const void *from, Long64_t n);
+
+   void PackFloat16(char *buf, const Float_t *f, Long64_t n, Int_t nbits);
+   void PackFloat16(char *buf, const Double_t *d, Long64_t n, Int_t nbits);
+   void UnpackFloat16(const char *buf, Float_t *f, Long64_t n, Int_t nbits);
+   void UnpackFloat16(const char *buf, Double_t *d, Long64_t n, Int_t nbits);
+
+   const char *GetBswapCopyImplementation();
+
+} // namespace Internal
+} // namespace ROOT
+
+#endif
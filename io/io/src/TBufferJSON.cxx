@@ -28,6 +28,19 @@
 //    h1->FillRandom("gaus",10000);
 //    TString json = TBufferJSON::ConvertToJSON(h1);
 //
+// Large objects can be written directly to a stream (for instance a
+// file), without keeping the complete JSON code in memory:
+//
+//    std::ofstream ofs("h1.json");
+//    TBufferJSON::ExportToStream(ofs, h1, 3);
+//
+// When 10 is added to the compact parameter, arrays of numbers with
+// many zeros or repeated values are written in compressed form, for
+// instance {"$arr":"Float64","len":100,"p":10,"v":[1,2,3],"p1":50,"v1":7,"n1":20}
+// where pN is the position of a segment, vN its values (or a single
+// value repeated nN times) and all other elements are 0.
+// JSROOT.JSONR_unref() restores such arrays.
+//
 //________________________________________________________________________
 
 
@@ -37,6 +50,7 @@
 #include <string>
 #include <string.h>
 #include <locale.h>
+#include <cmath>
 
 #include "Compression.h"
 
@@ -77,6 +91,167 @@ ClassImp(TBufferJSON)
 
 const char *TBufferJSON::fgFloatFmt = "%e";
 
+namespace {
+
+   const Int_t kSinkChunk = 65536;      // size of output flushed at once to the sink
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Write decimal representation of the unsigned value into buf,
+   /// returns number of characters (no terminating 0)
+
+   Int_t JsonFormatUnsigned(char *buf, ULong64_t value)
+   {
+      char tmp[24];
+      Int_t len = 0;
+      do {
+         tmp[len++] = '0' + (char)(value % 10);
+         value /= 10;
+      } while (value != 0);
+      for (Int_t n = 0; n < len; n++) buf[n] = tmp[len - 1 - n];
+      return len;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Write decimal representation of the signed value into buf
+
+   Int_t JsonFormatSigned(char *buf, Long64_t value)
+   {
+      if (value >= 0) return JsonFormatUnsigned(buf, value);
+      buf[0] = '-';
+      return 1 + JsonFormatUnsigned(buf + 1, 0 - (ULong64_t) value);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Produce same output as printf("%e", value) without printf and
+   /// independently of the locale.
+   /// Returns number of characters or -1 when the value can not be formatted
+   /// exactly this way (not finite, too large exponent or too close to a
+   /// rounding boundary) and printf has to be used
+
+   Int_t JsonFormatExp(char *buf, Double_t value)
+   {
+      // powers of 10 exactly represented as double
+      static const Double_t pow10[23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+      Double_t a = fabs(value);
+      if (!(a > 0) || (a > 1e28)) return -1;
+
+      Int_t e = (Int_t) floor(log10(a));
+      Double_t scaled = 0;
+
+      // log10 may be wrong by one close to powers of ten
+      for (Int_t iter = 0; iter < 3; iter++) {
+         if ((e < -16) || (e > 28)) return -1;
+         // single correctly rounded operation, error below 1e-9
+         scaled = (e >= 6) ? a / pow10[e - 6] : a * pow10[6 - e];
+         if (scaled < 1e6) e--; else
+         if (scaled >= 1e7) e++; else break;
+      }
+      if ((scaled < 1e6) || (scaled >= 1e7)) return -1;
+
+      Double_t fl = floor(scaled), frac = scaled - fl;
+      if (fabs(frac - 0.5) < 1e-6) return -1;
+
+      ULong64_t mant = (ULong64_t) fl + (frac > 0.5 ? 1 : 0);
+      if (mant == 10000000) { mant = 1000000; e++; }
+
+      char digits[8];
+      JsonFormatUnsigned(digits, mant);
+
+      Int_t len = 0;
+      if (value < 0) buf[len++] = '-';
+      buf[len++] = digits[0];
+      buf[len++] = '.';
+      for (Int_t n = 1; n < 7; n++) buf[len++] = digits[n];
+      buf[len++] = 'e';
+      buf[len++] = (e < 0) ? '-' : '+';
+      if (e < 0) e = -e;
+      buf[len++] = '0' + e / 10;
+      buf[len++] = '0' + e % 10;
+      return len;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Format float or double value as done by TBufferJSON: integer values
+   /// without decimal point, all others with TBufferJSON::GetFloatFormat()
+   /// Returns number of characters
+
+   Int_t JsonFormatFloat(char *buf, Int_t bufsize, Double_t value, const char *fmt)
+   {
+      Int_t len = -1;
+      if (value == floor(value)) {
+         if (fabs(value) < 1e18) {
+            if ((value == 0) && std::signbit(value)) {
+               buf[0] = '-'; buf[1] = '0';
+               return 2;
+            }
+            return JsonFormatSigned(buf, (Long64_t) value);
+         }
+         len = snprintf(buf, bufsize, "%1.0f", value);
+      } else {
+         if (strcmp(fmt, "%e") == 0) len = JsonFormatExp(buf, value);
+         if (len < 0) {
+            len = snprintf(buf, bufsize, fmt, value);
+            // JSON requires point as decimal separator whatever the locale
+            for (Int_t n = 0; n < len; n++)
+               if (buf[n] == ',') buf[n] = '.';
+         }
+      }
+      if (len >= bufsize) len = bufsize - 1;
+      return len < 0 ? 0 : len;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// Find end of the segment of a compressed array starting with the non-zero
+   /// element indx. Segment is either a run of at least 5 equal values
+   /// (repeat set) or values up to the next 3 zeros or next such run
+
+   template <typename T>
+   Int_t JsonArraySegment(const T *vname, Int_t arrsize, Int_t indx, Bool_t &repeat)
+   {
+      const Int_t kMinRepeat = 5, kMinZeros = 3;
+
+      Int_t last = indx + 1;
+      while ((last < arrsize) && (vname[last] == vname[indx])) last++;
+      repeat = (last - indx >= kMinRepeat);
+      if (repeat) return last;
+
+      Int_t end = indx; // one after last non-zero value of the segment
+      last = indx;
+      while (last < arrsize) {
+         if (vname[last] == 0) {
+            Int_t nzeros = 1;
+            while ((last + nzeros < arrsize) && (vname[last + nzeros] == 0)) nzeros++;
+            if (nzeros >= kMinZeros) break;
+            last += nzeros;
+            continue;
+         }
+         Int_t nsame = 1;
+         while ((last + nsame < arrsize) && (nsame < kMinRepeat) && (vname[last + nsame] == vname[last])) nsame++;
+         if ((nsame >= kMinRepeat) && (last > indx)) break;
+         end = ++last;
+      }
+      return end;
+   }
+
+   // names of the array types in compressed arrays, 0 when not compressed
+
+   const char *JsonArrayType(const Bool_t *)    { return 0; }
+   const char *JsonArrayType(const Char_t *)    { return "Int8"; }
+   const char *JsonArrayType(const UChar_t *)   { return "Uint8"; }
+   const char *JsonArrayType(const Short_t *)   { return "Int16"; }
+   const char *JsonArrayType(const UShort_t *)  { return "Uint16"; }
+   const char *JsonArrayType(const Int_t *)     { return "Int32"; }
+   const char *JsonArrayType(const UInt_t *)    { return "Uint32"; }
+   const char *JsonArrayType(const Long_t *)    { return "Int64"; }
+   const char *JsonArrayType(const ULong_t *)   { return "Uint64"; }
+   const char *JsonArrayType(const Long64_t *)  { return "Int64"; }
+   const char *JsonArrayType(const ULong64_t *) { return "Uint64"; }
+   const char *JsonArrayType(const Float_t *)   { return "Float32"; }
+   const char *JsonArrayType(const Double_t *)  { return "Float64"; }
+}
+
 
 // TJSONStackObj is used to keep stack of object hierarchy,
 // stored in TBuffer. For instance, data for parent class(es)
@@ -146,6 +321,9 @@ TBufferJSON::TBufferJSON() :
    fStack(),
    fExpectedChain(kFALSE),
    fCompact(0),
+   fArrayCompact(kFALSE),
+   fSink(0),
+   fSinkLength(0),
    fSemicolon(" : "),
    fArraySepar(", "),
    fNumericLocale()
@@ -162,8 +340,9 @@ TBufferJSON::TBufferJSON() :
 
    // checks if setlocale(LC_NUMERIC) returns others than "C"
    // in this case locale will be changed and restored at the end of object conversion
+   // Not required with default "%e" format, which is produced without printf
 
-   char* loc = setlocale(LC_NUMERIC, 0);
+   char* loc = (strcmp(fgFloatFmt, "%e") != 0) ? setlocale(LC_NUMERIC, 0) : 0;
    if ((loc!=0) && (strcmp(loc,"C")!=0)) {
       fNumericLocale = loc;
       setlocale(LC_NUMERIC, "C");
@@ -205,10 +384,13 @@ TString TBufferJSON::ConvertToJSON(const TObject *obj, Int_t compact, const char
 ///   1 - exclude spaces in the begin
 ///   2 - remove newlines
 ///   3 - exclude spaces as much as possible
+/// When 10 is added (like 13), arrays of numbers are compressed: zeros are
+/// skipped and repeated values are written once, see class description
 
 void TBufferJSON::SetCompact(int level)
 {
-   fCompact = level;
+   fArrayCompact = level >= 10;
+   fCompact = level % 10;
    fSemicolon = fCompact > 2 ? ":" : " : ";
    fArraySepar = fCompact > 2 ? "," : ", ";
 }
@@ -222,6 +404,7 @@ void TBufferJSON::SetCompact(int level)
 ///   1 - exclude spaces in the begin
 ///   2 - remove newlines
 ///   3 - exclude spaces as much as possible
+///  +10 - compress arrays of numbers
 /// When member_name specified, converts only this data member
 
 TString TBufferJSON::ConvertToJSON(const void *obj, const TClass *cl,
@@ -297,13 +480,11 @@ Int_t TBufferJSON::ExportToFile(const char* filename, const TObject *obj, const
    Int_t compact = 0;
    if (option && (*option >= '0') && (*option <='3')) compact = TString(option,1).Atoi();
 
-   TString json = TBufferJSON::ConvertToJSON(obj, compact);
-
    std::ofstream ofs (filename);
-   ofs << json.Data();
+   Long64_t len = ExportToStream(ofs, obj, compact);
    ofs.close();
 
-   return json.Length();
+   return (Int_t) len;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -317,13 +498,67 @@ Int_t TBufferJSON::ExportToFile(const char* filename, const void *obj, const TCl
    Int_t compact = 0;
    if (option && (*option >= '0') && (*option <='3')) compact = TString(option,1).Atoi();
 
-   TString json = TBufferJSON::ConvertToJSON(obj, cl, compact);
-
    std::ofstream ofs (filename);
-   ofs << json.Data();
+   Long64_t len = ExportToStream(ofs, obj, cl, compact);
    ofs.close();
 
-   return json.Length();
+   return (Int_t) len;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Convert object into JSON and write it to the stream
+/// Output is written in portions while the object is converted, therefore
+/// the complete JSON code is never kept in memory.
+/// Returns number of written bytes
+
+Long64_t TBufferJSON::ExportToStream(std::ostream &os, const TObject *obj, Int_t compact)
+{
+   if (!obj) return 0;
+
+   TClass *clActual = TObject::Class()->GetActualClass(obj);
+   void *ptr = (void *) obj;
+   if (!clActual) clActual = TObject::Class(); else
+   if (clActual != TObject::Class())
+      ptr = (void *) ((Long_t) obj - clActual->GetBaseClassOffset(TObject::Class()));
+
+   return ExportToStream(os, ptr, clActual, compact);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Convert object of class cl into JSON and write it to the stream
+/// Returns number of written bytes
+
+Long64_t TBufferJSON::ExportToStream(std::ostream &os, const void *obj, const TClass *cl, Int_t compact)
+{
+   if (!obj || !cl) return 0;
+
+   TBufferJSON buf;
+
+   buf.SetCompact(compact);
+
+   buf.fSink = &os;
+
+   buf.JsonWriteObject(obj, cl);
+
+   // arrays, strings and containers are produced in the value
+   if ((buf.fSinkLength == 0) && (buf.fOutBuffer.Length() == 0))
+      buf.fOutBuffer = buf.fValue;
+
+   buf.FlushSink();
+
+   return buf.fSinkLength;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write main output to the sink stream and clear it
+
+void TBufferJSON::FlushSink()
+{
+   if ((fSink == 0) || (fOutBuffer.Length() == 0)) return;
+
+   fSink->write(fOutBuffer.Data(), fOutBuffer.Length());
+   fSinkLength += fOutBuffer.Length();
+   fOutBuffer.Clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -711,6 +946,9 @@ void TBufferJSON::AppendOutput(const char *line0, const char *line1)
          fOutput->Append(line1);
       }
    }
+
+   if ((fSink != 0) && (fOutput == &fOutBuffer) && (fOutBuffer.Length() > kSinkChunk))
+      FlushSink();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2084,11 +2322,90 @@ void TBufferJSON::ReadFastArray(void ** /*startp*/, const TClass * /*cl*/,
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Write array of numbers in compressed form, see class description
+/// Zeros are skipped, runs of at least 5 equal values are written once.
+/// Returns kFALSE (and writes nothing) when compression does not pay off
+
+template <typename T>
+Bool_t TBufferJSON::JsonWriteArrayCompress(const T *vname, Int_t arrsize, const char *typname)
+{
+   if ((typname == 0) || (arrsize < 10)) return kFALSE;
+
+   Bool_t repeat(kFALSE);
+
+   // first count written values and segments, to decide if compression is useful
+   Int_t nvalues = 0, nsegments = 0, indx = 0;
+   while (indx < arrsize) {
+      if (vname[indx] == 0) { indx++; continue; }
+      Int_t last = JsonArraySegment(vname, arrsize, indx, repeat);
+      nvalues += repeat ? 1 : last - indx;
+      nsegments++;
+      indx = last;
+   }
+
+   if (nvalues + 4*nsegments + 4 >= arrsize) return kFALSE;
+
+   fValue.Append("{\"$arr\"");
+   fValue.Append(fSemicolon);
+   fValue.Append("\"");
+   fValue.Append(typname);
+   fValue.Append("\"");
+   fValue.Append(fArraySepar);
+   fValue.Append("\"len\"");
+   fValue.Append(fSemicolon);
+   JsonWriteBasic(arrsize);
+
+   TString suffix;
+   nsegments = 0;
+   indx = 0;
+   while (indx < arrsize) {
+      if (vname[indx] == 0) { indx++; continue; }
+      Int_t last = JsonArraySegment(vname, arrsize, indx, repeat);
+
+      if (nsegments++ > 0) suffix.Form("%d", nsegments - 1);
+      fValue.Append(fArraySepar);
+      fValue.Append("\"p");
+      fValue.Append(suffix);
+      fValue.Append("\"");
+      fValue.Append(fSemicolon);
+      JsonWriteBasic(indx);
+      fValue.Append(fArraySepar);
+      fValue.Append("\"v");
+      fValue.Append(suffix);
+      fValue.Append("\"");
+      fValue.Append(fSemicolon);
+
+      if (repeat) {
+         JsonWriteBasic(vname[indx]);
+         fValue.Append(fArraySepar);
+         fValue.Append("\"n");
+         fValue.Append(suffix);
+         fValue.Append("\"");
+         fValue.Append(fSemicolon);
+         JsonWriteBasic(last - indx);
+      } else {
+         fValue.Append("[");
+         for (Int_t k = indx; k < last; k++) {
+            if (k > indx) fValue.Append(fArraySepar);
+            JsonWriteBasic(vname[k]);
+         }
+         fValue.Append("]");
+      }
+      indx = last;
+   }
+
+   fValue.Append("}");
+
+   return kTRUE;
+}
+
 #define TJSONWriteArrayContent(vname, arrsize)        \
-   {                                                     \
+   if (!fArrayCompact ||                                 \
+       !JsonWriteArrayCompress(vname, arrsize, JsonArrayType(vname))) { \
       fValue.Append("["); /* fJsonrCnt++; */             \
       for (Int_t indx=0;indx<arrsize;indx++) {           \
-         if (indx>0) fValue.Append(fArraySepar.Data());  \
+         if (indx>0) fValue.Append(fArraySepar);         \
          JsonWriteBasic(vname[indx]);                    \
       }                                                  \
       fValue.Append("]");                                \
@@ -2824,8 +3141,7 @@ void TBufferJSON::WriteStdString(const std::string &s)
 void TBufferJSON::JsonWriteBasic(Char_t value)
 {
    char buf[50];
-   snprintf(buf, sizeof(buf), "%d", value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatSigned(buf, value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2834,8 +3150,7 @@ void TBufferJSON::JsonWriteBasic(Char_t value)
 void TBufferJSON::JsonWriteBasic(Short_t value)
 {
    char buf[50];
-   snprintf(buf, sizeof(buf), "%hd", value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatSigned(buf, value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2844,8 +3159,7 @@ void TBufferJSON::JsonWriteBasic(Short_t value)
 void TBufferJSON::JsonWriteBasic(Int_t value)
 {
    char buf[50];
-   snprintf(buf, sizeof(buf), "%d", value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatSigned(buf, value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2854,8 +3168,7 @@ void TBufferJSON::JsonWriteBasic(Int_t value)
 void TBufferJSON::JsonWriteBasic(Long_t value)
 {
    char buf[50];
-   snprintf(buf, sizeof(buf), "%ld", value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatSigned(buf, value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2864,8 +3177,7 @@ void TBufferJSON::JsonWriteBasic(Long_t value)
 void TBufferJSON::JsonWriteBasic(Long64_t value)
 {
    char buf[50];
-   snprintf(buf, sizeof(buf), FLong64, value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatSigned(buf, value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2874,11 +3186,7 @@ void TBufferJSON::JsonWriteBasic(Long64_t value)
 void TBufferJSON::JsonWriteBasic(Float_t value)
 {
    char buf[200];
-   if (value == floor(value))
-      snprintf(buf, sizeof(buf), "%1.0f", value);
-   else
-      snprintf(buf, sizeof(buf), fgFloatFmt, value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatFloat(buf, sizeof(buf), value, fgFloatFmt));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2887,11 +3195,7 @@ void TBufferJSON::JsonWriteBasic(Float_t value)
 void TBufferJSON::JsonWriteBasic(Double_t value)
 {
    char buf[200];
-   if (value == floor(value))
-      snprintf(buf, sizeof(buf), "%1.0f", value);
-   else
-      snprintf(buf, sizeof(buf), fgFloatFmt, value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatFloat(buf, sizeof(buf), value, fgFloatFmt));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2908,8 +3212,7 @@ void TBufferJSON::JsonWriteBasic(Bool_t value)
 void TBufferJSON::JsonWriteBasic(UChar_t value)
 {
    char buf[50];
-   snprintf(buf, sizeof(buf), "%u", value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatUnsigned(buf, value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2918,8 +3221,7 @@ void TBufferJSON::JsonWriteBasic(UChar_t value)
 void TBufferJSON::JsonWriteBasic(UShort_t value)
 {
    char buf[50];
-   snprintf(buf, sizeof(buf), "%hu", value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatUnsigned(buf, value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2928,8 +3230,7 @@ void TBufferJSON::JsonWriteBasic(UShort_t value)
 void TBufferJSON::JsonWriteBasic(UInt_t value)
 {
    char buf[50];
-   snprintf(buf, sizeof(buf), "%u", value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatUnsigned(buf, value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2938,8 +3239,7 @@ void TBufferJSON::JsonWriteBasic(UInt_t value)
 void TBufferJSON::JsonWriteBasic(ULong_t value)
 {
    char buf[50];
-   snprintf(buf, sizeof(buf), "%lu", value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatUnsigned(buf, value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2948,8 +3248,7 @@ void TBufferJSON::JsonWriteBasic(ULong_t value)
 void TBufferJSON::JsonWriteBasic(ULong64_t value)
 {
    char buf[50];
-   snprintf(buf, sizeof(buf), FULong64, value);
-   fValue.Append(buf);
+   fValue.Append(buf, JsonFormatUnsigned(buf, value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
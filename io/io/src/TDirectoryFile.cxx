@@ -47,12 +47,184 @@ End_Macro
 #include "TProcessUUID.h"
 #include "TVirtualMutex.h"
 #include "TEmulatedCollectionProxy.h"
+#include "TEnv.h"
+#include "RZip.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef R__USE_IMT
+#include "tbb/parallel_for.h"
+#endif
 
 const UInt_t kIsBigFile = BIT(16);
 const Int_t  kMaxLen = 2048;
+const Int_t  kMaxBulkRead = 64*1024*1024; // maximum size of one vectored read of ReadObjects
+
+Int_t TDirectoryFile::fgLazyKeys = -1;
 
 ClassImp(TDirectoryFile)
 
+namespace ROOT {
+namespace Internal {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Keys record of a directory read with lazy key loading (see
+/// TDirectoryFile::SetLazyKeys).
+///
+/// The record is kept in memory as read from the file and the TKey of an
+/// entry is only created when a key with its name is looked for. The entries
+/// are chained by the hash of their name in the order of the record, i.e.
+/// for a given name the highest cycle comes first, like in the list of keys.
+
+class TKeysIndex {
+public:
+   TKey               *fHeaderKey; ///< Key holding the buffer of the keys record
+   std::vector<char*>  fEntries;   ///< Start of each entry in the buffer
+   std::vector<char*>  fClassNames;///< Class name (as streamed by TString) of each entry
+   std::vector<char*>  fNames;     ///< Name (as streamed by TString) of each entry
+   std::vector<TKey*>  fKeys;      ///< TKey created from each entry, 0 if not yet
+   std::vector<Int_t>  fNext;      ///< Next entry in the same bucket, -1 at the end
+   std::vector<Int_t>  fBuckets;   ///< First entry of each bucket, -1 if empty
+
+   TKeysIndex(TKey *headerkey) : fHeaderKey(headerkey) {}
+   ~TKeysIndex() { delete fHeaderKey; }
+
+   Int_t  Build(TDirectoryFile *dir, char *buffer, Int_t nkeys, Long64_t fsize);
+   TKey  *Find(TDirectoryFile *dir, TList *keys, const char *name, Short_t cycle);
+   TKey  *CreateKey(TDirectoryFile *dir, Int_t i);
+   Int_t  CountClass(const char *classname) const;
+
+   static const char *ReadString(char *&buffer, Int_t &nchars)
+   {
+      UChar_t nwh;
+      frombuf(buffer, &nwh);
+      if (nwh == 255) frombuf(buffer, &nchars);
+      else            nchars = nwh;
+      const char *chars = buffer;
+      buffer += nchars;
+      return chars;
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Index the nkeys entries of the keys record starting at buffer, see
+/// TKey::ReadKeyBuffer for their layout. Stop at the first entry pointing
+/// outside of the file, like TDirectoryFile::ReadKeys. Return the number
+/// of entries indexed.
+
+Int_t TKeysIndex::Build(TDirectoryFile *dir, char *buffer, Int_t nkeys, Long64_t fsize)
+{
+   fEntries.reserve(nkeys);
+   fClassNames.reserve(nkeys);
+   fNames.reserve(nkeys);
+   std::vector<UInt_t> hashes;
+   hashes.reserve(nkeys);
+   for (Int_t i = 0; i < nkeys; i++) {
+      char *entry = buffer;
+      buffer += sizeof(Int_t);                      // fNbytes
+      Version_t version;
+      frombuf(buffer, &version);
+      buffer += 2*sizeof(Int_t) + 2*sizeof(Short_t); // fObjlen, fDatime, fKeylen, fCycle
+      Long64_t seekkey, seekpdir;
+      if (version > 1000) {
+         frombuf(buffer, &seekkey);
+         frombuf(buffer, &seekpdir);
+         seekpdir &= 0xffffffffffffLL; // the 16 highest bits hold the pid offset
+      } else {
+         UInt_t skey, spdir;
+         frombuf(buffer, &skey);  seekkey  = skey;
+         frombuf(buffer, &spdir); seekpdir = spdir;
+      }
+      if (seekkey < 64 || seekkey > fsize || seekpdir < 64 || seekpdir > fsize) {
+         dir->Error("ReadKeys","reading illegal key, exiting after %d keys",i);
+         break;
+      }
+      Int_t nchars;
+      char *classname = buffer;
+      ReadString(buffer, nchars);
+      char *name = buffer;
+      const char *chars = ReadString(buffer, nchars);
+      ReadString(buffer, nchars);         // title
+      fEntries.push_back(entry);
+      fClassNames.push_back(classname);
+      fNames.push_back(name);
+      hashes.push_back(TString::Hash(chars, nchars));
+   }
+
+   Int_t n = fEntries.size();
+   UInt_t nbuckets = 16;
+   while (nbuckets < (UInt_t)n) nbuckets <<= 1;
+   fBuckets.assign(nbuckets, -1);
+   fNext.resize(n);
+   fKeys.assign(n, (TKey*)0);
+   for (Int_t i = n-1; i >= 0; i--) {
+      Int_t &head = fBuckets[hashes[i] & (nbuckets-1)];
+      fNext[i] = head;
+      head = i;
+   }
+   return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create the key of entry i.
+
+TKey *TKeysIndex::CreateKey(TDirectoryFile *dir, Int_t i)
+{
+   TKey *key = new TKey(dir);
+   char *buffer = fEntries[i];
+   key->ReadKeyBuffer(buffer);
+   fKeys[i] = key;
+   return key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the number of entries holding an object of class classname.
+
+Int_t TKeysIndex::CountClass(const char *classname) const
+{
+   Int_t len = strlen(classname);
+   Int_t n = 0;
+   for (UInt_t i = 0; i < fClassNames.size(); i++) {
+      char *buffer = fClassNames[i];
+      Int_t nchars;
+      const char *chars = ReadString(buffer, nchars);
+      if (nchars == len && !memcmp(chars, classname, len)) n++;
+   }
+   return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the key with name and cycle, same as TDirectoryFile::GetKey.
+/// A key created here is added to keys.
+
+TKey *TKeysIndex::Find(TDirectoryFile *dir, TList *keys, const char *name, Short_t cycle)
+{
+   if (fEntries.empty()) return 0;
+   Int_t len = strlen(name);
+   for (Int_t i = fBuckets[TString::Hash(name, len) & (fBuckets.size()-1)]; i >= 0; i = fNext[i]) {
+      char *buffer = fNames[i];
+      Int_t nchars;
+      const char *chars = ReadString(buffer, nchars);
+      if (nchars != len || memcmp(chars, name, len)) continue;
+      if (cycle != 9999) {
+         // fCycle follows fNbytes, the version, fObjlen, fDatime and fKeylen
+         buffer = fEntries[i] + 3*sizeof(Int_t) + sizeof(Version_t) + sizeof(Short_t);
+         Short_t keycycle;
+         frombuf(buffer, &keycycle);
+         if (cycle < keycycle) continue;
+      }
+      if (!fKeys[i]) keys->Add(CreateKey(dir, i));
+      return fKeys[i];
+   }
+   return 0;
+}
+
+} // namespace Internal
+} // namespace ROOT
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Default Constructor
@@ -60,7 +232,7 @@ ClassImp(TDirectoryFile)
 TDirectoryFile::TDirectoryFile() : TDirectory()
    , fModified(kFALSE), fWritable(kFALSE), fNbytesKeys(0), fNbytesName(0)
    , fBufferSize(0), fSeekDir(0), fSeekParent(0), fSeekKeys(0)
-   , fFile(0), fKeys(0)
+   , fFile(0), fKeys(0), fKeysIndex(0)
 {
 }
 
@@ -80,7 +252,7 @@ TDirectoryFile::TDirectoryFile(const char *name, const char *title, Option_t *cl
            : TDirectory()
    , fModified(kFALSE), fWritable(kFALSE), fNbytesKeys(0), fNbytesName(0)
    , fBufferSize(0), fSeekDir(0), fSeekParent(0), fSeekKeys(0)
-   , fFile(0), fKeys(0)
+   , fFile(0), fKeys(0), fKeysIndex(0)
 {
    fName = name;
    fTitle = title;
@@ -168,7 +340,7 @@ void TDirectoryFile::Init(TClass *cl)
 TDirectoryFile::TDirectoryFile(const TDirectoryFile & directory) : TDirectory(directory)
    , fModified(kFALSE), fWritable(kFALSE), fNbytesKeys(0), fNbytesName(0)
    , fBufferSize(0), fSeekDir(0), fSeekParent(0), fSeekKeys(0)
-   , fFile(0), fKeys(0)
+   , fFile(0), fKeys(0), fKeysIndex(0)
 {
    ((TDirectoryFile&)directory).Copy(*this);
 }
@@ -178,6 +350,7 @@ TDirectoryFile::TDirectoryFile(const TDirectoryFile & directory) : TDirectory(di
 
 TDirectoryFile::~TDirectoryFile()
 {
+   DeleteKeysIndex();
    if (fKeys) {
       fKeys->Delete("slow");
       SafeDelete(fKeys);
@@ -230,6 +403,8 @@ Int_t TDirectoryFile::AppendKey(TKey *key)
 
    key->SetMotherDir(this);
 
+   if (fKeysIndex) LoadAllKeys();
+
    // This is a fast hash lookup in case the key does not already exist
    TKey *oldkey = (TKey*)fKeys->FindObject(key->GetName());
    if (!oldkey) {
@@ -262,7 +437,7 @@ void TDirectoryFile::Browse(TBrowser *b)
       TObject *obj = 0;
       TIter nextin(fList);
       TKey *key = 0, *keyo = 0;
-      TIter next(fKeys);
+      TIter next(GetListOfKeys());
 
       cd();
 
@@ -316,7 +491,7 @@ void TDirectoryFile::Build(TFile* motherFile, TDirectory* motherDir)
    fSeekParent = 0;
    fSeekKeys   = 0;
    fList       = new THashList(100,50);
-   fKeys       = new THashList(100,50);
+   fKeys       = new THashList(100,4);
    fMother     = motherDir;
    fFile       = motherFile ? motherFile : TFile::CurrentFile();
    SetBit(kCanDelete);
@@ -559,6 +734,7 @@ void TDirectoryFile::Close(Option_t *)
    }
 
    // Delete keys from key list (but don't delete the list header)
+   DeleteKeysIndex();
    if (fKeys) {
       fKeys->Delete("slow");
    }
@@ -921,16 +1097,11 @@ TObject *TDirectoryFile::Get(const char *namecycle)
 
 //*-*---------------------Case of Key---------------------
 //                        ===========
-   TKey *key;
-   TIter nextkey(GetListOfKeys());
-   while ((key = (TKey *) nextkey())) {
-      if (strcmp(namobj,key->GetName()) == 0) {
-         if ((cycle == 9999) || (cycle == key->GetCycle())) {
-            TDirectory::TContext ctxt(this);
-            idcur = key->ReadObj();
-            break;
-         }
-      }
+   // GetKey returns the highest cycle not above the requested one
+   TKey *key = GetKey(namobj, cycle);
+   if (key && ((cycle == 9999) || (cycle == key->GetCycle()))) {
+      TDirectory::TContext ctxt(this);
+      idcur = key->ReadObj();
    }
 
    return idcur;
@@ -1035,16 +1206,11 @@ void *TDirectoryFile::GetObjectChecked(const char *namecycle, const TClass* expe
 //*-*---------------------Case of Key---------------------
 //                        ===========
    void *idcur = 0;
-   TKey *key;
-   TIter nextkey(GetListOfKeys());
-   while ((key = (TKey *) nextkey())) {
-      if (strcmp(namobj,key->GetName()) == 0) {
-         if ((cycle == 9999) || (cycle == key->GetCycle())) {
-            TDirectory::TContext ctxt(this);
-            idcur = key->ReadObjectAny(expectedClass);
-            break;
-         }
-      }
+   // GetKey returns the highest cycle not above the requested one
+   TKey *key = GetKey(namobj, cycle);
+   if (key && ((cycle == 9999) || (cycle == key->GetCycle()))) {
+      TDirectory::TContext ctxt(this);
+      idcur = key->ReadObjectAny(expectedClass);
    }
 
    return idcur;
@@ -1070,6 +1236,9 @@ Int_t TDirectoryFile::GetBufferSize() const
 
 TKey *TDirectoryFile::GetKey(const char *name, Short_t cycle) const
 {
+   if (fKeysIndex)
+      return fKeysIndex->Find(const_cast<TDirectoryFile*>(this), fKeys, name, cycle);
+
    // TIter::TIter() already checks for null pointers
    TIter next( ((THashList *)(GetListOfKeys()))->GetListForObject(name) );
 
@@ -1084,6 +1253,74 @@ TKey *TDirectoryFile::GetKey(const char *name, Short_t cycle) const
    return 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return the number of keys of this directory holding an object of class
+/// classname, without creating the keys not yet created with lazy key
+/// loading.
+
+Int_t TDirectoryFile::GetNkeysOfClass(const char *classname) const
+{
+   if (fKeysIndex) return fKeysIndex->CountClass(classname);
+   Int_t n = 0;
+   TIter next(fKeys);
+   TKey *key;
+   while ((key = (TKey*)next())) {
+      if (!strcmp(key->GetClassName(), classname)) n++;
+   }
+   return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the number of keys of this directory, including the ones not yet
+/// created with lazy key loading.
+
+Int_t TDirectoryFile::GetNkeys() const
+{
+   if (fKeysIndex) return fKeysIndex->fEntries.size();
+   return fKeys->GetSize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return kTRUE if the TKeys of the directories read from a file are created
+/// on demand, see SetLazyKeys.
+
+Bool_t TDirectoryFile::GetLazyKeys()
+{
+   if (fgLazyKeys < 0) fgLazyKeys = gEnv->GetValue("TFile.LazyKeys", 0) ? 1 : 0;
+   return fgLazyKeys == 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Create the TKeys of the keys record not created yet by GetKey and put
+/// all the keys in the list of keys, in the order of the record.
+
+void TDirectoryFile::LoadAllKeys() const
+{
+   ROOT::Internal::TKeysIndex *index = fKeysIndex;
+   if (!index) return;
+   fKeysIndex = 0;
+
+   fKeys->Clear("nodelete");
+   Int_t nkeys = index->fEntries.size();
+   if (nkeys > fKeys->GetSize()) ((THashList*)fKeys)->Rehash(nkeys);
+   for (Int_t i = 0; i < nkeys; i++) {
+      TKey *key = index->fKeys[i];
+      if (!key) key = index->CreateKey(const_cast<TDirectoryFile*>(this), i);
+      fKeys->Add(key);
+   }
+   delete index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Delete the index of the keys record of a directory read with lazy key
+/// loading. The keys already created stay in the list of keys.
+
+void TDirectoryFile::DeleteKeysIndex()
+{
+   delete fKeysIndex;
+   fKeysIndex = 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// List Directory contents
 ///
@@ -1255,12 +1492,201 @@ void TDirectoryFile::ReadAll(Option_t* opt)
 
          if ((dir!=0) && (strcmp(opt,"dirs*")==0)) dir->ReadAll("dirs*");
       }
-   else
-      while ((key = (TKey *) next())) {
+   else {
+      // Each object replaces the one with the same name read before, so only
+      // the last key of the list with a given name has to be read
+      TList keys;
+      std::set<std::string> names;
+      TIter prev(GetListOfKeys(), kIterBackward);
+      while ((key = (TKey *) prev())) {
+         if (!names.insert(key->GetName()).second) continue;
          TObject *thing = GetList()->FindObject(key->GetName());
          if (thing) { delete thing; }
-         key->ReadObj();
+         keys.AddFirst(key);
       }
+      ReadObjects(&keys);
+   }
+}
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return a new buffer with the key header followed by the uncompressed
+/// object of key, from its record as read from the file, or 0 if the record
+/// cannot be uncompressed (see TKey::ReadObj).
+
+char *UnzipKeyRecord(const TKey *key, const char *record)
+{
+   Int_t keylen = key->GetKeylen();
+   Int_t objlen = key->GetObjlen();
+   char *buffer = new char[keylen+objlen];
+   memcpy(buffer, record, keylen);
+   if (objlen <= key->GetNbytes()-keylen) {
+      memcpy(buffer+keylen, record+keylen, objlen);
+      return buffer;
+   }
+
+   char *objbuf = buffer + keylen;
+   UChar_t *bufcur = (UChar_t *)&record[keylen];
+   Int_t nin, nout = 0, nbuf;
+   Int_t noutot = 0;
+   while (1) {
+      Int_t hc = R__unzip_header(&nin, bufcur, &nbuf);
+      if (hc!=0) break;
+      R__unzip(&nin, bufcur, &nbuf, (unsigned char*) objbuf, &nout);
+      if (!nout) break;
+      noutot += nout;
+      if (noutot >= objlen) break;
+      bufcur += nin;
+      objbuf += nout;
+   }
+   if (!nout) {
+      delete [] buffer;
+      return 0;
+   }
+   return buffer;
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read the objects of a collection of keys of this directory.
+///
+/// The objects are added to the directory like by TKey::ReadObj and, if
+/// objects is not null, appended to it in the order of the keys. Return the
+/// number of objects read.
+///
+/// Instead of one read per key, the records of the keys are read in order of
+/// their position in the file with vectored reads (TFile::ReadBuffers) of up
+/// to 64 MB. If the implicit multi-threading is enabled
+/// (ROOT::EnableImplicitMT) they are uncompressed in parallel. The objects of
+/// each group of records are streamed before the next group is read, so that
+/// only the records of one group and their uncompressed buffers are in memory.
+///
+/// With option "P" the objects are also streamed in parallel. This is only
+/// safe if their Streamer does not modify a global state (gDirectory, lists
+/// of gROOT, ...), which is the case of the histograms and graphs for
+/// example. Directories, objects not deriving from TObject and emulated
+/// classes are always read sequentially, with TKey::ReadObj.
+
+Int_t TDirectoryFile::ReadObjects(const TCollection *keys, TCollection *objects, Option_t *option)
+{
+   if (!keys || !fFile) return 0;
+   TDirectory::TContext ctxt(this);
+
+   TString opt = option;
+   opt.ToUpper();
+   Bool_t parallel = kFALSE;
+#ifdef R__USE_IMT
+   parallel = ROOT::IsImplicitMTEnabled();
+#endif
+   Bool_t parallelStreaming = parallel && opt.Contains("P");
+
+   // The keys read with their own TKey::ReadObj have no bulk slot
+   std::vector<TKey*> all;
+   std::vector<TKey*> bulk;
+   std::vector<Bool_t> concurrent;
+   TIter next(keys);
+   TKey *key;
+   while ((key = (TKey*)next())) {
+      all.push_back(key);
+      TClass *cl = TClass::GetClass(key->GetClassName());
+      if (!fFile->IsBinary() || !cl || !cl->IsTObject() || cl->InheritsFrom(TDirectoryFile::Class()))
+         continue;
+      bulk.push_back(key);
+      // Make sure the streamer infos are built before the parallel streaming
+      if (parallelStreaming && cl->IsLoaded()) cl->GetStreamerInfo();
+      concurrent.push_back(parallelStreaming && cl->IsLoaded());
+   }
+
+   // Read the records in order of their position in the file
+   Int_t nbulk = bulk.size();
+   std::vector<Int_t> order(nbulk);
+   for (Int_t i = 0; i < nbulk; i++) order[i] = i;
+   std::sort(order.begin(), order.end(),
+             [&bulk](Int_t a, Int_t b) { return bulk[a]->GetSeekKey() < bulk[b]->GetSeekKey(); });
+
+   std::vector<TObject*> objs(nbulk, (TObject*)0);
+   std::vector<Long64_t> pos;
+   std::vector<Int_t> len;
+   std::vector<char*> records;
+   std::vector<char*> buffers;
+   Int_t first = 0;
+   while (first < nbulk) {
+      // Group the records up to kMaxBulkRead bytes (at least one record)
+      Int_t last = first;
+      Long64_t nbytes = 0;
+      pos.clear();
+      len.clear();
+      while (last < nbulk && (last == first || nbytes + bulk[order[last]]->GetNbytes() <= kMaxBulkRead)) {
+         TKey *k = bulk[order[last]];
+         pos.push_back(k->GetSeekKey());
+         len.push_back(k->GetNbytes());
+         nbytes += k->GetNbytes();
+         last++;
+      }
+      char *data = new char[nbytes];
+      Int_t nrecords = last - first;
+      Bool_t failed = fFile->ReadBuffers(data, &pos[0], &len[0], nrecords);
+      records.resize(nrecords);
+      for (Int_t i = 0, offset = 0; i < nrecords; offset += len[i], i++) records[i] = data + offset;
+      buffers.assign(nrecords, (char*)0);
+
+      // Uncompress the records, then stream the objects which allow it
+      auto unzip = [&](Int_t i) {
+         Int_t j = order[first+i];
+         buffers[i] = UnzipKeyRecord(bulk[j], records[i]);
+         if (buffers[i] && concurrent[j]) {
+            objs[j] = bulk[j]->ReadObjFromBuffer(buffers[i]);
+            buffers[i] = 0;
+         }
+      };
+      if (!failed) {
+#ifdef R__USE_IMT
+         if (parallel) {
+            tbb::parallel_for(0, nrecords, unzip);
+         } else {
+            for (Int_t i = 0; i < nrecords; i++) unzip(i);
+         }
+#else
+         for (Int_t i = 0; i < nrecords; i++) unzip(i);
+#endif
+      }
+      delete [] data;
+
+      // Stream the other objects of the group sequentially, so that the
+      // uncompressed records of one group only are kept in memory
+      for (Int_t i = 0; i < nrecords; i++) {
+         if (buffers[i]) objs[order[first+i]] = bulk[order[first+i]]->ReadObjFromBuffer(buffers[i]);
+      }
+      first = last;
+   }
+
+   // Add the objects to the directory, in the order of the keys
+   Int_t nread = 0;
+   Int_t ibulk = 0;
+   for (size_t i = 0; i < all.size(); i++) {
+      key = all[i];
+      TObject *obj = 0;
+      if (ibulk < nbulk && bulk[ibulk] == key) {
+         obj = objs[ibulk];
+         ibulk++;
+      }
+      if (obj) {
+         // what TKey::ReadObj does after the streaming
+         if (gROOT->GetForceStyle()) obj->UseCurrentStyle();
+         TClass *cl = TClass::GetClass(key->GetClassName());
+         ROOT::DirAutoAdd_t addfunc = cl->GetDirectoryAutoAdd();
+         if (addfunc) addfunc((char*)obj - cl->GetBaseClassOffset(TObject::Class()), key->GetMotherDir());
+      } else {
+         // not read in bulk, or its record could not be read or uncompressed
+         obj = key->ReadObj();
+      }
+      if (!obj) continue;
+      nread++;
+      if (objects) objects->Add(obj);
+   }
+   return nread;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1300,6 +1726,7 @@ Int_t TDirectoryFile::ReadKeys(Bool_t forceRead)
 
    char *buffer;
    if (forceRead) {
+      DeleteKeysIndex();
       fKeys->Delete();
       //In case directory was updated by another process, read new
       //position for the keys
@@ -1340,20 +1767,30 @@ Int_t TDirectoryFile::ReadKeys(Bool_t forceRead)
       buffer = headerkey->GetBuffer();
       headerkey->ReadKeyBuffer(buffer);
 
-      TKey *key;
       frombuf(buffer, &nkeys);
+      if (fKeysIndex) LoadAllKeys();
+      if (GetLazyKeys() && !fKeys->GetSize()) {
+         // Keep the record, the TKeys are created by GetKey or LoadAllKeys
+         fKeysIndex = new ROOT::Internal::TKeysIndex(headerkey);
+         nkeys = fKeysIndex->Build(this, buffer, nkeys, fsize);
+         return nkeys;
+      }
+
+      // Size the hash table once for all the keys
+      if (nkeys > 0) ((THashList*)fKeys)->Rehash(fKeys->GetSize() + nkeys);
+      TKey *key;
       for (Int_t i = 0; i < nkeys; i++) {
          key = new TKey(this);
          key->ReadKeyBuffer(buffer);
          if (key->GetSeekKey() < 64 || key->GetSeekKey() > fsize) {
             Error("ReadKeys","reading illegal key, exiting after %d keys",i);
-            fKeys->Remove(key);
+            delete key;
             nkeys = i;
             break;
          }
          if (key->GetSeekPdir() < 64 || key->GetSeekPdir() > fsize) {
             Error("ReadKeys","reading illegal key, exiting after %d keys",i);
-            fKeys->Remove(key);
+            delete key;
             nkeys = i;
             break;
          }
@@ -1412,7 +1849,7 @@ void TDirectoryFile::ResetAfterMerge(TFileMergeInfo *info)
    fSeekParent = 0; // updated by Init
    fSeekKeys = 0;   // updated by Init
    // Does not change: fFile
-   TKey *key = (TKey*)fKeys->FindObject(fName);
+   TKey *key = (TKey*)GetListOfKeys()->FindObject(fName);
    TClass *cl = IsA();
    if (key) {
       cl = TClass::GetClass(key->GetClassName());
@@ -1544,6 +1981,24 @@ void TDirectoryFile::SaveSelf(Bool_t force)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Create the TKeys of the directories read from a file on demand.
+///
+/// By default ReadKeys creates a TKey for every entry of the keys record
+/// of the directory. With lazy key loading the record is only indexed by
+/// name; the TKey of an entry is created when a key with its name is looked
+/// for (GetKey, FindKey, Get, GetObject) and all the keys are created when
+/// the list of keys is used (GetListOfKeys, ls, ReadAll, writing).
+/// Directories with a large number of keys of which only a few are read
+/// then open much faster and use less memory.
+///
+/// The default is taken from the rootrc variable TFile.LazyKeys (default no).
+
+void TDirectoryFile::SetLazyKeys(Bool_t lazy)
+{
+   fgLazyKeys = lazy ? 1 : 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Set the default buffer size when creating new TKeys.
 ///
@@ -1799,9 +2254,14 @@ Int_t TDirectoryFile::Write(const char *n, Int_t opt, Int_t bufsize) const
 /// The "SingleKey" option is only used by TCollection::Write() to write
 /// a container with a single key instead of each object in the container
 /// with its own key.
+/// If the file tracks the changes (see TFile::SetChangeTracking), with the
+/// "Overwrite" and "WriteDelete" options an object which did not change since
+/// it was written with the previous key of the same name is not written again.
 /// An object is read from this directory via TDirectoryFile::Get.
 /// The function returns the total number of bytes written to the directory.
-/// It returns 0 if the object cannot be written.
+/// It returns 0 if the object cannot be written. If the object was not
+/// written because it did not change, the number of bytes of its previous
+/// key is returned, like if it had been written again.
 ///
 /// WARNING: avoid special characters like '^','$','.' in the name as they
 /// are used by the regular expression parser (see TRegexp).
@@ -1854,6 +2314,14 @@ Int_t TDirectoryFile::WriteTObject(const TObject *obj, const char *name, Option_
       oname = newName;
    }
 
+   if (fFile->IsChangeTracking() && (opt.Contains("overwrite") || opt.Contains("writedelete"))) {
+      // Compare the object to its previous key before compressing it.
+      key = GetKey(oname);
+      if (key && key->IsUnchanged(obj)) {
+         if (newName) delete [] newName;
+         return key->GetNbytes();
+      }
+   }
    if (opt.Contains("overwrite")) {
       //One must use GetKey. FindObject would return the lowest cycle of the key!
       //key = (TKey*)gDirectory->GetListOfKeys()->FindObject(oname);
@@ -2082,7 +2550,7 @@ void TDirectoryFile::WriteKeys()
       f->MakeFree(fSeekKeys, fSeekKeys + fNbytesKeys -1);
    }
 //*-* Write new keys record
-   TIter next(fKeys);
+   TIter next(GetListOfKeys());
    TKey *key;
    Int_t nkeys  = fKeys->GetSize();
    Int_t nbytes = sizeof nkeys;          //*-* Compute size of all keys
@@ -126,8 +126,11 @@ The structure of a directory is shown in TDirectoryFile::TDirectoryFile
 #include "TObjString.h"
 #include "TStopwatch.h"
 #include "compiledata.h"
+#include <algorithm>
 #include <cmath>
+#include <map>
 #include <set>
+#include <vector>
 #include "TSchemaRule.h"
 #include "TSchemaRuleSet.h"
 #include "TThreadSlots.h"
@@ -164,6 +167,165 @@ AddPseudoGlobals() {
 }
 } gAddPseudoGlobals;
 }
+
+namespace ROOT {
+namespace Internal {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Index of the free segments of a file (TFile::fFree).
+///
+/// The segments stay in the list of the file, ordered by position, which is
+/// written to the file. They are also indexed by their first byte, to find
+/// the neighbours of a segment being released, and by size, to find the
+/// smallest gap in which a record fits. The last segment, from the end of
+/// the file, is not in the size index: it is used only when no gap is large
+/// enough. All the operations are logarithmic in the number of segments,
+/// while TFree::AddFree and TFree::GetBestFree scan the list.
+
+class TFreeIndex {
+public:
+   typedef std::pair<Long64_t, Long64_t> SizeKey_t; ///< Size and first byte of a gap
+
+   TList                          *fList;       ///< List of free segments of the file
+   std::map<Long64_t, TObjLink *>  fByFirst;    ///< Link in fList of each segment, by first byte
+   std::set<SizeKey_t>             fBySize;     ///< The gaps (all segments but the last) by size
+
+   TFreeIndex(TList *lfree);
+
+   Bool_t IsValid(TList *lfree) const;
+   TFree *AddFree(Long64_t first, Long64_t last);
+   TFree *GetBestFree(Long64_t nbytes, Long64_t before);
+   void   UseFree(TFree *segment, Long64_t nbytes);
+
+   static Long64_t Size(const TFree *segment) { return segment->GetLast() - segment->GetFirst() + 1; }
+   static TFree   *Segment(TObjLink *lnk) { return (TFree *)lnk->GetObject(); }
+
+   void Insert(TObjLink *lnk)
+   {
+      TFree *segment = Segment(lnk);
+      fByFirst[segment->GetFirst()] = lnk;
+      if (lnk->Next()) fBySize.insert(SizeKey_t(Size(segment), segment->GetFirst()));
+   }
+   void Erase(TObjLink *lnk)
+   {
+      TFree *segment = Segment(lnk);
+      fByFirst.erase(segment->GetFirst());
+      fBySize.erase(SizeKey_t(Size(segment), segment->GetFirst()));
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// Index the segments of the list lfree.
+
+TFreeIndex::TFreeIndex(TList *lfree) : fList(lfree)
+{
+   for (TObjLink *lnk = lfree->FirstLink(); lnk; lnk = lnk->Next())
+      Insert(lnk);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Check that the index still describes lfree after a change of the list
+/// without the index (through TFile::GetListOfFree): same number of segments
+/// and same first and last segments. Only the segments of lfree are read, the
+/// links of the index may be gone. TFile calls TFile::DeleteFreeIndex itself
+/// whenever it changes or replaces fFree.
+
+Bool_t TFreeIndex::IsValid(TList *lfree) const
+{
+   if (lfree != fList || lfree->GetSize() != (Int_t)fByFirst.size()) return kFALSE;
+   if (fByFirst.empty()) return kTRUE;
+   return Segment(lfree->FirstLink())->GetFirst() == fByFirst.begin()->first &&
+          Segment(lfree->LastLink())->GetFirst() == fByFirst.rbegin()->first;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add the segment [first,last] to the free segments, merging it with the
+/// segments just before and just after it, like TFree::AddFree.
+/// Return the resulting segment.
+
+TFree *TFreeIndex::AddFree(Long64_t first, Long64_t last)
+{
+   std::map<Long64_t, TObjLink *>::iterator inext = fByFirst.upper_bound(first);
+   TObjLink *next = (inext != fByFirst.end()) ? inext->second : 0;
+   TObjLink *prev = 0;
+   if (inext != fByFirst.begin()) {
+      std::map<Long64_t, TObjLink *>::iterator iprev = inext;
+      prev = (--iprev)->second;
+   }
+
+   if (prev && Segment(prev)->GetLast() == first-1) {
+      TFree *segment = Segment(prev);
+      Erase(prev);
+      segment->SetLast(last);
+      if (next && Segment(next)->GetFirst() <= last+1) {
+         segment->SetLast(Segment(next)->GetLast());
+         Erase(next);
+         delete fList->Remove(next);
+      }
+      Insert(prev);
+      return segment;
+   }
+   if (!next) return 0;
+   if (Segment(next)->GetFirst() == last+1) {
+      TFree *segment = Segment(next);
+      Erase(next);
+      segment->SetFirst(first);
+      Insert(next);
+      return segment;
+   }
+   TFree *newfree = new TFree();
+   newfree->SetFirst(first);
+   newfree->SetLast(last);
+   fList->AddBefore(next, newfree);
+   Insert(next->Prev());
+   return newfree;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the smallest gap of exactly nbytes or of at least nbytes+4 (room
+/// for the header of the remaining gap) or, if there is none, the last
+/// segment, extended for a big file if needed like in TFree::GetBestFree.
+/// If before is not negative, only the gaps starting before this position
+/// are considered and 0 is returned if none of them is large enough.
+
+TFree *TFreeIndex::GetBestFree(Long64_t nbytes, Long64_t before)
+{
+   std::set<SizeKey_t>::const_iterator it = fBySize.lower_bound(SizeKey_t(nbytes, 0));
+   for (; it != fBySize.end() && it->first == nbytes; ++it) {
+      if (before < 0 || it->second < before) return Segment(fByFirst[it->second]);
+   }
+   for (it = fBySize.lower_bound(SizeKey_t(nbytes+4, 0)); it != fBySize.end(); ++it) {
+      if (before < 0 || it->second < before) return Segment(fByFirst[it->second]);
+   }
+   if (before >= 0) return 0;
+
+   TObjLink *lnk = fList->LastLink();
+   if (!lnk) return 0;
+   TFree *last = Segment(lnk);
+   if (Size(last) != nbytes && Size(last) < nbytes+4)
+      last->SetLast(last->GetLast() + 1000000000);
+   return last;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove the first nbytes from segment, which is deleted if it becomes empty.
+
+void TFreeIndex::UseFree(TFree *segment, Long64_t nbytes)
+{
+   std::map<Long64_t, TObjLink *>::iterator it = fByFirst.find(segment->GetFirst());
+   if (it == fByFirst.end()) return;
+   TObjLink *lnk = it->second;
+   Erase(lnk);
+   if (Size(segment) == nbytes) {
+      delete fList->Remove(lnk);
+      return;
+   }
+   segment->SetFirst(segment->GetFirst() + nbytes);
+   Insert(lnk);
+}
+
+} // namespace Internal
+} // namespace ROOT
 ////////////////////////////////////////////////////////////////////////////////
 /// File default Constructor.
 
@@ -171,6 +333,7 @@ TFile::TFile() : TDirectoryFile(), fInfoCache(0)
 {
    fD               = -1;
    fFree            = 0;
+   fFreeIndex       = 0;
    fWritten         = 0;
    fSumBuffer       = 0;
    fSum2Buffer      = 0;
@@ -193,6 +356,7 @@ TFile::TFile() : TDirectoryFile(), fInfoCache(0)
    fInitDone        = kFALSE;
    fMustFlush       = kTRUE;
    fIsPcmFile       = kFALSE;
+   fChangeTracking  = kFALSE;
    fAsyncHandle     = 0;
    fAsyncOpenStatus = kAOSNotAsync;
    SetBit(kBinaryFile, kTRUE);
@@ -350,6 +514,7 @@ TFile::TFile(const char *fname1, Option_t *option, const char *ftitle, Int_t com
    // Init initialization control flag
    fInitDone   = kFALSE;
    fMustFlush  = kTRUE;
+   fChangeTracking = kFALSE;
 
    // We are opening synchronously
    fAsyncHandle = 0;
@@ -359,6 +524,7 @@ TFile::TFile(const char *fname1, Option_t *option, const char *ftitle, Int_t com
 
    fD            = -1;
    fFree         = 0;
+   fFreeIndex    = 0;
    fVersion      = gROOT->GetVersionInt();  //ROOT version in integer format
    fUnits        = 4;
    fOption       = option;
@@ -547,6 +713,7 @@ TFile::~TFile()
    SafeDelete(fCacheReadMap);
    SafeDelete(fCacheWrite);
    SafeDelete(fProcessIDs);
+   DeleteFreeIndex();
    SafeDelete(fFree);
    SafeDelete(fArchive);
    SafeDelete(fInfoCache);
@@ -627,6 +794,7 @@ void TFile::Init(Bool_t create)
 
    if (create) {
       //*-*---------------NEW file
+      DeleteFreeIndex();
       fFree        = new TList;
       fEND         = fBEGIN;    //Pointer to end of file
       new TFree(fFree, fBEGIN, Long64_t(kStartBigFile));  //Create new free list
@@ -702,6 +870,7 @@ void TFile::Init(Bool_t create)
       fSeekDir = fBEGIN;
       //*-*-------------Read Free segments structure if file is writable
       if (fWritable) {
+         DeleteFreeIndex();
          fFree = new TList;
          if (fSeekFree > fBEGIN) {
             ReadFree();
@@ -860,15 +1029,10 @@ void TFile::Init(Bool_t create)
       }
    }
 
-   // Count number of TProcessIDs in this file
-   {
-      TIter next(fKeys);
-      TKey *key;
-      while ((key = (TKey*)next())) {
-         if (!strcmp(key->GetClassName(),"TProcessID")) fNProcessIDs++;
-      }
-      fProcessIDs = new TObjArray(fNProcessIDs+1);
-   }
+   // Count number of TProcessIDs in this file (the keys may not be created
+   // yet with lazy key loading)
+   fNProcessIDs = GetNkeysOfClass("TProcessID");
+   fProcessIDs = new TObjArray(fNProcessIDs+1);
    return;
 
 zombie:
@@ -954,6 +1118,7 @@ void TFile::Close(Option_t *option)
    fClassIndex = 0;
 
    // Delete free segments from free list (but don't delete list header)
+   DeleteFreeIndex();
    if (fFree) {
       fFree->Delete();
    }
@@ -988,6 +1153,81 @@ void TFile::Close(Option_t *option)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Append to keys the keys of dir and of its subdirectories.
+
+static void CollectKeys(TDirectory *dir, std::vector<TKey*> &keys)
+{
+   TIter next(dir->GetListOfKeys());
+   TKey *key;
+   while ((key = (TKey*)next())) {
+      if (strstr(key->GetClassName(), "TDirectory")) {
+         TDirectory *subdir = dir->GetDirectory(key->GetName());
+         if (subdir) CollectKeys(subdir, keys);
+      } else {
+         keys.push_back(key);
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Move the records of a file opened in UPDATE mode into the gaps left by
+/// the deleted or overwritten objects.
+///
+/// Starting from the end of the file, the record of each key of the file
+/// and of its subdirectories, and the StreamerInfo record, is moved into
+/// the smallest gap located before it in which it fits (see TKey::Relocate).
+/// The records are copied as they are on the file: the objects are neither
+/// read nor streamed again. The lists of keys of the modified directories
+/// and the list of free segments are then written again, as well as the
+/// header of the file.
+///
+/// The space released at the end of the file is given back: GetEND()
+/// moves down and the next records are written from there. The size of
+/// the file on disk is not reduced, this is left to the caller (e.g. by
+/// copying the first GetEND() bytes after closing the file).
+///
+/// The records which are not in a list of keys are not moved, e.g. the
+/// baskets of the TTrees (their location is in the TTree) and the headers
+/// of the subdirectories.
+///
+/// Returns the number of bytes by which the end of the file moved down,
+/// or -1 if the file is not writable.
+
+Long64_t TFile::Compact()
+{
+   if (!IsWritable()) {
+      Error("Compact", "file %s is not writable", GetName());
+      return -1;
+   }
+   Long64_t end = fEND;
+
+   std::vector<TKey*> keys;
+   CollectKeys(this, keys);
+   TKey *info = fSeekInfo ? new TKey(fSeekInfo, fNbytesInfo, this) : 0;
+   if (info) keys.push_back(info);
+
+   std::sort(keys.begin(), keys.end(),
+             [](const TKey *a, const TKey *b) { return a->GetSeekKey() > b->GetSeekKey(); });
+   Int_t nmoved = 0;
+   for (std::vector<TKey*>::iterator it = keys.begin(); it != keys.end(); ++it) {
+      if ((*it)->Relocate()) nmoved++;
+   }
+   if (info) {
+      fSeekInfo = info->GetSeekKey();
+      delete info;
+   }
+
+   if (nmoved) {
+      Save();
+      WriteFree();
+      WriteHeader();
+   }
+   if (gDebug) Info("Compact", "%d records moved, end of file from %lld to %lld", nmoved, end, fEND);
+
+   return end - fEND;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Creates key for object and converts data to buffer.
 
@@ -1383,12 +1623,14 @@ Bool_t TFile::IsOpen() const
 /// of consecutive free segments on the file. At the same time, the first
 /// 4 bytes of the freed record on the file are overwritten by GAPSIZE
 /// where GAPSIZE = -(Number of bytes occupied by the record).
+/// The segment is merged with its neighbours using the index of the free
+/// segments (see TFile::GetBestFree).
 
 void TFile::MakeFree(Long64_t first, Long64_t last)
 {
-   TFree *f1      = (TFree*)fFree->First();
-   if (!f1) return;
-   TFree *newfree = f1->AddFree(fFree,first,last);
+   ROOT::Internal::TFreeIndex *index = GetFreeIndex();
+   if (!index) return;
+   TFree *newfree = index->AddFree(first,last);
    if(!newfree) return;
    Long64_t nfirst = newfree->GetFirst();
    Long64_t nlast  = newfree->GetLast();
@@ -1411,6 +1653,64 @@ void TFile::MakeFree(Long64_t first, Long64_t last)
    delete [] psave;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return the index of the free segments, created from fFree when needed.
+///
+/// The index is created again if fFree was changed without it (e.g. by
+/// TFree::AddFree on the list returned by GetListOfFree). The functions of
+/// TFile changing or replacing fFree call DeleteFreeIndex.
+
+ROOT::Internal::TFreeIndex *TFile::GetFreeIndex()
+{
+   if (fFreeIndex && !fFreeIndex->IsValid(fFree)) DeleteFreeIndex();
+   if (!fFreeIndex && fFree && fFree->First())
+      fFreeIndex = new ROOT::Internal::TFreeIndex(fFree);
+   return fFreeIndex;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Delete the index of the free segments, fFree is not changed.
+
+void TFile::DeleteFreeIndex()
+{
+   delete fFreeIndex;
+   fFreeIndex = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the free segment in which a record of nbytes is written.
+///
+/// This is the smallest gap of exactly nbytes, or of at least nbytes+4 so
+/// that the remaining gap can be marked on the file, or the last segment
+/// (at the end of the file) if no gap is large enough. Choosing the best
+/// fitting gap instead of the first one (TFree::GetBestFree) keeps the large
+/// gaps for the large records and reduces the fragmentation of files updated
+/// many times. The free segments are indexed by size, the search does not
+/// depend on the number of gaps.
+///
+/// If before is not negative, only the gaps starting before this position
+/// are considered and 0 is returned if none is large enough (see
+/// TKey::Relocate).
+///
+/// The segment must then be used with UseFree.
+
+TFree *TFile::GetBestFree(Int_t nbytes, Long64_t before)
+{
+   ROOT::Internal::TFreeIndex *index = GetFreeIndex();
+   if (!index) return 0;
+   return index->GetBestFree(nbytes, before);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Remove nbytes at the beginning of segment (returned by GetBestFree), in
+/// which a record is written. The segment is deleted when it is filled.
+
+void TFile::UseFree(TFree *segment, Int_t nbytes)
+{
+   ROOT::Internal::TFreeIndex *index = GetFreeIndex();
+   if (index) index->UseFree(segment, nbytes);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// List the contents of a file sequentially.
 /// For each logical record found, it prints:
@@ -1749,6 +2049,8 @@ Int_t TFile::ReadBufferViaCache(char *buf, Int_t len)
 
 void TFile::ReadFree()
 {
+   DeleteFreeIndex();
+
    // Avoid problem with file corruption.
    if (fNbytesFree < 0 || fNbytesFree > fEND) {
       fNbytesFree = 0;
@@ -1872,6 +2174,7 @@ Int_t TFile::Recover()
 
    fEND = Long64_t(size);
 
+   DeleteFreeIndex();
    if (fWritable && !fFree) fFree  = new TList;
 
    TKey *key;
@@ -1945,6 +2248,7 @@ Int_t TFile::Recover()
    if (fWritable) {
       Long64_t max_file_size = Long64_t(kStartBigFile);
       if (max_file_size < fEND) max_file_size = fEND+1000000000;
+      DeleteFreeIndex();
       TFree *last = (TFree*)fFree->Last();
       if (last) {
          last->AddFree(fFree,fEND,max_file_size);
@@ -2001,6 +2305,7 @@ Int_t TFile::ReOpen(Option_t *mode)
          FlushWriteCache();
 
          // delete free segments from free list
+         DeleteFreeIndex();
          if (fFree) {
             fFree->Delete();
             SafeDelete(fFree);
@@ -2047,6 +2352,7 @@ Int_t TFile::ReOpen(Option_t *mode)
       }
       SetWritable(kTRUE);
 
+      DeleteFreeIndex();
       fFree = new TList;
       if (fSeekFree > fBEGIN)
          ReadFree();
@@ -2202,6 +2508,32 @@ void TFile::SetCacheWrite(TFileCacheWrite *cache)
    fCacheWrite = cache;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Enable or disable the tracking of the changes of the objects written to
+/// this file.
+///
+/// This is meant for the files (typically TMemFile) in which the same set
+/// of objects, e.g. the histograms of an online monitoring, is written again
+/// and again with TObject::kOverwrite or TObject::kWriteDelete.
+/// When the tracking is enabled, the keys remember a checksum of the object
+/// buffer. When an object is written again under the same name with one of
+/// these options, it is only streamed (not compressed) and compared to its
+/// previous key: if it did not change since the last write, nothing is
+/// written and TObject::Write returns the number of bytes of the previous
+/// key (0 still means that the object could not be written). A changed
+/// object replaces its previous key as before: with TObject::kOverwrite the
+/// space of the previous key is released first, so that the new key can be
+/// written in place.
+///
+/// The objects which were not written with the tracking enabled (e.g. the
+/// ones already in a file opened in UPDATE mode) are always written again the
+/// first time.
+
+void TFile::SetChangeTracking(Bool_t on)
+{
+   fChangeTracking = on;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Return the size in bytes of the file header.
 
@@ -123,6 +123,10 @@ void TFree::FillBuffer(char *&buffer)
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Return the best free segment where to store nbytes.
+///
+/// This is the first segment, in the order of the list, of exactly nbytes
+/// or of more than nbytes+3. The files use TFile::GetBestFree instead, which
+/// returns the smallest such gap from an index of their free segments.
 
 TFree *TFree::GetBestFree(TList *lfree, Int_t nbytes)
 {
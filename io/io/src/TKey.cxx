@@ -84,6 +84,16 @@ TString &gTDirectoryString() {
 }
 std::atomic<UInt_t> keyAbsNumber{0};
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return a 64 bits checksum of the object buffer of a key: the CRC-32 of
+/// the bytes in the upper half and their (Murmur) hash in the lower half.
+
+static ULong64_t ObjectChecksum(const char *buffer, Int_t nbytes)
+{
+   ULong64_t crc = R__crc32(0, (const unsigned char *)buffer, nbytes);
+   return (crc << 32) | TString::Hash(buffer, nbytes);
+}
+
 ClassImp(TKey)
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -120,6 +130,7 @@ TKey::TKey(TDirectory* motherDir, const TKey &orig, UShort_t pidOffset) : TNamed
    fPidOffset  = orig.fPidOffset + pidOffset;
    fNbytes     = orig.fNbytes;
    fObjlen     = orig.fObjlen;
+   fChecksum   = orig.fChecksum;
    fClassName  = orig.fClassName;
    fName       = orig.fName;
    fTitle      = orig.fTitle;
@@ -251,6 +262,8 @@ TKey::TKey(const TObject *obj, const char *name, Int_t bufsize, TDirectory* moth
    ((TObject*)obj)->Streamer(*fBufferRef);    //write object
    lbuf       = fBufferRef->Length();
    fObjlen    = lbuf - fKeylen;
+   if (GetFile() && GetFile()->IsChangeTracking())
+      fChecksum = ObjectChecksum(fBufferRef->Buffer() + fKeylen, fObjlen);
 
    Int_t cxlevel = GetFile() ? GetFile()->GetCompressionLevel() : 0;
    Int_t cxAlgorithm = GetFile() ? GetFile()->GetCompressionAlgorithm() : 0;
@@ -402,6 +415,7 @@ void TKey::Build(TDirectory* motherDir, const char* classname, Long64_t filepos)
    fSeekPdir   = 0;
    fSeekKey    = 0;
    fLeft       = 0;
+   fChecksum   = 0;
 
    fClassName = classname;
    //the following test required for forward and backward compatibility
@@ -467,11 +481,9 @@ void TKey::Create(Int_t nbytes, TFile* externFile)
    }
 
    Int_t nsize      = nbytes + fKeylen;
-   TList *lfree     = f->GetListOfFree();
-   TFree *f1        = (TFree*)lfree->First();
 //*-*-------------------find free segment
 //*-*                    =================
-   TFree *bestfree  = f1->GetBestFree(lfree,nsize);
+   TFree *bestfree  = f->GetBestFree(nsize);
    if (bestfree == 0) {
       Error("Create","Cannot allocate %d bytes for ID = %s Title = %s",
             nsize,GetName(),GetTitle());
@@ -482,7 +494,6 @@ void TKey::Create(Int_t nbytes, TFile* externFile)
 //*-*----------------- Case Add at the end of the file
    if (fSeekKey >= f->GetEND()) {
       f->SetEND(fSeekKey+nsize);
-      bestfree->SetFirst(fSeekKey+nsize);
       fLeft   = -1;
       if (!fBuffer) fBuffer = new char[nsize];
    } else {
@@ -494,8 +505,6 @@ void TKey::Create(Int_t nbytes, TFile* externFile)
       if (!fBuffer) {
          fBuffer = new char[nsize];
       }
-      lfree->Remove(bestfree);
-      delete bestfree;
    }
 //*-*----------------- Case where new object is placed in a deleted gap larger than itself
    if (fLeft > 0) {    // found a bigger segment
@@ -505,8 +514,8 @@ void TKey::Create(Int_t nbytes, TFile* externFile)
       char *buffer  = fBuffer+nsize;
       Int_t nbytesleft = -fLeft;  // set header of remaining record
       tobuf(buffer, nbytesleft);
-      bestfree->SetFirst(fSeekKey+nsize);
    }
+   f->UseFree(bestfree, nsize);
 
    fSeekPdir = externFile ? externFile->GetSeekDir() : fMotherDir->GetSeekDir();
 }
@@ -666,6 +675,83 @@ Bool_t TKey::IsFolder() const
    return ret;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Move the record of this key into the best fitting gap of its file
+/// located before it (see TFile::GetBestFree). Used by TFile::Compact.
+///
+/// The record is copied as it is on the file, the object is neither read
+/// nor streamed: only the location of the key in the record header is
+/// changed. The space used before is released and the mother directory is
+/// flagged as modified, so that its list of keys is written again.
+/// Returns kTRUE if the record has been moved.
+
+Bool_t TKey::Relocate()
+{
+   TFile *f = GetFile();
+   if (!f || !f->IsWritable() || fSeekKey <= 0 || fNbytes <= 0) return kFALSE;
+
+   TFree *bestfree = f->GetBestFree(fNbytes, fSeekKey);
+   if (!bestfree) return kFALSE;
+   Long64_t seekkey = bestfree->GetFirst();
+   Int_t left = Int_t(bestfree->GetLast() - seekkey - fNbytes + 1);
+
+   Int_t nsize = fNbytes;
+   char *record = new char[nsize + sizeof(Int_t)];
+   f->Seek(fSeekKey);
+   if (f->ReadBuffer(record, nsize)) {
+      delete [] record;
+      return kFALSE;
+   }
+   // fSeekKey follows fNbytes, fVersion, fObjlen, fDatime, fKeylen and fCycle
+   char *buffer = record + sizeof(Int_t);
+   Version_t version;
+   frombuf(buffer, &version);
+   buffer = record + 2*sizeof(Int_t) + sizeof(UInt_t) + 3*sizeof(Short_t);
+   if (version > 1000) tobuf(buffer, seekkey);
+   else                tobuf(buffer, (Int_t)seekkey);
+   if (left > 0) {
+      buffer = record + nsize;
+      Int_t nbytesleft = -left;  // set header of remaining record
+      tobuf(buffer, nbytesleft);
+      nsize += sizeof(Int_t);
+   }
+   f->Seek(seekkey);
+   Bool_t failed = f->WriteBuffer(record, nsize);
+   delete [] record;
+   if (failed) return kFALSE;
+
+   f->UseFree(bestfree, fNbytes);
+   f->MakeFree(fSeekKey, fSeekKey + fNbytes - 1);
+   fSeekKey = seekkey;
+   if (fMotherDir) fMotherDir->SetModified();
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return kTRUE if obj would be written with exactly the same bytes as the
+/// object written with this key.
+///
+/// obj is streamed (but not compressed) and its checksum is compared to the
+/// one of this key. This is only possible if the key was written to a file
+/// with change tracking enabled (see TFile::SetChangeTracking), otherwise
+/// kFALSE is returned.
+
+Bool_t TKey::IsUnchanged(const TObject *obj) const
+{
+   if (!obj || !fChecksum) return kFALSE;
+
+   // Stream the object at the same offset as in the key buffer, the
+   // references to the classes and objects are relative to the buffer start.
+   TBufferFile buffer(TBuffer::kWrite, fKeylen + fObjlen + 64);
+   buffer.SetParent(GetFile());
+   buffer.SetBufferOffset(fKeylen);
+   buffer.MapObject(obj);
+   ((TObject*)obj)->Streamer(buffer);
+   Int_t objlen = buffer.Length() - fKeylen;
+   if (objlen != fObjlen) return kFALSE;
+   return ObjectChecksum(buffer.Buffer() + fKeylen, objlen) == fChecksum;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Set the "KEEP" status.
 ///
@@ -977,6 +1063,47 @@ CLEAR:
    return tobj;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Create the object of this key and stream it from buffer.
+///
+/// buffer holds the key header followed by the uncompressed object
+/// (fKeylen+fObjlen bytes), as prepared for example by
+/// TDirectoryFile::ReadObjects; it is adopted by this function.
+/// Contrary to ReadObj, the object is not added to the directory and the
+/// current style is not applied to it, so that objects of different keys
+/// can be streamed concurrently. The class must derive from TObject.
+
+TObject *TKey::ReadObjFromBuffer(char *buffer)
+{
+   TClass *cl = TClass::GetClass(fClassName.Data());
+   if (!cl || !cl->IsTObject() || GetFile()==0) {
+      Error("ReadObjFromBuffer", "Cannot read object of class %s", fClassName.Data());
+      delete [] buffer;
+      return 0;
+   }
+
+   TBufferFile bufferRef(TBuffer::kRead, fObjlen+fKeylen, buffer, kTRUE);
+   bufferRef.SetParent(GetFile());
+   bufferRef.SetPidOffset(fPidOffset);
+
+   // get version of key
+   bufferRef.SetBufferOffset(sizeof(fNbytes));
+   Version_t kvers = bufferRef.ReadVersion();
+
+   bufferRef.SetBufferOffset(fKeylen);
+   char *pobj = (char*)cl->New();
+   if (!pobj) {
+      Error("ReadObjFromBuffer", "Cannot create new object of class %s", fClassName.Data());
+      return 0;
+   }
+   TObject *tobj = (TObject*)(pobj+cl->GetBaseClassOffset(TObject::Class()));
+   if (kvers > 1)
+      bufferRef.MapObject(pobj,cl);  //register obj in map to handle self reference
+   tobj->Streamer(bufferRef);
+
+   return tobj;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// To read an object (non deriving from TObject) from the file.
 ///
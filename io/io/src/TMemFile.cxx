@@ -299,6 +299,7 @@ void TMemFile::ResetAfterMerge(TFileMergeInfo *info)
    fMustFlush = kTRUE;
    fInitDone = kFALSE;
 
+   DeleteFreeIndex();
    if (fFree) {
       fFree->Delete();
       delete fFree;
@@ -321,6 +322,7 @@ void TMemFile::ResetAfterMerge(TFileMergeInfo *info)
    fCacheRead    = 0;
    fCacheWrite   = 0;
    fReadCalls    = 0;
+   DeleteFreeIndex();
    if (fFree) {
       fFree->Delete();
       delete fFree;
@@ -2544,10 +2544,10 @@ void TStreamerInfo::Clear(Option_t *option)
       ResetIsCompiled();
       ResetBit(kBuildOldUsed);
 
-      if (fReadObjectWise) fReadObjectWise->fActions.clear();
+      if (fReadObjectWise) fReadObjectWise->ClearActions();
       if (fReadMemberWise) fReadMemberWise->fActions.clear();
       if (fReadMemberWiseVecPtr) fReadMemberWiseVecPtr->fActions.clear();
-      if (fWriteObjectWise) fWriteObjectWise->fActions.clear();
+      if (fWriteObjectWise) fWriteObjectWise->ClearActions();
       if (fWriteMemberWise) fWriteMemberWise->fActions.clear();
       if (fWriteMemberWiseVecPtr) fWriteMemberWiseVecPtr->fActions.clear();
    }
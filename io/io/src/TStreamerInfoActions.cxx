@@ -23,6 +23,10 @@
 #include "TClassEdit.h"
 #include "TVirtualCollectionIterators.h"
 #include "TProcessID.h"
+#include "TEnv.h"
+
+#include <map>
+#include <string>
 
 static const Int_t kRegrouped = TStreamerInfo::kOffsetL;
 
@@ -2282,10 +2286,10 @@ void TStreamerInfo::Compile()
    Int_t ndata = fElements->GetEntries();
 
 
-   if (fReadObjectWise) fReadObjectWise->fActions.clear();
+   if (fReadObjectWise) fReadObjectWise->ClearActions();
    else fReadObjectWise = new TStreamerInfoActions::TActionSequence(this,ndata);
 
-   if (fWriteObjectWise) fWriteObjectWise->fActions.clear();
+   if (fWriteObjectWise) fWriteObjectWise->ClearActions();
    else fWriteObjectWise = new TStreamerInfoActions::TActionSequence(this,ndata);
 
    if (fReadMemberWise) fReadMemberWise->fActions.clear();
@@ -3182,6 +3186,190 @@ void TStreamerInfoActions::TActionSequence::AddToOffset(Int_t delta)
       if (!iter->fConfiguration->fInfo->GetElements()->At(iter->fConfiguration->fElemId)->TestBit(TStreamerElement::kCache))
          iter->fConfiguration->AddToOffset(delta);
    }
+   // The offsets are hard coded in the generated function.
+   fCompiled = 0;
+   fNCalls = 0;
+}
+
+Int_t TStreamerInfoActions::TActionSequence::fgCodeGenerationThreshold = -1;
+
+void TStreamerInfoActions::TActionSequence::SetCodeGenerationThreshold(Int_t ncalls)
+{
+   // Set the number of times an object-wise sequence is applied by TBufferFile
+   // before Cling is asked to generate a specialized function for it.
+   // 0 (the default) disables the code generation. The initial value is taken
+   // from the rc variable Root.StreamerInfo.CodeGeneration.
+
+   fgCodeGenerationThreshold = ncalls < 0 ? 0 : ncalls;
+}
+
+Int_t TStreamerInfoActions::TActionSequence::GetCodeGenerationThreshold()
+{
+   // Return the number of applications of a sequence before code is generated for it.
+
+   if (fgCodeGenerationThreshold < 0) {
+      Int_t ncalls = gEnv ? gEnv->GetValue("Root.StreamerInfo.CodeGeneration", 0) : 0;
+      fgCodeGenerationThreshold = ncalls < 0 ? 0 : ncalls;
+   }
+   return fgCodeGenerationThreshold;
+}
+
+TStreamerInfoActions::TActionSequence::TCompiledSequence_t TStreamerInfoActions::TActionSequence::CountAndCompile() const
+{
+   // Count one more application of the sequence and, once the threshold is
+   // reached, generate the specialized function. The count is never
+   // incremented once the generation has been attempted (fNCalls < 0), so
+   // that a late thread cannot restart the counting.
+
+   Int_t threshold = GetCodeGenerationThreshold();
+   if (threshold == 0) return 0;
+   Int_t ncalls = fNCalls.load();
+   do {
+      if (ncalls < 0) return fCompiled.load();
+   } while (!fNCalls.compare_exchange_weak(ncalls, ncalls + 1));
+   if (ncalls + 1 < threshold) return 0;
+   Compile();
+   return fCompiled.load();
+}
+
+namespace {
+   struct TBasicAction {
+      TStreamerInfoAction_t fRead;
+      TStreamerInfoAction_t fWrite;
+      const char           *fTypeName;
+      Int_t                 fSize;     // size in the buffer
+   };
+
+   // Actions for which the code generation emits the conversion in place.
+   // Long_t and ULong_t are left to their action: their size in the buffer
+   // depends on the platform that wrote it.
+   const TBasicAction gBasicActions[] = {
+      { ReadBasicType<Bool_t>,    WriteBasicType<Bool_t>,    "Bool_t",    1 },
+      { ReadBasicType<Char_t>,    WriteBasicType<Char_t>,    "Char_t",    1 },
+      { ReadBasicType<UChar_t>,   WriteBasicType<UChar_t>,   "UChar_t",   1 },
+      { ReadBasicType<Short_t>,   WriteBasicType<Short_t>,   "Short_t",   2 },
+      { ReadBasicType<UShort_t>,  WriteBasicType<UShort_t>,  "UShort_t",  2 },
+      { ReadBasicType<Int_t>,     WriteBasicType<Int_t>,     "Int_t",     4 },
+      { ReadBasicType<UInt_t>,    WriteBasicType<UInt_t>,    "UInt_t",    4 },
+      { ReadBasicType<Float_t>,   WriteBasicType<Float_t>,   "Float_t",   4 },
+      { ReadBasicType<Long64_t>,  WriteBasicType<Long64_t>,  "Long64_t",  8 },
+      { ReadBasicType<ULong64_t>, WriteBasicType<ULong64_t>, "ULong64_t", 8 },
+      { ReadBasicType<Double_t>,  WriteBasicType<Double_t>,  "Double_t",  8 }
+   };
+
+   // Return the description of the basic type read (isRead) or written by the
+   // action, or 0 if the action has to be called as is.
+   const TBasicAction *FindBasicAction(const TConfiguredAction &action, Bool_t &isRead)
+   {
+      for (UInt_t i = 0; i < sizeof(gBasicActions)/sizeof(gBasicActions[0]); ++i) {
+         if (action.fAction == gBasicActions[i].fRead) {
+            isRead = kTRUE;
+            return &gBasicActions[i];
+         }
+         if (action.fAction == gBasicActions[i].fWrite) {
+            isRead = kFALSE;
+            return &gBasicActions[i];
+         }
+      }
+      return 0;
+   }
+
+   // Close a run of consecutive basic type actions: the buffer is expanded
+   // once for the whole run and the position updated at its end.
+   void FlushRun(std::string &code, std::string &run, Bool_t isRead, Int_t size)
+   {
+      if (run.empty()) return;
+      if (!isRead) {
+         code += TString::Format("   if (b.Length() + %d > b.BufferSize()) b.AutoExpand(b.Length() + %d);\n", size, size).Data();
+      }
+      code += "   c = b.Buffer() + b.Length();\n";
+      code += run;
+      code += "   b.SetBufferOffset(c - b.Buffer());\n";
+      run.clear();
+   }
+}
+
+Bool_t TStreamerInfoActions::TActionSequence::Compile() const
+{
+   // Ask Cling for a function equivalent to applying this (object-wise)
+   // sequence with a TBufferFile. Consecutive members of basic type are read
+   // or written in straight-line code at their fixed offsets, with the byte
+   // swaps inlined; all the other members are streamed by calling back their
+   // action. The functions are cached by their code, so that the sequences of
+   // the same class version share the same function. Returns false, and the
+   // sequence keeps being interpreted, if no function could be generated.
+
+   R__LOCKGUARD(gInterpreterMutex);
+
+   // The threads reaching the threshold together wait here, the first one
+   // generates the function and the others find it.
+   if (fNCalls.load() < 0) return fCompiled.load() != 0;
+   fNCalls = -1;
+   fCompiled = 0;
+   if (!gInterpreter || fActions.empty()) return kFALSE;
+
+   std::string code, run;
+   Bool_t runIsRead = kTRUE;
+   Int_t runSize = 0;
+   Int_t nbasic = 0;
+   for (UInt_t i = 0; i < fActions.size(); ++i) {
+      Bool_t isRead = kTRUE;
+      const TBasicAction *basic = FindBasicAction(fActions[i], isRead);
+      if (basic && (run.empty() || isRead == runIsRead)) {
+         runIsRead = isRead;
+      } else {
+         FlushRun(code, run, runIsRead, runSize);
+         runSize = 0;
+         runIsRead = isRead;
+      }
+      if (basic) {
+         Int_t offset = fActions[i].fConfiguration->fOffset;
+         if (isRead) {
+            run += TString::Format("   frombuf(c, (%s*)(o + %d));\n", basic->fTypeName, offset).Data();
+         } else {
+            run += TString::Format("   tobuf(c, *(%s*)(o + %d));\n", basic->fTypeName, offset).Data();
+         }
+         runSize += basic->fSize;
+         ++nbasic;
+      } else {
+         code += TString::Format("   s.fActions[%u](b, addr);\n", i).Data();
+      }
+   }
+   FlushRun(code, run, runIsRead, runSize);
+
+   // Nothing to gain if every member is streamed by its action anyway.
+   if (nbasic == 0) return kFALSE;
+
+   static std::map<std::string, TCompiledSequence_t> gCompiledSequences;
+   std::map<std::string, TCompiledSequence_t>::const_iterator cached = gCompiledSequences.find(code);
+   if (cached != gCompiledSequences.end()) {
+      fCompiled = cached->second;
+      return cached->second != 0;
+   }
+
+   TString name = TString::Format("Sequence%lu", (ULong_t)gCompiledSequences.size());
+   TString source;
+   source += "#include \"TBuffer.h\"\n#include \"Bytes.h\"\n#include \"TStreamerInfoActions.h\"\n";
+   source += "namespace ROOT { namespace Internal { namespace StreamerInfoCodeGen {\n";
+   source += TString::Format("// %s version %d\n", fStreamerInfo->GetName(), fStreamerInfo->GetClassVersion());
+   source += TString::Format("Int_t %s(TBuffer &b, void *addr, const TStreamerInfoActions::TActionSequence &s)\n{\n", name.Data());
+   source += "   char *o = (char*)addr;\n   char *c = 0;\n   (void)o; (void)c; (void)s;\n";
+   source += code.c_str();
+   source += "   return 0;\n}\n}}}\n";
+
+   TCompiledSequence_t func = 0;
+   if (gInterpreter->Declare(source)) {
+      TInterpreter::EErrorCode error = TInterpreter::kNoError;
+      Long_t address = gInterpreter->Calc(TString::Format("(Long_t)&ROOT::Internal::StreamerInfoCodeGen::%s", name.Data()), &error);
+      if (error == TInterpreter::kNoError) func = (TCompiledSequence_t)address;
+   }
+   if (!func && gDebug > 0) {
+      ::Info("TActionSequence::Compile", "No code could be generated for %s version %d, its actions are used instead.",
+             fStreamerInfo->GetName(), fStreamerInfo->GetClassVersion());
+   }
+   gCompiledSequences[code] = func;
+   fCompiled = func;
+   return func != 0;
 }
 
 TStreamerInfoActions::TActionSequence *TStreamerInfoActions::TActionSequence::CreateCopy()
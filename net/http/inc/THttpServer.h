@@ -21,9 +21,15 @@
 #endif
 
 #include <mutex>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 class THttpEngine;
 class THttpTimer;
+class THttpSnapshot;
 class TRootSniffer;
 
 
@@ -50,9 +56,24 @@ protected:
    std::mutex   fMutex;       //! mutex to protect list with arguments
    TList        fCallArgs;    //! submitted arguments
 
+   Bool_t       fAsync;       //! serve root.json requests from snapshots in the engine threads
+   Long_t       fSnapshotPeriod; //! minimal time between two snapshots of an object (ms)
+   Long_t       fLongPollTimeout; //! maximal waiting time of a long-poll request (ms)
+   Int_t        fMaxLongPolls; //! maximal number of long-poll requests waiting at the same time
+   Int_t        fNumLongPolls; //! number of long-poll requests waiting
+   Bool_t       fTerminating; //! set when server is deleted, releases waiting long-poll requests
+   std::mutex   fSnapshotMutex; //! mutex to protect snapshots
+   std::condition_variable fSnapshotCond; //! notified when snapshots are updated
+   std::map<std::string, std::shared_ptr<THttpSnapshot> > fSnapshots; //! snapshots of requested objects
+   std::vector<std::shared_ptr<TObject> > fRetired; //! replaced snapshots, deleted in main thread
+
    // Here any request can be processed
    virtual void ProcessRequest(THttpCallArg *arg);
 
+   Bool_t ProcessFromSnapshot(THttpCallArg *arg);
+
+   void UpdateSnapshots();
+
    static Bool_t VerifyFilePath(const char *fname);
 
 public:
@@ -99,6 +120,10 @@ public:
 
    void SetTimer(Long_t milliSec = 100, Bool_t mode = kTRUE);
 
+   void SetAsync(Bool_t on = kTRUE, Long_t period = 500, Long_t longpoll = 30000, Int_t maxwaiting = 2);
+
+   Bool_t IsAsync() const { return fAsync; }
+
    /** Check if file is requested, thread safe */
    Bool_t  IsFileRequested(const char *uri, TString &res) const;
 
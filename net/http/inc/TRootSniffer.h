@@ -185,6 +185,8 @@ public:
 
    Bool_t HasRestriction(const char* item_name);
 
+   Bool_t HasRestrictions() const { return fRestrictions.GetLast() >= 0; }
+
    Int_t CheckRestriction(const char* item_name);
 
    void SetScanGlobalDir(Bool_t on = kTRUE)
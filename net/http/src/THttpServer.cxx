@@ -11,6 +11,10 @@
 #include "TClass.h"
 #include "TCanvas.h"
 #include "TFolder.h"
+#include "TFile.h"
+#include "TUrl.h"
+#include "TBufferFile.h"
+#include "TBufferJSON.h"
 #include "RVersion.h"
 #include "RConfigure.h"
 
@@ -23,6 +27,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <fstream>
+#include <chrono>
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -62,6 +67,38 @@ public:
 
 // =======================================================
 
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// THttpSnapshot                                                        //
+//                                                                      //
+// Copy of an object requested via root.json in async mode              //
+// Taken in the main thread, used in the engine threads to produce      //
+// the JSON without waiting for the main thread                         //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+class THttpSnapshot {
+public:
+   std::shared_ptr<TObject> fObject;    // last copy of the object, 0 until first snapshot
+   ULong_t                  fVersion;   // incremented each time the object content changes
+   Long64_t                 fTaken;     // time of the last snapshot (ms)
+   Long64_t                 fRequested; // time of the last request (ms)
+   Bool_t                   fFailed;    // object cannot be copied, always served by main thread
+   std::string              fBytes;     // streamed object of the last snapshot, used to detect changes
+
+   THttpSnapshot() : fObject(), fVersion(0), fTaken(0), fRequested(0), fFailed(kFALSE), fBytes() {}
+};
+
+namespace {
+   // monotonic time in ms
+   Long64_t NowMs()
+   {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+}
+
+// =======================================================
+
 //////////////////////////////////////////////////////////////////////////
 //                                                                      //
 // THttpServer                                                          //
@@ -99,6 +136,23 @@ public:
 // enable monitoring flag in the browser - than objects view            //
 // will be regularly updated.                                           //
 //                                                                      //
+// Asynchronous mode                                                    //
+//                                                                      //
+// By default all requests are processed in the main thread, when the   //
+// application calls gSystem->ProcessEvents(). With                     //
+//    serv->SetAsync();                                                 //
+// (or "http:8080;async") root.json requests for objects are answered   //
+// directly in the threads of the http engine, using copies of the      //
+// objects which are taken in the main thread at most every 500 ms      //
+// and only for objects requested recently. Long-poll requests are      //
+// supported: each such reply has a "SnapshotVersion" header and a      //
+// request with "?longpoll=N" only returns when the version of the      //
+// object is newer than N (or after 30 s). At most 2 long-poll          //
+// requests wait at the same time, the others are answered at once,     //
+// so that the engine threads (5 for civetweb) stay available for       //
+// other requests. When sniffer restrictions are configured, all        //
+// requests are processed in the main thread.                           //
+//                                                                      //
 // More information: http://root.cern.ch/drupal/content/users-guide     //
 //                                                                      //
 //////////////////////////////////////////////////////////////////////////
@@ -122,13 +176,21 @@ THttpServer::THttpServer(const char *engine) :
    fDefaultPageCont(),
    fDrawPage(),
    fDrawPageCont(),
-   fCallArgs()
+   fCallArgs(),
+   fAsync(kFALSE),
+   fSnapshotPeriod(500),
+   fLongPollTimeout(30000),
+   fMaxLongPolls(2),
+   fNumLongPolls(0),
+   fTerminating(kFALSE)
 {
    // As argument, one specifies engine kind which should be
    // created like "http:8080". One could specify several engines
    // at once, separating them with ; like "http:8080;fastcgi:9000"
    // One also can configure readonly flag for sniffer like
    // "http:8080;readonly" or "http:8080;readwrite"
+   // With "http:8080;async" object requests are served from snapshots,
+   // see SetAsync()
    //
    // Also searches for JavaScript ROOT sources, which are used in web clients
    // Typically JSROOT sources located in $ROOTSYS/etc/http directory,
@@ -195,6 +257,8 @@ THttpServer::THttpServer(const char *engine) :
             GetSniffer()->SetReadOnly(kTRUE);
          } else if ((strcmp(opt, "readwrite") == 0) || (strcmp(opt, "rw") == 0)) {
             GetSniffer()->SetReadOnly(kFALSE);
+         } else if (strcmp(opt, "async") == 0) {
+            SetAsync(kTRUE);
          } else
             CreateEngine(opt);
       }
@@ -209,8 +273,18 @@ THttpServer::THttpServer(const char *engine) :
 
 THttpServer::~THttpServer()
 {
+   // release long-poll requests, otherwise engines wait for them
+   {
+      std::lock_guard<std::mutex> lk(fSnapshotMutex);
+      fTerminating = kTRUE;
+   }
+   fSnapshotCond.notify_all();
+
    fEngines.Delete();
 
+   fSnapshots.clear();
+   fRetired.clear();
+
    SetSniffer(0);
 
    SetTimer(0);
@@ -378,6 +452,53 @@ void THttpServer::SetTimer(Long_t milliSec, Bool_t mode)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Enable or disable asynchronous processing of object requests
+///
+/// In async mode root.json requests are processed in the threads of the
+/// http engine, using copies (snapshots) of the objects instead of the
+/// objects themselves. Snapshots are taken in the main thread, from
+/// ProcessRequests(), for objects requested during the last
+/// max(10 s, 2*longpoll) ms, not more often than every period ms.
+/// Therefore the main thread only spends the time to stream the objects,
+/// the conversion to JSON is performed in parallel in the engine threads.
+/// A request with the option longpoll=N waits (at most longpoll ms) until
+/// the object is different from the version N. Version of the delivered
+/// object is returned in the "SnapshotVersion" header.
+/// Each waiting long-poll request blocks a thread of the http engine, at
+/// most maxwaiting requests wait at the same time and the others are
+/// answered at once with the current version. maxwaiting must be kept
+/// below the number of threads of the engine (5 by default for civetweb,
+/// see the thrds option), otherwise the waiting requests may block all
+/// the other ones.
+/// Other requests (h.json, images, commands, ...) and all requests when
+/// restrictions are configured in the sniffer are still processed in the
+/// main thread.
+
+void THttpServer::SetAsync(Bool_t on, Long_t period, Long_t longpoll, Int_t maxwaiting)
+{
+   if (on) ROOT::EnableThreadSafety();
+
+   std::lock_guard<std::mutex> lk(fSnapshotMutex);
+
+   fAsync = on;
+   if (period > 0) fSnapshotPeriod = period;
+   if (longpoll >= 0) fLongPollTimeout = longpoll;
+   if (maxwaiting >= 0) fMaxLongPolls = maxwaiting;
+
+   if (!on) {
+      // drop all snapshots, objects are deleted in the main thread
+      std::map<std::string, std::shared_ptr<THttpSnapshot> >::iterator iter;
+      for (iter = fSnapshots.begin(); iter != fSnapshots.end(); ++iter)
+         if (iter->second->fObject) {
+            fRetired.push_back(iter->second->fObject);
+            iter->second->fObject.reset();
+         }
+      fSnapshots.clear();
+      fSnapshotCond.notify_all();
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Checked that filename does not contains relative path below current directory
 /// Used to prevent access to files below current directory
@@ -465,6 +586,9 @@ Bool_t THttpServer::ExecuteHttp(THttpCallArg *arg)
       return kTRUE;
    }
 
+   // in async mode object may be delivered from its snapshot in this thread
+   if (fAsync && ProcessFromSnapshot(arg)) return kTRUE;
+
    // add call arg to the list
    std::unique_lock<std::mutex> lk(fMutex);
    fCallArgs.Add(arg);
@@ -514,6 +638,8 @@ void THttpServer::ProcessRequests()
       arg->fCond.notify_one();
    }
 
+   UpdateSnapshots();
+
    // regularly call Process() method of engine to let perform actions in ROOT context
    TIter iter(&fEngines);
    THttpEngine *engine = 0;
@@ -521,6 +647,192 @@ void THttpServer::ProcessRequests()
       engine->Process();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Try to process a root.json request from the snapshot of the object
+/// Called from the engine threads in async mode.
+/// Returns kFALSE when request should be processed in the main thread -
+/// typically when the first snapshot of the object is not yet taken.
+
+Bool_t THttpServer::ProcessFromSnapshot(THttpCallArg *arg)
+{
+   if ((fSniffer == 0) || fSniffer->HasRestrictions()) return kFALSE;
+
+   if (arg->fPathName.IsNull() || (strcmp(arg->GetMethod(), "GET") != 0)) return kFALSE;
+
+   TString filename = arg->fFileName;
+   Bool_t iszip = kFALSE;
+   if (filename.EndsWith(".gz")) {
+      filename.Resize(filename.Length() - 3);
+      iszip = kTRUE;
+   }
+   if (filename != "root.json") return kFALSE;
+
+   TUrl url;
+   url.SetOptions(arg->fQuery.Data());
+   url.ParseOptions();
+   Int_t compact = 0;
+   if (url.GetValueFromOptions("compact"))
+      compact = url.GetIntValueFromOptions("compact");
+   Long_t known = -1;
+   if (url.GetValueFromOptions("longpoll"))
+      known = url.GetIntValueFromOptions("longpoll");
+
+   std::shared_ptr<TObject> obj;
+   ULong_t version = 0;
+
+   {
+      std::unique_lock<std::mutex> lk(fSnapshotMutex);
+      if (!fAsync || fTerminating) return kFALSE;
+
+      // register request, main thread will take the snapshot
+      std::shared_ptr<THttpSnapshot> &entry = fSnapshots[arg->fPathName.Data()];
+      if (!entry) entry = std::make_shared<THttpSnapshot>();
+      std::shared_ptr<THttpSnapshot> snap = entry;
+      snap->fRequested = NowMs();
+
+      if (!snap->fObject) return kFALSE;
+
+      // when too many requests wait already, answer at once to keep
+      // engine threads for the other requests
+      if ((known >= 0) && (snap->fVersion <= (ULong_t) known) && (fNumLongPolls < fMaxLongPolls)) {
+         fNumLongPolls++;
+         fSnapshotCond.wait_for(lk, std::chrono::milliseconds(fLongPollTimeout), [&] {
+            return fTerminating || !snap->fObject || (snap->fVersion > (ULong_t) known);
+         });
+         fNumLongPolls--;
+      }
+
+      if (!snap->fObject) return kFALSE;
+
+      obj = snap->fObject;
+      version = snap->fVersion;
+   }
+
+   arg->fContent = TBufferJSON::ConvertToJSON(obj.get(), obj->IsA(), compact);
+   if (arg->fContent.Length() == 0) return kFALSE;
+
+   arg->SetJson();
+   if (iszip) arg->SetZipping(3);
+   arg->AddHeader("SnapshotVersion", TString::Format("%lu", version).Data());
+   arg->AddHeader("Cache-Control", "private, no-cache, no-store, must-revalidate, max-age=0, proxy-revalidate, s-maxage=0");
+
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Take new snapshots of objects requested in async mode
+/// Called from ProcessRequests() in the main thread. Object is streamed and
+/// compared with the last snapshot; only when it changed, a new copy is
+/// created and waiting long-poll requests are notified.
+
+void THttpServer::UpdateSnapshots()
+{
+   std::vector<std::pair<std::string, std::shared_ptr<THttpSnapshot> > > todo;
+   std::vector<std::shared_ptr<TObject> > unused;
+
+   {
+      std::lock_guard<std::mutex> lk(fSnapshotMutex);
+
+      // replaced snapshots which are no longer used by the engine threads
+      for (UInt_t n = 0; n < fRetired.size(); ) {
+         if (fRetired[n].use_count() == 1) {
+            unused.push_back(fRetired[n]);
+            fRetired[n] = fRetired.back();
+            fRetired.pop_back();
+         } else {
+            n++;
+         }
+      }
+
+      if (!fAsync) return;
+
+      Long64_t now = NowMs(), keep = 2*fLongPollTimeout;
+      if (keep < 10000) keep = 10000;
+
+      std::map<std::string, std::shared_ptr<THttpSnapshot> >::iterator iter = fSnapshots.begin();
+      while (iter != fSnapshots.end()) {
+         THttpSnapshot *snap = iter->second.get();
+         if (now - snap->fRequested > keep) {
+            // not requested any longer
+            if (snap->fObject) {
+               fRetired.push_back(snap->fObject);
+               snap->fObject.reset();
+            }
+            fSnapshots.erase(iter++);
+            continue;
+         }
+         if (!snap->fFailed && (now - snap->fTaken >= fSnapshotPeriod))
+            todo.push_back(std::make_pair(iter->first, iter->second));
+         ++iter;
+      }
+   }
+
+   // objects deleted outside of the lock
+   unused.clear();
+
+   if (todo.empty()) return;
+
+   Bool_t changed = kFALSE;
+
+   TDirectory *olddir = gDirectory;
+   gDirectory = 0;
+   TFile *oldfile = gFile;
+   gFile = 0;
+
+   for (UInt_t n = 0; n < todo.size(); n++) {
+      THttpSnapshot *snap = todo[n].second.get();
+      snap->fTaken = NowMs();
+
+      const char *path = todo[n].first.c_str();
+      if (*path == '/') path++;
+
+      TClass *obj_cl(0);
+      TDataMember *member(0);
+      void *obj_ptr = fSniffer->FindInHierarchy(path, &obj_cl, &member);
+
+      if ((obj_ptr == 0) || (obj_cl == 0)) continue; // may appear later
+      if ((member != 0) || (obj_cl->GetBaseClassOffset(TObject::Class()) != 0)) {
+         snap->fFailed = kTRUE;
+         continue;
+      }
+
+      TObject *obj = (TObject *) obj_ptr;
+      TBufferFile sbuf(TBuffer::kWrite, 10000);
+      sbuf.MapObject(obj);
+      obj->Streamer(sbuf);
+      Int_t nbytes = sbuf.Length();
+
+      if ((snap->fBytes.length() == (size_t) nbytes) &&
+          (memcmp(snap->fBytes.data(), sbuf.Buffer(), nbytes) == 0)) continue;
+
+      TObject *copy = (TObject *) obj_cl->New();
+      if (copy == 0) {
+         snap->fFailed = kTRUE;
+         continue;
+      }
+      sbuf.SetReadMode();
+      sbuf.ResetMap();
+      sbuf.SetBufferOffset(0);
+      sbuf.MapObject(copy);
+      copy->Streamer(sbuf);
+      copy->ResetBit(kIsReferenced);
+      copy->ResetBit(kCanDelete);
+
+      snap->fBytes.assign(sbuf.Buffer(), nbytes);
+
+      std::lock_guard<std::mutex> lk(fSnapshotMutex);
+      if (snap->fObject) fRetired.push_back(snap->fObject);
+      snap->fObject.reset(copy);
+      snap->fVersion++;
+      changed = kTRUE;
+   }
+
+   gDirectory = olddir;
+   gFile = oldfile;
+
+   if (changed) fSnapshotCond.notify_all();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Process single http request
 /// Depending from requested path and filename different actions will be performed.
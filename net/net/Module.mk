@@ -68,7 +68,7 @@ include/%.h:    $(NETDIRI)/%.h
 $(NETLIB):      $(NETO) $(NETDO) $(ORDER_) $(MAINLIBS) $(NETLIBDEP)
 		@$(MAKELIB) $(PLATFORM) $(LD) "$(LDFLAGS)" \
 		   "$(SOFLAGS)" libNet.$(SOEXT) $@ "$(NETO) $(NETDO)" \
-		   "$(NETLIBEXTRA) $(CRYPTOLIBDIR) $(CRYPTOLIB) $(SSLLIB)"
+		   "$(NETLIBEXTRA) $(CRYPTOLIBDIR) $(CRYPTOLIB) $(SSLLIB) $(TBBLIBDIR) $(TBBLIB)"
 
 $(call pcmrule,NET)
 	$(noop)
@@ -102,3 +102,6 @@ endif
 $(call stripsrc,$(NETDIRS)/TSSLSocket.o): CXXFLAGS += $(SSLINCDIR:%=-I%)
 $(call stripsrc,$(NETDIRS)/TS3HTTPRequest.o): CXXFLAGS += $(SSLINCDIR:%=-I%)
 $(call stripsrc,$(NETDIRS)/TWebFile.o): CXXFLAGS += $(NETSSL)
+ifeq ($(BUILDTBB),yes)
+$(call stripsrc,$(NETDIRS)/TMessage.o): CXXFLAGS += $(TBBINCDIR:%=-I%)
+endif
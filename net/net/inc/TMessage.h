@@ -66,6 +66,7 @@ private:
 protected:
    TMessage(void *buf, Int_t bufsize);   // only called by T(P)Socket::Recv()
    void SetLength() const;               // only called by T(P)Socket::Send()
+   Int_t CompressParallel(Int_t compressionLevel, Int_t compressionAlgorithm);
 
 public:
    TMessage(UInt_t what = kMESS_ANY, Int_t bufsiz = TBuffer::kInitialSize);
@@ -37,6 +37,8 @@
 #include "TUrl.h"
 #endif
 
+#include <thread>
+
 
 class TSocket;
 class TArrayC;
@@ -50,13 +52,19 @@ private:
    Int_t    fServerVersion;  // Protocol version used by the server.
    TArrayC *fClassSent;      // Record which StreamerInfo we already sent.
    TMessage fMessage;
+   Bool_t   fAsyncUpload;    // Compress and send fMessage in fUploadThread.
+   std::thread fUploadThread;//! Thread uploading fMessage, if any.
+   Int_t    fUploadStatus;   // Result of the last upload (TSocket::Send).
 
 public:
    TParallelMergingFile(const char *filename, Option_t *option = "", const char *ftitle = "", Int_t compress = 1);
    ~TParallelMergingFile();
 
    virtual void   Close(Option_t *option="");
+           Bool_t GetAsyncUpload() const { return fAsyncUpload; }
+           void   SetAsyncUpload(Bool_t async = kTRUE);
            Bool_t UploadAndReset();
+           Bool_t WaitForUpload();
    virtual Int_t  Write(const char *name=0, Int_t opt=0, Int_t bufsiz=0);
    virtual Int_t  Write(const char *name=0, Int_t opt=0, Int_t bufsiz=0) const;
    virtual void   WriteStreamerInfo();
@@ -105,6 +105,8 @@ protected:
 
    TVirtualMutex *fLastUsageMtx;   // Protect last usage setting / reading
    TTimeStamp    fLastUsage;      // Time stamp of last usage
+   Double_t      fSendTime;       // time (s) spent sending over this socket
+   Double_t      fRecvTime;       // time (s) spent receiving (including waiting) over this socket
 
    static ULong64_t fgBytesRecv;  // total bytes received by all socket objects
    static ULong64_t fgBytesSent;  // total bytes sent by all socket objects
@@ -114,7 +116,8 @@ protected:
    TSocket() : fAddress(), fBytesRecv(0), fBytesSent(0), fCompress(0),
                fLocalAddress(), fRemoteProtocol(), fSecContext(0), fService(),
                fServType(kSOCKD), fSocket(-1), fTcpWindowSize(0), fUrl(),
-               fBitsInfo(), fUUIDs(0), fLastUsageMtx(0), fLastUsage() { }
+               fBitsInfo(), fUUIDs(0), fLastUsageMtx(0), fLastUsage(),
+               fSendTime(0), fRecvTime(0) { }
 
    Bool_t       Authenticate(const char *user);
    void         SetDescriptor(Int_t desc) { fSocket = desc; }
@@ -148,6 +151,9 @@ public:
    virtual Int_t         GetLocalPort();
    UInt_t                GetBytesSent() const { return fBytesSent; }
    UInt_t                GetBytesRecv() const { return fBytesRecv; }
+   Double_t              GetSendTime() const { return fSendTime; }
+   Double_t              GetRecvTime() const { return fRecvTime; }
+   Double_t              GetSendThroughput() const { return fSendTime > 0 ? fBytesSent / fSendTime : 0; }
    Int_t                 GetCompressionAlgorithm() const;
    Int_t                 GetCompressionLevel() const;
    Int_t                 GetCompressionSettings() const;
@@ -42,7 +42,7 @@ friend class TWebSocket;
 friend class TWebSystem;
 
 private:
-   TWebFile() : fSocket(0) { }
+   TWebFile() : fSocket(0), fSocketOpens(0) { }
 
 protected:
    mutable Long64_t  fSize;             // file size
@@ -57,8 +57,11 @@ protected:
    TString           fBasicUrl;         // basic url without authentication and options
    TUrl              fUrlOrg;           // save original url in case of temp redirection
    TString           fBasicUrlOrg;      // save original url in case of temp redirection
+   Int_t             fSocketOpens;      //! number of times fSocket was (re)opened
 
    static TUrl       fgProxy;           // globally set proxy URL
+   static Int_t      fgGapThreshold;    // ranges closer than this are read with one request
+   static Int_t      fgPipelineDepth;   // max number of outstanding HTTP/1.1 range requests
 
    virtual void        Init(Bool_t readHeadOnly);
    virtual void        CheckProxy();
@@ -68,8 +71,9 @@ protected:
    virtual Int_t       GetHunk(TSocket *s, char *hunk, Int_t maxsize);
    virtual const char *HttpTerminator(const char *start, const char *peeked, Int_t peeklen);
    virtual Int_t       GetFromWeb(char *buf, Int_t len, const TString &msg);
-   virtual Int_t       GetFromWeb10(char *buf, Int_t len, const TString &msg, Int_t nseg = 0, Long64_t *seg_pos = 0, Int_t *seg_len = 0);
+   virtual Int_t       GetFromWeb10(char *buf, Int_t len, const TString &msg, Int_t nseg = 0, Long64_t *seg_pos = 0, Int_t *seg_len = 0, Bool_t sent = kFALSE);
    virtual Bool_t      ReadBuffer10(char *buf, Int_t len);
+   virtual Bool_t      ReadRanges(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf);
    virtual Bool_t      ReadBuffers10(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf);
    virtual void        SetMsgReadBuffer10(const char *redirectLocation = 0, Bool_t tempRedirect = kFALSE);
    virtual void        ProcessHttpHeader(const TString& headerLine);
@@ -89,6 +93,10 @@ public:
 
    static void        SetProxy(const char *url);
    static const char *GetProxy();
+   static void        SetGapThreshold(Int_t bytes);
+   static Int_t       GetGapThreshold();
+   static void        SetPipelineDepth(Int_t depth);
+   static Int_t       GetPipelineDepth();
 
    ClassDef(TWebFile,2)  //A ROOT file that reads via a http server
 };
@@ -26,9 +26,20 @@
 #include "TFile.h"
 #include "TProcessID.h"
 #include "RZip.h"
+#include "TROOT.h"
+
+#include <vector>
+
+#ifdef R__USE_IMT
+#include "tbb/parallel_for.h"
+#endif
 
 Bool_t TMessage::fgEvolution = kFALSE;
 
+// With the implicit multi-threading, messages larger than two blocks are
+// compressed and uncompressed in blocks of this size on the thread pool.
+const Int_t kParallelZipBlock = 1024*1024;
+
 
 ClassImp(TMessage)
 
@@ -318,8 +329,12 @@ Int_t TMessage::Compress()
 
    Int_t hdrlen   = 2*sizeof(UInt_t);
    Int_t messlen  = Length() - hdrlen;
-   Int_t nbuffers = 1 + (messlen - 1) / kMAXZIPBUF;
    Int_t chdrlen  = 3*sizeof(UInt_t);   // compressed buffer header length
+#ifdef R__USE_IMT
+   if (ROOT::IsImplicitMTEnabled() && messlen > 2*kParallelZipBlock)
+      return CompressParallel(compressionLevel, compressionAlgorithm);
+#endif
+   Int_t nbuffers = 1 + (messlen - 1) / kMAXZIPBUF;
    Int_t buflen   = std::max(512, chdrlen + messlen + 9*nbuffers);
    fBufComp       = new char[buflen];
    char *messbuf  = Buffer() + hdrlen;
@@ -358,6 +373,63 @@ Int_t TMessage::Compress()
    return 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compress the message in blocks of kParallelZipBlock bytes on the implicit
+/// multi-threading pool. The compressed blocks are independent, so that the
+/// result is read by Uncompress like the one of the sequential compression.
+/// Returns -1 in case of error (the message is then sent uncompressed).
+
+Int_t TMessage::CompressParallel(Int_t compressionLevel, Int_t compressionAlgorithm)
+{
+#ifdef R__USE_IMT
+   Int_t hdrlen   = 2*sizeof(UInt_t);
+   Int_t messlen  = Length() - hdrlen;
+   Int_t chdrlen  = 3*sizeof(UInt_t);
+   Int_t nbuffers = 1 + (messlen - 1) / kParallelZipBlock;
+
+   // Block i is compressed at chdrlen + i*kParallelZipBlock, then the
+   // blocks are moved down one after the other
+   fBufComp = new char[chdrlen + (Long64_t)nbuffers*kParallelZipBlock];
+   std::vector<Int_t> nouts(nbuffers);
+   char *messbuf = Buffer() + hdrlen;
+   tbb::parallel_for(0, nbuffers, [&](Int_t i) {
+      Int_t bufmax = (i == nbuffers - 1) ? messlen - i*kParallelZipBlock : kParallelZipBlock;
+      Int_t nout = 0;
+      R__zipMultipleAlgorithm(compressionLevel, &bufmax, messbuf + (Long64_t)i*kParallelZipBlock, &bufmax,
+                              fBufComp + chdrlen + (Long64_t)i*kParallelZipBlock, &nout, compressionAlgorithm);
+      nouts[i] = nout;
+   });
+
+   char *bufcur = fBufComp + chdrlen;
+   for (Int_t i = 0; i < nbuffers; ++i) {
+      if (nouts[i] == 0) {
+         //this happens when the buffer cannot be compressed
+         delete [] fBufComp;
+         fBufComp    = 0;
+         fBufCompCur = 0;
+         fCompPos    = 0;
+         return -1;
+      }
+      if (i) memmove(bufcur, fBufComp + chdrlen + (Long64_t)i*kParallelZipBlock, nouts[i]);
+      bufcur += nouts[i];
+   }
+   fBufCompCur = bufcur;
+   fCompPos    = fBufCur;
+
+   bufcur = fBufComp;
+   tobuf(bufcur, (UInt_t)(CompLength() - sizeof(UInt_t)));
+   Int_t what = fWhat | kMESS_ZIP;
+   tobuf(bufcur, what);
+   tobuf(bufcur, Length());    // original uncompressed buffer length
+
+   return 0;
+#else
+   (void)compressionLevel;
+   (void)compressionAlgorithm;
+   return -1;
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Uncompress the message. The message will only be uncompressed when
 /// kMESS_ZIP is set. Returns -1 in case of error, 0 otherwise.
@@ -386,6 +458,41 @@ Int_t TMessage::Uncompress()
    fBufMax  = fBuffer + fBufSize;
    char *messbuf = fBuffer + hdrlen;
 
+#ifdef R__USE_IMT
+   if (ROOT::IsImplicitMTEnabled() && buflen - hdrlen > 2*kParallelZipBlock) {
+      // Locate the compressed blocks, then uncompress them in parallel
+      std::vector<UChar_t*> srcs;
+      std::vector<char*> dsts;
+      std::vector<Int_t> nins, nbufs;
+      Int_t noutot = 0;
+      while (noutot < buflen - hdrlen) {
+         if (R__unzip_header(&nin, bufcur, &nbuf) != 0 || noutot + nbuf > buflen - hdrlen) {
+            Error("Uncompress", "Inconsistency found in header of block %d (nin=%d, nbuf=%d)", (Int_t)srcs.size(), nin, nbuf);
+            return -1;
+         }
+         srcs.push_back(bufcur);
+         dsts.push_back(messbuf + noutot);
+         nins.push_back(nin);
+         nbufs.push_back(nbuf);
+         noutot += nbuf;
+         bufcur += nin;
+      }
+      std::vector<Int_t> nouts(srcs.size());
+      tbb::parallel_for(0, (Int_t)srcs.size(), [&](Int_t i) {
+         R__unzip(&nins[i], srcs[i], &nbufs[i], (unsigned char*) dsts[i], &nouts[i]);
+      });
+      for (UInt_t i = 0; i < nouts.size(); i++) {
+         if (nouts[i] != nbufs[i]) {
+            Error("Uncompress", "Failed to uncompress block %d (nin=%d, nbuf=%d, nout=%d)", i, nins[i], nbufs[i], nouts[i]);
+            return -1;
+         }
+      }
+      fWhat &= ~kMESS_ZIP;
+      fCompress = 1;
+      return 0;
+   }
+#endif
+
    Int_t nout;
    Int_t noutot = 0;
    while (1) {
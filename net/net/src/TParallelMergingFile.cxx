@@ -26,6 +26,7 @@
 #include "TParallelMergingFile.h"
 #include "TSocket.h"
 #include "TArrayC.h"
+#include "TROOT.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Constructor.
@@ -34,7 +35,8 @@
 
 TParallelMergingFile::TParallelMergingFile(const char *filename, Option_t *option /* = "" */,
                                            const char *ftitle /* = "" */, Int_t compress /* = 1 */) :
-   TMemFile(filename,option,ftitle,compress),fSocket(0),fServerIdx(-1),fServerVersion(0),fClassSent(0),fMessage(kMESS_OBJECT)
+   TMemFile(filename,option,ftitle,compress),fSocket(0),fServerIdx(-1),fServerVersion(0),fClassSent(0),fMessage(kMESS_OBJECT),
+   fAsyncUpload(kFALSE),fUploadStatus(1)
 {
    TString serverurl = strstr(fUrl.GetOptions(),"pmerge=");
    if (serverurl.Length()) {
@@ -59,6 +61,7 @@ TParallelMergingFile::~TParallelMergingFile()
 void TParallelMergingFile::Close(Option_t *option)
 {
    TMemFile::Close(option);
+   WaitForUpload();
    if (fSocket) {
       if (0==fSocket->Send("Finished")) {          // tell server we are finished
          Warning("Close","Failed to send the finishing message to the server %s:%d",fServerLocation.GetHost(),fServerLocation.GetPort());
@@ -69,12 +72,54 @@ void TParallelMergingFile::Close(Option_t *option)
    fSocket = 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compress and send the content of the file to the server in a separate
+/// thread, so that the client can go on filling the file meanwhile.
+///
+/// UploadAndReset then only copies the content of the file into the message
+/// to upload, after waiting for the end of the previous upload; an upload
+/// failure is reported by the next UploadAndReset (or Close). The
+/// compression of the message is set with fSocket->SetCompressionSettings
+/// or fMessage.SetCompressionSettings as in the synchronous case.
+///
+/// TSocket::Send streams the StreamerInfos and ProcessIDs used by the message
+/// while the client resets the file and fills it again, so the thread safety
+/// of ROOT is enabled (ROOT::EnableThreadSafety).
+
+void TParallelMergingFile::SetAsyncUpload(Bool_t async)
+{
+   if (async) ROOT::EnableThreadSafety();
+   else WaitForUpload();
+   fAsyncUpload = async;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Wait for the end of the asynchronous upload in progress, if any.
+/// Return false if it failed (the connection to the server is then closed).
+
+Bool_t TParallelMergingFile::WaitForUpload()
+{
+   if (fUploadThread.joinable()) fUploadThread.join();
+   if (fUploadStatus > 0) return kTRUE;
+
+   Error("UploadAndReset","Upload to the merging server failed with %d\n",fUploadStatus);
+   fUploadStatus = 1;
+   delete fSocket;
+   fSocket = 0;
+   return kFALSE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Upload the current file data to the merging server.
 /// Reset the file and return true in case of success.
+/// With SetAsyncUpload the data is sent in a separate thread and true is
+/// returned unless the previous upload failed.
 
 Bool_t TParallelMergingFile::UploadAndReset()
 {
+   // The message is re-used: wait till it has been sent
+   if (!WaitForUpload()) return kFALSE;
+
    // Open connection to server
    if (fSocket == 0) {
       const char *host = fServerLocation.GetHost();
@@ -120,11 +165,11 @@ Bool_t TParallelMergingFile::UploadAndReset()
    fMessage.WriteLong64(GetEND());
    CopyTo(fMessage);
 
-   if (int error = fSocket->Send(fMessage) <= 0) {
-      Error("UploadAndReset","Upload to the merging server failed with %d\n",error);
-      delete fSocket;
-      fSocket = 0;
-      return kFALSE;
+   if (fAsyncUpload) {
+      fUploadThread = std::thread([this]() { fUploadStatus = fSocket->Send(fMessage); });
+   } else {
+      fUploadStatus = fSocket->Send(fMessage);
+      if (!WaitForUpload()) return kFALSE;
    }
 
    // Record the StreamerInfo we sent over.
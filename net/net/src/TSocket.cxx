@@ -36,6 +36,8 @@
 #include "TStreamerInfo.h"
 #include "TProcessID.h"
 
+#include <chrono>
+
 ULong64_t TSocket::fgBytesSent = 0;
 ULong64_t TSocket::fgBytesRecv = 0;
 
@@ -64,6 +66,14 @@ TVirtualMutex *gSocketAuthMutex = 0;
 
 ClassImp(TSocket)
 
+namespace {
+   // Seconds elapsed since start, for the send and receive time counters
+   Double_t SecondsSince(const std::chrono::steady_clock::time_point &start)
+   {
+      return std::chrono::duration<Double_t>(std::chrono::steady_clock::now() - start).count();
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Create a socket. Connect to the named service at address addr.
 /// Use tcpwindowsize to specify the size of the receive buffer, it has
@@ -92,6 +102,8 @@ TSocket::TSocket(TInetAddress addr, const char *service, Int_t tcpwindowsize)
    fAddress.fPort = gSystem->GetServiceByName(service);
    fBytesSent = 0;
    fBytesRecv = 0;
+   fSendTime  = 0;
+   fRecvTime  = 0;
    fCompress = 0;
    fTcpWindowSize = tcpwindowsize;
    fUUIDs = 0;
@@ -140,6 +152,8 @@ TSocket::TSocket(TInetAddress addr, Int_t port, Int_t tcpwindowsize)
    SetTitle(fService);
    fBytesSent = 0;
    fBytesRecv = 0;
+   fSendTime  = 0;
+   fRecvTime  = 0;
    fCompress = 0;
    fTcpWindowSize = tcpwindowsize;
    fUUIDs = 0;
@@ -185,6 +199,8 @@ TSocket::TSocket(const char *host, const char *service, Int_t tcpwindowsize)
    SetName(fAddress.GetHostName());
    fBytesSent = 0;
    fBytesRecv = 0;
+   fSendTime  = 0;
+   fRecvTime  = 0;
    fCompress = 0;
    fTcpWindowSize = tcpwindowsize;
    fUUIDs = 0;
@@ -236,6 +252,8 @@ TSocket::TSocket(const char *url, Int_t port, Int_t tcpwindowsize)
    SetTitle(fService);
    fBytesSent = 0;
    fBytesRecv = 0;
+   fSendTime  = 0;
+   fRecvTime  = 0;
    fCompress = 0;
    fTcpWindowSize = tcpwindowsize;
    fUUIDs = 0;
@@ -274,6 +292,8 @@ TSocket::TSocket(const char *sockpath) : TNamed(sockpath, "")
    SetTitle(fService);
    fBytesSent = 0;
    fBytesRecv = 0;
+   fSendTime  = 0;
+   fRecvTime  = 0;
    fCompress  = 0;
    fTcpWindowSize = -1;
    fUUIDs = 0;
@@ -302,6 +322,8 @@ TSocket::TSocket(Int_t desc) : TNamed("", "")
    fServType       = kSOCKD;
    fBytesSent      = 0;
    fBytesRecv      = 0;
+   fSendTime       = 0;
+   fRecvTime       = 0;
    fCompress       = 0;
    fTcpWindowSize = -1;
    fUUIDs          = 0;
@@ -338,6 +360,8 @@ TSocket::TSocket(Int_t desc, const char *sockpath) : TNamed(sockpath, "")
    SetTitle(fService);
    fBytesSent = 0;
    fBytesRecv = 0;
+   fSendTime  = 0;
+   fRecvTime  = 0;
    fCompress  = 0;
    fTcpWindowSize = -1;
    fUUIDs = 0;
@@ -364,6 +388,8 @@ TSocket::TSocket(const TSocket &s) : TNamed(s)
    fLocalAddress   = s.fLocalAddress;
    fBytesSent      = s.fBytesSent;
    fBytesRecv      = s.fBytesRecv;
+   fSendTime       = s.fSendTime;
+   fRecvTime       = s.fRecvTime;
    fCompress       = s.fCompress;
    fSecContext     = s.fSecContext;
    fRemoteProtocol = s.fRemoteProtocol;
@@ -534,6 +560,9 @@ Int_t TSocket::Send(const TMessage &mess)
    // send the process id's so TRefs work
    SendProcessIDs(mess);
 
+   // the compression is accounted in the time to send the message
+   auto start = std::chrono::steady_clock::now();
+
    mess.SetLength();   //write length in first word of buffer
 
    if (GetCompressionLevel() > 0 && mess.GetCompressionLevel() == 0)
@@ -562,6 +591,7 @@ Int_t TSocket::Send(const TMessage &mess)
 
    fBytesSent  += nsent;
    fgBytesSent += nsent;
+   fSendTime   += SecondsSince(start);
 
    // If acknowledgement is desired, wait for it
    if (mess.What() & kMESS_ACK) {
@@ -624,6 +654,7 @@ Int_t TSocket::SendRaw(const void *buffer, Int_t length, ESendRecvOptions opt)
    if (fSocket == -1) return -1;
 
    ResetBit(TSocket::kBrokenConn);
+   auto start = std::chrono::steady_clock::now();
    Int_t nsent;
    if ((nsent = gSystem->SendRaw(fSocket, buffer, length, (int) opt)) <= 0) {
       if (nsent == -5) {
@@ -636,6 +667,7 @@ Int_t TSocket::SendRaw(const void *buffer, Int_t length, ESendRecvOptions opt)
 
    fBytesSent  += nsent;
    fgBytesSent += nsent;
+   fSendTime   += SecondsSince(start);
 
    Touch();  // update usage timestamp
 
@@ -826,6 +858,7 @@ Int_t TSocket::Recv(TMessage *&mess)
 
 oncemore:
    ResetBit(TSocket::kBrokenConn);
+   auto start = std::chrono::steady_clock::now();
    Int_t  n;
    UInt_t len;
    if ((n = gSystem->RecvRaw(fSocket, &len, sizeof(UInt_t), 0)) <= 0) {
@@ -856,6 +889,7 @@ oncemore:
    fgBytesRecv += n + sizeof(UInt_t);
 
    mess = new TMessage(buf, len+sizeof(UInt_t));
+   fRecvTime   += SecondsSince(start);
 
    // receive any streamer infos
    if (RecvStreamerInfos(mess))
@@ -906,6 +940,7 @@ Int_t TSocket::RecvRaw(void *buffer, Int_t length, ESendRecvOptions opt)
    if (length == 0) return 0;
 
    ResetBit(TSocket::kBrokenConn);
+   auto start = std::chrono::steady_clock::now();
    Int_t n;
    if ((n = gSystem->RecvRaw(fSocket, buffer, length, (int) opt)) <= 0) {
       if (n == 0 || n == -5) {
@@ -918,6 +953,7 @@ Int_t TSocket::RecvRaw(void *buffer, Int_t length, ESendRecvOptions opt)
 
    fBytesRecv  += n;
    fgBytesRecv += n;
+   fRecvTime   += SecondsSince(start);
 
    Touch();  // update usage timestamp
 
@@ -26,12 +26,14 @@
 #include "TSystem.h"
 #include "TBase64.h"
 #include "TVirtualPerfStats.h"
+#include "TEnv.h"
 #ifdef R__SSL
 #include "TSSLSocket.h"
 #endif
 
 #include <errno.h>
 #include <stdlib.h>
+#include <vector>
 
 #ifdef WIN32
 # ifndef EADDRINUSE
@@ -44,7 +46,9 @@
 
 static const char *gUserAgent = "User-Agent: ROOT-TWebFile/1.1";
 
-TUrl TWebFile::fgProxy;
+TUrl  TWebFile::fgProxy;
+Int_t TWebFile::fgGapThreshold  = -1;
+Int_t TWebFile::fgPipelineDepth = -1;
 
 
 // Internal class used to manage the socket that may stay open between
@@ -105,6 +109,7 @@ void TWebSocket::ReOpen()
 #endif
       } else
          fWebFile->fSocket = new TSocket(connurl.GetHost(), connurl.GetPort());
+      fWebFile->fSocketOpens++;
 
       if (!fWebFile->fSocket || !fWebFile->fSocket->IsValid()) {
          delete fWebFile->fSocket;
@@ -140,7 +145,7 @@ ClassImp(TWebFile)
 /// to see if the file is accessible. The preferred interface to this
 /// constructor is via TFile::Open().
 
-TWebFile::TWebFile(const char *url, Option_t *opt) : TFile(url, "WEB"), fSocket(0)
+TWebFile::TWebFile(const char *url, Option_t *opt) : TFile(url, "WEB"), fSocket(0), fSocketOpens(0)
 {
    TString option = opt;
    fNoProxy = kFALSE;
@@ -173,7 +178,7 @@ TWebFile::TWebFile(const char *url, Option_t *opt) : TFile(url, "WEB"), fSocket(
 /// the kZombie bit will be set in the TWebFile object. Use IsZombie()
 /// to see if the file is accessible.
 
-TWebFile::TWebFile(TUrl url, Option_t *opt) : TFile(url.GetUrl(), "WEB"), fSocket(0)
+TWebFile::TWebFile(TUrl url, Option_t *opt) : TFile(url.GetUrl(), "WEB"), fSocket(0), fSocketOpens(0)
 {
    TString option = opt;
    fNoProxy = kFALSE;
@@ -485,9 +490,69 @@ Bool_t TWebFile::ReadBuffer10(char *buf, Int_t len)
 /// where pos[i] is the seek position of block i of length len[i].
 /// Note that for nbuf=1, this call is equivalent to TFile::ReafBuffer
 /// This function is overloaded by TNetFile, TWebFile, etc.
+/// Consecutive blocks separated by at most GetGapThreshold() bytes are
+/// requested as a single byte range, the bytes in between being discarded.
 /// Returns kTRUE in case of failure.
 
 Bool_t TWebFile::ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
+{
+   if (nbuf < 2)
+      return ReadRanges(buf, pos, len, nbuf);
+
+   const Int_t gap = GetGapThreshold();
+
+   // merge the blocks following each other (in increasing order) closely;
+   // where[i] is the offset of block i in the data of the merged ranges
+   std::vector<Long64_t> mpos, where(nbuf);
+   std::vector<Int_t>    mlen;
+   mpos.reserve(nbuf);
+   mlen.reserve(nbuf);
+   Long64_t ntot = 0, nmerged = 0;
+   for (Int_t i = 0; i < nbuf; i++) {
+      ntot += len[i];
+      if (!mpos.empty()) {
+         Long64_t end = mpos.back() + mlen.back();
+         if (pos[i] >= end && pos[i] - end <= gap &&
+             pos[i] + len[i] - mpos.back() <= kMaxInt/2) {
+            where[i] = nmerged + pos[i] - mpos.back();
+            mlen.back() = Int_t(pos[i] + len[i] - mpos.back());
+            continue;
+         }
+         nmerged += mlen.back();
+      }
+      where[i] = nmerged;
+      mpos.push_back(pos[i]);
+      mlen.push_back(len[i]);
+   }
+   nmerged += mlen.back();
+
+   if (Int_t(mpos.size()) == nbuf)
+      return ReadRanges(buf, pos, len, nbuf);
+
+   // only touching blocks were merged: the data lands in place
+   if (nmerged == ntot)
+      return ReadRanges(buf, &mpos[0], &mlen[0], mpos.size());
+
+   std::vector<char> scratch(nmerged);
+   if (ReadRanges(&scratch[0], &mpos[0], &mlen[0], mpos.size()))
+      return kTRUE;
+
+   // copy the requested blocks out of the merged ranges
+   Long64_t k = 0;
+   for (Int_t i = 0; i < nbuf; i++) {
+      memcpy(&buf[k], &scratch[where[i]], len[i]);
+      k += len[i];
+   }
+
+   return kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Read the nbuf byte ranges described in arrays pos and len, either via
+/// mod_root or via HTTP range requests (see ReadBuffers10()).
+/// Returns kTRUE in case of failure.
+
+Bool_t TWebFile::ReadRanges(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
 {
    if (!fHasModRoot)
       return ReadBuffers10(buf, pos, len, nbuf);
@@ -534,12 +599,26 @@ Bool_t TWebFile::ReadBuffers(char *buf, Long64_t *pos, Int_t *len, Int_t nbuf)
 /// where pos[i] is the seek position of block i of length len[i].
 /// Note that for nbuf=1, this call is equivalent to TFile::ReafBuffer
 /// This function is overloaded by TNetFile, TWebFile, etc.
+/// The ranges are sent in requests of at most 200 ranges. When the server
+/// speaks HTTP/1.1, up to GetPipelineDepth() requests are sent on the
+/// keep-alive connection before their responses are read, so that a
+/// large read costs about one round trip instead of one per request.
 /// Returns kTRUE in case of failure.
 
 Bool_t TWebFile::ReadBuffers10(char *buf,  Long64_t *pos, Int_t *len, Int_t nbuf)
 {
    SetMsgReadBuffer10();
 
+   // one request per at most 200 ranges (or 8000 characters)
+   struct Request_t {
+      TString fMsg;     // HTTP request
+      Int_t   fFirst;   // index of the first range
+      Int_t   fCnt;     // number of ranges
+      Int_t   fOffset;  // offset of the data in buf
+      Int_t   fLen;     // number of bytes
+   };
+   std::vector<Request_t> reqs;
+
    TString msg = fMsgReadBuffer10;
 
    Int_t k = 0, n = 0, r, cnt = 0;
@@ -552,9 +631,8 @@ Bool_t TWebFile::ReadBuffers10(char *buf,  Long64_t *pos, Int_t *len, Int_t nbuf
       cnt++;
       if ((msg.Length() > 8000) || (cnt >= 200) || (i+1 == nbuf)) {
          msg += "\r\n\r\n";
-         r = GetFromWeb10(&buf[k], n, msg, cnt, pos + (i+1-cnt), len + (i+1-cnt));
-         if (r == -1)
-            return kTRUE;
+         Request_t req = { msg, i+1-cnt, cnt, k, n };
+         reqs.push_back(req);
          msg = fMsgReadBuffer10;
          k += n;
          n = 0;
@@ -562,6 +640,40 @@ Bool_t TWebFile::ReadBuffers10(char *buf,  Long64_t *pos, Int_t *len, Int_t nbuf
       }
    }
 
+   const Int_t nreq = reqs.size();
+   const Int_t depth = GetPipelineDepth();
+   Int_t sent = 0;   // requests [0, sent) are already on the wire
+   for (Int_t i = 0; i < nreq; i++) {
+      if (fHTTP11 && depth > 1 && nreq > 1) {
+         // keep up to depth requests outstanding on the keep-alive socket
+         TWebSocket ws(this);
+         if (sent < i) sent = i;
+         while (sent < nreq && sent < i + depth && fSocket && fSocket->IsValid()) {
+            if (gDebug > 0)
+               Info("ReadBuffers10", "pipelining HTTP request %d of %d", sent+1, nreq);
+            if (fSocket->SendRaw(reqs[sent].fMsg.Data(), reqs[sent].fMsg.Length()) == -1)
+               break;
+            sent++;
+         }
+      }
+      const Request_t &req = reqs[i];
+      Int_t opens = fSocketOpens;
+      r = GetFromWeb10(&buf[req.fOffset], req.fLen, req.fMsg, req.fCnt,
+                       pos + req.fFirst, len + req.fFirst,
+                       i < sent);
+      if (r == -1) {
+         if (sent > i+1) {
+            // drop the responses still in flight
+            delete fSocket;
+            fSocket = 0;
+         }
+         return kTRUE;
+      }
+      // the requests sent ahead were lost with the previous connection
+      if (fSocketOpens != opens && sent > i+1)
+         sent = i+1;
+   }
+
    return kFALSE;
 }
 
@@ -633,16 +745,22 @@ Int_t TWebFile::GetFromWeb(char *buf, Int_t len, const TString &msg)
 ////////////////////////////////////////////////////////////////////////////////
 /// Read multiple byte range request from web server.
 /// Uses HTTP 1.0 daemon wihtout mod-root.
+/// If sent is true the request was already sent on fSocket (pipelining)
+/// and only its response is read.
 /// Returns -2 in case file does not exist, -1 in case
 /// of error and 0 in case of success.
 
-Int_t TWebFile::GetFromWeb10(char *buf, Int_t len, const TString &msg, Int_t nseg, Long64_t *seg_pos, Int_t *seg_len)
+Int_t TWebFile::GetFromWeb10(char *buf, Int_t len, const TString &msg, Int_t nseg, Long64_t *seg_pos, Int_t *seg_len, Bool_t sent)
 {
    if (!len) return 0;
 
    Double_t start = 0;
    if (gPerfStats) start = TTimeStamp();
 
+   // a request sent ahead is lost if the socket went away since
+   if (!fSocket)
+      sent = kFALSE;
+
    // open fSocket and close it when going out of scope
    TWebSocket ws(this);
 
@@ -651,10 +769,10 @@ Int_t TWebFile::GetFromWeb10(char *buf, Int_t len, const TString &msg, Int_t nse
       return -1;
    }
 
-   if (gDebug > 0)
+   if (gDebug > 0 && !sent)
       Info("GetFromWeb10", "sending HTTP request:\n%s", msg.Data());
 
-   if (fSocket->SendRaw(msg.Data(), msg.Length()) == -1) {
+   if (!sent && fSocket->SendRaw(msg.Data(), msg.Length()) == -1) {
       Error("GetFromWeb10", "error sending command to host %s", fUrl.GetHost());
       return -1;
    }
@@ -1356,6 +1474,54 @@ const char *TWebFile::GetProxy()
    return "";
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Static method setting the gap threshold of ReadBuffers(): consecutive
+/// blocks separated by at most bytes bytes are read with a single byte
+/// range, trading the transfer of the gap for fewer ranges (and requests).
+/// A negative value restores the default, taken from the rootrc variable
+/// TWebFile.GapThreshold (0, i.e. only touching blocks are merged).
+
+void TWebFile::SetGapThreshold(Int_t bytes)
+{
+   fgGapThreshold = bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Static method returning the gap threshold of ReadBuffers().
+
+Int_t TWebFile::GetGapThreshold()
+{
+   if (fgGapThreshold < 0) {
+      Int_t gap = gEnv->GetValue("TWebFile.GapThreshold", 0);
+      return gap < 0 ? 0 : gap;
+   }
+   return fgGapThreshold;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Static method setting the maximum number of byte range requests sent
+/// ahead on an HTTP/1.1 keep-alive connection before their responses are
+/// read (see ReadBuffers10()). 1 disables the pipelining. A value < 1
+/// restores the default, taken from the rootrc variable
+/// TWebFile.PipelineDepth (1).
+
+void TWebFile::SetPipelineDepth(Int_t depth)
+{
+   fgPipelineDepth = depth;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Static method returning the maximum number of outstanding requests.
+
+Int_t TWebFile::GetPipelineDepth()
+{
+   if (fgPipelineDepth < 1) {
+      Int_t depth = gEnv->GetValue("TWebFile.PipelineDepth", 1);
+      return depth < 1 ? 1 : depth;
+   }
+   return fgPipelineDepth;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Process the HTTP header in the argument. This method is intended to be
 /// overwritten by subclasses that exploit the information contained in the
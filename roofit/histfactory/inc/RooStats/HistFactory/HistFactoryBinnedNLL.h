@@ -0,0 +1,99 @@
+// @(#)root/roostats:$Id$
+/*************************************************************************
+ * Copyright (C) 1995-2008, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+#ifndef ROOSTATS_HISTFACTORYBINNEDNLL
+#define ROOSTATS_HISTFACTORYBINNEDNLL
+
+#include "RooAbsReal.h"
+#include "RooListProxy.h"
+#include <vector>
+
+class RooRealSumPdf ;
+class RooAbsData ;
+class RooArgSet ;
+class PiecewiseInterpolation ;
+class ParamHistFunc ;
+
+namespace RooStats{
+  namespace HistFactory{
+
+class HistFactoryBinnedNLL : public RooAbsReal {
+public:
+
+  HistFactoryBinnedNLL() ;
+  HistFactoryBinnedNLL(const char *name, const char *title, const RooRealSumPdf& pdf, const RooAbsData& data) ;
+  HistFactoryBinnedNLL(const HistFactoryBinnedNLL& other, const char* name=0) ;
+  virtual TObject* clone(const char* newname) const { return new HistFactoryBinnedNLL(*this,newname); }
+  virtual ~HistFactoryBinnedNLL() ;
+
+  Int_t numBins() const { return _nBins ; }
+  Int_t numSamples() const { return _nSamples ; }
+
+  const RooArgList& paramList() const { return _params ; }
+  const RooArgList& scalarList() const { return _scalars ; }
+
+  // Expected event yield in each bin at the current parameter values
+  const std::vector<Double_t>& expectedYields() const ;
+
+protected:
+
+  Double_t evaluate() const ;
+
+  void computeYields() const ;
+  void applyInterpolation(Int_t interp, Double_t* sum) const ;
+
+  void collectFactors(RooAbsReal& func, const RooArgSet& obs, Int_t sample,
+		      std::vector<RooAbsReal*>& hists, std::vector<Int_t>& histSample,
+		      std::vector<PiecewiseInterpolation*>& interps,
+		      std::vector<ParamHistFunc*>& gammas) ;
+  Int_t addParameter(RooAbsReal& param) ;
+  Int_t addScalar(RooAbsReal& scalar, Int_t sample) ;
+
+  RooListProxy _params ;   // Parameters entering bin-by-bin modifiers
+  RooListProxy _scalars ;  // Bin-independent factors (coefficients, normalizations)
+
+  Int_t _nBins ;           // Number of bins
+  Int_t _nSamples ;        // Number of samples (terms of the RooRealSumPdf)
+
+  std::vector<Double_t> _data ;      // Observed events per bin
+  std::vector<Double_t> _binw ;      // Bin volume per bin
+  std::vector<Double_t> _lnGammaN ;  // log(N!) per bin
+
+  std::vector<Int_t> _scalarIdx ;    // Index in _scalars of each scalar factor
+  std::vector<Int_t> _scalarSample ; // Sample multiplied by each scalar factor
+
+  std::vector<Double_t> _base ;      // [sample*nBins+bin] product of constant histogram factors
+
+  std::vector<Int_t> _interpBegin ;    // [sample] first interpolation of sample, size nSamples+1
+  std::vector<Double_t> _interpNominal ; // [interp*nBins+bin] nominal of each interpolation
+  std::vector<Bool_t> _interpPosDef ;  // [interp] positive definite flag
+  std::vector<Int_t> _varBegin ;       // [interp] first variation of interpolation, size nInterp+1
+  std::vector<Int_t> _varParam ;       // [var] index in _params of variation parameter
+  std::vector<Int_t> _varCode ;        // [var] interpolation code
+  std::vector<Double_t> _varLow ;      // [var*nBins+bin] low variation
+  std::vector<Double_t> _varHigh ;     // [var*nBins+bin] high variation
+
+  std::vector<Int_t> _gammaBegin ;     // [sample] first bin-wise factor of sample, size nSamples+1
+  std::vector<Int_t> _gammaIdx ;       // [gamma*nBins+bin] index in _params of bin-wise factor
+
+  mutable std::vector<Double_t> _paramVals ;  //! Parameter values of current evaluation
+  mutable std::vector<Double_t> _sampleNorm ; //! Scalar normalization per sample
+  mutable std::vector<Double_t> _yields ;     //! Expected yield per bin
+  mutable std::vector<Double_t> _work ;       //! Per-sample scratch array
+  mutable std::vector<Double_t> _interpSum ;  //! Per-interpolation scratch array
+
+private:
+
+  ClassDef(RooStats::HistFactory::HistFactoryBinnedNLL,1) // Flattened binned Poisson likelihood of a HistFactory channel
+};
+
+  }
+}
+
+#endif
@@ -61,6 +61,9 @@ namespace RooStats{
 
       void SetFunctionsToPreprocess(std::vector<std::string> lines) { fPreprocessFunctions=lines; }
 
+      // also import a flattened binned likelihood 'binnedNLL' into the created workspaces
+      void SetMakeBinnedNLL(bool makeBinnedNLL) { fMakeBinnedNLL=makeBinnedNLL; }
+
     protected:
 
        void AddConstraintTerms(RooWorkspace* proto, Measurement& measurement, std::string prefix, std::string interpName,
@@ -85,6 +88,9 @@ namespace RooStats{
 			   std::map<std::string,double> logNormSyst, 
 			   std::map<std::string,double> noSyst);
 
+      void MakeBinnedNLL(RooWorkspace* ws, std::vector<std::string> channel_names,
+			 RooCategory* channelCat=0);
+
       void LinInterpWithConstraint(RooWorkspace* proto, TH1* nominal, std::vector<HistoSys>,  
 				   std::string prefix, std::string productPrefix, 
 				   std::string systTerm, 
@@ -128,6 +134,7 @@ namespace RooStats{
       double fLumiError;
       int fLowBin; 
       int fHighBin;    
+      bool fMakeBinnedNLL;
 
     private:
     
@@ -137,7 +144,7 @@ namespace RooStats{
       std::string fObsName;
       std::vector<std::string> fPreprocessFunctions;
     
-      ClassDef(RooStats::HistFactory::HistoToWorkspaceFactoryFast,3)
+      ClassDef(RooStats::HistFactory::HistoToWorkspaceFactoryFast,4)
     };
   
   }
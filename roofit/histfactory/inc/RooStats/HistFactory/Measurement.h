@@ -98,6 +98,10 @@ public:
   void SetExportOnly( bool ExportOnly ) { fExportOnly = ExportOnly; }
   bool GetExportOnly() { return fExportOnly; }
 
+  // also build a flattened binned likelihood (HistFactoryBinnedNLL) for each model
+  void SetBinnedNLL( bool BinnedNLL ) { fBinnedNLL = BinnedNLL; }
+  bool GetBinnedNLL() { return fBinnedNLL; }
+
 
   void PrintTree( std::ostream& = std::cout ); // Print to a stream
   void PrintXML( std::string Directory="", std::string NewOutputPrefix="" );
@@ -134,6 +138,7 @@ private:
   int fBinLow;
   int fBinHigh;
   bool fExportOnly;
+  bool fBinnedNLL;
   std::string fInterpolationScheme;
 
   // Channels that make up this measurement
@@ -159,7 +164,7 @@ private:
   
   std::string GetDirPath( TDirectory* dir );
 
-  ClassDef(RooStats::HistFactory::Measurement, 3);
+  ClassDef(RooStats::HistFactory::Measurement, 4);
 
 };
  
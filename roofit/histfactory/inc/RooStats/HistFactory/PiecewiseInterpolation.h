@@ -42,6 +42,9 @@ public:
   const RooArgList& lowList() const { return _lowSet ; }
   const RooArgList& highList() const { return _highSet ; }
   const RooArgList& paramList() const { return _paramSet ; }
+  const RooAbsReal& nominalHist() const { return _nominal.arg() ; }
+  const std::vector<int>& interpolationCodes() const { return _interpCode ; }
+  Bool_t positiveDefinite() const { return _positiveDefinite ; }
 
   //virtual Bool_t forceAnalyticalInt(const RooAbsArg&) const { return kTRUE ; }
   Bool_t setBinIntegrator(RooArgSet& allVars) ;
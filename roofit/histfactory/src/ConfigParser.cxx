@@ -274,6 +274,7 @@ HistFactory::Measurement ConfigParser::CreateMeasurementFromDriverNode( TXMLNode
   measurement.SetBinLow( 0 );
   measurement.SetBinHigh( 1 );
   measurement.SetExportOnly( false );
+  measurement.SetBinnedNLL( false );
 
   std::cout << "Creating new measurement: " << std::endl;
 
@@ -310,6 +311,9 @@ HistFactory::Measurement ConfigParser::CreateMeasurementFromDriverNode( TXMLNode
     else if( curAttr->GetName() == TString( "ExportOnly" ) ) {
       measurement.SetExportOnly( CheckTrueFalse(curAttr->GetValue(),"Measurement") );
     }
+    else if( curAttr->GetName() == TString( "BinnedNLL" ) ) {
+      measurement.SetBinnedNLL( CheckTrueFalse(curAttr->GetValue(),"Measurement") );
+    }
 
     else {
       std::cout << "Found unknown XML attribute in Measurement: " << curAttr->GetName()
@@ -0,0 +1,521 @@
+// @(#)root/roostats:$Id$
+/*************************************************************************
+ * Copyright (C) 1995-2008, Rene Brun and Fons Rademakers.               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+/** \class RooStats::HistFactory::HistFactoryBinnedNLL
+ * \ingroup HistFactory
+ * Flattened binned -log(L) of a single HistFactory channel.
+ *
+ * The channel model built by HistoToWorkspaceFactoryFast is a RooRealSumPdf
+ * of (coefficient x RooProduct) terms, one per sample, where each product
+ * combines RooHistFunc templates, PiecewiseInterpolation histogram systematics,
+ * ParamHistFunc bin-wise factors and bin-independent normalizations.
+ * Evaluating it through RooNLLVar walks this graph with virtual getVal()
+ * calls for every bin. This class decomposes the graph once at construction
+ * into contiguous per-bin arrays (nominal yields, low/high variations,
+ * bin-wise parameter indices) and evaluates the expected yields for all bins
+ * in tight loops, after reading every parameter and normalization only once.
+ *
+ * The value is identical to the one of RooNLLVar in binned likelihood mode
+ * (the 'BinnedLikelihood' attribute of RooRealSumPdf), i.e. the sum over bins
+ * of -log(Poisson(N_i|mu_i)). Constraint terms are not included; add a
+ * RooConstraintSum to obtain the full likelihood. If the model contains
+ * components that cannot be flattened, the constructor throws hf_exc.
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "RooFit.h"
+#include "Riostream.h"
+
+#include "RooStats/HistFactory/HistFactoryBinnedNLL.h"
+#include "RooStats/HistFactory/HistFactoryException.h"
+#include "RooStats/HistFactory/PiecewiseInterpolation.h"
+#include "RooStats/HistFactory/ParamHistFunc.h"
+#include "RooRealSumPdf.h"
+#include "RooProduct.h"
+#include "RooHistFunc.h"
+#include "RooAbsData.h"
+#include "RooRealVar.h"
+#include "RooAbsRealLValue.h"
+#include "RooAbsBinning.h"
+#include "RooArgSet.h"
+#include "RooMsgService.h"
+#include "TMath.h"
+
+using namespace std ;
+
+ClassImp(RooStats::HistFactory::HistFactoryBinnedNLL)
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Default constructor
+
+RooStats::HistFactory::HistFactoryBinnedNLL::HistFactoryBinnedNLL() :
+  _nBins(0), _nSamples(0)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Construct the flattened likelihood of the channel model 'pdf' for the
+/// binned dataset 'data'. Each entry of 'data' is one bin; its weight is the
+/// observed number of events. The observables of 'pdf' are temporarily moved
+/// to each bin to extract the template contents and are restored afterwards.
+
+RooStats::HistFactory::HistFactoryBinnedNLL::HistFactoryBinnedNLL(const char *name, const char *title,
+								  const RooRealSumPdf& pdf, const RooAbsData& data) :
+  RooAbsReal(name,title),
+  _params("params","Bin-wise modifier parameters",this),
+  _scalars("scalars","Bin-independent factors",this),
+  _nBins(data.numEntries()),
+  _nSamples(pdf.funcList().getSize())
+{
+  if (pdf.coefList().getSize()!=_nSamples) {
+    coutE(InputArguments) << "HistFactoryBinnedNLL::ctor(" << GetName() << ") ERROR: " << pdf.GetName()
+			  << " has a different number of functions and coefficients" << endl ;
+    throw hf_exc() ;
+  }
+
+  RooArgSet* obs = pdf.getObservables(data) ;
+  RooArgSet* obsSaved = (RooArgSet*) obs->snapshot() ;
+
+  // Classify the factors of every sample at the first bin; the structure of
+  // a HistFactory model does not depend on the bin
+  std::vector<RooAbsReal*> hists ;
+  std::vector<Int_t> histSample ;
+  std::vector<PiecewiseInterpolation*> interps ;
+  std::vector<ParamHistFunc*> gammas ;
+  _interpBegin.push_back(0) ;
+  _gammaBegin.push_back(0) ;
+  try {
+    for (Int_t s=0 ; s<_nSamples ; s++) {
+      addScalar((RooAbsReal&)*pdf.coefList().at(s),s) ;
+      collectFactors((RooAbsReal&)*pdf.funcList().at(s),*obs,s,hists,histSample,interps,gammas) ;
+      _interpBegin.push_back(interps.size()) ;
+      _gammaBegin.push_back(gammas.size()) ;
+    }
+  } catch (hf_exc&) {
+    delete obsSaved ;
+    delete obs ;
+    throw ;
+  }
+
+  // Lay out the variations of all interpolations contiguously
+  _varBegin.push_back(0) ;
+  for (unsigned int m=0 ; m<interps.size() ; m++) {
+    const RooArgList& params = interps[m]->paramList() ;
+    for (Int_t k=0 ; k<params.getSize() ; k++) {
+      _varParam.push_back(addParameter((RooAbsReal&)*params.at(k))) ;
+      _varCode.push_back(interps[m]->interpolationCodes()[k]) ;
+    }
+    _varBegin.push_back(_varParam.size()) ;
+    _interpPosDef.push_back(interps[m]->positiveDefinite()) ;
+  }
+
+  _data.resize(_nBins) ;
+  _binw.resize(_nBins) ;
+  _lnGammaN.resize(_nBins) ;
+  _base.assign(_nSamples*_nBins,1.) ;
+  _interpNominal.resize(interps.size()*_nBins) ;
+  _varLow.resize(_varParam.size()*_nBins) ;
+  _varHigh.resize(_varParam.size()*_nBins) ;
+  _gammaIdx.resize(gammas.size()*_nBins) ;
+
+  // Fill the per-bin arrays
+  for (Int_t i=0 ; i<_nBins ; i++) {
+    *obs = *data.get(i) ;
+    _data[i] = data.weight() ;
+    _lnGammaN[i] = TMath::LnGamma(_data[i]+1) ;
+
+    Double_t binw(1) ;
+    RooFIter oiter = obs->fwdIterator() ;
+    RooAbsArg* arg ;
+    while((arg=oiter.next())) {
+      RooAbsRealLValue* lv = dynamic_cast<RooAbsRealLValue*>(arg) ;
+      if (lv) binw *= lv->getBinning().binWidth(lv->getBin()) ;
+    }
+    _binw[i] = binw ;
+
+    for (unsigned int h=0 ; h<hists.size() ; h++) {
+      _base[histSample[h]*_nBins+i] *= hists[h]->getVal() ;
+    }
+
+    Int_t v(0) ;
+    for (unsigned int m=0 ; m<interps.size() ; m++) {
+      _interpNominal[m*_nBins+i] = interps[m]->nominalHist().getVal() ;
+      const RooArgList& low = interps[m]->lowList() ;
+      const RooArgList& high = interps[m]->highList() ;
+      for (Int_t k=0 ; k<low.getSize() ; k++, v++) {
+	_varLow[v*_nBins+i] = ((RooAbsReal*)low.at(k))->getVal() ;
+	_varHigh[v*_nBins+i] = ((RooAbsReal*)high.at(k))->getVal() ;
+      }
+    }
+
+    for (unsigned int g=0 ; g<gammas.size() ; g++) {
+      _gammaIdx[g*_nBins+i] = addParameter(gammas[g]->getParameter()) ;
+    }
+  }
+
+  *obs = *obsSaved ;
+  delete obsSaved ;
+  delete obs ;
+
+  coutI(InputArguments) << "HistFactoryBinnedNLL::ctor(" << GetName() << ") flattened " << pdf.GetName()
+			<< " into " << _nSamples << " samples x " << _nBins << " bins with "
+			<< interps.size() << " interpolations, " << gammas.size() << " bin-wise factors and "
+			<< _params.getSize() << " parameters" << endl ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Copy constructor
+
+RooStats::HistFactory::HistFactoryBinnedNLL::HistFactoryBinnedNLL(const HistFactoryBinnedNLL& other, const char* name) :
+  RooAbsReal(other,name),
+  _params("params",this,other._params),
+  _scalars("scalars",this,other._scalars),
+  _nBins(other._nBins),
+  _nSamples(other._nSamples),
+  _data(other._data),
+  _binw(other._binw),
+  _lnGammaN(other._lnGammaN),
+  _scalarIdx(other._scalarIdx),
+  _scalarSample(other._scalarSample),
+  _base(other._base),
+  _interpBegin(other._interpBegin),
+  _interpNominal(other._interpNominal),
+  _interpPosDef(other._interpPosDef),
+  _varBegin(other._varBegin),
+  _varParam(other._varParam),
+  _varCode(other._varCode),
+  _varLow(other._varLow),
+  _varHigh(other._varHigh),
+  _gammaBegin(other._gammaBegin),
+  _gammaIdx(other._gammaIdx)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Destructor
+
+RooStats::HistFactory::HistFactoryBinnedNLL::~HistFactoryBinnedNLL()
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Recursively split 'func' into its factors and classify them as constant
+/// templates (RooHistFunc), histogram systematics (PiecewiseInterpolation),
+/// bin-wise factors (ParamHistFunc) or bin-independent scalars. Throws hf_exc
+/// for any other observable-dependent component.
+
+void RooStats::HistFactory::HistFactoryBinnedNLL::collectFactors(RooAbsReal& func, const RooArgSet& obs, Int_t sample,
+								 std::vector<RooAbsReal*>& hists, std::vector<Int_t>& histSample,
+								 std::vector<PiecewiseInterpolation*>& interps,
+								 std::vector<ParamHistFunc*>& gammas)
+{
+  if (!func.dependsOn(obs)) {
+    addScalar(func,sample) ;
+    return ;
+  }
+
+  RooProduct* prod = dynamic_cast<RooProduct*>(&func) ;
+  if (prod) {
+    RooArgList comps(prod->components()) ;
+    RooFIter iter = comps.fwdIterator() ;
+    RooAbsArg* arg ;
+    while((arg=iter.next())) {
+      RooAbsReal* comp = dynamic_cast<RooAbsReal*>(arg) ;
+      if (!comp) {
+	coutE(InputArguments) << "HistFactoryBinnedNLL::collectFactors(" << GetName() << ") ERROR: cannot flatten non-real component "
+			      << arg->GetName() << " of " << func.GetName() << endl ;
+	throw hf_exc() ;
+      }
+      collectFactors(*comp,obs,sample,hists,histSample,interps,gammas) ;
+    }
+    return ;
+  }
+
+  if (dynamic_cast<RooHistFunc*>(&func)) {
+    hists.push_back(&func) ;
+    histSample.push_back(sample) ;
+    return ;
+  }
+
+  PiecewiseInterpolation* interp = dynamic_cast<PiecewiseInterpolation*>(&func) ;
+  if (interp) {
+    Bool_t ok = dynamic_cast<const RooHistFunc*>(&interp->nominalHist())!=0 ;
+    RooFIter liter = interp->lowList().fwdIterator() ;
+    RooFIter hiter = interp->highList().fwdIterator() ;
+    RooFIter piter = interp->paramList().fwdIterator() ;
+    RooAbsArg* arg ;
+    while((arg=liter.next())) ok &= dynamic_cast<RooHistFunc*>(arg)!=0 ;
+    while((arg=hiter.next())) ok &= dynamic_cast<RooHistFunc*>(arg)!=0 ;
+    while((arg=piter.next())) ok &= !arg->dependsOn(obs) ;
+    for (unsigned int k=0 ; k<interp->interpolationCodes().size() ; k++) {
+      if (interp->interpolationCodes()[k]<0 || interp->interpolationCodes()[k]>5) ok = kFALSE ;
+    }
+    if (!ok) {
+      coutE(InputArguments) << "HistFactoryBinnedNLL::collectFactors(" << GetName() << ") ERROR: cannot flatten "
+			    << func.GetName() << ", only interpolations between RooHistFunc templates are supported" << endl ;
+      throw hf_exc() ;
+    }
+    interps.push_back(interp) ;
+    return ;
+  }
+
+  ParamHistFunc* phf = dynamic_cast<ParamHistFunc*>(&func) ;
+  if (phf && !obs.overlaps(phf->paramList())) {
+    gammas.push_back(phf) ;
+    return ;
+  }
+
+  coutE(InputArguments) << "HistFactoryBinnedNLL::collectFactors(" << GetName() << ") ERROR: cannot flatten component "
+			<< func.GetName() << " of type " << func.IsA()->GetName() << endl ;
+  throw hf_exc() ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Add 'param' to the list of bin-wise modifier parameters, if not yet
+/// present, and return its index
+
+Int_t RooStats::HistFactory::HistFactoryBinnedNLL::addParameter(RooAbsReal& param)
+{
+  Int_t idx = _params.index(&param) ;
+  if (idx<0) {
+    _params.add(param) ;
+    idx = _params.getSize()-1 ;
+  }
+  return idx ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Register 'scalar' as a bin-independent factor of sample 'sample' and
+/// return its index in the list of scalars
+
+Int_t RooStats::HistFactory::HistFactoryBinnedNLL::addScalar(RooAbsReal& scalar, Int_t sample)
+{
+  Int_t idx = _scalars.index(&scalar) ;
+  if (idx<0) {
+    _scalars.add(scalar) ;
+    idx = _scalars.getSize()-1 ;
+  }
+  _scalarIdx.push_back(idx) ;
+  _scalarSample.push_back(sample) ;
+  return idx ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Apply the variations of interpolation 'interp' to its nominal yields and
+/// store the result in 'sum'. The arithmetic per bin is the same as in
+/// PiecewiseInterpolation::evaluate(), but the loop over bins is innermost.
+
+void RooStats::HistFactory::HistFactoryBinnedNLL::applyInterpolation(Int_t interp, Double_t* sum) const
+{
+  const Int_t n = _nBins ;
+  const Double_t* nom = &_interpNominal[interp*n] ;
+  for (Int_t b=0 ; b<n ; b++) sum[b] = nom[b] ;
+
+  for (Int_t v=_varBegin[interp] ; v<_varBegin[interp+1] ; v++) {
+    const Double_t x = _paramVals[_varParam[v]] ;
+    const Double_t* low = &_varLow[v*n] ;
+    const Double_t* high = &_varHigh[v*n] ;
+
+    switch(_varCode[v]) {
+    case 0: {
+      // piece-wise linear
+      if (x>0) {
+	for (Int_t b=0 ; b<n ; b++) sum[b] += x*(high[b] - nom[b]) ;
+      } else {
+	for (Int_t b=0 ; b<n ; b++) sum[b] += x*(nom[b] - low[b]) ;
+      }
+      break ;
+    }
+    case 1: {
+      // piece-wise log
+      if (x>=0) {
+	for (Int_t b=0 ; b<n ; b++) sum[b] *= pow(high[b]/nom[b], +x) ;
+      } else {
+	for (Int_t b=0 ; b<n ; b++) sum[b] *= pow(low[b]/nom[b], -x) ;
+      }
+      break ;
+    }
+    case 2:
+    case 3: {
+      // parabolic with linear extrapolation
+      for (Int_t b=0 ; b<n ; b++) {
+	double a = 0.5*(high[b]+low[b])-nom[b] ;
+	double bb = 0.5*(high[b]-low[b]) ;
+	if (x>1) {
+	  sum[b] += (2*a+bb)*(x-1)+high[b]-nom[b] ;
+	} else if (x<-1) {
+	  sum[b] += -1*(2*a-bb)*(x+1)+low[b]-nom[b] ;
+	} else {
+	  sum[b] += a*pow(x,2) + bb*x ;
+	}
+      }
+      break ;
+    }
+    case 4: {
+      // 6th order polynomial with linear extrapolation
+      if (x>1) {
+	for (Int_t b=0 ; b<n ; b++) sum[b] += x*(high[b] - nom[b]) ;
+      } else if (x<-1) {
+	for (Int_t b=0 ; b<n ; b++) sum[b] += x*(nom[b] - low[b]) ;
+      } else {
+	const Double_t poly = 15 + x * x * (-10 + x * x * 3) ;
+	for (Int_t b=0 ; b<n ; b++) {
+	  double eps_plus = high[b] - nom[b] ;
+	  double eps_minus = nom[b] - low[b] ;
+	  double S = 0.5 * (eps_plus + eps_minus) ;
+	  double A = 0.0625 * (eps_plus - eps_minus) ;
+	  double val = nom[b] + x * (S + x * A * poly) ;
+	  if (val < 0) val = 0 ;
+	  sum[b] += val-nom[b] ;
+	}
+      }
+      break ;
+    }
+    case 5: {
+      // 4th order polynomial with linear extrapolation
+      if (x>1 || x<-1) {
+	if (x>0) {
+	  for (Int_t b=0 ; b<n ; b++) sum[b] += x*(high[b] - nom[b]) ;
+	} else {
+	  for (Int_t b=0 ; b<n ; b++) sum[b] += x*(nom[b] - low[b]) ;
+	}
+      } else {
+	for (Int_t b=0 ; b<n ; b++) {
+	  if (nom[b]==0) continue ;
+	  double eps_plus = high[b] - nom[b] ;
+	  double eps_minus = nom[b] - low[b] ;
+	  double S = (eps_plus + eps_minus)/2 ;
+	  double A = (eps_plus - eps_minus)/2 ;
+	  double val = nom[b] + S*x + 3*A/2*pow(x,2) - A/2*pow(x,4) ;
+	  if (val < 0) val = 0 ;
+	  sum[b] += val-nom[b] ;
+	}
+      }
+      break ;
+    }
+    default:
+      break ;
+    }
+  }
+
+  if (_interpPosDef[interp]) {
+    for (Int_t b=0 ; b<n ; b++) if (sum[b]<0) sum[b] = 0 ;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compute the expected yield density in every bin, i.e. the value of the
+/// (unnormalized) channel RooRealSumPdf at each bin
+
+void RooStats::HistFactory::HistFactoryBinnedNLL::computeYields() const
+{
+  const Int_t n = _nBins ;
+  _paramVals.resize(_params.getSize()) ;
+  _sampleNorm.assign(_nSamples,1.) ;
+  _yields.assign(n,0.) ;
+  _work.resize(n) ;
+  _interpSum.resize(n) ;
+
+  // Read every parameter and scalar factor only once
+  RooFIter piter = _params.fwdIterator() ;
+  RooAbsReal* arg ;
+  Int_t k(0) ;
+  while((arg=(RooAbsReal*)piter.next())) _paramVals[k++] = arg->getVal() ;
+
+  std::vector<Double_t> scalarVals(_scalars.getSize()) ;
+  RooFIter siter = _scalars.fwdIterator() ;
+  k = 0 ;
+  while((arg=(RooAbsReal*)siter.next())) scalarVals[k++] = arg->getVal() ;
+  for (unsigned int t=0 ; t<_scalarIdx.size() ; t++) {
+    _sampleNorm[_scalarSample[t]] *= scalarVals[_scalarIdx[t]] ;
+  }
+
+  Double_t* work = &_work[0] ;
+  Double_t* isum = &_interpSum[0] ;
+  Double_t* yields = &_yields[0] ;
+  for (Int_t s=0 ; s<_nSamples ; s++) {
+    const Double_t norm = _sampleNorm[s] ;
+    if (norm==0) continue ;
+
+    const Double_t* base = &_base[s*n] ;
+    for (Int_t b=0 ; b<n ; b++) work[b] = norm*base[b] ;
+
+    for (Int_t m=_interpBegin[s] ; m<_interpBegin[s+1] ; m++) {
+      applyInterpolation(m,isum) ;
+      for (Int_t b=0 ; b<n ; b++) work[b] *= isum[b] ;
+    }
+
+    for (Int_t g=_gammaBegin[s] ; g<_gammaBegin[s+1] ; g++) {
+      const Int_t* idx = &_gammaIdx[g*n] ;
+      for (Int_t b=0 ; b<n ; b++) work[b] *= _paramVals[idx[b]] ;
+    }
+
+    for (Int_t b=0 ; b<n ; b++) yields[b] += work[b] ;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return the expected number of events per bin at the current parameter values
+
+const std::vector<Double_t>& RooStats::HistFactory::HistFactoryBinnedNLL::expectedYields() const
+{
+  computeYields() ;
+  for (Int_t i=0 ; i<_nBins ; i++) _yields[i] *= _binw[i] ;
+  return _yields ;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Sum of -log(Poisson(N_i|mu_i)) over all bins, with the same conventions as
+/// the binned likelihood mode of RooNLLVar
+
+Double_t RooStats::HistFactory::HistFactoryBinnedNLL::evaluate() const
+{
+  computeYields() ;
+
+  Double_t result(0), carry(0) ;
+  for (Int_t i=0 ; i<_nBins ; i++) {
+    Double_t N = _data[i] ;
+    Double_t mu = _yields[i]*_binw[i] ;
+
+    if (mu<=0 && N>0) {
+
+      // Catch error condition: data present where zero events are predicted
+      logEvalError(Form("Observed %f events in bin %d with zero event yield",N,i)) ;
+
+    } else if (fabs(mu)<1e-10 && fabs(N)<1e-10) {
+
+      // log(Poisson(0,0))=0, nothing to add
+
+    } else {
+
+      Double_t term = -1*(-mu + N*log(mu) - _lnGammaN[i]) ;
+
+      // Kahan summation of result
+      Double_t y = term - carry ;
+      Double_t t = result + y ;
+      carry = (t - result) - y ;
+      result = t ;
+    }
+  }
+
+  return result ;
+}
@@ -27,6 +27,7 @@ END_HTML
 #include "RooRealVar.h"
 #include "RooConstVar.h"
 #include "RooAddition.h"
+#include "RooConstraintSum.h"
 #include "RooProduct.h"
 #include "RooProdPdf.h"
 #include "RooAddPdf.h"
@@ -75,6 +76,7 @@ END_HTML
 #include "RooStats/HistFactory/LinInterpVar.h"
 #include "RooStats/HistFactory/FlexibleInterpVar.h"
 #include "RooStats/HistFactory/HistoToWorkspaceFactoryFast.h"
+#include "RooStats/HistFactory/HistFactoryBinnedNLL.h"
 #include "RooStats/HistFactory/Measurement.h"
 #include "Helper.h"
 
@@ -99,7 +101,7 @@ namespace HistFactory{
 
   HistoToWorkspaceFactoryFast::HistoToWorkspaceFactoryFast() : 
        fNomLumi(1.0), fLumiError(0),   
-       fLowBin(0), fHighBin(0)  
+       fLowBin(0), fHighBin(0), fMakeBinnedNLL(false)
   {}
 
   HistoToWorkspaceFactoryFast::~HistoToWorkspaceFactoryFast(){
@@ -111,7 +113,8 @@ namespace HistFactory{
     fNomLumi( measurement.GetLumi() ),
     fLumiError( measurement.GetLumi()*measurement.GetLumiRelErr() ),
     fLowBin( measurement.GetBinLow() ),
-    fHighBin( measurement.GetBinHigh() ) {
+    fHighBin( measurement.GetBinHigh() ),
+    fMakeBinnedNLL( measurement.GetBinnedNLL() ) {
 
     // Set Preprocess functions
     SetFunctionsToPreprocess( measurement.GetPreprocessFunctions() );
@@ -2026,6 +2029,10 @@ namespace HistFactory{
     delete model;
     delete proto_config;
     delete asimov_dataset; 
+
+    if( fMakeBinnedNLL ) {
+      MakeBinnedNLL( proto, std::vector<std::string>(1, channel_name) );
+    }
     
     proto->Print();
     return proto;
@@ -2306,6 +2313,10 @@ namespace HistFactory{
     combined->importClassCode();
     //    combined->writeToFile("results/model_combined.root");
 
+    if( fMakeBinnedNLL ) {
+      MakeBinnedNLL( combined, ch_names, channelCat );
+    }
+
     //clean up
     delete combined_config;
     delete simPdf; 
@@ -2314,6 +2325,76 @@ namespace HistFactory{
   }
 
 
+  void HistoToWorkspaceFactoryFast::MakeBinnedNLL(RooWorkspace* ws, std::vector<std::string> channel_names,
+						  RooCategory* channelCat) {
+
+    // Build the flattened binned likelihood of the model in 'ws' for the
+    // observed data and import it as 'binnedNLL': the sum of one
+    // HistFactoryBinnedNLL per channel and of the constraint terms.
+    // If any channel cannot be flattened, nothing is imported and the
+    // model has to be fit with the usual createNLL.
+
+    ModelConfig* config = (ModelConfig*) ws->obj("ModelConfig");
+    RooAbsData* data = ws->data("obsData");
+    if( config==NULL || config->GetPdf()==NULL || data==NULL ) {
+      std::cout << "Warning: No model or no observed data in workspace: " << ws->GetName()
+		<< ", not creating binnedNLL" << std::endl;
+      return;
+    }
+
+    RooArgList nllTerms;
+    for( unsigned int i=0; i < channel_names.size(); ++i ) {
+      std::string channel_name = channel_names[i];
+
+      RooRealSumPdf* sumPdf = dynamic_cast<RooRealSumPdf*>( ws->pdf((channel_name+"_model").c_str()) );
+      if( sumPdf==NULL ) {
+	std::cout << "Warning: Cannot find RooRealSumPdf " << channel_name << "_model"
+		  << ", not creating binnedNLL" << std::endl;
+	return;
+      }
+
+      RooAbsData* channelData = data;
+      if( channelCat ) {
+	channelData = data->reduce( Form("%s==%s::%s", channelCat->GetName(), 
+					 channelCat->GetName(), channel_name.c_str()) );
+      }
+
+      HistFactoryBinnedNLL* channelNLL = NULL;
+      try {
+	channelNLL = new HistFactoryBinnedNLL( ("binnedNLL_"+channel_name).c_str(), 
+					       ("-log(L) of channel "+channel_name).c_str(),
+					       *sumPdf, *channelData );
+      }
+      catch( hf_exc& ) {
+	channelNLL = NULL;
+      }
+      if( channelCat ) delete channelData;
+
+      if( channelNLL==NULL ) {
+	std::cout << "Warning: Cannot flatten model of channel " << channel_name
+		  << ", not creating binnedNLL" << std::endl;
+	return;
+      }
+      nllTerms.addOwned( *channelNLL );
+    }
+
+    // Constraint terms, normalized as in RooAbsPdf::createNLL
+    RooAbsPdf* pdf = config->GetPdf();
+    RooArgSet* constrainedParams = pdf->getParameters( *data );
+    RooArgSet* constraints = pdf->getAllConstraints( *data->get(), *constrainedParams );
+    const RooArgSet* normSet = config->GetGlobalObservables() ? config->GetGlobalObservables() : constrainedParams;
+    RooConstraintSum constraintSum( "binnedNLL_constr", "-log(constraints)", *constraints, *normSet );
+
+    RooArgList allTerms( nllTerms );
+    allTerms.add( constraintSum );
+    RooAddition binnedNLL( "binnedNLL", "flattened binned -log(L)", allTerms );
+    ws->import( binnedNLL, RecycleConflictNodes() );
+
+    delete constraints;
+    delete constrainedParams;
+  }
+
+
   RooDataSet* HistoToWorkspaceFactoryFast::MergeDataSets(RooWorkspace* combined,
 							 std::vector<RooWorkspace*> wspace_vec, 
 							 std::vector<std::string> channel_names, 
@@ -40,7 +40,7 @@ ClassImp(RooStats::HistFactory::Measurement) ;
 
 RooStats::HistFactory::Measurement::Measurement() :
   fPOI(), fLumi( 1.0 ), fLumiRelErr( .10 ), 
-  fBinLow( 0 ), fBinHigh( 1 ), fExportOnly( false )
+  fBinLow( 0 ), fBinHigh( 1 ), fExportOnly( false ), fBinnedNLL( false )
 {
   // standard constructor
 }
@@ -56,7 +56,7 @@ RooStats::HistFactory::Measurement::Measurement(const Measurement& other) :
 RooStats::HistFactory::Measurement::Measurement(const char* Name, const char* Title) :
   TNamed( Name, Title ),
   fPOI(), fLumi( 1.0 ), fLumiRelErr( .10 ), 
-  fBinLow( 0 ), fBinHigh( 1 ), fExportOnly( false )
+  fBinLow( 0 ), fBinHigh( 1 ), fExportOnly( false ), fBinnedNLL( false )
 {
   // standard constructor specifying name and title of measurement
 }
@@ -226,6 +226,7 @@ void RooStats::HistFactory::Measurement::PrintTree( std::ostream& stream )
 	 << "\t BinLow: " << fBinLow
 	 << "\t BinHigh: " << fBinHigh
 	 << "\t ExportOnly: " << fExportOnly
+	 << "\t BinnedNLL: " << fBinnedNLL
 	 << std::endl;
 
 
@@ -353,6 +354,7 @@ void RooStats::HistFactory::Measurement::PrintXML( std::string directory, std::s
     //<< "BinLow=\""      << fBinLow     << "\" "
     // << "BinHigh=\""     << fBinHigh    << "\" "
       << "ExportOnly=\""  << (fExportOnly ? std::string("True") : std::string("False")) << "\" "
+      << "BinnedNLL=\""   << (fBinnedNLL ? std::string("True") : std::string("False")) << "\" "
       << " >" <<  std::endl;
 
 
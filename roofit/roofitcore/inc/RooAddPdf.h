@@ -25,6 +25,10 @@
 #include "RooCacheManager.h"
 #include "RooObjCacheManager.h"
 #include "RooNameReg.h"
+#include <vector>
+
+class RooChangeTracker ;
+class RooAbsRealLValue ;
 
 class RooAddPdf : public RooAbsPdf {
 public:
@@ -105,7 +109,8 @@ protected:
 
   class CacheElem : public RooAbsCacheElement {
   public:
-    virtual ~CacheElem() {} ;
+    CacheElem() : _coefTracker(0) {} ;
+    virtual ~CacheElem() ;
 
     RooArgList _suppNormList ; // Supplemental normalization list
     Bool_t    _needSupNorm ; // Does the above list contain any non-unit entries?
@@ -115,12 +120,22 @@ protected:
     RooArgList _refRangeProjList ; // Range integrals to be multiplied with coefficients (reference range)
     RooArgList _rangeProjList ; // Range integrals to be multiplied with coefficients (target range)
 
+    RooChangeTracker* _coefTracker ; // Tracker of the variables on which the transformed coefficients depend (if not event dependent)
+    std::vector<Double_t> _coefValues ; // Transformed coefficients at the last tracked parameter values
+    std::vector<const RooAbsArg*> _normSetArgs ; // Contents of the normalization set for which the element was made
+    std::vector<std::pair<const RooAbsRealLValue*,const char*> > _rangeObs ; // Observables and ranges (0: default) integrated in the coefficients
+    std::vector<Double_t> _rangeBounds ; // Bounds of these ranges at the last calculation of the coefficients
+
+    Bool_t sameNormSet(const RooArgSet* nset) const ;
+    Bool_t rangesChanged() ;
+
     virtual RooArgList containedArgs(Action) ;
 
   } ;
   mutable RooObjCacheManager _projCacheMgr ;  // Manager of cache with coefficient projections and transformations
   CacheElem* getProjCache(const RooArgSet* nset, const RooArgSet* iset=0, const char* rangeName=0) const ;
   void updateCoefficients(CacheElem& cache, const RooArgSet* nset) const ;
+  void computeCoefficients(CacheElem& cache, const RooArgSet* nset) const ;
 
   
   friend class RooAddGenContext ;
@@ -19,13 +19,16 @@
 #include "RooHistPdf.h"
 #include "TVirtualFFT.h"
 class RooRealVar ;
+class RooChangeTracker ;
 
 #include <map>
+#include <list>
+#include <vector>
  
 class RooFFTConvPdf : public RooAbsCachedPdf {
 public:
 
-  RooFFTConvPdf() {
+  RooFFTConvPdf() : _paramCacheSize(10) {
     // coverity[UNINIT_CTOR]
   } ;
   RooFFTConvPdf(const char *name, const char *title, RooRealVar& convVar, RooAbsPdf& pdf1, RooAbsPdf& pdf2, Int_t ipOrder=2);
@@ -55,6 +58,12 @@ public:
   void setBufferStrategy(BufStrat bs) ;
   void setBufferFraction(Double_t frac) ;
 
+  void setParamCacheSize(Int_t n) ;
+  Int_t paramCacheSize() const { 
+    // Return the number of recent parameter points for which the convolution output is kept
+    return _paramCacheSize ; 
+  }
+
   void printMetaArgs(std::ostream& os) const ;
 
   // Propagate maximum value estimate of pdf1 as convolution can only result in lower max values
@@ -89,6 +98,19 @@ protected:
     RooAbsPdf* pdf1Clone ;
     RooAbsPdf* pdf2Clone ;
 
+    RooChangeTracker* pdf1Tracker ; // Tracks parameters of pdf1Clone
+    RooChangeTracker* pdf2Tracker ; // Tracks parameters of pdf2Clone
+    std::vector<Double_t> fft1 ;    // Forward transforms of pdf1 for all slices (re,im interleaved)
+    std::vector<Double_t> fft2 ;    // Forward transforms of pdf2 for all slices (re,im interleaved)
+    Bool_t reuse1 ;                 // Reuse fft1 in current fill
+    Bool_t reuse2 ;                 // Reuse fft2 in current fill
+    Int_t slice ;                   // Index of slice being filled
+    Int_t N, N2 ;                   // Number of bins without and with buffer
+    Int_t binShift1 ;               // Zero bin of pdf1 sampling
+
+    // Cache contents for recent parameter points, most recent first
+    std::list<std::pair<std::vector<Double_t>,std::vector<Double_t> > > paramCache ;
+
     RooAbsBinning* histBinning ;
     RooAbsBinning* scanBinning ;
 
@@ -102,6 +124,7 @@ protected:
   virtual RooArgSet* actualParameters(const RooArgSet& nset) const ;
   virtual RooAbsArg& pdfObservable(RooAbsArg& histObservable) const ;
   virtual void fillCacheObject(PdfCacheElem& cache) const ;
+  void fillCacheSlices(FFTCacheElem& cache) const ;
   void fillCacheSlice(FFTCacheElem& cache, const RooArgSet& slicePosition) const ;
 
   virtual PdfCacheElem* createCache(const RooArgSet* nset) const ;
@@ -114,6 +137,8 @@ protected:
   Double_t  _shift1 ; 
   Double_t  _shift2 ; 
 
+  Int_t _paramCacheSize ; // Number of recent parameter points for which the convolution output is kept
+
   virtual RooAbsGenContext* genContext(const RooArgSet &vars, const RooDataSet *prototype=0, 
                                        const RooArgSet* auxProto=0, Bool_t verbose= kFALSE) const ;
 
@@ -122,7 +147,7 @@ protected:
 
 private:
 
-  ClassDef(RooFFTConvPdf,1) // Convolution operator p.d.f based on numeric Fourier transforms
+  ClassDef(RooFFTConvPdf,2) // Convolution operator p.d.f based on numeric Fourier transforms
 };
  
 #endif
@@ -62,6 +62,7 @@ of each coefficient_i.
 #include "TIterator.h"
 #include "TIterator.h"
 #include "TList.h"
+#include "TObjArray.h"
 #include "RooAddPdf.h"
 #include "RooDataSet.h"
 #include "RooRealProxy.h"
@@ -75,6 +76,7 @@ of each coefficient_i.
 #include "RooGlobalFunc.h"
 #include "RooRealIntegral.h"
 #include "RooTrace.h"
+#include "RooChangeTracker.h"
 
 #include "Riostream.h"
 #include <algorithm>
@@ -434,7 +436,13 @@ RooAddPdf::CacheElem* RooAddPdf::getProjCache(const RooArgSet* nset, const RooAr
   // Check if cache already exists 
   CacheElem* cache = (CacheElem*) _projCacheMgr.getObj(nset,iset,0,rangeName) ;
   if (cache) {
-    return cache ;
+    if (cache->sameNormSet(nset)) {
+      return cache ;
+    }
+    // The normalization set was changed in place, or another set is at its address: the
+    // supplemental normalizations and projections made for the old contents are wrong
+    cxcoutD(Caching) << "RooAddPdf::getProjCache(" << GetName() << ") normalization set changed, clearing cache" << endl ;
+    _projCacheMgr.reset() ;
   }
 
   //Create new cache 
@@ -499,7 +507,76 @@ RooAddPdf::CacheElem* RooAddPdf::getProjCache(const RooArgSet* nset, const RooAr
   }
 
 
-  // *** PART 2 : Create projection coefficients ***
+  // *** PART 2 : Create tracker of the variables on which the coefficients depend ***
+
+  // The transformed coefficients depend on all the variables of the coefficients, and on
+  // the parameters of the component p.d.f.s if these are extended or if the coefficients
+  // are projected: the projection integrals run over the observables. If a variable of the
+  // coefficients is an observable of the normalization set, the coefficients change from
+  // event to event: no tracker is made then and the coefficients are recalculated at every
+  // evaluation
+  RooArgSet coefVars ;
+  RooFIter citer = _coefList.fwdIterator() ;
+  RooAbsArg* carg ;
+  while((carg=citer.next())) {
+    RooArgSet* vars = carg->getVariables() ;
+    coefVars.add(*vars,kTRUE) ;
+    delete vars ;
+  }
+  Bool_t projected = _projectCoefs || rangeName || _normRange.Length()>0 ;
+  if (_allExtendable || projected) {
+    RooFIter piter = _pdfList.fwdIterator() ;
+    while((carg=piter.next())) {
+      RooArgSet* vars = carg->getParameters(nset) ;
+      coefVars.add(*vars,kTRUE) ;
+      delete vars ;
+    }
+  }
+  if (!nset || !coefVars.overlaps(*nset)) {
+    TString trackerName(GetName()) ;
+    trackerName.Append("_CoefTracker") ;
+    cache->_coefTracker = new RooChangeTracker(trackerName,"Coefficient variable tracker",coefVars,kTRUE) ;
+  }
+
+  // The supplemental normalization and projection integrals also depend on the ranges of
+  // the observables, which the tracker does not see: their bounds are kept with the element
+  if (nset) {
+    RooFIter niter = nset->fwdIterator() ;
+    while((carg=niter.next())) {
+      cache->_normSetArgs.push_back(carg) ;
+    }
+  }
+  std::vector<const char*> rangeNames(1,(const char*)0) ;
+  if (rangeName) rangeNames.push_back(RooNameReg::str(RooNameReg::ptr(rangeName))) ;
+  if (_refCoefRangeName) rangeNames.push_back(RooNameReg::str(_refCoefRangeName)) ;
+  if (_normRange.Length()>0) {
+    TObjArray* tokens = _normRange.Tokenize(",") ;
+    for (Int_t i=0 ; i<tokens->GetEntries() ; i++) {
+      rangeNames.push_back(RooNameReg::str(RooNameReg::ptr(tokens->At(i)->GetName()))) ;
+    }
+    delete tokens ;
+  }
+  RooArgSet rangeObs ;
+  RooArgSet* obs = getObservables(nset) ;
+  rangeObs.add(*obs) ;
+  delete obs ;
+  obs = getObservables(_refCoefNorm) ;
+  rangeObs.add(*obs,kTRUE) ;
+  delete obs ;
+  RooFIter oiter = rangeObs.fwdIterator() ;
+  while((carg=oiter.next())) {
+    RooAbsRealLValue* lvalue = dynamic_cast<RooAbsRealLValue*>(carg) ;
+    if (!lvalue) continue ;
+    for (std::vector<const char*>::iterator rname = rangeNames.begin() ; rname != rangeNames.end() ; ++rname) {
+      if (*rname==0 || lvalue->hasRange(*rname)) {
+        cache->_rangeObs.push_back(std::make_pair((const RooAbsRealLValue*)lvalue,*rname)) ;
+      }
+    }
+  }
+  cache->rangesChanged() ;
+
+
+  // *** PART 3 : Create projection coefficients ***
 
 //   cout << " this = " << this << " (" << GetName() << ")" << endl ;
 //   cout << "projectCoefs = " << (_projectCoefs?"T":"F") << endl ;
@@ -671,12 +748,32 @@ RooAddPdf::CacheElem* RooAddPdf::getProjCache(const RooArgSet* nset, const RooAr
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/// Update the coefficient values in the given cache element: calculate new remainder
+/// Update the coefficient values in the given cache element. The transformed
+/// coefficients are only recalculated if any of the variables they depend on
+/// or any range of the observables has changed since the last calculation with
+/// this cache element, otherwise the stored values are reused
+
+void RooAddPdf::updateCoefficients(CacheElem& cache, const RooArgSet* nset) const 
+{
+  Bool_t rangesChanged = cache.rangesChanged() ;
+  if (cache._coefTracker && !cache._coefTracker->hasChanged(kTRUE) && !rangesChanged) {
+    std::copy(cache._coefValues.begin(),cache._coefValues.end(),_coefCache) ;
+    return ;
+  }
+
+  computeCoefficients(cache,nset) ;
+  cache._coefValues.assign(_coefCache,_coefCache+_pdfList.getSize()) ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Calculate the coefficient values for the given cache element: calculate new remainder
 /// fraction, normalize fractions obtained from extended ML terms to unity and
 /// multiply these the various range and dimensional corrections needed in the
 /// current use context
 
-void RooAddPdf::updateCoefficients(CacheElem& cache, const RooArgSet* nset) const 
+void RooAddPdf::computeCoefficients(CacheElem& cache, const RooArgSet* nset) const 
 {
   // cxcoutD(ChangeTracking) << "RooAddPdf::updateCoefficients(" << GetName() << ") update coefficients" << endl ;
   
@@ -1171,12 +1268,64 @@ RooArgList RooAddPdf::CacheElem::containedArgs(Action)
   allNodes.add(_suppProjList) ;
   allNodes.add(_refRangeProjList) ;
   allNodes.add(_rangeProjList) ;
+  if (_coefTracker) allNodes.add(*_coefTracker) ;
 
   return allNodes ;
 }
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Destructor
+
+RooAddPdf::CacheElem::~CacheElem() 
+{
+  delete _coefTracker ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if nset has the contents of the normalization set for which
+/// this element was made
+
+Bool_t RooAddPdf::CacheElem::sameNormSet(const RooArgSet* nset) const
+{
+  if (!nset) return _normSetArgs.empty() ;
+  if (nset->getSize() != (Int_t)_normSetArgs.size()) return kFALSE ;
+  RooFIter iter = nset->fwdIterator() ;
+  RooAbsArg* arg ;
+  Int_t i(0) ;
+  while((arg=iter.next())) {
+    if (arg != _normSetArgs[i++]) return kFALSE ;
+  }
+  return kTRUE ;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Return true if the bounds of any range integrated in the transformed
+/// coefficients changed since the last call, and store the current bounds
+
+Bool_t RooAddPdf::CacheElem::rangesChanged()
+{
+  Bool_t changed(kFALSE) ;
+  _rangeBounds.resize(2*_rangeObs.size()) ;
+  for (UInt_t i=0 ; i<_rangeObs.size() ; i++) {
+    Double_t lo = _rangeObs[i].first->getMin(_rangeObs[i].second) ;
+    Double_t hi = _rangeObs[i].first->getMax(_rangeObs[i].second) ;
+    if (lo != _rangeBounds[2*i] || hi != _rangeBounds[2*i+1]) {
+      _rangeBounds[2*i] = lo ;
+      _rangeBounds[2*i+1] = hi ;
+      changed = kTRUE ;
+    }
+  }
+  return changed ;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Loop over components for plot sampling hints and merge them if there are multiple
 
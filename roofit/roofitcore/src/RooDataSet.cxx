@@ -494,9 +494,7 @@ RooDataSet::RooDataSet(const char* name, const char* title, const RooArgSet& var
 	if (tstore) {
 	  tstore->loadValues(impTree,&cutVarTmp,cutRange);      
 	} else {
-	  RooTreeDataStore tmpstore(name,title,_vars,wgtVarName) ;
-	  tmpstore.loadValues(impTree,&cutVarTmp,cutRange) ;
-	  _dstore->append(tmpstore) ;
+	  vstore->loadValues(impTree,&cutVarTmp,cutRange) ;
 	}
       } else if (fname && strlen(fname)) {
 
@@ -515,9 +513,7 @@ RooDataSet::RooDataSet(const char* name, const char* title, const RooArgSet& var
 	if (tstore) {
 	  tstore->loadValues(t,&cutVarTmp,cutRange);      	
 	} else {
-	  RooTreeDataStore tmpstore(name,title,_vars,wgtVarName) ;
-	  tmpstore.loadValues(t,&cutVarTmp,cutRange) ;
-	  _dstore->append(tmpstore) ;
+	  vstore->loadValues(t,&cutVarTmp,cutRange) ;
 	}
 	f->Close() ;
 
@@ -553,9 +549,7 @@ RooDataSet::RooDataSet(const char* name, const char* title, const RooArgSet& var
 	if (tstore) {
 	  tstore->loadValues(impTree,cutVar,cutRange);
 	} else {
-	  RooTreeDataStore tmpstore(name,title,_vars,wgtVarName) ;
-	  tmpstore.loadValues(impTree,cutVar,cutRange) ;
-	  _dstore->append(tmpstore) ;
+	  vstore->loadValues(impTree,cutVar,cutRange) ;
 	}
 	} else if (fname && strlen(fname)) {
 	// Case 5b --- Import TTree from file with cutvar
@@ -572,9 +566,7 @@ RooDataSet::RooDataSet(const char* name, const char* title, const RooArgSet& var
 	if (tstore) {
 	  tstore->loadValues(t,cutVar,cutRange);      	
 	} else {
-	  RooTreeDataStore tmpstore(name,title,_vars,wgtVarName) ;
-	  tmpstore.loadValues(t,cutVar,cutRange) ;
-	  _dstore->append(tmpstore) ;
+	  vstore->loadValues(t,cutVar,cutRange) ;
 	}
 
 	f->Close() ;
@@ -609,9 +601,7 @@ RooDataSet::RooDataSet(const char* name, const char* title, const RooArgSet& var
 	if (tstore) {
 	  tstore->loadValues(impTree,0,cutRange);
 	} else {
-	  RooTreeDataStore tmpstore(name,title,_vars,wgtVarName) ;
-	  tmpstore.loadValues(impTree,0,cutRange) ;
-	  _dstore->append(tmpstore) ;
+	  vstore->loadValues(impTree,0,cutRange) ;
 	}
       } else if (fname && strlen(fname)) {
 	// Case 5c --- Import TTree from file
@@ -628,9 +618,7 @@ RooDataSet::RooDataSet(const char* name, const char* title, const RooArgSet& var
 	if (tstore) {
 	  tstore->loadValues(t,0,cutRange);      	
 	} else {
-	  RooTreeDataStore tmpstore(name,title,_vars,wgtVarName) ;
-	  tmpstore.loadValues(t,0,cutRange) ;
-	  _dstore->append(tmpstore) ;
+	  vstore->loadValues(t,0,cutRange) ;
 	}
 	f->Close() ;
       }
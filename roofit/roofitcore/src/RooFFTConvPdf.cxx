@@ -44,7 +44,13 @@
  // p.d.f at all points in observables space for the given choice of parameters,
  // which are stored in the cache. Subsequent evaluations of RooFFTConvPdf with
  // identical parameters will retrieve results from the cache. If one or more
- // of the parameters change, the cache will be updated.
+ // of the parameters change, the cache will be updated. If only the parameters
+ // of one of the input p.d.f.s changed, the stored transform of the other input is
+ // reused, e.g. a resolution model with fixed parameters is sampled and transformed
+ // only once. The outputs for the last few parameter points are also retained, so
+ // that returning to a recently visited point, as happens during numeric gradient
+ // calculation, requires no FFT at all. The number of retained points (default 10)
+ // can be changed with setParamCacheSize().
  // 
  // The sampling density of the cache is controlled by the binning of the 
  // the convolution observable, which can be changed from RooRealVar::setBins(N)
@@ -119,6 +125,8 @@
 #include "RooGlobalFunc.h"
 #include "RooLinearVar.h"
 #include "RooConstVar.h"
+#include "RooChangeTracker.h"
+#include "RooAbsCategory.h"
 #include "TClass.h"
 #include "TSystem.h"
 
@@ -144,6 +152,7 @@ RooFFTConvPdf::RooFFTConvPdf(const char *name, const char *title, RooRealVar& co
   _bufStrat(Extend),
   _shift1(0),
   _shift2(0),
+  _paramCacheSize(10),
   _cacheObs("!cacheObs","Cached observables",this,kFALSE,kFALSE)
  { 
    if (!convVar.hasBinning("cache")) {
@@ -174,6 +183,7 @@ RooFFTConvPdf::RooFFTConvPdf(const char *name, const char *title, RooAbsReal& pd
   _bufStrat(Extend),
   _shift1(0),
   _shift2(0),
+  _paramCacheSize(10),
   _cacheObs("!cacheObs","Cached observables",this,kFALSE,kFALSE)
  { 
    if (!convVar.hasBinning("cache")) {
@@ -201,6 +211,7 @@ RooFFTConvPdf::RooFFTConvPdf(const RooFFTConvPdf& other, const char* name) :
   _bufStrat(other._bufStrat),
   _shift1(other._shift1),
   _shift2(other._shift2),
+  _paramCacheSize(other._paramCacheSize),
   _cacheObs("!cacheObs",this,other._cacheObs)
  { 
  } 
@@ -247,7 +258,9 @@ RooFFTConvPdf::PdfCacheElem* RooFFTConvPdf::createCache(const RooArgSet* nset) c
 
 RooFFTConvPdf::FFTCacheElem::FFTCacheElem(const RooFFTConvPdf& self, const RooArgSet* nsetIn) : 
   PdfCacheElem(self,nsetIn),
-  fftr2c1(0),fftr2c2(0),fftc2r(0) 
+  fftr2c1(0),fftr2c2(0),fftc2r(0),
+  pdf1Tracker(0),pdf2Tracker(0),
+  reuse1(kFALSE),reuse2(kFALSE),slice(0),N(0),N2(0),binShift1(0)
 {
   RooAbsPdf* clonePdf1 = (RooAbsPdf*) self._pdf1.arg().cloneTree() ;
   RooAbsPdf* clonePdf2 = (RooAbsPdf*) self._pdf2.arg().cloneTree() ;
@@ -310,6 +323,15 @@ RooFFTConvPdf::FFTCacheElem::FFTCacheElem(const RooFFTConvPdf& self, const RooAr
 
   delete fftParams ;
 
+  // Track the parameters of each input p.d.f. separately, so that the
+  // transform of an input whose parameters did not change can be reused
+  RooArgSet* params1 = pdf1Clone->getParameters(*hist()->get()) ;
+  RooArgSet* params2 = pdf2Clone->getParameters(*hist()->get()) ;
+  pdf1Tracker = new RooChangeTracker(Form("%s_pdf1Tracker",self.GetName()),"pdf1 parameter tracker",*params1,kTRUE) ;
+  pdf2Tracker = new RooChangeTracker(Form("%s_pdf2Tracker",self.GetName()),"pdf2 parameter tracker",*params2,kTRUE) ;
+  delete params1 ;
+  delete params2 ;
+
   // Save copy of original histX binning and make alternate binning
   // for extended range scanning
 
@@ -353,6 +375,8 @@ RooArgList RooFFTConvPdf::FFTCacheElem::containedArgs(Action a)
   if (pdf2Clone->ownedComponents()) {
     ret.add(*pdf2Clone->ownedComponents()) ;
   }
+  ret.add(*pdf1Tracker) ;
+  ret.add(*pdf2Tracker) ;
 
   return ret ;
 }
@@ -369,6 +393,9 @@ RooFFTConvPdf::FFTCacheElem::~FFTCacheElem()
   delete pdf1Clone ;
   delete pdf2Clone ;
 
+  delete pdf1Tracker ;
+  delete pdf2Tracker ;
+
   delete histBinning ;
   delete scanBinning ;
 
@@ -381,11 +408,68 @@ RooFFTConvPdf::FFTCacheElem::~FFTCacheElem()
 /// Fill the contents of the cache the FFT convolution output
 
 void RooFFTConvPdf::fillCacheObject(RooAbsCachedPdf::PdfCacheElem& cache) const 
+{
+  RooDataHist& cacheHist = *cache.hist() ;
+  FFTCacheElem& aux = (FFTCacheElem&) cache ;
+
+  // Retrieve the output from the list of recent parameter points if available
+  std::vector<Double_t> point ;
+  if (_paramCacheSize>0) {
+    RooArgSet params(cache.paramTracker()->parameters()) ;
+    RooFIter iter = params.fwdIterator() ;
+    RooAbsArg* arg ;
+    while((arg=iter.next())) {
+      RooAbsCategory* cat = dynamic_cast<RooAbsCategory*>(arg) ;
+      point.push_back(cat ? cat->getIndex() : static_cast<RooAbsReal*>(arg)->getVal()) ;
+    }
+
+    std::list<std::pair<std::vector<Double_t>,std::vector<Double_t> > >::iterator piter = aux.paramCache.begin() ;
+    for (; piter!=aux.paramCache.end() ; ++piter) {
+      if (piter->first==point) {
+	for (Int_t i=0 ; i<cacheHist.numEntries() ; i++) {
+	  cacheHist.get(i) ;
+	  cacheHist.set(piter->second[i]) ;
+	}
+	aux.paramCache.splice(aux.paramCache.begin(),aux.paramCache,piter) ;
+	return ;
+      }
+    }
+  }
+
+  // Reuse the transforms of an input p.d.f. whose parameters did not change
+  Bool_t changed1 = aux.pdf1Tracker->hasChanged(kTRUE) ;
+  Bool_t changed2 = aux.pdf2Tracker->hasChanged(kTRUE) ;
+  aux.reuse1 = !changed1 && !aux.fft1.empty() ;
+  aux.reuse2 = !changed2 && !aux.fft2.empty() ;
+  aux.slice = 0 ;
+
+  fillCacheSlices(aux) ;
+
+  // Store the output for the current parameter point
+  if (_paramCacheSize>0) {
+    std::vector<Double_t> weights(cacheHist.numEntries()) ;
+    for (Int_t i=0 ; i<cacheHist.numEntries() ; i++) {
+      cacheHist.get(i) ;
+      weights[i] = cacheHist.weight() ;
+    }
+    aux.paramCache.push_front(std::make_pair(point,weights)) ;
+    while (Int_t(aux.paramCache.size())>_paramCacheSize) {
+      aux.paramCache.pop_back() ;
+    }
+  }
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Fill all slices of the cache histogram with the output of the FFT convolution
+
+void RooFFTConvPdf::fillCacheSlices(FFTCacheElem& cache) const 
 {
   RooDataHist& cacheHist = *cache.hist() ;
   
-  ((FFTCacheElem&)cache).pdf1Clone->setOperMode(ADirty,kTRUE) ;
-  ((FFTCacheElem&)cache).pdf2Clone->setOperMode(ADirty,kTRUE) ;
+  cache.pdf1Clone->setOperMode(ADirty,kTRUE) ;
+  cache.pdf2Clone->setOperMode(ADirty,kTRUE) ;
 
   // Determine if there other observables than the convolution observable in the cache
   RooArgSet otherObs ;
@@ -484,16 +568,19 @@ void RooFFTConvPdf::fillCacheSlice(FFTCacheElem& aux, const RooArgSet& slicePos)
   //
   // 
 
-  Int_t N,N2,binShift1,binShift2 ;
+  // Input p.d.f.s whose parameters did not change since the previous fill
+  // are not sampled again, their stored transform for this slice is used instead
+  Int_t N(aux.N),N2(aux.N2),binShift1(aux.binShift1),binShift2 ;
   
   RooRealVar* histX = (RooRealVar*) cacheHist.get()->find(_x.arg().GetName()) ;
   if (_bufStrat==Extend) histX->setBinning(*aux.scanBinning) ;
-  Double_t* input1 = scanPdf((RooRealVar&)_x.arg(),*aux.pdf1Clone,cacheHist,slicePos,N,N2,binShift1,_shift1) ;
-  Double_t* input2 = scanPdf((RooRealVar&)_x.arg(),*aux.pdf2Clone,cacheHist,slicePos,N,N2,binShift2,_shift2) ;
+  Double_t* input1 = aux.reuse1 ? 0 : scanPdf((RooRealVar&)_x.arg(),*aux.pdf1Clone,cacheHist,slicePos,N,N2,binShift1,_shift1) ;
+  Double_t* input2 = aux.reuse2 ? 0 : scanPdf((RooRealVar&)_x.arg(),*aux.pdf2Clone,cacheHist,slicePos,N,N2,binShift2,_shift2) ;
   if (_bufStrat==Extend) histX->setBinning(*aux.histBinning) ;
 
-
-
+  aux.N = N ;
+  aux.N2 = N2 ;
+  aux.binShift1 = binShift1 ;
 
   // Retrieve previously defined FFT transformation plans
   if (!aux.fftr2c1) {
@@ -501,21 +588,38 @@ void RooFFTConvPdf::fillCacheSlice(FFTCacheElem& aux, const RooArgSet& slicePos)
     aux.fftr2c2 = TVirtualFFT::FFT(1, &N2, "R2CK");
     aux.fftc2r  = TVirtualFFT::FFT(1, &N2, "C2RK");
   }
+
+  // Location of the transforms of this slice in the stored arrays
+  Int_t nc = N2/2+1 ;
+  Int_t offset = 2*nc*aux.slice ;
   
   // Real->Complex FFT Transform on p.d.f. 1 sampling
-  aux.fftr2c1->SetPoints(input1);
-  aux.fftr2c1->Transform();
+  if (!aux.reuse1) {
+    aux.fftr2c1->SetPoints(input1);
+    aux.fftr2c1->Transform();
+    if (Int_t(aux.fft1.size())<offset+2*nc) aux.fft1.resize(offset+2*nc) ;
+    for (Int_t i=0 ; i<nc ; i++) {
+      aux.fftr2c1->GetPointComplex(i,aux.fft1[offset+2*i],aux.fft1[offset+2*i+1]) ;
+    }
+  }
 
   // Real->Complex FFT Transform on p.d.f 2 sampling
-  aux.fftr2c2->SetPoints(input2);
-  aux.fftr2c2->Transform();
+  if (!aux.reuse2) {
+    aux.fftr2c2->SetPoints(input2);
+    aux.fftr2c2->Transform();
+    if (Int_t(aux.fft2.size())<offset+2*nc) aux.fft2.resize(offset+2*nc) ;
+    for (Int_t i=0 ; i<nc ; i++) {
+      aux.fftr2c2->GetPointComplex(i,aux.fft2[offset+2*i],aux.fft2[offset+2*i+1]) ;
+    }
+  }
 
   // Loop over first half +1 of complex output results, multiply 
   // and set as input of reverse transform
-  for (Int_t i=0 ; i<N2/2+1 ; i++) {
-    Double_t re1,re2,im1,im2 ;
-    aux.fftr2c1->GetPointComplex(i,re1,im1) ;
-    aux.fftr2c2->GetPointComplex(i,re2,im2) ;
+  for (Int_t i=0 ; i<nc ; i++) {
+    Double_t re1 = aux.fft1[offset+2*i] ;
+    Double_t im1 = aux.fft1[offset+2*i+1] ;
+    Double_t re2 = aux.fft2[offset+2*i] ;
+    Double_t im2 = aux.fft2[offset+2*i+1] ;
     Double_t re = re1*re2 - im1*im2 ;
     Double_t im = re1*im2 + re2*im1 ;
     TComplex t(re,im) ;
@@ -548,6 +652,8 @@ void RooFFTConvPdf::fillCacheSlice(FFTCacheElem& aux, const RooArgSet& slicePos)
   delete[] input1 ;
   delete[] input2 ;
 
+  aux.slice++ ;
+
 }
 
 
@@ -828,6 +934,27 @@ void RooFFTConvPdf::setBufferFraction(Double_t frac)
 }
 
 
+
+////////////////////////////////////////////////////////////////////////////////
+/// Set the number of recently visited parameter points for which the output
+/// of the convolution is retained. When the parameters return to one of these
+/// points (as happens frequently during numeric gradient calculation in MINUIT)
+/// the stored output is used and no FFT is performed. A size of zero disables
+/// this cache
+
+void RooFFTConvPdf::setParamCacheSize(Int_t n) 
+{
+  if (n<0) {
+    coutE(InputArguments) << "RooFFTConvPdf::setParamCacheSize(" << GetName() << ") size should be greater than or equal to zero" << endl ;
+    return ;
+  }
+  _paramCacheSize = n ;
+
+  // Sterilize the cache to drop stored outputs beyond the new size
+  _cacheMgr.sterilize() ;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Change strategy to fill the overflow buffer on either side of the convolution observable range.
 ///
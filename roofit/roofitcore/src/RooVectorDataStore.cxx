@@ -30,6 +30,8 @@ use a TTree as internal storage mechanism
 
 #include "Riostream.h"
 #include "TTree.h"
+#include "TBranch.h"
+#include "TLeaf.h"
 #include "TChain.h"
 #include "TDirectory.h"
 #include "TROOT.h"
@@ -38,6 +40,7 @@ use a TTree as internal storage mechanism
 #include "RooCategory.h"
 #include "RooNameSet.h"
 #include "RooHistError.h"
+#include "RooNumber.h"
 #include "RooTrace.h"
 
 #include <iomanip>
@@ -835,6 +838,198 @@ void RooVectorDataStore::loadValues(const RooAbsDataStore *ads, const RooFormula
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Load values from tree 't' into this data collection, optionally
+/// selecting events using 'select' RooFormulaVar
+///
+/// If all variables are RooRealVars read from plain single-valued
+/// branches, the branches are read column by column in chunks of events,
+/// directly into the value vectors, without cloning the tree or copying
+/// the variables event by event. The range check is done per column and
+/// the selection formula is only evaluated for events in range. Otherwise
+/// the tree is imported through a temporary RooTreeDataStore.
+/// As for RooTreeDataStore::loadValues(), 'rangeName', 'nStart' and
+/// 'nStop' are ignored.
+
+void RooVectorDataStore::loadValues(const TTree *t, const RooFormulaVar* select, const char* rangeName, Int_t nStart, Int_t nStop) 
+{
+  TTree* tree = const_cast<TTree*>(t) ;
+
+  // Check if the columnar import can be used: only real-valued columns
+  // without errors, stored in basic type branches of a tree without
+  // entry list or friends
+  Bool_t bulk = _catStoreList.empty() && _realfStoreList.empty() && !tree->GetEntryList() && 
+    (!tree->GetListOfFriends() || tree->GetListOfFriends()->GetSize()==0) ;
+
+  std::vector<RooRealVar*> vars ;
+  std::vector<RealVector*> columns ;
+  std::vector<TString> branchNames ;
+  RooFIter viter = _varsww.fwdIterator() ;
+  RooAbsArg* arg ;
+  while(bulk && (arg=viter.next())) {
+    RooRealVar* var = dynamic_cast<RooRealVar*>(arg) ;
+    TBranch* branch = var ? tree->GetBranch(var->cleanBranchName()) : 0 ;
+    if (!branch || branch->IsA()!=TBranch::Class() || branch->GetListOfLeaves()->GetEntries()!=1) {
+      bulk = kFALSE ;
+      break ;
+    }
+    TLeaf* leaf = (TLeaf*) branch->GetListOfLeaves()->At(0) ;
+    Int_t dummy ;
+    TString typeName(leaf->GetTypeName()) ;
+    if (leaf->GetLeafCounter(dummy) || leaf->GetLen()!=1 ||
+	(typeName!="Double_t" && typeName!="Float_t" && typeName!="Int_t" && typeName!="UInt_t" && 
+	 typeName!="Char_t" && typeName!="UChar_t" && typeName!="Bool_t")) {
+      bulk = kFALSE ;
+      break ;
+    }
+    vars.push_back(var) ;
+    columns.push_back(addReal(var)) ;
+    branchNames.push_back(var->cleanBranchName()) ;
+  }
+
+  if (!bulk) {
+    RooTreeDataStore tmpstore(GetName(),GetTitle(),_varsww,_wgtVar?_wgtVar->GetName():0) ;
+    tmpstore.loadValues(t,select,rangeName,nStart,nStop) ;
+    append(tmpstore) ;
+    return ;
+  }
+
+  const Int_t ncol = vars.size() ;
+
+  // Cache the ranges of all columns
+  std::vector<Double_t> colMin(ncol), colMax(ncol) ;
+  std::vector<Bool_t> hasMin(ncol), hasMax(ncol) ;
+  Int_t wgtCol(-1) ;
+  for (Int_t c=0 ; c<ncol ; c++) {
+    colMin[c] = vars[c]->getMin() ;
+    colMax[c] = vars[c]->getMax() ;
+    hasMin[c] = !RooNumber::isInfinite(colMin[c]) ;
+    hasMax[c] = !RooNumber::isInfinite(colMax[c]) ;
+    if (vars[c]==_wgtVar) wgtCol = c ;
+  }
+
+  // Redirect formula servers to a private copy of the variables, and
+  // keep track of the columns the formula depends on
+  RooArgSet* sourceArgSet(0) ;
+  RooFormulaVar* selectClone(0) ;
+  std::vector<Int_t> selCols ;
+  std::vector<RooRealVar*> selVars ;
+  if (select) {
+    sourceArgSet = (RooArgSet*) _varsww.snapshot(kFALSE) ;
+    selectClone = (RooFormulaVar*) select->cloneTree() ;
+    selectClone->recursiveRedirectServers(*sourceArgSet) ;
+    selectClone->setOperMode(RooAbsArg::ADirty,kTRUE) ;
+    for (Int_t c=0 ; c<ncol ; c++) {
+      RooRealVar* svar = (RooRealVar*) sourceArgSet->find(vars[c]->GetName()) ;
+      if (svar && selectClone->dependsOn(*svar)) {
+	// Values are already range checked, do not clip them when setting
+	svar->removeRange() ;
+	selCols.push_back(c) ;
+	selVars.push_back(svar) ;
+      }
+    }
+  }
+
+  const Long64_t chunkSize = 100000 ;
+  std::vector<std::vector<Double_t> > buf(ncol,std::vector<Double_t>(chunkSize)) ;
+  std::vector<Bool_t> pass(chunkSize) ;
+  std::vector<TBranch*> branches(ncol) ;
+  std::vector<TLeaf*> leaves(ncol) ;
+
+  Long64_t nevent = tree->GetEntries() ;
+  reserve(numEntries() + nevent) ;
+
+  Int_t numInvalid(0) ;
+  Long64_t entry(0) ;
+  while (entry<nevent) {
+
+    // Load the next tree of a chain, for a tree this is the tree itself
+    Long64_t first = tree->LoadTree(entry) ;
+    if (first<0) break ;
+    TTree* cur = tree->GetTree() ;
+    Long64_t nLocal = cur->GetEntries() ;
+
+    Bool_t found(kTRUE) ;
+    for (Int_t c=0 ; c<ncol ; c++) {
+      branches[c] = cur->GetBranch(branchNames[c]) ;
+      if (!branches[c]) {
+	coutE(InputArguments) << "RooVectorDataStore::loadValues(" << GetName() << ") ERROR: branch " << branchNames[c] 
+			      << " not found in tree " << cur->GetName() << ", skipping its entries" << endl ;
+	found = kFALSE ;
+	break ;
+      }
+      leaves[c] = (TLeaf*) branches[c]->GetListOfLeaves()->At(0) ;
+    }
+    
+    for (Long64_t begin=first ; found && begin<nLocal ; begin+=chunkSize) {
+      const Int_t n = (Int_t) std::min(chunkSize,nLocal-begin) ;
+
+      // Read and range check the columns
+      std::fill(pass.begin(),pass.begin()+n,kTRUE) ;
+      for (Int_t c=0 ; c<ncol ; c++) {
+	Double_t* col = &buf[c][0] ;
+	for (Int_t i=0 ; i<n ; i++) {
+	  branches[c]->GetEntry(begin+i) ;
+	  col[i] = leaves[c]->GetValue() ;
+	}
+	const Double_t lo = colMin[c]-1e-6 ;
+	const Double_t hi = colMax[c]+1e-6 ;
+	if (hasMin[c]) {
+	  for (Int_t i=0 ; i<n ; i++) pass[i] = pass[i] && !(col[i]<lo) ;
+	}
+	if (hasMax[c]) {
+	  for (Int_t i=0 ; i<n ; i++) pass[i] = pass[i] && !(col[i]>hi) ;
+	}
+      }
+
+      // Apply the selection to the events in range
+      for (Int_t i=0 ; i<n ; i++) {
+	if (!pass[i]) {
+	  numInvalid++ ;
+	  continue ;
+	}
+	if (selectClone) {
+	  for (unsigned int k=0 ; k<selCols.size() ; k++) {
+	    selVars[k]->setVal(buf[selCols[k]][i]) ;
+	  }
+	  if (selectClone->getVal()==0) pass[i] = kFALSE ;
+	}
+      }
+
+      // Append the selected events
+      for (Int_t c=0 ; c<ncol ; c++) {
+	const Double_t* col = &buf[c][0] ;
+	std::vector<Double_t>& vec = columns[c]->_vec ;
+	for (Int_t i=0 ; i<n ; i++) {
+	  if (pass[i]) vec.push_back(col[i]) ;
+	}
+	columns[c]->_vec0 = vec.size()>0 ? &vec.front() : 0 ;
+      }
+      for (Int_t i=0 ; i<n ; i++) {
+	if (!pass[i]) continue ;
+	// use Kahan's algorithm to sum up weights to avoid loss of precision
+	Double_t y = (wgtCol>=0 ? buf[wgtCol][i] : 1.) - _sumWeightCarry;
+	Double_t tw = _sumWeight + y;
+	_sumWeightCarry = (tw - _sumWeight) - y;
+	_sumWeight = tw;
+	_nEntries++ ;
+      }
+    }
+
+    entry += nLocal - first ;
+  }
+
+  if (numInvalid>0) {
+    coutI(Eval) << "RooVectorDataStore::loadValues(" << GetName() << ") Ignored " << numInvalid << " out of range events" << endl ;
+  }
+
+  delete selectClone ;
+  delete sourceArgSet ;
+}
+
+
+
+
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -1301,19 +1496,22 @@ void RooVectorDataStore::recalculateCache( const RooArgSet *projectedArgs, Int_t
 {
   if (!_cache) return ;
 
-  pRealVector tv[1000] ;
-  Int_t ntv(0) ;
-
-  // Check which items need recalculation
+  // Check which items need recalculation. Each tracked element only depends on the
+  // parameters registered with its tracker, so after a change of a single parameter
+  // only the elements depending on it are refilled. No limit is put on the number of
+  // tracked elements, as models with many channels can easily exceed a few thousands
+  std::vector<pRealVector> tv ;
+  tv.reserve(_cache->_nReal) ;
   for (Int_t i=0 ; i<_cache->_nReal ; i++) {
     if ((*(_cache->_firstReal+i))->needRecalc() || _forcedUpdate) {
-      tv[ntv] = (*(_cache->_firstReal+i)) ;
-      tv[ntv]->_nativeReal->setOperMode(RooAbsArg::ADirty) ;
-      tv[ntv]->_nativeReal->_operMode=RooAbsArg::Auto ;
-//       cout << "recalculate: need to update " << tv[ntv]->_nativeReal->GetName() << endl ;
-      ntv++ ;
+      pRealVector rv = (*(_cache->_firstReal+i)) ;
+      rv->_nativeReal->setOperMode(RooAbsArg::ADirty) ;
+      rv->_nativeReal->_operMode=RooAbsArg::Auto ;
+//       cout << "recalculate: need to update " << rv->_nativeReal->GetName() << endl ;
+      tv.push_back(rv) ;
     }    
   }
+  Int_t ntv = tv.size() ;
   _forcedUpdate = kFALSE ;
 
   // If no recalculations are neede stop here
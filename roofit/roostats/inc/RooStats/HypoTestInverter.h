@@ -26,6 +26,7 @@ class RooRealVar;
 class TGraphErrors;
 
 #include <memory>
+#include <vector>
 
 
 
@@ -162,6 +163,12 @@ public:
    // set numerical error in test statistic evaluation (default is zero)
    void SetNumErr(double err) { fNumErr = err; }
 
+   // set number of worker processes used to evaluate the points of a fixed scan in parallel
+   // (1 = serial scan (default), 0 = use all the available cores)
+   // With toy-based calculators every point is seeded independently: the result does not depend
+   // on the number of workers, but agrees with the serial scan only within the toy statistics
+   void SetParallelScan(int nWorkers = 0) { fNWorkers = nWorkers; }
+
    // set flag to close proof for every new run
    static void SetCloseProof(Bool_t flag);
 
@@ -179,6 +186,15 @@ protected:
    // run the hybrid at a single point
    HypoTestResult * Eval( HypoTestCalculatorGeneric &hc, bool adaptive , double clsTarget) const;
 
+   // set the scanned variable to the given value and run the hypothesis test there
+   HypoTestResult * EvalPoint( double & rVal, bool adaptive, double clsTarget) const;
+
+   // add the result obtained at the given point to the HypoTestInverterResult
+   void AddPointResult( double rVal, HypoTestResult * result) const;
+
+   // evaluate the given points in parallel using worker processes
+   bool RunParallelScan( const std::vector<double> & xValues) const;
+
    // helper functions 
    static RooRealVar * GetVariableToScan(const HypoTestCalculatorGeneric &hc);    
    static void CheckInputModels(const HypoTestCalculatorGeneric &hc, const RooRealVar & scanVar);    
@@ -215,10 +231,11 @@ private:
    double fXmin; 
    double fXmax; 
    double fNumErr;
+   int fNWorkers;  // number of workers used for a fixed scan (1 = serial, 0 = all cores)
 
 protected:
 
-   ClassDef(HypoTestInverter,4)  // HypoTestInverter class
+   ClassDef(HypoTestInverter,5)  // HypoTestInverter class
 
 };
 
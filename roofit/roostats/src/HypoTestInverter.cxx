@@ -48,6 +48,13 @@
 
 #include "RooStats/ProofConfig.h"
 
+#include <numeric>
+#include <algorithm>
+#ifndef _WIN32
+#include "TProcPool.h"
+#include "TList.h"
+#endif
+
 ClassImp(RooStats::HypoTestInverter)
 
 using namespace RooStats;
@@ -149,7 +156,8 @@ HypoTestInverter::HypoTestInverter( ) :
    fVerbose(0),
    fCalcType(kUndefined), 
    fNBins(0), fXmin(1), fXmax(1),
-   fNumErr(0)
+   fNumErr(0),
+   fNWorkers(1)
 {
   // default constructor (doesn't do anything) 
 }
@@ -167,7 +175,8 @@ HypoTestInverter::HypoTestInverter( HypoTestCalculatorGeneric& hc,
    fVerbose(0),
    fCalcType(kUndefined), 
    fNBins(0), fXmin(1), fXmax(1),
-   fNumErr(0)
+   fNumErr(0),
+   fNWorkers(1)
 {
    // Constructor from a HypoTestCalculatorGeneric
    // The HypoTest calculator must be a FrequentistCalculator or HybridCalculator type 
@@ -221,7 +230,8 @@ HypoTestInverter::HypoTestInverter( HybridCalculator& hc,
    fVerbose(0),
    fCalcType(kHybrid), 
    fNBins(0), fXmin(1), fXmax(1),
-   fNumErr(0)
+   fNumErr(0),
+   fNWorkers(1)
 {
    // Constructor from a reference to a HybridCalculator 
    // The calculator must be created before by using the S+B model for the null and 
@@ -255,7 +265,8 @@ HypoTestInverter::HypoTestInverter( FrequentistCalculator& hc,
    fVerbose(0),
    fCalcType(kFrequentist), 
    fNBins(0), fXmin(1), fXmax(1),
-   fNumErr(0)
+   fNumErr(0),
+   fNWorkers(1)
 {
    // Constructor from a reference to a FrequentistCalculator  
    // The calculator must be created before by using the S+B model for the null and 
@@ -285,7 +296,8 @@ HypoTestInverter::HypoTestInverter( AsymptoticCalculator& hc,
    fVerbose(0),
    fCalcType(kAsymptotic), 
    fNBins(0), fXmin(1), fXmax(1),
-   fNumErr(0)
+   fNumErr(0),
+   fNWorkers(1)
 {
    // Constructor from a reference to a AsymptoticCalculator 
    // The calculator must be created before by using the S+B model for the null and 
@@ -324,7 +336,8 @@ HypoTestInverter::HypoTestInverter( RooAbsData& data, ModelConfig &sbModel, Mode
    fVerbose(0),
    fCalcType(type), 
    fNBins(0), fXmin(1), fXmax(1),
-   fNumErr(0)
+   fNumErr(0),
+   fNWorkers(1)
 {
    if(fCalcType==kFrequentist) fHC.reset(new FrequentistCalculator(data, bModel, sbModel)); 
    if(fCalcType==kHybrid) fHC.reset( new HybridCalculator(data, bModel, sbModel)) ; 
@@ -374,6 +387,7 @@ HypoTestInverter & HypoTestInverter::operator= (const HypoTestInverter & rhs) {
    fXmin = rhs.fXmin;
    fXmax = rhs.fXmax;
    fNumErr = rhs.fNumErr;
+   fNWorkers = rhs.fNWorkers;
 
    return *this;
 }
@@ -600,6 +614,7 @@ bool HypoTestInverter::RunFixedScan( int nBins, double xMin, double xMax, bool s
                                           << xMax << std::endl; 
    }         
 
+   std::vector<double> xValues(nBins);
    double thisX = xMin; 
    for (int i=0; i<nBins; i++) {
       
@@ -609,8 +624,15 @@ bool HypoTestInverter::RunFixedScan( int nBins, double xMin, double xMax, bool s
          else
             thisX = xMin + i*(xMax-xMin)/(nBins-1);          // linear scan in x 
       }
+      xValues[i] = thisX;
+   }
+
+   if (fNWorkers != 1 && nBins > 1) 
+      return RunParallelScan(xValues);
+
+   for (int i=0; i<nBins; i++) {
          
-      bool status = RunOnePoint(thisX);
+      bool status = RunOnePoint(xValues[i]);
       
       // check if failed status
       if ( status==false ) {
@@ -625,11 +647,110 @@ bool HypoTestInverter::RunFixedScan( int nBins, double xMin, double xMax, bool s
 }
 
 
-bool HypoTestInverter::RunOnePoint( double rVal, bool adaptive, double clTarget) const
+bool HypoTestInverter::RunParallelScan( const std::vector<double> & xValues) const
 {
-   // run only one point at the given POI value
+   // Evaluate the given scan points in parallel.
+   // Every point is run in a worker process forked by a TProcPool. Each worker owns a
+   // private copy of the calculator, the models and the data, so no state is shared 
+   // between the points. The results are merged afterwards in the scan order, with the
+   // same logic as in the serial scan.
+   // For the asymptotic calculator the result is identical to the one of the serial scan.
+   // For the toy-based calculators the random generator is re-seeded for each point
+   // from a seed drawn once here, so that the result does not depend on the number of
+   // workers or on the order in which the points are completed. The serial scan instead
+   // generates the toys of all the points from a single random sequence, therefore the
+   // toys, and the p-values obtained from them, differ from the ones of the serial scan
+   // within their statistical uncertainty
+
+#ifdef _WIN32
+   oocoutW((TObject*)0,Eval) << "HypoTestInverter::RunFixedScan - parallel scan is not supported on Windows, "
+                             << "run a serial scan" << std::endl;
+   for (unsigned int i = 0; i < xValues.size(); ++i) { 
+      if (!RunOnePoint(xValues[i]) ) { 
+         std::cout << "\t\tLoop interrupted because of failed status\n";
+         return false;
+      }
+   }
+   return true; 
+#else
+
+   bool useToys = (fCalcType == kFrequentist || fCalcType == kHybrid);
+   UInt_t seed = (useToys) ? RooRandom::randomGenerator()->Integer(kMaxInt) : 0;
+
+   // evaluate point i in a worker, the returned list is named after the point index
+   // and is empty when the result has to be skipped 
+   auto evalPoint = [&](int i) -> TList * { 
+      if (useToys) RooRandom::randomGenerator()->SetSeed(seed + i + 1);
+      double rVal = xValues[i];
+      HypoTestResult * result = EvalPoint(rVal, false, -1);
+      if (!result) return nullptr;
+      TList * list = new TList();
+      list->SetName(TString::Format("%d",i));
+      if (TMath::IsNaN(result->NullPValue() ) && TMath::IsNaN(result->AlternatePValue() ) ) 
+         delete result;
+      else 
+         list->Add(result); 
+      return list;
+   };
+
+   std::vector<int> indices(xValues.size());
+   std::iota(indices.begin(), indices.end(), 0);
+
+   oocoutI((TObject*)0,Eval) << "HypoTestInverter::RunFixedScan - run " << indices.size() << " points in parallel" 
+                             << std::endl;
+
+   TProcPool pool( (fNWorkers > 0) ? fNWorkers : 0 ); 
+   std::vector<TList *> lists = pool.Map(evalPoint, indices);
+
+   // order the results as in the scan 
+   std::vector<TList *> orderedLists(xValues.size(), nullptr);
+   bool ok = (lists.size() == xValues.size() );
+   for (auto list : lists) { 
+      if (!list) { 
+         ok = false; 
+         continue;
+      }
+      int i = TString(list->GetName()).Atoi();
+      if (i >= 0 && i < int(orderedLists.size()) ) orderedLists[i] = list;
+      else { 
+         list->SetOwner(true);
+         delete list;
+      }
+   }
+   if (!ok) { 
+      oocoutE((TObject*)0,Eval) << "HypoTestInverter::RunFixedScan - Error running the parallel scan" << std::endl;
+      for (auto list : orderedLists) { 
+         if (!list) continue;
+         list->SetOwner(true);
+         delete list;
+      }
+      return false;
+   }
 
    CreateResults();
+   for (unsigned int i = 0; i < orderedLists.size(); ++i) { 
+      HypoTestResult * result = (HypoTestResult*) orderedLists[i]->First(); 
+      if (result) { 
+         if (useToys && result->GetNullDistribution() && result->GetAltDistribution() )
+            fTotalToysRun += (result->GetAltDistribution()->GetSize() + result->GetNullDistribution()->GetSize());
+         AddPointResult(std::min(std::max(xValues[i], fScannedVariable->getMin()), fScannedVariable->getMax()), result);
+      }
+      else 
+         oocoutW((TObject*)0,Eval) << "HypoTestInverter - Skip invalid result for  point " << fScannedVariable->GetName() << " = " <<
+            xValues[i] << endl;
+      orderedLists[i]->SetOwner(false);
+      delete orderedLists[i];
+   }
+
+   return true;
+#endif
+}
+
+
+HypoTestResult * HypoTestInverter::EvalPoint( double & rVal, bool adaptive, double clTarget) const
+{
+   // set the scanned variable to rVal (moved inside the variable range if needed), 
+   // run the hypothesis test and restore the previous value of the variable
 
    // check if rVal is in the range specified for fScannedVariable
    if ( rVal < fScannedVariable->getMin() ) {
@@ -668,14 +789,42 @@ bool HypoTestInverter::RunOnePoint( double rVal, bool adaptive, double clTarget)
    if (!result) { 
       oocoutE((TObject*)0,Eval) << "HypoTestInverter - Error running point " << fScannedVariable->GetName() << " = " <<
    fScannedVariable->getVal() << endl;
-      return false;
    }
+
+   fScannedVariable->setVal(oldValue);
+
+   return result;
+}
+
+
+bool HypoTestInverter::RunOnePoint( double rVal, bool adaptive, double clTarget) const
+{
+   // run only one point at the given POI value
+
+   CreateResults();
+
+   HypoTestResult* result = EvalPoint(rVal, adaptive, clTarget);
+   if (!result) return false;
+
    // in case of a dummy result
    if (TMath::IsNaN(result->NullPValue() ) && TMath::IsNaN(result->AlternatePValue() ) ) {
       oocoutW((TObject*)0,Eval) << "HypoTestInverter - Skip invalid result for  point " << fScannedVariable->GetName() << " = " <<
-         fScannedVariable->getVal() << endl;
+         rVal << endl;
+      delete result; 
       return true;  // need to return true to avoid breaking the scan loop
    }
+
+   AddPointResult(rVal, result);
+   
+   return true;
+}
+
+
+void HypoTestInverter::AddPointResult( double rVal, HypoTestResult * result) const
+{
+   // add the result of the given point to the HypoTestInverterResult, merging it with 
+   // the last stored one if it refers to the same point. The result is owned afterwards 
+   // by the HypoTestInverterResult or deleted
    
    double lastXtested;
    if ( fResults->ArraySize()!=0 ) lastXtested = fResults->GetXValue(fResults->ArraySize()-1);
@@ -709,13 +858,9 @@ bool HypoTestInverter::RunOnePoint( double rVal, bool adaptive, double clTarget)
       // std::cout << "computed value for poi  " << rVal  << " : " << fResults->GetYValue(fResults->ArraySize()-1) 
       //        << " +/- " << fResults->GetYError(fResults->ArraySize()-1) << endl;
 
-   fScannedVariable->setVal(oldValue);
-   
-   return true;
 }
 
 
-
 bool HypoTestInverter::RunLimit(double &limit, double &limitErr, double absAccuracy, double relAccuracy, const double*hint) const {
    // run an automatic scan until the desired accurancy is reached
    // Start by default from the full interval (min,max) of the POI and then via bisection find the line crossing 
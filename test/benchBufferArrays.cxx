@@ -0,0 +1,217 @@
+// This program measures the throughput (MB/s of memory arrays) of the
+// streaming of arrays of basic types by TBufferFile, i.e. the byte swapping
+// of ReadFastArray/WriteFastArray and the packing of Float16_t/Double32_t
+// arrays with a truncated mantissa.
+// For each type two numbers are given:
+//  -"element-wise": one frombuf/tobuf (or operator<</>>) per element, as
+//   done by TBufferFile before the vectorised kernels were introduced
+//  -"TBufferFile": the current Read/WriteFastArray
+// Both are checked to produce the same bytes and values.
+//
+//  run with
+//     benchBufferArrays [nelements] [nrepeat]
+
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "TBufferFile.h"
+#include "TRandom3.h"
+#include "TStopwatch.h"
+#include "TStreamerElement.h"
+#include "TVirtualStreamerInfo.h"
+#include "Bytes.h"
+
+int gErrors = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// print the throughput of the element-wise and of the TBufferFile versions
+
+void PrintResult(const char *name, double bytes, double cpuLoop, double cpuBuffer)
+{
+   printf("%-20s %12.1f MB/s %12.1f MB/s %8.2f x\n", name, bytes/1e6/cpuLoop, bytes/1e6/cpuBuffer, cpuLoop/cpuBuffer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// time the writing and the reading of n elements of type T
+
+template <typename T>
+void BenchType(const char *name, int n, int nrepeat, TRandom3 &rnd)
+{
+   std::vector<T> in(n), out(n);
+   for (int i = 0; i < n; i++) in[i] = (T)(rnd.Uniform(-1e4, 1e4));
+   const double bytes = double(n)*sizeof(T)*nrepeat;
+
+   TBufferFile loop(TBuffer::kWrite, n*sizeof(T) + 1024);
+   TBufferFile buf(TBuffer::kWrite, n*sizeof(T) + 1024);
+   TStopwatch timer;
+
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++) {
+      loop.SetBufferOffset(0);
+      char *cur = loop.Buffer();
+      for (int i = 0; i < n; i++) tobuf(cur, in[i]);
+      loop.SetBufferOffset(cur - loop.Buffer());
+   }
+   timer.Stop();
+   const double cpuWriteLoop = timer.CpuTime();
+
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++) {
+      buf.SetBufferOffset(0);
+      buf.WriteFastArray(&in[0], n);
+   }
+   timer.Stop();
+   const double cpuWrite = timer.CpuTime();
+   if (loop.Length() != buf.Length() || memcmp(loop.Buffer(), buf.Buffer(), buf.Length())) {
+      printf("%s: the written bytes differ\n", name);
+      gErrors++;
+   }
+
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++) {
+      char *cur = loop.Buffer();
+      for (int i = 0; i < n; i++) frombuf(cur, &out[i]);
+   }
+   timer.Stop();
+   const double cpuReadLoop = timer.CpuTime();
+
+   buf.SetReadMode();
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++) {
+      buf.SetBufferOffset(0);
+      buf.ReadFastArray(&out[0], n);
+   }
+   timer.Stop();
+   const double cpuRead = timer.CpuTime();
+   if (memcmp(&in[0], &out[0], n*sizeof(T))) {
+      printf("%s: the values read differ\n", name);
+      gErrors++;
+   }
+
+   PrintResult(Form("write %s", name), bytes, cpuWriteLoop, cpuWrite);
+   PrintResult(Form("read %s", name), bytes, cpuReadLoop, cpuRead);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// write and read Float16_t and Double32_t arrays
+
+void WriteTruncated(TBuffer &b, const Float_t *f, int n, TStreamerElement *ele) { b.WriteFastArrayFloat16(f, n, ele); }
+void WriteTruncated(TBuffer &b, const Double_t *d, int n, TStreamerElement *ele) { b.WriteFastArrayDouble32(d, n, ele); }
+void ReadTruncated(TBuffer &b, Float_t *f, int n, TStreamerElement *ele) { b.ReadFastArrayFloat16(f, n, ele); }
+void ReadTruncated(TBuffer &b, Double_t *d, int n, TStreamerElement *ele) { b.ReadFastArrayDouble32(d, n, ele); }
+
+////////////////////////////////////////////////////////////////////////////////
+/// time the writing and the reading of n elements of type T (Float_t or
+/// Double_t) with their mantissa truncated to nbits
+
+template <typename T>
+void BenchTruncated(const char *name, int n, int nrepeat, int nbits, TRandom3 &rnd)
+{
+   std::vector<T> in(n), out(n), ref(n);
+   for (int i = 0; i < n; i++) in[i] = (T)(rnd.Gaus(0, 100));
+   const double bytes = double(n)*sizeof(T)*nrepeat;
+
+   // element of a Float16_t or Double32_t member declared with //[0,0,nbits]
+   const bool isFloat = sizeof(T) == sizeof(Float_t);
+   TStreamerBasicType ele("x", Form("[0,0,%d]", nbits), 0,
+                          isFloat ? TVirtualStreamerInfo::kFloat16 : TVirtualStreamerInfo::kDouble32,
+                          isFloat ? "Float16_t" : "Double32_t");
+
+   TBufferFile loop(TBuffer::kWrite, n*sizeof(T) + 1024);
+   TBufferFile buf(TBuffer::kWrite, n*sizeof(T) + 1024);
+   TStopwatch timer;
+
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++) {
+      loop.SetBufferOffset(0);
+      for (int i = 0; i < n; i++) {
+         union {
+            Float_t fFloatValue;
+            Int_t   fIntValue;
+         };
+         fFloatValue = (Float_t)in[i];
+         UChar_t  theExp = (UChar_t)(0x000000ff & ((fIntValue<<1)>>24));
+         UShort_t theMan = ((1<<(nbits+1))-1) & (fIntValue>>(23-nbits-1));
+         theMan++;
+         theMan = theMan>>1;
+         if (theMan&1<<nbits) theMan = (1<<nbits) - 1;
+         if (fFloatValue < 0) theMan |= 1<<(nbits+1);
+         loop << theExp;
+         loop << theMan;
+      }
+   }
+   timer.Stop();
+   const double cpuWriteLoop = timer.CpuTime();
+
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++) {
+      buf.SetBufferOffset(0);
+      WriteTruncated(buf, &in[0], n, &ele);
+   }
+   timer.Stop();
+   const double cpuWrite = timer.CpuTime();
+   if (loop.Length() != buf.Length() || memcmp(loop.Buffer(), buf.Buffer(), buf.Length())) {
+      printf("%s: the written bytes differ\n", name);
+      gErrors++;
+   }
+
+   loop.SetReadMode();
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++) {
+      loop.SetBufferOffset(0);
+      for (int i = 0; i < n; i++) {
+         union {
+            Float_t fFloatValue;
+            Int_t   fIntValue;
+         };
+         UChar_t  theExp;
+         UShort_t theMan;
+         loop >> theExp;
+         loop >> theMan;
+         fIntValue = theExp;
+         fIntValue <<= 23;
+         fIntValue |= (theMan & ((1<<(nbits+1))-1)) <<(23-nbits);
+         if (1<<(nbits+1) & theMan) fFloatValue = -fFloatValue;
+         ref[i] = fFloatValue;
+      }
+   }
+   timer.Stop();
+   const double cpuReadLoop = timer.CpuTime();
+
+   buf.SetReadMode();
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++) {
+      buf.SetBufferOffset(0);
+      ReadTruncated(buf, &out[0], n, &ele);
+   }
+   timer.Stop();
+   const double cpuRead = timer.CpuTime();
+   if (memcmp(&ref[0], &out[0], n*sizeof(T))) {
+      printf("%s: the values read differ\n", name);
+      gErrors++;
+   }
+
+   PrintResult(Form("write %s", name), bytes, cpuWriteLoop, cpuWrite);
+   PrintResult(Form("read %s", name), bytes, cpuReadLoop, cpuRead);
+}
+
+int main(int argc, char **argv)
+{
+   int n = (argc > 1) ? atoi(argv[1]) : 100000;
+   int nrepeat = (argc > 2) ? atoi(argv[2]) : 1000;
+
+   TRandom3 rnd(4357);
+   printf("\nbenchBufferArrays: %d elements, %d repetitions\n\n", n, nrepeat);
+   printf("%-20s %17s %17s %10s\n", "", "element-wise", "TBufferFile", "speedup");
+   BenchType<Short_t>("Short_t", n, nrepeat, rnd);
+   BenchType<Int_t>("Int_t", n, nrepeat, rnd);
+   BenchType<Float_t>("Float_t", n, nrepeat, rnd);
+   BenchType<Long64_t>("Long64_t", n, nrepeat, rnd);
+   BenchType<Double_t>("Double_t", n, nrepeat, rnd);
+   BenchTruncated<Float_t>("Float16_t (12 bits)", n, nrepeat, 12, rnd);
+   BenchTruncated<Double_t>("Double32_t (14 bits)", n, nrepeat, 14, rnd);
+   printf("\n");
+   return gErrors ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+// This program measures the writing of a file updated many times, as done
+// by an online monitoring writing the same histograms again and again with
+// TObject::kOverwrite, and the compaction of the file with TFile::Compact.
+// For each series of cycles it prints the number of cycles per second, the
+// end of the file compared to the sum of the sizes of the keys (the rest
+// are gaps) and the number of free segments.
+// The file is closed after the compaction, opened again and every histogram
+// is compared to the one in memory. The file is then updated for one more
+// series of cycles, with the free segments read from the file, and compared
+// again.
+//
+//  run with
+//     benchFileUpdate [nhist] [ncycles]
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TKey.h"
+#include "TRandom3.h"
+#include "TStopwatch.h"
+#include "TString.h"
+#include "TSystem.h"
+
+int gErrors = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// print the end of the file, the sum of the sizes of its keys and the
+/// number of free segments
+
+void PrintFile(const char *what, TFile &file)
+{
+   Long64_t used = 0;
+   TIter next(file.GetListOfKeys());
+   TKey *key;
+   while ((key = (TKey*)next())) used += key->GetNbytes();
+   printf("%-28s end %10lld B, keys %10lld B (%5.1f %%), %6d free segments\n", what,
+          file.GetEND(), used, 100. * used / file.GetEND(), file.GetNfree());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// fill a part of the histograms and write all of them with kOverwrite,
+/// ncycles times; their compressed size grows
+
+void WriteCycles(TFile &file, std::vector<TH1F*> &hists, int ncycles, TRandom3 &rnd)
+{
+   int nhist = hists.size();
+   for (int c = 0; c < ncycles; c++) {
+      for (int i = 0; i < nhist; i++) {
+         if (rnd.Rndm() < 0.3) continue;
+         int nfill = (int)rnd.Uniform(0, 200);
+         for (int n = 0; n < nfill; n++) hists[i]->Fill(rnd.Gaus(0.5, 0.2));
+      }
+      for (int i = 0; i < nhist; i++) file.WriteTObject(hists[i], 0, "Overwrite");
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// open the file again and compare every histogram to the one in memory
+
+void CompareFile(const char *filename, const char *what, const std::vector<TH1F*> &hists)
+{
+   TFile file(filename);
+   if (file.IsZombie()) {
+      printf("FAILED: cannot open %s %s\n", filename, what);
+      gErrors++;
+      return;
+   }
+   int ndiff = 0;
+   for (size_t i = 0; i < hists.size(); i++) {
+      TH1F *h = 0;
+      file.GetObject(hists[i]->GetName(), h);
+      bool same = h && h->GetNbinsX() == hists[i]->GetNbinsX() && h->GetEntries() == hists[i]->GetEntries() &&
+                  h->GetSumOfWeights() == hists[i]->GetSumOfWeights();
+      for (int b = 0; same && b <= h->GetNbinsX() + 1; b++)
+         same = h->GetBinContent(b) == hists[i]->GetBinContent(b);
+      if (!same) {
+         printf("FAILED: %s differs %s\n", hists[i]->GetName(), what);
+         ndiff++;
+      }
+      delete h;
+   }
+   if (file.GetNkeys() != (Int_t)hists.size()) {
+      printf("FAILED: %d keys %s instead of %d\n", file.GetNkeys(), what, (int)hists.size());
+      ndiff++;
+   }
+   gErrors += ndiff;
+}
+
+int main(int argc, char **argv)
+{
+   int nhist = (argc > 1) ? atoi(argv[1]) : 1000;
+   int ncycles = (argc > 2) ? atoi(argv[2]) : 50;
+   const char *filename = "benchFileUpdate.root";
+
+   TH1::AddDirectory(kFALSE);
+   TRandom3 rnd(4357);
+
+   std::vector<TH1F*> hists(nhist);
+   for (int i = 0; i < nhist; i++) {
+      int nbins = 10 + (int)rnd.Uniform(0, 2000);
+      hists[i] = new TH1F(Form("h%d", i), Form("histogram %d", i), nbins, 0, 1);
+   }
+
+   printf("\nbenchFileUpdate: %d histograms, %d cycles\n\n", nhist, ncycles);
+
+   TStopwatch timer;
+   {
+      TFile file(filename, "RECREATE");
+      for (int series = 0; series < 4; series++) {
+         timer.Start();
+         WriteCycles(file, hists, ncycles, rnd);
+         timer.Stop();
+         printf("cycles %4d-%-4d %8.1f cycles/s | ", series * ncycles, (series + 1) * ncycles - 1,
+                ncycles / timer.RealTime());
+         PrintFile("", file);
+      }
+
+      timer.Start();
+      Long64_t gain = file.Compact();
+      timer.Stop();
+      printf("compaction %8.3f s, %lld B   | ", timer.RealTime(), gain);
+      PrintFile("", file);
+   }
+   CompareFile(filename, "after the compaction", hists);
+
+   {
+      TFile file(filename, "UPDATE");
+      timer.Start();
+      WriteCycles(file, hists, ncycles, rnd);
+      timer.Stop();
+      printf("update %4d cycles %6.1f cycles/s | ", ncycles, ncycles / timer.RealTime());
+      PrintFile("", file);
+   }
+   CompareFile(filename, "after the update", hists);
+
+   printf("\nread back: %s\n\n", gErrors ? "FAILED" : "ok");
+   gSystem->Unlink(filename);
+   for (int i = 0; i < nhist; i++) delete hists[i];
+   return gErrors ? 1 : 0;
+}
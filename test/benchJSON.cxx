@@ -0,0 +1,135 @@
+// This program measures the speed of the conversion of histograms to JSON
+// by TBufferJSON, as done by THttpServer for the web monitoring.
+// For representative histograms it prints the number of conversions per
+// second and the output rate (MB/s of JSON) for:
+//  -"plain": compact=3, all array elements written
+//  -"compressed": compact=13, zeros skipped and repeated values coded once
+//  -"stream": compact=3 written with TBufferJSON::ExportToStream
+// It also checks that the numbers are formatted like printf would do.
+//
+//  run with
+//     benchJSON [nrepeat]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <sstream>
+
+#include "TBufferJSON.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TProfile.h"
+#include "TRandom3.h"
+#include "TStopwatch.h"
+#include "TString.h"
+
+int gErrors = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// time the conversion of obj to JSON
+
+void BenchObject(const char *name, TObject *obj, int nrepeat)
+{
+   TStopwatch timer;
+   Long64_t lenPlain = 0, lenCompr = 0, lenStream = 0;
+
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++)
+      lenPlain = TBufferJSON::ConvertToJSON(obj, 3).Length();
+   timer.Stop();
+   const double cpuPlain = timer.CpuTime();
+
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++)
+      lenCompr = TBufferJSON::ConvertToJSON(obj, 13).Length();
+   timer.Stop();
+   const double cpuCompr = timer.CpuTime();
+
+   timer.Start();
+   for (int r = 0; r < nrepeat; r++) {
+      std::ostringstream os;
+      lenStream = TBufferJSON::ExportToStream(os, obj, 3);
+   }
+   timer.Stop();
+   const double cpuStream = timer.CpuTime();
+
+   if (lenStream != lenPlain) {
+      printf("%s: streamed JSON has %lld bytes instead of %lld\n", name, lenStream, lenPlain);
+      gErrors++;
+   }
+
+   printf("%-24s plain %8.0f/s %7.1f MB/s %8lld B | compressed %8.0f/s %8lld B | stream %8.0f/s\n", name,
+          nrepeat / cpuPlain, lenPlain * 1e-6 * nrepeat / cpuPlain, lenPlain,
+          nrepeat / cpuCompr, lenCompr,
+          nrepeat / cpuStream);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// check that the bin contents of h are written as printf would do
+
+void CheckFormat(TH1D *h)
+{
+   TString expected = "\"fArray\":[";
+   for (int n = 0; n < h->fN; n++) {
+      char buf[100];
+      Double_t v = h->fArray[n];
+      snprintf(buf, sizeof(buf), (v == floor(v)) ? "%1.0f" : "%e", v);
+      if (n > 0) expected.Append(",");
+      expected.Append(buf);
+   }
+   expected.Append("]");
+
+   TString json = TBufferJSON::ConvertToJSON(h, 3);
+   if (json.Index(expected) == kNPOS) {
+      printf("%s: values are not formatted as with printf\n", h->GetName());
+      gErrors++;
+   }
+
+   std::ostringstream os;
+   TBufferJSON::ExportToStream(os, h, 3);
+   if (json != os.str().c_str()) {
+      printf("%s: ExportToStream differs from ConvertToJSON\n", h->GetName());
+      gErrors++;
+   }
+
+   if (TBufferJSON::ConvertToJSON(h, 13).Index("\"$arr\"") == kNPOS) {
+      printf("%s: array was not compressed\n", h->GetName());
+      gErrors++;
+   }
+}
+
+int main(int argc, char **argv)
+{
+   int nrepeat = (argc > 1) ? atoi(argv[1]) : 200;
+
+   TH1::AddDirectory(kFALSE);
+   TRandom3 rnd(4357);
+
+   TH1D h1("h1", "1D gaus, 1000 bins", 1000, -5, 5);
+   for (int n = 0; n < 100000; n++) h1.Fill(rnd.Gaus(0, 1), rnd.Uniform(0.5, 1.5));
+
+   TH2F h2("h2", "2D gaus, 100x100 bins", 100, -5, 5, 100, -5, 5);
+   for (int n = 0; n < 100000; n++) h2.Fill(rnd.Gaus(0, 1), rnd.Gaus(0, 1));
+
+   TH2I h3("h3", "2D sparse, 500x500 bins", 500, 0, 1, 500, 0, 1);
+   for (int n = 0; n < 1000; n++) h3.Fill(rnd.Uniform(0, 1), rnd.Uniform(0, 0.1));
+
+   TProfile h4("h4", "profile, 1000 bins", 1000, 0, 1);
+   for (int n = 0; n < 100000; n++) {
+      Double_t x = rnd.Uniform(0, 1);
+      h4.Fill(x, x * x + rnd.Gaus(0, 0.1));
+   }
+
+   printf("\nbenchJSON: %d conversions of each histogram\n\n", nrepeat);
+
+   CheckFormat(&h1);
+
+   BenchObject("TH1D 1000 bins", &h1, nrepeat);
+   BenchObject("TH2F 100x100 gaus", &h2, nrepeat);
+   BenchObject("TH2I 500x500 sparse", &h3, (nrepeat + 9) / 10);
+   BenchObject("TProfile 1000 bins", &h4, nrepeat);
+
+   printf("\n");
+   return gErrors ? 1 : 0;
+}
@@ -0,0 +1,246 @@
+// This program compares the speed of the different ways to evaluate a
+// trained TMVA BDT for the same weights file:
+//  -TMVA::Reader, event by event
+//  -TMVA::Reader, batch interface (flattened forest, blocks of events)
+//  -standalone class written by MakeClass with MakeClassStyle=Nodes
+//   (linked node objects, the historical layout)
+//  -standalone class with MakeClassStyle=FlatArrays (static node arrays)
+//  -standalone class with MakeClassStyle=NestedIf (one function per tree)
+// The standalone classes are compiled with ACLiC. All responses are
+// compared to the one of the Reader evaluated event by event: they must
+// be identical, except for the Nodes layout which writes the cuts with a
+// limited precision. The program returns 1 in case of a difference.
+//
+//  run with
+//     benchTMVABDT [weightfile] [nevents] [ntrees]
+//  Without weight file (or with "-"), a BDT of ntrees trees (default 400)
+//  of depth 3 is first trained on a toy sample with 4 variables. The events used in the evaluation are
+//  drawn uniformly within the ranges of the input variables.
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TRandom3.h"
+#include "TStopwatch.h"
+#include "TSystem.h"
+#include "TString.h"
+#include "TXMLEngine.h"
+#include "TMath.h"
+
+#include "TMVA/Factory.h"
+#include "TMVA/DataLoader.h"
+#include "TMVA/Reader.h"
+#include "TMVA/MethodBDT.h"
+#include "TMVA/Tools.h"
+
+typedef void (*BenchFunc_t)(const double*, int, int, const char**, double*);
+
+int gErrors = 0;
+
+/// train a BDT of ntrees trees on a toy sample, return the name of the weight file
+/// train a BDT on a toy sample, return the name of the weight file
+
+TString TrainToyBDT(int ntrees)
+{
+   const int nvar = 4;
+   const int nevents = 20000;
+   TRandom3 rnd(4357);
+   Float_t x[nvar];
+   TTree *sig = new TTree("sig", "signal");
+   TTree *bkg = new TTree("bkg", "background");
+   for (int ivar = 0; ivar < nvar; ivar++) {
+      sig->Branch(Form("x%d", ivar), &x[ivar], Form("x%d/F", ivar));
+      bkg->Branch(Form("x%d", ivar), &x[ivar], Form("x%d/F", ivar));
+   }
+   for (int i = 0; i < nevents; i++) {
+      for (int ivar = 0; ivar < nvar; ivar++) x[ivar] = rnd.Gaus(0.3*(ivar+1), 1.);
+      sig->Fill();
+      for (int ivar = 0; ivar < nvar; ivar++) x[ivar] = rnd.Gaus(-0.3*(ivar+1), 1.);
+      bkg->Fill();
+   }
+
+   TFile *output = TFile::Open("benchTMVABDT.root", "RECREATE");
+   TMVA::Factory *factory = new TMVA::Factory("benchTMVABDT", output, "Silent:!V:!DrawProgressBar:AnalysisType=Classification");
+   TMVA::DataLoader *loader = new TMVA::DataLoader("benchTMVABDT");
+   for (int ivar = 0; ivar < nvar; ivar++) loader->AddVariable(Form("x%d", ivar), 'F');
+   loader->AddSignalTree(sig, 1.);
+   loader->AddBackgroundTree(bkg, 1.);
+   loader->PrepareTrainingAndTestTree("", "", "SplitMode=Random:NormMode=NumEvents:!V");
+   factory->BookMethod(loader, TMVA::Types::kBDT, "BDT", Form("!H:!V:NTrees=%d:MaxDepth=3:BoostType=AdaBoost:nCuts=20", ntrees));
+   factory->TrainAllMethods();
+   delete factory;
+   delete loader;
+   output->Close();
+   delete output;
+   delete sig;
+   delete bkg;
+   return "benchTMVABDT/weights/benchTMVABDT_BDT.weights.xml";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// read the input variables (expression, min, max) from the weight file
+
+bool ReadVariables(const char *weightfile, std::vector<TString> &names, std::vector<double> &xmin, std::vector<double> &xmax)
+{
+   TXMLEngine xml;
+   XMLDocPointer_t doc = xml.ParseFile(weightfile);
+   if (!doc) return false;
+   XMLNodePointer_t node = xml.GetChild(xml.DocGetRootElement(doc));
+   for (; node; node = xml.GetNext(node)) {
+      if (TString(xml.GetNodeName(node)) != "Variables") continue;
+      for (XMLNodePointer_t var = xml.GetChild(node); var; var = xml.GetNext(var)) {
+         if (TString(xml.GetNodeName(var)) != "Variable") continue;
+         names.push_back(xml.GetAttr(var, "Expression"));
+         xmin.push_back(atof(xml.GetAttr(var, "Min")));
+         xmax.push_back(atof(xml.GetAttr(var, "Max")));
+      }
+   }
+   xml.FreeDoc(doc);
+   return !names.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// write the standalone class with the given style and compile it together
+/// with a driver function evaluating a column-major array of events
+
+BenchFunc_t MakeStandalone(TMVA::MethodBDT *bdt, const char *style)
+{
+   TString classFile = Form("benchTMVABDT_%s.class.C", style);
+   TString driverFile = Form("benchTMVABDT_%s_driver.C", style);
+   bdt->SetMakeClassStyle(style);
+   bdt->MakeClass(classFile);
+
+   std::ofstream fout(driverFile.Data());
+   fout << "#include <vector>" << std::endl;
+   fout << "#include <cmath>" << std::endl;
+   fout << "#include <string>" << std::endl;
+   fout << "#include <iostream>" << std::endl;
+   // every class is wrapped in its own namespace, they all have the same name
+   fout << "namespace benchTMVABDT_" << style << " {" << std::endl;
+   fout << "#include \"" << classFile << "\"" << std::endl;
+   fout << "}" << std::endl;
+   fout << "extern \"C\" void benchTMVABDT_" << style << "_eval(const double *x, int nvar, int n, const char **names, double *out)" << std::endl;
+   fout << "{" << std::endl;
+   fout << "   std::vector<std::string> vars(names, names+nvar);" << std::endl;
+   fout << "   benchTMVABDT_" << style << "::Read" << bdt->GetMethodName() << " reader(vars);" << std::endl;
+   fout << "   std::vector<double> v(nvar);" << std::endl;
+   fout << "   for (int i = 0; i < n; i++) {" << std::endl;
+   fout << "      for (int ivar = 0; ivar < nvar; ivar++) v[ivar] = x[ivar*n+i];" << std::endl;
+   fout << "      out[i] = reader.GetMvaValue(v);" << std::endl;
+   fout << "   }" << std::endl;
+   fout << "}" << std::endl;
+   fout.close();
+
+   if (!gSystem->CompileMacro(driverFile, "kfO")) {
+      std::cerr << "benchTMVABDT: cannot compile " << driverFile << std::endl;
+      return 0;
+   }
+   return (BenchFunc_t) gSystem->DynFindSymbol("*", Form("benchTMVABDT_%s_eval", style));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// print one line of the summary table, count an error if the responses
+/// must be identical to the reference ones and are not
+
+void PrintResult(const char *name, double cpu, int nevents, double reference, const std::vector<double> &values,
+                 const std::vector<double> &refValues, bool exact = true)
+{
+   int nDiff = 0;
+   double maxDiff = 0;
+   for (size_t i = 0; i < values.size(); i++) {
+      double diff = TMath::Abs(values[i] - refValues[i]);
+      if (diff != 0) nDiff++;
+      if (diff > maxDiff) maxDiff = diff;
+   }
+   printf("%-30s %10.1f ns/event %8.2f x %10d differences (max %g)\n", name, 1e9*cpu/nevents, reference/cpu, nDiff, maxDiff);
+   if (exact && nDiff) {
+      printf("%s: the responses differ from the ones of the Reader\n", name);
+      gErrors++;
+   }
+}
+
+int main(int argc, char **argv)
+{
+   TString weightfile = (argc > 1) ? argv[1] : "";
+   int nevents = (argc > 2) ? atoi(argv[2]) : 1000000;
+   int ntrees = (argc > 3) ? atoi(argv[3]) : 400;
+
+   if (weightfile == "" || weightfile == "-") weightfile = TrainToyBDT(ntrees);
+
+   std::vector<TString> names;
+   std::vector<double> xmin, xmax;
+   if (!ReadVariables(weightfile, names, xmin, xmax)) {
+      std::cerr << "benchTMVABDT: cannot read the input variables from " << weightfile << std::endl;
+      return 1;
+   }
+   const int nvar = names.size();
+
+   // events, column-major
+   TRandom3 rnd(65539);
+   std::vector<Float_t> xf(nvar*nevents);
+   std::vector<double> xd(nvar*nevents);
+   for (int ivar = 0; ivar < nvar; ivar++) {
+      for (int i = 0; i < nevents; i++) {
+         xf[ivar*nevents+i] = rnd.Uniform(xmin[ivar], xmax[ivar]);
+         xd[ivar*nevents+i] = xf[ivar*nevents+i];
+      }
+   }
+
+   std::vector<Float_t> vars(nvar);
+   TMVA::Reader reader("!Color:Silent");
+   for (int ivar = 0; ivar < nvar; ivar++) reader.AddVariable(names[ivar], &vars[ivar]);
+   TMVA::MethodBDT *bdt = dynamic_cast<TMVA::MethodBDT*>(reader.BookMVA("BDT", weightfile));
+   if (!bdt) {
+      std::cerr << "benchTMVABDT: " << weightfile << " is not a BDT weight file" << std::endl;
+      return 1;
+   }
+
+   TStopwatch timer;
+   std::vector<double> reference(nevents), values(nevents);
+
+   // Reader, event by event
+   timer.Start();
+   std::vector<Float_t> event(nvar);
+   for (int i = 0; i < nevents; i++) {
+      for (int ivar = 0; ivar < nvar; ivar++) event[ivar] = xf[ivar*nevents+i];
+      reference[i] = reader.EvaluateMVA(event, "BDT");
+   }
+   timer.Stop();
+   const double cpuReader = timer.CpuTime();
+
+   printf("\nbenchTMVABDT: %d events, %d variables, %d trees\n\n", nevents, nvar, int(bdt->GetForest().size()));
+   printf("%-30s %10s %17s %12s\n", "", "time", "speedup", "vs Reader");
+   PrintResult("Reader", cpuReader, nevents, cpuReader, reference, reference);
+
+   // Reader, batch
+   timer.Start();
+   reader.EvaluateMVA(&xf[0], nevents, "BDT", &values[0]);
+   timer.Stop();
+   PrintResult("Reader (batch)", timer.CpuTime(), nevents, cpuReader, values, reference);
+
+   // standalone classes
+   std::vector<const char*> cnames(nvar);
+   for (int ivar = 0; ivar < nvar; ivar++) cnames[ivar] = names[ivar].Data();
+   const char *styles[] = { "Nodes", "FlatArrays", "NestedIf" };
+   for (int istyle = 0; istyle < 3; istyle++) {
+      BenchFunc_t eval = MakeStandalone(bdt, styles[istyle]);
+      if (!eval) {
+         gErrors++;
+         continue;
+      }
+      timer.Start();
+      eval(&xd[0], nvar, nevents, &cnames[0], &values[0]);
+      timer.Stop();
+      PrintResult(Form("MakeClass (%s)", styles[istyle]), timer.CpuTime(), nevents, cpuReader, values, reference,
+                  istyle > 0);
+   }
+   printf("\n");
+   return gErrors ? 1 : 0;
+}
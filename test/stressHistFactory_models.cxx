@@ -15,13 +15,16 @@ using namespace RooStats;
 /// Build model for prototype on/off problem
 /// Poiss(x | s+b) * Poiss(y | tau b )
 
-void buildAPI_XML_TestModel(TString prefix)
+void buildAPI_XML_TestModel(TString prefix, bool binnedNLL = false)
 {
   HistFactory::Measurement meas("Test","API_XML_TestModel");
 
   // do not fit, just export the workspace
   meas.SetExportOnly(true);
 
+  // optionally add the flattened binned likelihood to the workspaces
+  meas.SetBinnedNLL(binnedNLL);
+
   // put output in separate sub-directory
   meas.SetOutputFilePrefix(prefix.Data());
 
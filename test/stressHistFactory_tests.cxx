@@ -17,6 +17,7 @@
 #include "RooLinkedListIter.h"
 #include "RooAbsPdf.h"
 #include "RooDataSet.h"
+#include "TRandom3.h"
 
 // RooStats header(s)
 #include "RooStats/ModelConfig.h"
@@ -29,7 +30,7 @@ using namespace RooFit;
 using namespace RooStats;
 
 class PdfComparison : public RooUnitTest {
-private:
+protected:
   TString fTestDirectory;
   TString fOldDirectory;  // old directory where test is started
   Double_t fTolerance;
@@ -37,9 +38,10 @@ public:
   PdfComparison(
     TFile* refFile,
     Bool_t writeRef,
-    Int_t verbose
+    Int_t verbose,
+    const char* name = "PDF comparison for HistFactory"
     ) :
-    RooUnitTest("PDF comparison for HistFactory", refFile, writeRef, verbose),
+    RooUnitTest(name, refFile, writeRef, verbose),
     fTestDirectory("HistFactoryTest"),
     fTolerance(1e-3)
   {
@@ -237,7 +239,7 @@ public:
     return kTRUE;
   }
 
-private:
+protected:
   Bool_t CreateTestDirectory()
   {
     // use trick to get unique, unoccupied file name as test directory name
@@ -477,3 +479,99 @@ private:
     return kTRUE;
   }
 };
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compare the flattened binned likelihood (HistFactoryBinnedNLL) built by
+/// the model builder with the likelihood made by RooAbsPdf::createNLL for the
+/// same model and data. Both are evaluated at random parameter points around
+/// the nominal values; the changes of the two likelihoods with respect to the
+/// nominal point must agree (the constant terms of the two are different).
+
+class BinnedNLLComparison : public PdfComparison {
+public:
+  BinnedNLLComparison(
+    TFile* refFile,
+    Bool_t writeRef,
+    Int_t verbose
+    ) :
+    PdfComparison(refFile, writeRef, verbose, "Binned likelihood comparison for HistFactory")
+  {}
+
+  Bool_t testCode()
+  {
+    // dump histfactory output into a file
+    gSystem->RedirectOutput(fTestDirectory + "/BinnedNLL_test.log","a");
+
+    // build model with the binned likelihood using the API
+    gSystem->ChangeDirectory(fTestDirectory + "/API/");
+    buildAPI_XML_TestModel("API_XML_TestModel", true);
+
+    // cancel redirection
+    gSystem->RedirectOutput(0);
+
+    TFile* pFile = TFile::Open("API_XML_TestModel_combined_Test_model.root");
+    gSystem->ChangeDirectory(fOldDirectory);
+    if(!pFile || pFile->IsZombie()) {
+       Error("testCode","Error opening the file API_XML_TestModel_combined_Test_model.root");
+       return kFALSE;
+    }
+
+    RooWorkspace* pWS = (RooWorkspace*)pFile->Get("combined");
+    ModelConfig* pMC = pWS ? (ModelConfig*)pWS->obj("ModelConfig") : 0;
+    if(!pMC || !pMC->GetPdf() || !pWS->data("obsData")) {
+       Error("testCode","Error retrieving the model from the workspace combined");
+       return kFALSE;
+    }
+
+    RooAbsReal* pBinnedNLL = pWS->function("binnedNLL");
+    if(!pBinnedNLL) {
+       Error("testCode","Error retrieving the binned likelihood binnedNLL");
+       return kFALSE;
+    }
+
+    RooAbsData& data = *pWS->data("obsData");
+    RooAbsReal* pNLL = pMC->GetPdf()->createNLL(data, Constrain(*pMC->GetNuisanceParameters()),
+                                                GlobalObservables(*pMC->GetGlobalObservables()));
+
+    RooArgSet* pParams = pMC->GetPdf()->getParameters(data);
+    RooArgSet* pNominal = (RooArgSet*)pParams->snapshot();
+
+    const Double_t nll0 = pNLL->getVal();
+    const Double_t binnedNLL0 = pBinnedNLL->getVal();
+
+    TRandom3 rnd(4357);
+    Bool_t bResult = kTRUE;
+    for(Int_t i = 0; i < 50 && bResult; ++i)
+    {
+      *pParams = *pNominal;
+      RooLinkedListIter it = pParams->iterator();
+      TObject* obj = 0;
+      while((obj = it.Next()))
+      {
+        RooRealVar* par = dynamic_cast<RooRealVar*>(obj);
+        if(!par || par->isConstant()) continue;
+        // setVal keeps the value inside the range of the parameter
+        par->setVal(par->getVal() + 0.05*(par->getMax() - par->getMin())*rnd.Uniform(-1,1));
+      }
+
+      Double_t dNLL = pNLL->getVal() - nll0;
+      Double_t dBinnedNLL = pBinnedNLL->getVal() - binnedNLL0;
+      if(_verb > 0)
+         Info("testCode","point %d: delta NLL %.8g, delta binned NLL %.8g",i,dNLL,dBinnedNLL);
+      if(!TMath::AreEqualAbs(dNLL,dBinnedNLL,1e-6*TMath::Max(1.,TMath::Abs(dNLL))))
+      {
+         Warning("testCode","binned likelihood differs from RooNLLVar at point %d: delta NLL %.8g vs %.8g",i,dBinnedNLL,dNLL);
+         bResult = kFALSE;
+      }
+    }
+
+    // clean up
+    *pParams = *pNominal;
+    delete pNominal;
+    delete pParams;
+    delete pNLL;
+    delete pFile;
+
+    return bResult;
+  }
+};
@@ -123,6 +123,8 @@ Int_t stressRooFit(const char* refFile, Bool_t writeRef, Int_t doVerbose, Int_t
   testList.push_back(new TestBasic205(fref,writeRef,doVerbose)) ;
   testList.push_back(new TestBasic208(fref,writeRef,doVerbose)) ;
   testList.push_back(new TestBasic209(fref,writeRef,doVerbose)) ;
+  testList.push_back(new TestBasic210(fref,writeRef,doVerbose)) ;
+  testList.push_back(new TestBasic211(fref,writeRef,doVerbose)) ;
   testList.push_back(new TestBasic301(fref,writeRef,doVerbose)) ;
   testList.push_back(new TestBasic302(fref,writeRef,doVerbose)) ;
   testList.push_back(new TestBasic303(fref,writeRef,doVerbose)) ;
@@ -143,6 +145,7 @@ Int_t stressRooFit(const char* refFile, Bool_t writeRef, Int_t doVerbose, Int_t
   testList.push_back(new TestBasic404(fref,writeRef,doVerbose)) ;
   testList.push_back(new TestBasic405(fref,writeRef,doVerbose)) ;
   testList.push_back(new TestBasic406(fref,writeRef,doVerbose)) ;
+  testList.push_back(new TestBasic407(fref,writeRef,doVerbose)) ;
   testList.push_back(new TestBasic501(fref,writeRef,doVerbose)) ;
   testList.push_back(new TestBasic599(fref,writeRef,doVerbose)) ;
   testList.push_back(new TestBasic601(fref,writeRef,doVerbose)) ;
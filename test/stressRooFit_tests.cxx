@@ -1650,6 +1650,260 @@ public:
 } ;
 /////////////////////////////////////////////////////////////////////////
 //
+// 'ADDITION AND CONVOLUTION' RooFit test #210
+//
+// Caching of the coefficients of the addition operator: the value of
+// a RooAddPdf, evaluated many times while observables and parameters
+// change, must equal the one of a fresh copy without cached coefficients
+//
+// pdf1 = f(y)*gauss1(x) + (1-f(y))*gauss2(x) with f(y) = a0 + a1*y
+// pdf2 = nsig*gauss1(x) + nbkg*gauss2(x)
+// pdf3 = f*gauss1(x) + (1-f)*gauss2(x) with f defined in a range of x
+// pdf4 = f*gauss1(x) + (1-f)*gaussy(y)
+//
+// The ranges of x and y are also changed between evaluations, and pdf4
+// is evaluated alternately with normalization sets (x,y) and (x)
+//
+/////////////////////////////////////////////////////////////////////////
+
+#ifndef __CINT__
+#include "RooGlobalFunc.h"
+#endif
+#include "RooRealVar.h"
+#include "RooGaussian.h"
+#include "RooPolyVar.h"
+#include "RooAddPdf.h"
+#include "TRandom3.h"
+using namespace RooFit ;
+
+
+
+class TestBasic210 : public RooUnitTest
+{
+public:
+  TestBasic210(TFile* refFile, Bool_t writeRef, Int_t verbose) : RooUnitTest("Coefficient caching of addition operator",refFile,writeRef,verbose) {} ;
+
+  // Compare the value of the p.d.f. with the one of a fresh copy of it
+  Bool_t compareWithCopy(RooAbsPdf& pdf, const RooArgSet& nset, Int_t i) {
+    Double_t val = pdf.getVal(nset) ;
+    RooAbsPdf* copy = (RooAbsPdf*) pdf.cloneTree() ;
+    RooArgSet* copyNset = copy->getObservables(nset) ;
+    Double_t ref = copy->getVal(*copyNset) ;
+    delete copyNset ;
+    delete copy ;
+    if (fabs(val-ref) > 1e-10*fabs(ref)) {
+      Error("testCode","%s at step %d: cached value %g, uncached value %g",pdf.GetName(),i,val,ref) ;
+      return kFALSE ;
+    }
+    return kTRUE ;
+  }
+
+  Bool_t testCode() {
+
+    // S e t u p   m o d e l s
+    // -----------------------
+
+    RooRealVar x("x","x",-10,10) ;
+    RooRealVar y("y","y",-5,5) ;
+
+    RooRealVar mean1("mean1","mean1",-1,-10,10) ;
+    RooRealVar sigma1("sigma1","sigma1",1,0.1,10) ;
+    RooGaussian gauss1("gauss1","gauss1",x,mean1,sigma1) ;
+    RooRealVar mean2("mean2","mean2",2,-10,10) ;
+    RooRealVar sigma2("sigma2","sigma2",3,0.1,10) ;
+    RooGaussian gauss2("gauss2","gauss2",x,mean2,sigma2) ;
+
+    // Fraction depending on the observable y
+    RooRealVar a0("a0","a0",0.5,0,1) ;
+    RooRealVar a1("a1","a1",0.05,-0.1,0.1) ;
+    RooPolyVar fy("fy","fy",y,RooArgSet(a0,a1)) ;
+    RooAddPdf model1("model1","model1",RooArgList(gauss1,gauss2),fy) ;
+
+    // Extended components
+    RooRealVar nsig("nsig","nsig",100,0,1000) ;
+    RooRealVar nbkg("nbkg","nbkg",500,0,1000) ;
+    RooAddPdf model2("model2","model2",RooArgList(gauss1,gauss2),RooArgList(nsig,nbkg)) ;
+
+
+    // E v a l u a t e   w h i l e   c h a n g i n g   o b s e r v a b l e s   a n d   p a r a m e t e r s
+    // -----------------------------------------------------------------------------------------------------
+
+    TRandom3 rnd(210) ;
+    Bool_t ok = kTRUE ;
+    for (Int_t i=0 ; i<100 ; i++) {
+      x.setVal(rnd.Uniform(-10,10)) ;
+      y.setVal(rnd.Uniform(-5,5)) ;
+      if (i%10==5) mean1.setVal(rnd.Uniform(-2,2)) ;
+      if (i%10==7) a0.setVal(rnd.Uniform(0.3,0.7)) ;
+      if (i%10==9) nsig.setVal(rnd.Uniform(0,1000)) ;
+
+      ok &= compareWithCopy(model1,RooArgSet(x,y),i) ;
+      ok &= compareWithCopy(model1,RooArgSet(x),i) ;
+      ok &= compareWithCopy(model2,RooArgSet(x),i) ;
+    }
+
+
+    // C h a n g e   r a n g e s   b e t w e e n   e v a l u a t i o n s
+    // -----------------------------------------------------------------
+
+    // Projected coefficients, defined in a reference range of x
+    RooRealVar f("f","f",0.3,0,1) ;
+    x.setRange("ref",-3,3) ;
+    RooAddPdf model3("model3","model3",RooArgList(gauss1,gauss2),f) ;
+    model3.fixCoefNormalization(x) ;
+    model3.fixCoefRange("ref") ;
+
+    // Components with different observables: supplemental normalization over the other one
+    RooRealVar meany("meany","meany",0,-5,5) ;
+    RooRealVar sigmay("sigmay","sigmay",2,0.1,10) ;
+    RooGaussian gaussy("gaussy","gaussy",y,meany,sigmay) ;
+    RooAddPdf model4("model4","model4",RooArgList(gauss1,gaussy),f) ;
+
+    for (Int_t i=0 ; i<20 ; i++) {
+      x.setVal(rnd.Uniform(-3,3)) ;
+      y.setVal(rnd.Uniform(-3,3)) ;
+      if (i%4==1) x.setRange("ref",rnd.Uniform(-5,-1),rnd.Uniform(1,5)) ;
+      if (i%4==2) x.setRange(rnd.Uniform(-10,-4),rnd.Uniform(4,10)) ;
+      if (i%4==3) y.setRange(rnd.Uniform(-5,-4),rnd.Uniform(4,5)) ;
+      if (i%5==4) f.setVal(rnd.Uniform(0.1,0.9)) ;
+
+      ok &= compareWithCopy(model3,RooArgSet(x),100+i) ;
+      ok &= compareWithCopy(model4,RooArgSet(x,y),100+i) ;
+      ok &= compareWithCopy(model4,RooArgSet(x),100+i) ;
+    }
+
+    return ok ;
+  }
+} ;
+/////////////////////////////////////////////////////////////////////////
+//
+// 'ADDITION AND CONVOLUTION' RooFit test #211
+//
+// Caches of the FFT convolution operator: the forward transform of an
+// input p.d.f. whose parameters did not change is reused, and the outputs
+// of the last parameter points are kept. The values of the convolution,
+// evaluated while the parameters of either input change and when coming
+// back to earlier parameter points, some of them evicted from the cache,
+// must equal the ones of a new convolution without cached transforms
+// (requires ROOT to be compiled with --enable-fftw3)
+//
+// pdf = landau(t) (x) gauss(t)
+//
+/////////////////////////////////////////////////////////////////////////
+
+#ifndef __CINT__
+#include "RooGlobalFunc.h"
+#endif
+#include "RooRealVar.h"
+#include "RooGaussian.h"
+#include "RooLandau.h"
+#include "RooFFTConvPdf.h"
+#include "TPluginManager.h"
+#include "TROOT.h"
+using namespace RooFit ;
+
+
+
+class TestBasic211 : public RooUnitTest
+{
+public:
+  TestBasic211(TFile* refFile, Bool_t writeRef, Int_t verbose) : RooUnitTest("Caches of FFT convolution operator",refFile,writeRef,verbose) {} ;
+
+  Bool_t isTestAvailable() {
+     // only if ROOT was build with fftw3 enabled
+     TString conffeatures = gROOT->GetConfigFeatures();
+     if(conffeatures.Contains("fftw3")) {
+        TPluginHandler *h;
+        if ((h = gROOT->GetPluginManager()->FindHandler("TVirtualFFT"))) {
+           if (h->LoadPlugin() == -1) {
+              gROOT->ProcessLine("new TNamed ;") ;
+              return kFALSE;
+           } else {
+              return kTRUE ;
+           }
+        }
+     }
+     return kFALSE ;
+  }
+
+  // Compare the values of the convolution with the ones of a new convolution of the same inputs
+  Bool_t compareWithNew(RooFFTConvPdf& conv, RooRealVar& t, RooAbsPdf& pdf1, RooAbsPdf& pdf2, const char* step) {
+    RooFFTConvPdf fresh("fresh","fresh",t,pdf1,pdf2) ;
+    Bool_t ok = kTRUE ;
+    const Double_t tvals[] = { -5, 0, 3, 7, 15, 25 } ;
+    for (Int_t i=0 ; i<6 ; i++) {
+      t.setVal(tvals[i]) ;
+      Double_t val = conv.getVal(t) ;
+      Double_t ref = fresh.getVal(t) ;
+      if (fabs(val-ref) > 1e-10*fabs(ref)) {
+        Error("testCode","%s, t=%g: cached value %g, new value %g",step,tvals[i],val,ref) ;
+        ok = kFALSE ;
+      }
+    }
+    return ok ;
+  }
+
+  Bool_t testCode() {
+
+    // S e t u p   c o n v o l u t i o n
+    // ---------------------------------
+
+    RooRealVar t("t","t",-10,30) ;
+    t.setBins(1000,"cache") ;
+
+    RooRealVar ml("ml","mean landau",5.,-20,20) ;
+    RooRealVar sl("sl","sigma landau",1,0.1,10) ;
+    RooLandau landau("lx","lx",t,ml,sl) ;
+
+    RooRealVar mg("mg","mg",0) ;
+    RooRealVar sg("sg","sg",2,0.1,10) ;
+    RooGaussian gauss("gauss","gauss",t,mg,sg) ;
+
+    // Keep the outputs of the last 3 parameter points
+    RooFFTConvPdf lxg("lxg","landau (X) gauss",t,landau,gauss) ;
+    lxg.setParamCacheSize(3) ;
+
+
+    // C h a n g e   t h e   p a r a m e t e r s   o f   e i t h e r   i n p u t
+    // -------------------------------------------------------------------------
+
+    // Parameter points (ml,sg): A and B change the gaussian only, C and D the
+    // landau only, E both. B is then evicted by C, D and E while D is kept
+    const Double_t points[][2] = { {5,1.5}, {5,2.5}, {4,2.5}, {6,2.5}, {7,1} } ;
+    const char* names[] = { "A", "B", "C", "D", "E" } ;
+
+    Bool_t ok = compareWithNew(lxg,t,landau,gauss,"start") ;
+    for (Int_t i=0 ; i<5 ; i++) {
+      ml.setVal(points[i][0]) ;
+      sg.setVal(points[i][1]) ;
+      ok &= compareWithNew(lxg,t,landau,gauss,Form("point %s",names[i])) ;
+    }
+
+
+    // C o m e   b a c k   t o   e a r l i e r   p o i n t s
+    // -----------------------------------------------------
+
+    const Int_t revisit[] = { 3, 1, 0, 3, 4 } ;
+    for (Int_t i=0 ; i<5 ; i++) {
+      Int_t p = revisit[i] ;
+      ml.setVal(points[p][0]) ;
+      sg.setVal(points[p][1]) ;
+      ok &= compareWithNew(lxg,t,landau,gauss,Form("back to point %s",names[p])) ;
+    }
+
+    // A cache size of zero keeps no outputs
+    lxg.setParamCacheSize(0) ;
+    for (Int_t i=0 ; i<3 ; i++) {
+      ml.setVal(points[i][0]) ;
+      sg.setVal(points[i][1]) ;
+      ok &= compareWithNew(lxg,t,landau,gauss,Form("point %s without output cache",names[i])) ;
+    }
+
+    return ok ;
+  }
+} ;
+/////////////////////////////////////////////////////////////////////////
+//
 // 'MULTIDIMENSIONAL MODELS' RooFit tutorial macro #301
 //
 // Multi-dimensional p.d.f.s through composition, e.g. substituting a
@@ -3869,6 +4123,164 @@ public:
   }
 
 } ;
+/////////////////////////////////////////////////////////////////////////
+//
+// 'DATA AND CATEGORIES' RooFit test #407
+//
+// Import of TTrees into datasets with vector storage: the branches are
+// read column by column, the result must be the same, entry by entry, as
+// the import of the same tree into a dataset with tree storage, which
+// copies the events one by one. The trees have branches of several types,
+// entries out of the ranges of the variables, a cut and a weight, and are
+// also imported through a chain of two files
+//
+/////////////////////////////////////////////////////////////////////////
+
+#ifndef __CINT__
+#include "RooGlobalFunc.h"
+#endif
+#include "RooRealVar.h"
+#include "RooDataSet.h"
+#include "TTree.h"
+#include "TChain.h"
+#include "TFile.h"
+#include "TSystem.h"
+#include "TRandom3.h"
+using namespace RooFit ;
+
+
+class TestBasic407 : public RooUnitTest
+{
+public:
+  TestBasic407(TFile* refFile, Bool_t writeRef, Int_t verbose) : RooUnitTest("Columnar import of trees",refFile,writeRef,verbose) {} ;
+
+  // Fill a tree with a double, a float, an integer and a weight branch,
+  // part of the entries being out of the ranges of the variables
+  TTree* makeTree(Int_t nevt, UInt_t seed)
+  {
+    TTree* tree = new TTree("tree","tree") ;
+    Double_t x ;
+    Float_t y ;
+    Int_t n ;
+    Double_t w ;
+    tree->Branch("x",&x,"x/D") ;
+    tree->Branch("y",&y,"y/F") ;
+    tree->Branch("n",&n,"n/I") ;
+    tree->Branch("w",&w,"w/D") ;
+    TRandom3 rnd(seed) ;
+    for (Int_t i=0 ; i<nevt ; i++) {
+      x = rnd.Uniform(-12,12) ;
+      y = rnd.Gaus(0,4) ;
+      n = (Int_t) rnd.Uniform(0,20) ;
+      w = rnd.Uniform(0.5,2) ;
+      tree->Fill() ;
+    }
+    tree->ResetBranchAddresses() ;
+    return tree ;
+  }
+
+  // Import the tree with the given storage type
+  RooDataSet* import(const char* name, RooAbsData::StorageType type, TTree& tree, const RooArgSet& vars, const char* cut, const char* wgtName)
+  {
+    RooAbsData::setDefaultStorageType(type) ;
+    RooDataSet* data ;
+    if (wgtName) {
+      data = new RooDataSet(name,name,vars,Import(tree),Cut(cut),WeightVar(wgtName)) ;
+    } else {
+      data = new RooDataSet(name,name,vars,Import(tree),Cut(cut)) ;
+    }
+    RooAbsData::setDefaultStorageType(RooAbsData::Vector) ;
+    return data ;
+  }
+
+  // Compare the entries and the weights of two datasets
+  Bool_t compare(const char* what, RooDataSet& data, RooDataSet& ref)
+  {
+    if (data.numEntries() != ref.numEntries() || ref.numEntries()==0) {
+      Error("testCode","%s: %d entries imported instead of %d",what,data.numEntries(),ref.numEntries()) ;
+      return kFALSE ;
+    }
+    for (Int_t i=0 ; i<ref.numEntries() ; i++) {
+      const RooArgSet* row = data.get(i) ;
+      const RooArgSet* refRow = ref.get(i) ;
+      RooFIter iter = refRow->fwdIterator() ;
+      RooAbsArg* arg ;
+      while((arg=iter.next())) {
+        Double_t val = row->getRealValue(arg->GetName()) ;
+        Double_t refVal = ((RooAbsReal*)arg)->getVal() ;
+        if (val != refVal) {
+          Error("testCode","%s: entry %d, %s is %g instead of %g",what,i,arg->GetName(),val,refVal) ;
+          return kFALSE ;
+        }
+      }
+      if (data.weight() != ref.weight()) {
+        Error("testCode","%s: entry %d, weight is %g instead of %g",what,i,data.weight(),ref.weight()) ;
+        return kFALSE ;
+      }
+    }
+    if (data.sumEntries() != ref.sumEntries()) {
+      Error("testCode","%s: sum of weights is %g instead of %g",what,data.sumEntries(),ref.sumEntries()) ;
+      return kFALSE ;
+    }
+    return kTRUE ;
+  }
+
+  Bool_t testCode() {
+
+    RooRealVar x("x","x",-10,10) ;
+    RooRealVar y("y","y",-8,8) ;
+    RooRealVar n("n","n",0,15) ;
+    RooRealVar w("w","w",0,10) ;
+    RooArgSet vars(x,y,n) ;
+    RooArgSet wvars(x,y,n,w) ;
+
+    TTree* tree = makeTree(20000,407) ;
+    Bool_t ok = kTRUE ;
+
+    // I m p o r t   a   t r e e
+    // -------------------------
+
+    const char* cuts[] = { "", "x>y", "n<7 || x>5" } ;
+    for (Int_t c=0 ; c<3 ; c++) {
+      RooDataSet* data = import("data",RooAbsData::Vector,*tree,vars,cuts[c],0) ;
+      RooDataSet* ref = import("ref",RooAbsData::Tree,*tree,vars,cuts[c],0) ;
+      ok &= compare(Form("tree, cut '%s'",cuts[c]),*data,*ref) ;
+      delete data ;
+      delete ref ;
+    }
+
+    RooDataSet* data = import("wdata",RooAbsData::Vector,*tree,wvars,"x>y",w.GetName()) ;
+    RooDataSet* ref = import("wref",RooAbsData::Tree,*tree,wvars,"x>y",w.GetName()) ;
+    ok &= compare("weighted tree",*data,*ref) ;
+    delete data ;
+    delete ref ;
+    delete tree ;
+
+
+    // I m p o r t   a   c h a i n   o f   t w o   f i l e s
+    // -----------------------------------------------------
+
+    const char* fileNames[] = { "stressRooFit_407_a.root", "stressRooFit_407_b.root" } ;
+    TChain chain("tree") ;
+    for (Int_t f=0 ; f<2 ; f++) {
+      TFile file(fileNames[f],"RECREATE") ;
+      TTree* t = makeTree(5000+f*3000,408+f) ;
+      t->Write() ;
+      delete t ;
+      file.Close() ;
+      chain.Add(fileNames[f]) ;
+    }
+    data = import("cdata",RooAbsData::Vector,chain,vars,"x>y",0) ;
+    ref = import("cref",RooAbsData::Tree,chain,vars,"x>y",0) ;
+    ok &= compare("chain",*data,*ref) ;
+    delete data ;
+    delete ref ;
+    chain.Reset() ;
+    for (Int_t f=0 ; f<2 ; f++) gSystem->Unlink(fileNames[f]) ;
+
+    return ok ;
+  }
+} ;
 //////////////////////////////////////////////////////////////////////////
 //
 // 'ORGANIZATION AND SIMULTANEOUS FITS' RooFit tutorial macro #501
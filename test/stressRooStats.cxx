@@ -192,6 +192,10 @@ Int_t stressRooStats(const char* refFile, Bool_t writeRef, Int_t verbose, Bool_t
    testList.push_back(new TestHypoTestInverter2(fref, writeRef, verbose, kFrequentist, kProfileLROneSided, 10, 0.95));
    testList.push_back(new TestHypoTestInverter2(fref, writeRef, verbose, kHybrid, kSimpleLR, 10, 0.95));
 
+   // 49-50 TEST HTI PARALLEL SCAN S+B+E POISSON : compare with the serial scan
+   testList.push_back(new TestHypoTestInverter3(fref, writeRef, verbose, kAsymptotic, 10));
+   testList.push_back(new TestHypoTestInverter3(fref, writeRef, verbose, kFrequentist, 10));
+
 
    TString suiteType = TString::Format(" Starting S.T.R.E.S.S. %s",
                                        allTests ? "full suite" : (oneTest ? TString::Format("test %d", testNumber).Data() : "basic suite")
@@ -1755,6 +1755,128 @@ public:
 };
 
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// HYPOTESTINVERTER PARALLEL SCAN - POISSON EFFICIENCY MODEL
+//
+// Compare the fixed scan evaluated in parallel by worker processes with the
+// serial scan. With the asymptotic calculator the CLs values of every point
+// must be identical. With a toy-based calculator the result must not depend
+// on the number of workers, and must agree with the serial scan, which uses
+// different toys, within the statistical uncertainty of the CLs values.
+//
+// ModelConfig (explicit) : Poisson Efficiency Model
+//    built in stressRooStats_models.cxx
+//
+// Input Parameters:
+//    calculatorType -> type of the HypoTestCalculator used in the scan
+//    obsValueX -> observed value "x" when measuring sig * eff + bkg
+//
+///////////////////////////////////////////////////////////////////////////////
+
+class TestHypoTestInverter3 : public RooUnitTest {
+private:
+   ECalculatorType fCalculatorType;
+   Int_t fObsValueX;
+
+   // run the scan with the given number of workers, starting always from the same seed
+   HypoTestInverterResult *runScan(HypoTestCalculatorGeneric &calc, const ModelConfig &sbModel,
+                                   const ModelConfig &bModel, RooRealVar &sig, int nWorkers) {
+      RooRandom::randomGenerator()->SetSeed(12345);
+      HypoTestInverter hti(calc, NULL, 0.05);
+      hti.SetTestStatistic(*buildTestStatistic(kProfileLROneSided, sbModel, bModel));
+      hti.SetVerbose(_verb);
+      hti.SetFixedScan(10, sig.getMin(), sig.getMax() / 2);
+      hti.SetParallelScan(nWorkers);
+      return hti.GetInterval();
+   }
+
+public:
+   TestHypoTestInverter3(
+      TFile* refFile,
+      Bool_t writeRef,
+      Int_t verbose,
+      ECalculatorType calculatorType = kAsymptotic,
+      Int_t obsValueX = 10
+   ) :
+      RooUnitTest(TString::Format("HypoTestInverter Parallel Scan - Poisson Efficiency Model - %s",
+                                  kECalculatorTypeString[calculatorType]), refFile, writeRef, verbose),
+      fCalculatorType(calculatorType),
+      fObsValueX(obsValueX)
+   {};
+
+   Bool_t testCode() {
+
+      // Create workspace and model
+      RooWorkspace *w = new RooWorkspace("w");
+      buildPoissonEfficiencyModel(w);
+      ModelConfig *sbModel = (ModelConfig *)w->obj("S+B");
+      ModelConfig *bModel = (ModelConfig *)w->obj("B");
+
+      // add observed values to data set
+      w->var("x")->setVal(fObsValueX);
+      w->data("data")->add(*sbModel->GetObservables());
+
+      // set snapshots
+      sbModel->SetSnapshot(*sbModel->GetParametersOfInterest());
+      w->var("sig")->setVal(0);
+      bModel->SetSnapshot(*bModel->GetParametersOfInterest());
+
+      AsymptoticCalculator::SetPrintLevel(_verb);
+      HypoTestCalculatorGeneric *calc =
+         buildHypoTestCalculator(fCalculatorType, *w->data("data"), *sbModel, *bModel, 200, 100);
+      if (fCalculatorType == kAsymptotic) {
+         ((AsymptoticCalculator *)calc)->SetOneSided(kTRUE);
+      } else {
+         ToyMCSampler *tmcs = (ToyMCSampler *)calc->GetTestStatSampler();
+         tmcs->SetNEventsPerToy(1);
+         tmcs->SetUseMultiGen(kTRUE);
+      }
+
+      HypoTestInverterResult *serial = runScan(*calc, *sbModel, *bModel, *w->var("sig"), 1);
+      HypoTestInverterResult *parallel2 = runScan(*calc, *sbModel, *bModel, *w->var("sig"), 2);
+      HypoTestInverterResult *parallel3 = runScan(*calc, *sbModel, *bModel, *w->var("sig"), 3);
+
+      Bool_t ok = (serial->ArraySize() == 10 && parallel2->ArraySize() == 10 && parallel3->ArraySize() == 10);
+      for (int i = 0; ok && i < serial->ArraySize(); ++i) {
+         if (parallel2->GetXValue(i) != serial->GetXValue(i)) {
+            Error("testCode", "point %d: x = %g in the parallel scan, %g in the serial scan", i,
+                  parallel2->GetXValue(i), serial->GetXValue(i));
+            ok = kFALSE;
+         }
+         if (fCalculatorType == kAsymptotic) {
+            if (parallel2->CLs(i) != serial->CLs(i)) {
+               Error("testCode", "point %d: CLs = %g in the parallel scan, %g in the serial scan", i,
+                     parallel2->CLs(i), serial->CLs(i));
+               ok = kFALSE;
+            }
+         } else {
+            if (parallel2->CLs(i) != parallel3->CLs(i)) {
+               Error("testCode", "point %d: CLs = %g with 2 workers, %g with 3 workers", i,
+                     parallel2->CLs(i), parallel3->CLs(i));
+               ok = kFALSE;
+            }
+            double sigma = sqrt(pow(parallel2->CLsError(i), 2) + pow(serial->CLsError(i), 2));
+            if (fabs(parallel2->CLs(i) - serial->CLs(i)) > 5 * sigma + 1.E-6) {
+               Error("testCode", "point %d: CLs = %g +- %g in the parallel scan, %g +- %g in the serial scan", i,
+                     parallel2->CLs(i), parallel2->CLsError(i), serial->CLs(i), serial->CLsError(i));
+               ok = kFALSE;
+            }
+         }
+      }
+
+      // cleanup
+      delete serial;
+      delete parallel2;
+      delete parallel3;
+      delete calc;
+      delete w;
+
+      return ok;
+   }
+};
+
+
 //
 // END OF PART FIVE
 //
@@ -845,6 +845,7 @@ private:
    void _testConstructor4();
    void _testConstructor5();
    void _testConstructor6();
+   void _testAssignment();
    void _testMutators();
 
    // there are six different constructors:
@@ -918,6 +919,7 @@ void utEvent::run()
    _testConstructor4();
    _testConstructor5();
    _testConstructor6();
+   _testAssignment(); // after all constructors
 }
 
 
@@ -1113,6 +1115,39 @@ void utEvent::_testConstructor6()
 
 
 
+void utEvent::_testAssignment()
+{
+   // the vectors of different sizes of the target are replaced
+   Event event( *_eventC5 );
+   event = *_eventC3;
+
+   test_(event.IsDynamic()         == false);
+   test_(floatCompare(event.GetOriginalWeight(), _testWeight));
+   test_(floatCompare(event.GetBoostWeight(), _testBoostWeight));
+   test_(event.GetClass()          == _testClassVal);
+   test_(event.GetNVariables()     == (UInt_t)_testValueVec.size());
+   test_(event.GetNTargets()       == (UInt_t)_testTargetVec.size());
+   test_(event.GetNSpectators()    == (UInt_t)_testSpectatorVec.size());
+   for (UInt_t i = 0; i < _testValueVec.size(); i++)     test_(event.GetValue(i)     == _testValueVec[i]);
+   for (UInt_t i = 0; i < _testTargetVec.size(); i++)    test_(event.GetTarget(i)    == _testTargetVec[i]);
+   for (UInt_t i = 0; i < _testSpectatorVec.size(); i++) test_(event.GetSpectator(i) == _testSpectatorVec[i]);
+
+   // self assignment
+   const Event& self = event;
+   event = self;
+   test_(event.GetNVariables()     == (UInt_t)_testValueVec.size());
+   test_(event.GetValue(0)         == _testValueVec[0]);
+
+   // the values of a dynamic event are copied, the copy is not dynamic
+   event = *_eventC6;
+   test_(event.IsDynamic()         == false);
+   test_(event.GetNVariables()     == _testNVar);
+   test_(event.GetNSpectators()    == (UInt_t)_testPointerVec.size() - _testNVar);
+   for (UInt_t i = 0; i < _testNVar; i++) test_(event.GetValue(i) == *_testPointerVec[i]);
+}
+
+
+
 void utEvent::_testMutators()
 {
    // the empty/default constructor is taken for these tests
@@ -2827,6 +2862,1251 @@ bool MethodUnitTestWithComplexData::create_data(const char* filename, int nmax)
    dataFile->Close();
    return true;
 }
+// including file tmvaut/MethodComparisonUnitTest.h
+#ifndef METHODCOMPARISONUNITTEST_H
+#define METHODCOMPARISONUNITTEST_H
+
+// TMVA unit tests
+//
+// helpers for the tests comparing two ways of training or evaluating
+// the same method on the toy signal and background sample
+
+#include "TFile.h"
+#include "TString.h"
+
+#include "TMVA/DataLoader.h"
+
+namespace UnitTesting
+{
+   // open the toy signal and background sample
+   TFile* OpenToySigBkg();
+
+   // data loader with the 4 variables of the toy sample, split into training and test samples
+   TMVA::DataLoader* CreateToyDataLoader(TFile* input, const TString& name = "dataset",
+                                         const TString& splitOpt = "nTrain_Signal=1000:nTrain_Background=1000:nTest_Signal=5000:nTest_Background=5000");
+} // namespace UnitTesting
+#endif // METHODCOMPARISONUNITTEST_H
+// including file tmvaut/MethodComparisonUnitTest.cxx
+
+#include "TSystem.h"
+#include "TTree.h"
+#include "TCut.h"
+
+TFile* UnitTesting::OpenToySigBkg()
+{
+   FileStat_t stat;
+   TString fname = "../tmva/test/data/toy_sigbkg.root";
+   const char *fcname = gSystem->ExpandPathName("$ROOTSYS/tmva/test/data/toy_sigbkg.root");
+   TFile* input = 0;
+   if(!gSystem->GetPathInfo(fname,stat)) {
+      input = TFile::Open( fname );
+   } else if(!gSystem->GetPathInfo("../"+fname,stat)) {
+      input = TFile::Open( "../"+fname );
+   } else if(fcname && !gSystem->GetPathInfo(fcname,stat)) {
+      input = TFile::Open( fcname );
+   } else {
+      input = TFile::Open( "http://root.cern.ch/files/tmva_class_example.root" );
+   }
+   delete [] fcname;
+   if (input == NULL) {
+      std::cerr << "broken/inaccessible input file" << std::endl;
+   }
+   return input;
+}
+
+TMVA::DataLoader* UnitTesting::CreateToyDataLoader(TFile* input, const TString& name, const TString& splitOpt)
+{
+   TMVA::DataLoader* dataloader = new TMVA::DataLoader(name);
+   dataloader->AddVariable( "var1", 'F' );
+   dataloader->AddVariable( "var2", 'F' );
+   dataloader->AddVariable( "var3", 'F' );
+   dataloader->AddVariable( "var4", 'F' );
+   dataloader->AddSignalTree((TTree*)input->Get("TreeS"));
+   dataloader->AddBackgroundTree((TTree*)input->Get("TreeB"));
+   dataloader->SetBackgroundWeightExpression("weight");
+   dataloader->PrepareTrainingAndTestTree( TCut(""), TCut(""), splitOpt + ":SplitMode=Random:NormMode=NumEvents:!V" );
+   return dataloader;
+}
+
+// including file tmvaut/utBDTHistTraining.h
+#ifndef UTBDTHISTTRAINING_H
+#define UTBDTHISTTRAINING_H
+
+// TMVA unit tests
+//
+// the BDT grown on the quantized sample (UseHistTraining) must perform as
+// well as the one grown on the original values: the ROC integrals of the
+// two must agree within the given tolerance
+
+#include "TString.h"
+
+namespace UnitTesting
+{
+   class utBDTHistTraining : public UnitTest
+   {
+   public:
+      utBDTHistTraining(const TString& options, double tolerance = 0.01);
+      void run();
+
+   private:
+      TString fOptions;
+      double fTolerance;
+   };
+} // namespace UnitTesting
+#endif // UTBDTHISTTRAINING_H
+// including file tmvaut/utBDTHistTraining.cxx
+
+#include "TMVA/Factory.h"
+#include "TMVA/MethodBase.h"
+
+using namespace UnitTesting;
+
+utBDTHistTraining::utBDTHistTraining(const TString& options, double tolerance) :
+   UnitTest("BDTHistTraining", __FILE__), fOptions(options), fTolerance(tolerance)
+{
+}
+
+void utBDTHistTraining::run()
+{
+   TFile* input = OpenToySigBkg();
+   TFile* outputFile = TFile::Open( "weights/TMVAHistTraining.root", "RECREATE" );
+   if (!input || !outputFile) {
+      fail_("cannot open the input or the output file");
+      return;
+   }
+
+   TMVA::Factory* factory = new TMVA::Factory( "TMVAHistTraining", outputFile,
+                                               "!V:Silent:AnalysisType=Classification:!Color:!DrawProgressBar" );
+   TMVA::DataLoader* dataloader = CreateToyDataLoader(input);
+   factory->BookMethod(dataloader, TMVA::Types::kBDT, "BDT", fOptions);
+   factory->BookMethod(dataloader, TMVA::Types::kBDT, "BDTHist", fOptions + ":UseHistTraining");
+   factory->TrainAllMethods();
+   factory->TestAllMethods();
+   factory->EvaluateAllMethods();
+
+   TMVA::MethodBase* bdt     = dynamic_cast<TMVA::MethodBase*>(factory->GetMethod(dataloader->GetName(), "BDT"));
+   TMVA::MethodBase* bdtHist = dynamic_cast<TMVA::MethodBase*>(factory->GetMethod(dataloader->GetName(), "BDTHist"));
+   test_(bdt && bdtHist);
+   if (bdt && bdtHist) {
+      double roc     = bdt->GetROCIntegral();
+      double rocHist = bdtHist->GetROCIntegral();
+      if (TMath::Abs(roc - rocHist) > fTolerance)
+         std::cout << "failure in BDTHistTraining, ROC integral = " << rocHist << " with UseHistTraining, "
+                   << roc << " without" << std::endl;
+      test_(TMath::Abs(roc - rocHist) <= fTolerance);
+   }
+
+   outputFile->Close();
+   delete dataloader;
+   delete factory;
+   delete outputFile;
+   delete input;
+}
+
+// including file tmvaut/utBDTParallelTraining.h
+#ifndef UTBDTPARALLELTRAINING_H
+#define UTBDTPARALLELTRAINING_H
+
+// TMVA unit tests
+//
+// the BDTs trained with implicit multi-threading, which scans the variables
+// of the large nodes in parallel (DecisionTree::TrainNodeFast), must give
+// exactly the same responses as the ones trained serially
+
+#include <vector>
+#include "TString.h"
+
+namespace UnitTesting
+{
+   class utBDTParallelTraining : public UnitTest
+   {
+   public:
+      utBDTParallelTraining();
+      void run();
+
+   private:
+      bool train(const TString& jobName, TFile* input, bool imt);
+      std::vector<Double_t> evaluate(const TString& jobName, const TString& methodTitle, TTree* tree, Long64_t nEvents);
+   };
+} // namespace UnitTesting
+#endif // UTBDTPARALLELTRAINING_H
+// including file tmvaut/utBDTParallelTraining.cxx
+
+#include "TROOT.h"
+#include "TMVA/Factory.h"
+#include "TMVA/Reader.h"
+
+using namespace UnitTesting;
+
+utBDTParallelTraining::utBDTParallelTraining() : UnitTest("BDTParallelTraining", __FILE__)
+{
+}
+
+bool utBDTParallelTraining::train(const TString& jobName, TFile* input, bool imt)
+{
+#ifdef R__USE_IMT
+   if (imt) ROOT::EnableImplicitMT(4);
+#endif
+   TFile* outputFile = TFile::Open( "weights/" + jobName + ".root", "RECREATE" );
+   if (!outputFile) return false;
+
+   // training samples large enough for the parallel scan in the first levels of the trees
+   TMVA::Factory* factory = new TMVA::Factory( jobName, outputFile,
+                                               "!V:Silent:AnalysisType=Classification:!Color:!DrawProgressBar" );
+   TMVA::DataLoader* dataloader = CreateToyDataLoader(input, "dataset",
+                                                      "nTrain_Signal=4000:nTrain_Background=4000:nTest_Signal=1000:nTest_Background=1000");
+   factory->BookMethod(dataloader, TMVA::Types::kBDT, "BDT",
+                       "!H:!V:NTrees=100:MaxDepth=4:BoostType=AdaBoost:nCuts=20");
+   factory->BookMethod(dataloader, TMVA::Types::kBDT, "BDTG",
+                       "!H:!V:NTrees=100:MaxDepth=3:BoostType=Grad:Shrinkage=0.3:UseBaggedBoost:BaggedSampleFraction=0.6:nCuts=20");
+   factory->BookMethod(dataloader, TMVA::Types::kBDT, "BDTR",
+                       "!H:!V:NTrees=100:MaxDepth=4:BoostType=AdaBoost:UseRandomisedTrees:UseNvars=2:nCuts=20");
+   factory->TrainAllMethods();
+   outputFile->Close();
+   delete dataloader;
+   delete factory;
+   delete outputFile;
+#ifdef R__USE_IMT
+   if (imt) ROOT::DisableImplicitMT();
+#endif
+   return true;
+}
+
+std::vector<Double_t> utBDTParallelTraining::evaluate(const TString& jobName, const TString& methodTitle, TTree* tree, Long64_t nEvents)
+{
+   const UInt_t nvar = 4;
+   std::vector<Float_t> vars(nvar);
+   TMVA::Reader reader("!Color:Silent");
+   for (UInt_t ivar = 0; ivar < nvar; ivar++) {
+      reader.AddVariable(Form("var%d", ivar+1), &vars[ivar]);
+      tree->SetBranchAddress(Form("var%d", ivar+1), &vars[ivar]);
+   }
+   reader.BookMVA(methodTitle, "dataset/weights/" + jobName + "_" + methodTitle + ".weights.xml");
+
+   nEvents = TMath::Min(nEvents, tree->GetEntries());
+   std::vector<Double_t> values(nEvents);
+   for (Long64_t ievt = 0; ievt < nEvents; ievt++) {
+      tree->GetEntry(ievt);
+      values[ievt] = reader.EvaluateMVA(methodTitle);
+   }
+   tree->ResetBranchAddresses();
+   return values;
+}
+
+void utBDTParallelTraining::run()
+{
+   TFile* input = OpenToySigBkg();
+   if (!input) {
+      fail_("cannot open the input file");
+      return;
+   }
+   bool trained = train("TMVASerialTraining", input, false) && train("TMVAParallelTraining", input, true);
+   test_(trained);
+   if (!trained) {
+      delete input;
+      return;
+   }
+
+   const char* methods[] = { "BDT", "BDTG", "BDTR" };
+   const char* trees[] = { "TreeS", "TreeB" };
+   for (UInt_t i = 0; i < 3; i++) {
+      for (UInt_t t = 0; t < 2; t++) {
+         TTree* tree = (TTree*)input->Get(trees[t]);
+         std::vector<Double_t> serial = evaluate("TMVASerialTraining", methods[i], tree, 2000);
+         std::vector<Double_t> parallel = evaluate("TMVAParallelTraining", methods[i], tree, 2000);
+         Long64_t nDiff = 0;
+         for (size_t ievt = 0; ievt < serial.size(); ievt++) {
+            if (parallel[ievt] != serial[ievt]) nDiff++;
+         }
+         if (nDiff)
+            std::cout << "failure in BDTParallelTraining, " << methods[i] << ": " << nDiff << " of " << serial.size()
+                      << " responses in " << trees[t] << " differ between the parallel and the serial training" << std::endl;
+         test_(nDiff == 0 && !serial.empty());
+      }
+   }
+   delete input;
+}
+
+// including file tmvaut/utBDTBatchEvaluation.h
+#ifndef UTBDTBATCHEVALUATION_H
+#define UTBDTBATCHEVALUATION_H
+
+// TMVA unit tests
+//
+// the batch evaluation of a BDT by the Reader (flattened forest) must give
+// exactly the same responses as the evaluation event by event
+
+namespace UnitTesting
+{
+   class utBDTBatchEvaluation : public UnitTest
+   {
+   public:
+      utBDTBatchEvaluation();
+      void run();
+
+   private:
+      void compare(const TString& methodTitle, TTree* tree, Long64_t nEvents);
+   };
+} // namespace UnitTesting
+#endif // UTBDTBATCHEVALUATION_H
+// including file tmvaut/utBDTBatchEvaluation.cxx
+
+#include "TMVA/Factory.h"
+#include "TMVA/Reader.h"
+
+using namespace UnitTesting;
+
+utBDTBatchEvaluation::utBDTBatchEvaluation() : UnitTest("BDTBatchEvaluation", __FILE__)
+{
+}
+
+void utBDTBatchEvaluation::compare(const TString& methodTitle, TTree* tree, Long64_t nEvents)
+{
+   const UInt_t nvar = 4;
+   std::vector<Float_t> vars(nvar);
+   TMVA::Reader reader("!Color:Silent");
+   for (UInt_t ivar = 0; ivar < nvar; ivar++) {
+      reader.AddVariable(Form("var%d", ivar+1), &vars[ivar]);
+      tree->SetBranchAddress(Form("var%d", ivar+1), &vars[ivar]);
+   }
+   reader.BookMVA(methodTitle, "dataset/weights/TMVABatchEvaluation_" + methodTitle + ".weights.xml");
+
+   // event by event, and the inputs column-major for the batch interface
+   nEvents = TMath::Min(nEvents, tree->GetEntries());
+   std::vector<Float_t> inputs(nvar*nEvents);
+   std::vector<Double_t> reference(nEvents), values(nEvents);
+   for (Long64_t ievt = 0; ievt < nEvents; ievt++) {
+      tree->GetEntry(ievt);
+      for (UInt_t ivar = 0; ivar < nvar; ivar++) inputs[ivar*nEvents+ievt] = vars[ivar];
+      reference[ievt] = reader.EvaluateMVA(methodTitle);
+   }
+   tree->ResetBranchAddresses();
+
+   reader.EvaluateMVA(&inputs[0], nEvents, methodTitle, &values[0]);
+
+   Long64_t nDiff = 0;
+   for (Long64_t ievt = 0; ievt < nEvents; ievt++) {
+      if (values[ievt] != reference[ievt]) nDiff++;
+   }
+   if (nDiff)
+      std::cout << "failure in BDTBatchEvaluation, " << methodTitle << ": " << nDiff << " of " << nEvents
+                << " batch responses differ from the ones evaluated event by event" << std::endl;
+   test_(nDiff == 0);
+}
+
+void utBDTBatchEvaluation::run()
+{
+   TFile* input = OpenToySigBkg();
+   TFile* outputFile = TFile::Open( "weights/TMVABatchEvaluation.root", "RECREATE" );
+   if (!input || !outputFile) {
+      fail_("cannot open the input or the output file");
+      return;
+   }
+
+   TMVA::Factory* factory = new TMVA::Factory( "TMVABatchEvaluation", outputFile,
+                                               "!V:Silent:AnalysisType=Classification:!Color:!DrawProgressBar" );
+   TMVA::DataLoader* dataloader = CreateToyDataLoader(input);
+   factory->BookMethod(dataloader, TMVA::Types::kBDT, "BDT",
+                       "!H:!V:NTrees=200:MaxDepth=3:BoostType=AdaBoost:nCuts=20");
+   factory->BookMethod(dataloader, TMVA::Types::kBDT, "BDTYesNo",
+                       "!H:!V:NTrees=200:MaxDepth=3:BoostType=AdaBoost:UseYesNoLeaf:nCuts=20");
+   factory->BookMethod(dataloader, TMVA::Types::kBDT, "BDTG",
+                       "!H:!V:NTrees=200:MaxDepth=3:BoostType=Grad:Shrinkage=0.3:nCuts=20");
+   factory->BookMethod(dataloader, TMVA::Types::kBDT, "BDTD",
+                       "!H:!V:NTrees=200:MaxDepth=3:BoostType=AdaBoost:nCuts=20:VarTransform=Decorrelate");
+   factory->TrainAllMethods();
+   outputFile->Close();
+   delete dataloader;
+   delete factory;
+   delete outputFile;
+
+   // 1000 events is not a multiple of the block size of the batch evaluation
+   const char* methods[] = { "BDT", "BDTYesNo", "BDTG", "BDTD" };
+   for (UInt_t i = 0; i < 4; i++) {
+      compare(methods[i], (TTree*)input->Get("TreeS"), 1000);
+      compare(methods[i], (TTree*)input->Get("TreeB"), 1000);
+   }
+   delete input;
+}
+
+// including file tmvaut/utStreamingDataLoader.h
+#ifndef UTSTREAMINGDATALOADER_H
+#define UTSTREAMINGDATALOADER_H
+
+// TMVA unit tests
+//
+// the StreamingDataLoader must read every entry of the training trees once
+// per pass, with the formulas kept across the switches between the trees of
+// the shuffled chunks, and give the trees back with their branch status and
+// cache size; the standard DNN must train on the stream
+
+class TTree;
+
+namespace UnitTesting
+{
+   class utStreamingDataLoader : public UnitTest
+   {
+   public:
+      utStreamingDataLoader();
+      void run();
+
+   private:
+      TTree* createTree(const char* name, Long64_t nEntries, Float_t shift);
+      void   testLoader(TTree* treeS, TTree* treeB);
+      void   testDNN(TTree* treeS, TTree* treeB, TTree* testS, TTree* testB);
+   };
+} // namespace UnitTesting
+#endif // UTSTREAMINGDATALOADER_H
+// including file tmvaut/utStreamingDataLoader.cxx
+
+#include "TRandom3.h"
+#include "TMVA/DataSetInfo.h"
+#include "TMVA/DataSetManager.h"
+#include "TMVA/Event.h"
+#include "TMVA/Factory.h"
+#include "TMVA/MethodBase.h"
+#include "TMVA/StreamingDataLoader.h"
+
+using namespace UnitTesting;
+
+utStreamingDataLoader::utStreamingDataLoader() : UnitTest("StreamingDataLoader", __FILE__)
+{
+}
+
+TTree* utStreamingDataLoader::createTree(const char* name, Long64_t nEntries, Float_t shift)
+{
+   // clusters of 500 entries: the chunks of the signal and background trees alternate
+   TRandom3 rnd(UInt_t(nEntries + 1000*(shift + 1)));
+   Float_t vars[4], weight = 1, extra = 0;
+   TTree* tree = new TTree(name, name);
+   tree->SetAutoFlush(500);
+   for (Int_t ivar = 0; ivar < 4; ivar++) tree->Branch(Form("var%d", ivar+1), &vars[ivar], Form("var%d/F", ivar+1));
+   tree->Branch("weight", &weight, "weight/F");
+   tree->Branch("extra", &extra, "extra/F");
+   for (Long64_t i = 0; i < nEntries; i++) {
+      for (Int_t ivar = 0; ivar < 4; ivar++) vars[ivar] = rnd.Gaus(shift*(ivar+1)/4., 1.);
+      extra = i;
+      tree->Fill();
+   }
+   tree->Write();
+   tree->ResetBranchAddresses();
+   return tree;
+}
+
+void utStreamingDataLoader::testLoader(TTree* treeS, TTree* treeB)
+{
+   // the settings the loader must restore
+   treeS->SetBranchStatus("extra", 0);
+   treeS->SetCacheSize(1000000);
+   const Long64_t cacheSizeB = treeB->GetCacheSize();
+
+   Double_t sum = 0;
+   Long64_t nEntries = treeS->GetEntries() + treeB->GetEntries();
+   TTree* trees[] = { treeS, treeB };
+   for (Int_t itree = 0; itree < 2; itree++) {
+      Float_t var1;
+      trees[itree]->SetBranchAddress("var1", &var1);
+      for (Long64_t i = 0; i < trees[itree]->GetEntries(); i++) {
+         trees[itree]->GetEntry(i);
+         sum += var1;
+      }
+      trees[itree]->ResetBranchAddresses();
+   }
+
+   TMVA::DataLoader* dataloader = new TMVA::DataLoader("streamingloader");
+   for (Int_t ivar = 0; ivar < 4; ivar++) dataloader->AddVariable(Form("var%d", ivar+1), 'F');
+   dataloader->AddSignalTree(treeS, 1., TMVA::Types::kTraining);
+   dataloader->AddBackgroundTree(treeB, 1., TMVA::Types::kTraining);
+   TMVA::DataSetInfo& dsi = const_cast<TMVA::DataSetInfo&>(dataloader->GetDefaultDataSetInfo());
+
+   TMVA::StreamingDataLoader* loader =
+      new TMVA::StreamingDataLoader(dsi, dsi.GetDataSetManager()->DataInput(), TMVA::Types::kTraining, 700, 1);
+   test_(loader->GetNEntries() == nEntries);
+   for (Int_t pass = 0; pass < 2; pass++) {
+      Long64_t n = 0, nSignal = 0;
+      Double_t passSum = 0;
+      loader->Rewind();
+      for (;;) {
+         const std::vector<TMVA::Event*>& buffer = loader->NextBuffer();
+         if (buffer.empty()) break;
+         test_(buffer.size() <= 700);
+         for (UInt_t i = 0; i < buffer.size(); i++) {
+            passSum += buffer[i]->GetValue(0);
+            if (buffer[i]->GetClass() == 0) nSignal++;
+         }
+         n += buffer.size();
+      }
+      if (n != nEntries || TMath::Abs(passSum - sum) > 1e-6*(1 + TMath::Abs(sum)))
+         std::cout << "failure in StreamingDataLoader, pass " << pass << ": " << n << " events of "
+                   << nEntries << ", sum of var1 " << passSum << " instead of " << sum << std::endl;
+      test_(n == nEntries);
+      test_(nSignal == treeS->GetEntries());
+      test_(TMath::Abs(passSum - sum) <= 1e-6*(1 + TMath::Abs(sum)));
+   }
+
+   // online bagging: the repeated events are copies of the drawn one
+   loader->SetBagging(1.);
+   loader->Rewind();
+   Long64_t nBagged = 0;
+   for (;;) {
+      const std::vector<TMVA::Event*>& buffer = loader->NextBuffer();
+      if (buffer.empty()) break;
+      for (UInt_t i = 0; i < buffer.size(); i++) test_(buffer[i]->GetNVariables() == 4);
+      nBagged += buffer.size();
+   }
+   test_(TMath::Abs(nBagged - nEntries) < 5*TMath::Sqrt(nEntries));
+   delete loader;
+
+   test_(treeS->GetBranchStatus("var1"));
+   test_(treeS->GetBranchStatus("weight"));
+   test_(!treeS->GetBranchStatus("extra"));
+   test_(treeB->GetBranchStatus("extra"));
+   test_(treeS->GetCacheSize() == 1000000);
+   test_(treeB->GetCacheSize() == cacheSizeB);
+
+   delete dataloader;
+   treeS->SetBranchStatus("*", 1);
+}
+
+void utStreamingDataLoader::testDNN(TTree* treeS, TTree* treeB, TTree* testS, TTree* testB)
+{
+   TFile* outputFile = TFile::Open( "weights/TMVAStreamingDNN.root", "RECREATE" );
+   if (!outputFile) {
+      fail_("cannot open the output file");
+      return;
+   }
+   TMVA::Factory* factory = new TMVA::Factory( "TMVAStreamingDNN", outputFile,
+                                               "!V:Silent:AnalysisType=Classification:!Color:!DrawProgressBar" );
+   TMVA::DataLoader* dataloader = new TMVA::DataLoader("dataset");
+   for (Int_t ivar = 0; ivar < 4; ivar++) dataloader->AddVariable(Form("var%d", ivar+1), 'F');
+   dataloader->AddSignalTree(treeS, 1., TMVA::Types::kTraining);
+   dataloader->AddBackgroundTree(treeB, 1., TMVA::Types::kTraining);
+   dataloader->AddSignalTree(testS, 1., TMVA::Types::kTesting);
+   dataloader->AddBackgroundTree(testB, 1., TMVA::Types::kTesting);
+   dataloader->PrepareTrainingAndTestTree( TCut(""), TCut(""), "StreamTraining:StreamBufferSize=1000:NormMode=None:!V" );
+   factory->BookMethod(dataloader, TMVA::Types::kDNN, "DNNStream",
+                       "!H:!V:Architecture=STANDARD:VarTransform=N:ErrorStrategy=CROSSENTROPY:Layout=TANH|16,LINEAR"
+                       ":TrainingStrategy=LearningRate=0.05,Momentum=0.5,ConvergenceSteps=5,BatchSize=50,"
+                       "TestRepetitions=1,Regularization=None,Multithreading=False");
+   factory->TrainAllMethods();
+   factory->TestAllMethods();
+   factory->EvaluateAllMethods();
+
+   TMVA::MethodBase* dnn = dynamic_cast<TMVA::MethodBase*>(factory->GetMethod(dataloader->GetName(), "DNNStream"));
+   test_(dnn);
+   if (dnn) {
+      double roc = dnn->GetROCIntegral();
+      if (roc < 0.8) std::cout << "failure in StreamingDataLoader, ROC integral of the streamed DNN = " << roc << std::endl;
+      test_(roc >= 0.8);
+   }
+   test_(treeS->GetBranchStatus("extra"));
+
+   outputFile->Close();
+   delete dataloader;
+   delete factory;
+   delete outputFile;
+}
+
+void utStreamingDataLoader::run()
+{
+   TFile* file = TFile::Open( "weights/TMVAStreamingInput.root", "RECREATE" );
+   if (!file) {
+      fail_("cannot open the input file");
+      return;
+   }
+   TTree* treeS = createTree("TreeS", 5000,  1.);
+   TTree* treeB = createTree("TreeB", 5000, -1.);
+   TTree* testS = createTree("TestS", 2000,  1.);
+   TTree* testB = createTree("TestB", 2000, -1.);
+
+   testLoader(treeS, treeB);
+   testDNN(treeS, treeB, testS, testB);
+
+   file->Close();
+   delete file;
+}
+
+// including file tmvaut/utCrossValidation.h
+#ifndef UTCROSSVALIDATION_H
+#define UTCROSSVALIDATION_H
+
+// TMVA unit tests
+//
+// the folds of Factory::CrossValidate trained in worker processes must give
+// the ROC integrals of the serial training, leave the number of workers
+// unchanged and not write the output file of the factory
+
+namespace UnitTesting
+{
+   class utCrossValidation : public UnitTest
+   {
+   public:
+      utCrossValidation();
+      void run();
+   };
+} // namespace UnitTesting
+#endif // UTCROSSVALIDATION_H
+// including file tmvaut/utCrossValidation.cxx
+
+#include "TNamed.h"
+#include "TMVA/Config.h"
+#include "TMVA/Factory.h"
+
+using namespace UnitTesting;
+
+utCrossValidation::utCrossValidation() : UnitTest("CrossValidation", __FILE__)
+{
+}
+
+void utCrossValidation::run()
+{
+   TFile* input = OpenToySigBkg();
+   TFile* outputFile = TFile::Open( "weights/TMVACrossValidation.root", "RECREATE" );
+   if (!input || !outputFile) {
+      fail_("cannot open the input or the output file");
+      return;
+   }
+   TNamed marker("marker", "written before the cross validation");
+   outputFile->WriteTObject(&marker);
+
+   TMVA::Factory* factory = new TMVA::Factory( "TMVACrossValidation", outputFile,
+                                               "!V:Silent:AnalysisType=Classification:!Color:!DrawProgressBar" );
+   TMVA::DataLoader* dataloader = CreateToyDataLoader(input, "cvdataset");
+
+   const Int_t nFolds = 3;
+   const UInt_t nWorkers = TMVA::gConfig().GetNWorkers();
+   float serial[nFolds], parallel[nFolds];
+   TMVA::gConfig().SetNWorkers(1);
+   factory->CrossValidate(dataloader, TMVA::Types::kFisher, "Fisher", "!H:!V", false, nFolds, true, serial);
+   TMVA::gConfig().SetNWorkers(3);
+   factory->CrossValidate(dataloader, TMVA::Types::kFisher, "Fisher", "!H:!V", false, nFolds, false, parallel);
+   test_(TMVA::gConfig().GetNWorkers() == 3);
+   TMVA::gConfig().SetNWorkers(nWorkers);
+
+   for (Int_t fold = 0; fold < nFolds; fold++) {
+      if (TMath::Abs(serial[fold] - parallel[fold]) > 1e-6)
+         std::cout << "failure in CrossValidation, fold " << fold+1 << ": ROC integral " << parallel[fold]
+                   << " in a worker, " << serial[fold] << " in the serial training" << std::endl;
+      test_(TMath::Abs(serial[fold] - parallel[fold]) <= 1e-6);
+   }
+
+   // the file is written and closed by this process only
+   marker.SetTitle("written after the cross validation");
+   outputFile->WriteTObject(&marker, "marker2");
+   outputFile->Close();
+   delete dataloader;
+   delete factory;
+   delete outputFile;
+   delete input;
+
+   TFile* check = TFile::Open( "weights/TMVACrossValidation.root" );
+   test_(check && !check->IsZombie() && !check->TestBit(TFile::kRecovered));
+   if (check) {
+      test_(check->Get("marker") != 0);
+      test_(check->Get("marker2") != 0);
+      delete check;
+   }
+}
+
+// including file tmvaut/utEvaluateInWorkers.h
+#ifndef UTEVALUATEINWORKERS_H
+#define UTEVALUATEINWORKERS_H
+
+// TMVA unit tests
+//
+// the responses of the classifiers evaluated by the Factory in worker
+// processes, and the ROC integrals computed from them, must be the ones of
+// the serial evaluation; the workers must not write the output file
+
+#include <vector>
+
+namespace UnitTesting
+{
+   class utEvaluateInWorkers : public UnitTest
+   {
+   public:
+      utEvaluateInWorkers();
+      void run();
+
+   private:
+      // train, test and evaluate the methods with nWorkers workers, return
+      // the test responses and the ROC integral of each method
+      void evaluate(TFile* input, UInt_t nWorkers, const TString& name,
+                    std::vector<std::vector<Float_t> >& values, std::vector<Double_t>& rocs);
+   };
+} // namespace UnitTesting
+#endif // UTEVALUATEINWORKERS_H
+// including file tmvaut/utEvaluateInWorkers.cxx
+
+#include "TMVA/Config.h"
+#include "TMVA/Factory.h"
+#include "TMVA/MethodBase.h"
+#include "TMVA/ResultsClassification.h"
+
+using namespace UnitTesting;
+
+namespace {
+   const char* gWorkerMethods[] = { "Fisher", "Likelihood", "BDT" };
+}
+
+utEvaluateInWorkers::utEvaluateInWorkers() : UnitTest("EvaluateInWorkers", __FILE__)
+{
+}
+
+void utEvaluateInWorkers::evaluate(TFile* input, UInt_t nWorkers, const TString& name,
+                                   std::vector<std::vector<Float_t> >& values, std::vector<Double_t>& rocs)
+{
+   TString fileName = "weights/TMVA" + name + ".root";
+   TFile* outputFile = TFile::Open( fileName, "RECREATE" );
+   if (!outputFile) {
+      fail_("cannot open the output file");
+      return;
+   }
+
+   const UInt_t nWorkersBefore = TMVA::gConfig().GetNWorkers();
+   TMVA::gConfig().SetNWorkers(nWorkers);
+   TMVA::Factory* factory = new TMVA::Factory( "TMVA" + name, outputFile,
+                                               "!V:Silent:AnalysisType=Classification:!Color:!DrawProgressBar" );
+   TMVA::DataLoader* dataloader = CreateToyDataLoader(input, name);
+   factory->BookMethod(dataloader, TMVA::Types::kFisher, "Fisher", "!H:!V");
+   factory->BookMethod(dataloader, TMVA::Types::kLikelihood, "Likelihood", "!H:!V");
+   factory->BookMethod(dataloader, TMVA::Types::kBDT, "BDT", "!H:!V:NTrees=100:MaxDepth=3:BoostType=AdaBoost:nCuts=20");
+   factory->TrainAllMethods();
+   factory->TestAllMethods();
+   factory->EvaluateAllMethods();
+   TMVA::gConfig().SetNWorkers(nWorkersBefore);
+
+   for (UInt_t i = 0; i < 3; i++) {
+      TMVA::MethodBase* mva = dynamic_cast<TMVA::MethodBase*>(factory->GetMethod(dataloader->GetName(), gWorkerMethods[i]));
+      test_(mva);
+      if (!mva) continue;
+      TMVA::ResultsClassification* results = dynamic_cast<TMVA::ResultsClassification*>(
+         mva->Data()->GetResults(mva->GetMethodName(), TMVA::Types::kTesting, TMVA::Types::kClassification));
+      test_(results);
+      if (results) values.push_back(*results->GetValueVector());
+      rocs.push_back(mva->GetROCIntegral());
+   }
+
+   outputFile->Close();
+   delete dataloader;
+   delete factory;
+   delete outputFile;
+
+   TFile* check = TFile::Open( fileName );
+   test_(check && !check->IsZombie() && !check->TestBit(TFile::kRecovered));
+   delete check;
+}
+
+void utEvaluateInWorkers::run()
+{
+   TFile* input = OpenToySigBkg();
+   if (!input) {
+      fail_("cannot open the input file");
+      return;
+   }
+
+   std::vector<std::vector<Float_t> > serialValues, workerValues;
+   std::vector<Double_t> serialRocs, workerRocs;
+   evaluate(input, 1, "SerialEvaluation", serialValues, serialRocs);
+   evaluate(input, 3, "WorkerEvaluation", workerValues, workerRocs);
+
+   test_(serialValues.size() == 3 && workerValues.size() == 3);
+   test_(serialRocs.size() == 3 && workerRocs.size() == 3);
+   for (UInt_t i = 0; i < serialValues.size() && i < workerValues.size(); i++) {
+      if (serialValues[i] != workerValues[i])
+         std::cout << "failure in EvaluateInWorkers, " << gWorkerMethods[i]
+                   << ": the test responses of the workers differ from the serial ones" << std::endl;
+      test_(serialValues[i] == workerValues[i]);
+   }
+   for (UInt_t i = 0; i < serialRocs.size() && i < workerRocs.size(); i++) {
+      if (serialRocs[i] != workerRocs[i])
+         std::cout << "failure in EvaluateInWorkers, " << gWorkerMethods[i] << ": ROC integral "
+                   << workerRocs[i] << " with workers, " << serialRocs[i] << " without" << std::endl;
+      test_(serialRocs[i] == workerRocs[i]);
+   }
+   delete input;
+}
+
+// including file tmvaut/utOptimizeInWorkers.h
+#ifndef UTOPTIMIZEINWORKERS_H
+#define UTOPTIMIZEINWORKERS_H
+
+// TMVA unit tests
+//
+// the parameter sets of the optimisation of the tuning parameters trained in
+// worker processes must give the figures of merit of the serial optimisation;
+// the workers must not write the output file of the factory, which must still
+// be readable afterwards
+
+#include <map>
+#include <vector>
+
+namespace UnitTesting
+{
+   class utOptimizeInWorkers : public UnitTest
+   {
+   public:
+      utOptimizeInWorkers();
+      void run();
+
+   private:
+      // optimise, train and test the SVM with nWorkers workers, return the
+      // tuned parameters and the figure of merit of each parameter set
+      void optimize(TFile* input, UInt_t nWorkers, const TString& name,
+                    std::map<TString,Double_t>& tuned, std::vector<Double_t>& foms);
+   };
+} // namespace UnitTesting
+#endif // UTOPTIMIZEINWORKERS_H
+// including file tmvaut/utOptimizeInWorkers.cxx
+
+#include "TGraph.h"
+#include "TTree.h"
+#include "TMVA/Config.h"
+#include "TMVA/Factory.h"
+
+using namespace UnitTesting;
+
+utOptimizeInWorkers::utOptimizeInWorkers() : UnitTest("OptimizeInWorkers", __FILE__)
+{
+}
+
+void utOptimizeInWorkers::optimize(TFile* input, UInt_t nWorkers, const TString& name,
+                                   std::map<TString,Double_t>& tuned, std::vector<Double_t>& foms)
+{
+   TString fileName = "weights/TMVA" + name + ".root";
+   TFile* outputFile = TFile::Open( fileName, "RECREATE" );
+   if (!outputFile) {
+      fail_("cannot open the output file");
+      return;
+   }
+
+   const UInt_t nWorkersBefore = TMVA::gConfig().GetNWorkers();
+   TMVA::gConfig().SetNWorkers(nWorkers);
+   TMVA::Factory* factory = new TMVA::Factory( "TMVA" + name, outputFile,
+                                               "!V:Silent:AnalysisType=Classification:!Color:!DrawProgressBar" );
+   TMVA::DataLoader* dataloader = CreateToyDataLoader(input, name,
+                                                      "nTrain_Signal=500:nTrain_Background=500:nTest_Signal=1000:nTest_Background=1000");
+   // 3 x 2 parameter sets, scanned
+   factory->BookMethod(dataloader, TMVA::Types::kSVM, "SVM",
+                       "!H:!V:Gamma=0.25:Tol=0.001:VarTransform=Norm:Tune=Gamma[0.1;1.0;3],C[0.5;2.0;2]");
+   tuned = factory->OptimizeAllMethods("ROCIntegral", "Scan");
+   // the output file is then written by this process only
+   factory->TrainAllMethods();
+   factory->TestAllMethods();
+   factory->EvaluateAllMethods();
+   TMVA::gConfig().SetNWorkers(nWorkersBefore);
+
+   outputFile->Close();
+   delete dataloader;
+   delete factory;
+   delete outputFile;
+
+   TFile* check = TFile::Open( fileName );
+   test_(check && !check->IsZombie() && !check->TestBit(TFile::kRecovered));
+   if (!check) return;
+   TGraph* graph = dynamic_cast<TGraph*>(check->Get(name + "/Method_SVM/SVM/SVM_FOMvsIter"));
+   test_(graph);
+   if (graph) {
+      foms.assign(graph->GetY(), graph->GetY() + graph->GetN());
+      delete graph;
+   }
+   TTree* testTree = dynamic_cast<TTree*>(check->Get(name + "/TestTree"));
+   test_(testTree && testTree->GetEntries() == 2000);
+   delete check;
+}
+
+void utOptimizeInWorkers::run()
+{
+   TFile* input = OpenToySigBkg();
+   if (!input) {
+      fail_("cannot open the input file");
+      return;
+   }
+
+   std::map<TString,Double_t> serialTuned, workerTuned;
+   std::vector<Double_t> serialFoms, workerFoms;
+   optimize(input, 1, "SerialOptimisation", serialTuned, serialFoms);
+   optimize(input, 3, "WorkerOptimisation", workerTuned, workerFoms);
+
+   test_(serialFoms.size() == 6);
+   if (serialFoms != workerFoms)
+      std::cout << "failure in OptimizeInWorkers: the figures of merit of the "
+                << workerFoms.size() << " parameter sets trained in workers differ from the "
+                << serialFoms.size() << " serial ones" << std::endl;
+   test_(serialFoms == workerFoms);
+   test_(serialTuned.size() == 2 && serialTuned == workerTuned);
+   delete input;
+}
+
+// including file tmvaut/utKNNSearch.h
+#ifndef UTKNNSEARCH_H
+#define UTKNNSEARCH_H
+
+// TMVA unit tests
+//
+// the iterative search of the flattened kd-tree of ModulekNN must find the
+// same neighbors, in the same order and at the same distances, as the
+// recursive search, ties included; the responses of MethodKNN evaluated in
+// parallel must equal the serial ones and the ones computed from the
+// neighbors of the recursive search
+
+#include "TMVA/ModulekNN.h"
+
+namespace TMVA {
+   class MethodKNN;
+}
+
+namespace UnitTesting
+{
+   class utKNNSearch : public UnitTest
+   {
+   public:
+      utKNNSearch();
+      void run();
+
+   private:
+      // number of queries for which the two searches differ
+      UInt_t compareSearches(const TMVA::kNN::ModulekNN& module, const TMVA::kNN::EventVec& queries, UInt_t nfind);
+      // module with nevt events on a grid, so that many distances are equal
+      void fillModule(TMVA::kNN::ModulekNN& module, UInt_t nevt, UInt_t ifrac, const std::string& option);
+      // responses of the method, counted from the neighbors of the recursive search
+      std::vector<Double_t> recursiveMvaValues(TMVA::MethodKNN* mva, UInt_t knn, UInt_t balanceDepth, UInt_t ifrac);
+      void testModule();
+      void testMethod();
+   };
+} // namespace UnitTesting
+#endif // UTKNNSEARCH_H
+// including file tmvaut/utKNNSearch.cxx
+
+#include "TROOT.h"
+#include "TRandom3.h"
+#include "TMVA/DataSet.h"
+#include "TMVA/DataSetInfo.h"
+#include "TMVA/Event.h"
+#include "TMVA/Factory.h"
+#include "TMVA/MethodKNN.h"
+
+using namespace UnitTesting;
+
+utKNNSearch::utKNNSearch() : UnitTest("KNNSearch", __FILE__)
+{
+}
+
+void utKNNSearch::fillModule(TMVA::kNN::ModulekNN& module, UInt_t nevt, UInt_t ifrac, const std::string& option)
+{
+   TRandom3 rnd(38);
+   for (UInt_t ievt = 0; ievt < nevt; ievt++) {
+      TMVA::kNN::VarVec vvec(3);
+      for (UInt_t ivar = 0; ivar < 3; ivar++) vvec[ivar] = 0.5*TMath::Nint(2*rnd.Gaus(0, 2));
+      module.Add(TMVA::kNN::Event(vvec, rnd.Uniform(0.5, 1.5), (ievt%2) ? 1 : 2));
+   }
+   module.Fill(6, ifrac, option);
+}
+
+UInt_t utKNNSearch::compareSearches(const TMVA::kNN::ModulekNN& module, const TMVA::kNN::EventVec& queries, UInt_t nfind)
+{
+   UInt_t nDiff = 0;
+   TMVA::kNN::ElemVec flat;
+   for (UInt_t i = 0; i < queries.size(); i++) {
+      module.Find(queries[i], nfind);
+      module.Find(queries[i], nfind, flat);
+      const TMVA::kNN::List& recursive = module.GetkNNList();
+      bool same = (recursive.size() == flat.size() && flat.size() == nfind);
+      TMVA::kNN::List::const_iterator rit = recursive.begin();
+      for (UInt_t j = 0; same && j < flat.size(); j++, ++rit) {
+         same = (rit->first == flat[j].first && rit->second == flat[j].second);
+      }
+      if (!same) nDiff++;
+   }
+   return nDiff;
+}
+
+void utKNNSearch::testModule()
+{
+   TRandom3 rnd(39);
+   TMVA::kNN::EventVec queries;
+   for (UInt_t i = 0; i < 500; i++) {
+      TMVA::kNN::VarVec vvec(3);
+      // half of the queries on the grid of the events
+      for (UInt_t ivar = 0; ivar < 3; ivar++) {
+         vvec[ivar] = (i%2) ? 0.5*TMath::Nint(2*rnd.Gaus(0, 2)) : rnd.Gaus(0, 2);
+      }
+      queries.push_back(TMVA::kNN::Event(vvec, 1.0, 3));
+   }
+
+   // without and with the variables scaled to the same widths
+   const UInt_t ifrac[] = { 0, 80 };
+   const char* options[] = { "", "metric" };
+   const UInt_t nfind[] = { 1, 5, 22, 100 };
+   for (UInt_t m = 0; m < 2; m++) {
+      TMVA::kNN::ModulekNN module;
+      fillModule(module, 5000, ifrac[m], options[m]);
+      for (UInt_t k = 0; k < 4; k++) {
+         UInt_t nDiff = compareSearches(module, queries, nfind[k]);
+         if (nDiff)
+            std::cout << "failure in KNNSearch, option '" << options[m] << "', " << nfind[k] << " neighbors: the flat and the recursive searches differ for "
+                      << nDiff << " of " << queries.size() << " events" << std::endl;
+         test_(nDiff == 0);
+      }
+   }
+}
+
+std::vector<Double_t> utKNNSearch::recursiveMvaValues(TMVA::MethodKNN* mva, UInt_t knn, UInt_t balanceDepth, UInt_t ifrac)
+{
+   TMVA::DataSet* data = mva->Data();
+   const UInt_t nvar = mva->GetNVariables();
+
+   // same kd-tree as the one of the method, filled with the training events
+   TMVA::kNN::ModulekNN module;
+   data->SetCurrentType(TMVA::Types::kTraining);
+   for (Long64_t ievt = 0; ievt < data->GetNEvents(); ievt++) {
+      const TMVA::Event* ev = data->GetEvent(ievt);
+      TMVA::kNN::VarVec vvec(nvar);
+      for (UInt_t ivar = 0; ivar < nvar; ivar++) vvec[ivar] = ev->GetValue(ivar);
+      module.Add(TMVA::kNN::Event(vvec, ev->GetWeight(), mva->DataInfo().IsSignal(ev) ? 1 : 2));
+   }
+   module.Fill(balanceDepth, ifrac, "metric");
+
+   // weighted fraction of signal events among the knn nearest neighbors
+   std::vector<Double_t> values;
+   data->SetCurrentType(TMVA::Types::kTesting);
+   for (Long64_t ievt = 0; ievt < data->GetNEvents(); ievt++) {
+      const TMVA::Event* ev = data->GetEvent(ievt);
+      TMVA::kNN::VarVec vvec(nvar);
+      for (UInt_t ivar = 0; ivar < nvar; ivar++) vvec[ivar] = ev->GetValue(ivar);
+      module.Find(TMVA::kNN::Event(vvec, ev->GetWeight(), 3), knn + 2);
+      const TMVA::kNN::List& rlist = module.GetkNNList();
+      Double_t weight_all = 0, weight_sig = 0;
+      UInt_t count = 0;
+      for (TMVA::kNN::List::const_iterator it = rlist.begin(); it != rlist.end() && count < knn; ++it, ++count) {
+         weight_all += it->first->GetWeight();
+         if (it->first->GetEvent().GetType() == 1) weight_sig += it->first->GetWeight();
+      }
+      values.push_back(weight_sig/weight_all);
+   }
+   return values;
+}
+
+void utKNNSearch::testMethod()
+{
+   TFile* input = OpenToySigBkg();
+   if (!input) {
+      fail_("cannot open the input file");
+      return;
+   }
+   TFile* outputFile = TFile::Open( "weights/TMVAKNNSearch.root", "RECREATE" );
+   if (!outputFile) {
+      fail_("cannot open the output file");
+      delete input;
+      return;
+   }
+   TMVA::Factory* factory = new TMVA::Factory( "TMVAKNNSearch", outputFile,
+                                               "!V:Silent:AnalysisType=Classification:!Color:!DrawProgressBar" );
+   TMVA::DataLoader* dataloader = CreateToyDataLoader(input, "dataset",
+                                                      "nTrain_Signal=2000:nTrain_Background=2000:nTest_Signal=1000:nTest_Background=1000");
+   factory->BookMethod(dataloader, TMVA::Types::kKNN, "KNN",
+                       "!H:!V:nkNN=20:BalanceDepth=6:ScaleFrac=0.8:UseKernel=F:UseWeight=T:!Trim");
+   factory->TrainAllMethods();
+
+   TMVA::MethodKNN* mva = dynamic_cast<TMVA::MethodKNN*>(factory->GetMethod(dataloader->GetName(), "KNN"));
+   test_(mva);
+   if (mva) {
+      TMVA::DataSet* data = mva->Data();
+      std::vector<Double_t> reference = recursiveMvaValues(mva, 20, 6, 80);
+
+      // serial, one event at a time
+      data->SetCurrentType(TMVA::Types::kTesting);
+      std::vector<Double_t> serial;
+      for (Long64_t ievt = 0; ievt < data->GetNEvents(); ievt++) {
+         data->SetCurrentEvent(ievt);
+         serial.push_back(mva->GetMvaValue());
+      }
+
+      // all events at once, the searches in parallel; the batch inputs are
+      // stored variable by variable
+      const UInt_t nvar = mva->GetNVariables();
+      const Long64_t nEvents = data->GetNEvents();
+      std::vector<Float_t> inputs(nvar*nEvents);
+      for (Long64_t ievt = 0; ievt < nEvents; ievt++) {
+         const TMVA::Event* ev = data->GetEvent(ievt);
+         for (UInt_t ivar = 0; ivar < nvar; ivar++) inputs[ivar*nEvents+ievt] = ev->GetValue(ivar);
+      }
+#ifdef R__USE_IMT
+      ROOT::EnableImplicitMT(4);
+#endif
+      std::vector<Double_t> parallel = mva->GetMvaValues();
+      std::vector<Double_t> batch(serial.size());
+      if (!batch.empty()) mva->GetBatchMvaValues(&inputs[0], batch.size(), &batch[0]);
+#ifdef R__USE_IMT
+      ROOT::DisableImplicitMT();
+#endif
+
+      test_(serial.size() == 2000);
+      if (serial != reference)
+         std::cout << "failure in KNNSearch: the responses differ from the ones of the recursive search" << std::endl;
+      test_(serial == reference);
+      if (parallel != serial || batch != serial)
+         std::cout << "failure in KNNSearch: the responses evaluated in parallel differ from the serial ones" << std::endl;
+      test_(parallel == serial);
+      test_(batch == serial);
+   }
+
+   outputFile->Close();
+   delete dataloader;
+   delete factory;
+   delete outputFile;
+   delete input;
+}
+
+void utKNNSearch::run()
+{
+   testModule();
+   testMethod();
+}
+
+// including file tmvaut/utSVKernelMatrix.h
+#ifndef UTSVKERNELMATRIX_H
+#define UTSVKERNELMATRIX_H
+
+// TMVA unit tests
+//
+// a kernel matrix too large for its cache keeps the most recently used rows
+// only; the elements and the rows it returns, while rows are evicted, must be
+// the kernel function of the events, and an SVM trained with a small cache
+// must give the responses of the one trained with the full matrix
+
+namespace UnitTesting
+{
+   class utSVKernelMatrix : public UnitTest
+   {
+   public:
+      utSVKernelMatrix();
+      void run();
+
+   private:
+      void testMatrix();
+      void testTraining();
+   };
+} // namespace UnitTesting
+#endif // UTSVKERNELMATRIX_H
+// including file tmvaut/utSVKernelMatrix.cxx
+
+#include <vector>
+#include "TRandom3.h"
+#include "TMVA/DataSet.h"
+#include "TMVA/Factory.h"
+#include "TMVA/MethodBase.h"
+#include "TMVA/SVEvent.h"
+#include "TMVA/SVKernelFunction.h"
+#include "TMVA/SVKernelMatrix.h"
+
+using namespace UnitTesting;
+
+utSVKernelMatrix::utSVKernelMatrix() : UnitTest("SVKernelMatrix", __FILE__)
+{
+}
+
+void utSVKernelMatrix::testMatrix()
+{
+   // the lower triangle of 2000 events takes 7.6 MB, a cache of 1 MB holds 131 rows
+   const UInt_t nEvents = 2000;
+   TRandom3 rnd(39);
+   std::vector<TMVA::SVEvent*> events;
+   for (UInt_t i = 0; i < nEvents; i++) {
+      std::vector<Float_t> vars(4);
+      for (UInt_t ivar = 0; ivar < 4; ivar++) vars[ivar] = rnd.Gaus();
+      events.push_back(new TMVA::SVEvent(&vars, Float_t(0), (i%2) ? 1 : -1, UInt_t(0)));
+   }
+   TMVA::SVKernelFunction kernel(0.25);
+   TMVA::SVKernelMatrix cached(&events, &kernel, 1);
+   TMVA::SVKernelMatrix full(&events, &kernel, 0);
+   test_(!cached.IsPrecomputed());
+   test_(full.IsPrecomputed());
+
+   // the kernel matrix stores K(i,j) for i >= j as Evaluate(event i, event j)
+   UInt_t nDiff = 0;
+   for (UInt_t iter = 0; iter < 20000; iter++) {
+      UInt_t i = rnd.Integer(nEvents), j = rnd.Integer(nEvents);
+      Float_t direct = (i > j) ? kernel.Evaluate(events[i], events[j]) : kernel.Evaluate(events[j], events[i]);
+      if (cached.GetElement(i, j) != direct || full.GetElement(i, j) != direct) nDiff++;
+      // request rows, mostly new ones, so that the cached rows are evicted
+      if (iter%10 == 0) {
+         UInt_t line = (iter%30 == 0) ? i : rnd.Integer(nEvents);
+         Float_t* row = cached.GetLine(line);
+         for (UInt_t k = 0; k < nEvents; k++) {
+            Float_t value = (line > k) ? kernel.Evaluate(events[line], events[k]) : kernel.Evaluate(events[k], events[line]);
+            if (row[k] != value) {
+               nDiff++;
+               break;
+            }
+         }
+      }
+   }
+   if (nDiff)
+      std::cout << "failure in SVKernelMatrix: " << nDiff << " elements or rows of the cached kernel matrix differ from the kernel function" << std::endl;
+   test_(nDiff == 0);
+
+   for (UInt_t i = 0; i < nEvents; i++) delete events[i];
+}
+
+void utSVKernelMatrix::testTraining()
+{
+   TFile* input = OpenToySigBkg();
+   if (!input) {
+      fail_("cannot open the input file");
+      return;
+   }
+   TFile* outputFile = TFile::Open( "weights/TMVASVKernelMatrix.root", "RECREATE" );
+   if (!outputFile) {
+      fail_("cannot open the output file");
+      delete input;
+      return;
+   }
+   TMVA::Factory* factory = new TMVA::Factory( "TMVASVKernelMatrix", outputFile,
+                                               "!V:Silent:AnalysisType=Classification:!Color:!DrawProgressBar" );
+   // 2000 training events, the kernel matrix does not fit in 1 MB
+   TMVA::DataLoader* dataloader = CreateToyDataLoader(input, "dataset",
+                                                      "nTrain_Signal=1000:nTrain_Background=1000:nTest_Signal=1000:nTest_Background=1000");
+   factory->BookMethod(dataloader, TMVA::Types::kSVM, "SVMFull", "!H:!V:Gamma=0.25:Tol=0.001:VarTransform=Norm:KernelCacheSize=0");
+   factory->BookMethod(dataloader, TMVA::Types::kSVM, "SVMCache", "!H:!V:Gamma=0.25:Tol=0.001:VarTransform=Norm:KernelCacheSize=1");
+   factory->TrainAllMethods();
+
+   TMVA::MethodBase* full = dynamic_cast<TMVA::MethodBase*>(factory->GetMethod(dataloader->GetName(), "SVMFull"));
+   TMVA::MethodBase* cached = dynamic_cast<TMVA::MethodBase*>(factory->GetMethod(dataloader->GetName(), "SVMCache"));
+   test_(full && cached);
+   if (full && cached) {
+      TMVA::DataSet* data = full->Data();
+      data->SetCurrentType(TMVA::Types::kTesting);
+      std::vector<Double_t> fullValues, cachedValues;
+      for (Long64_t ievt = 0; ievt < data->GetNEvents(); ievt++) {
+         data->SetCurrentEvent(ievt);
+         fullValues.push_back(full->GetMvaValue());
+         cachedValues.push_back(cached->GetMvaValue());
+      }
+      Long64_t nDiff = 0;
+      for (size_t ievt = 0; ievt < fullValues.size() && ievt < cachedValues.size(); ievt++) {
+         if (fullValues[ievt] != cachedValues[ievt]) nDiff++;
+      }
+      if (nDiff)
+         std::cout << "failure in SVKernelMatrix: " << nDiff << " of " << fullValues.size()
+                   << " responses of the SVM trained with a kernel cache differ from the full kernel matrix" << std::endl;
+      test_(fullValues.size() == 2000 && cachedValues.size() == fullValues.size());
+      test_(nDiff == 0);
+   }
+
+   outputFile->Close();
+   delete dataloader;
+   delete factory;
+   delete outputFile;
+   delete input;
+}
+
+void utSVKernelMatrix::run()
+{
+   testMatrix();
+   testTraining();
+}
+
 // including file stressTMVA.cxx
 // Authors: Christoph Rosemann, Eckhard von Toerne   July 2010
 // TMVA unit tests
@@ -3054,6 +4334,25 @@ int main(int argc, char **argv)
    addDataInputTests(TMVA_test, full);
    addComplexClassificationTests(TMVA_test, full);
 
+   // quantized (histogram) training of the BDT
+   TMVA_test.addTest(new utBDTHistTraining("!H:!V:NTrees=400:MaxDepth=3:BoostType=AdaBoost:SeparationType=GiniIndex:nCuts=-1:PruneMethod=NoPruning"));
+   // identical BDTs trained with and without implicit multi-threading
+   TMVA_test.addTest(new utBDTParallelTraining);
+   // batch evaluation of the BDT with the flattened forest
+   TMVA_test.addTest(new utBDTBatchEvaluation);
+   // training on streamed trees
+   TMVA_test.addTest(new utStreamingDataLoader);
+   // cross validation with the folds trained in worker processes
+   TMVA_test.addTest(new utCrossValidation);
+   // evaluation of the classifiers in worker processes
+   TMVA_test.addTest(new utEvaluateInWorkers);
+   // optimisation of the tuning parameters in worker processes
+   TMVA_test.addTest(new utOptimizeInWorkers);
+   // flat kd-tree search and parallel evaluation of the kNN
+   TMVA_test.addTest(new utKNNSearch);
+   // SVM kernel matrix with a cache of the most recently used rows
+   TMVA_test.addTest(new utSVKernelMatrix);
+
    // run all
    ROOT::EnableThreadSafety();
    TMVA_test.run();
@@ -0,0 +1,120 @@
+// This program checks the tracking of the changes of the objects written to
+// a file (TFile::SetChangeTracking): a set of histograms is written again
+// and again to a TMemFile with TObject::kOverwrite or kWriteDelete. The
+// unchanged histograms must not be written again (same cycle, same end of
+// file), the changed ones must get a new cycle and checksum, and without the
+// tracking all of them must be written again as before.
+//
+//  run with
+//     testChangeTracking [nhist]
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "TH1.h"
+#include "TKey.h"
+#include "TMemFile.h"
+#include "TString.h"
+
+int gErrors = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// count a failed check
+
+void Check(bool ok, const char *what)
+{
+   if (!ok) {
+      printf("FAILED: %s\n", what);
+      gErrors++;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// write the histograms, check the returned number of bytes and record the
+/// cycle and the checksum of their keys
+
+void WriteAll(TFile &file, std::vector<TH1F *> &hists, Int_t option, std::vector<Short_t> &cycles,
+              std::vector<ULong64_t> &checksums, const char *what)
+{
+   file.cd();
+   cycles.clear();
+   checksums.clear();
+   for (UInt_t i = 0; i < hists.size(); i++) {
+      Int_t nbytes = hists[i]->Write(0, option);
+      TKey *key = file.GetKey(hists[i]->GetName());
+      Check(key && nbytes > 0 && nbytes == key->GetNbytes(),
+            Form("%s: %s written with %d bytes", what, hists[i]->GetName(), nbytes));
+      cycles.push_back(key ? key->GetCycle() : -1);
+      checksums.push_back(key ? key->GetChecksum() : 0);
+   }
+}
+
+int main(int argc, char **argv)
+{
+   int nhist = (argc > 1) ? atoi(argv[1]) : 20;
+
+   printf("\ntestChangeTracking: %d histograms\n\n", nhist);
+
+   std::vector<TH1F *> hists;
+   for (int i = 0; i < nhist; i++) {
+      TH1F *h = new TH1F(Form("h%d", i), Form("h%d", i), 100, -4, 4);
+      h->SetDirectory(0);
+      h->FillRandom("gaus", 1000);
+      hists.push_back(h);
+   }
+
+   TMemFile file("testChangeTracking.root", "RECREATE");
+   file.SetChangeTracking();
+   std::vector<Short_t> cycles, cycles0;
+   std::vector<ULong64_t> checksums, checksums0;
+   WriteAll(file, hists, TObject::kOverwrite, cycles0, checksums0, "first write");
+   for (int i = 0; i < nhist; i++) {
+      Check(cycles0[i] == 1 && checksums0[i] != 0, Form("first write: cycle and checksum of h%d", i));
+   }
+
+   // unchanged histograms are not written again
+   const Int_t options[] = { TObject::kOverwrite, TObject::kWriteDelete };
+   for (int o = 0; o < 2; o++) {
+      const char *what = o ? "unchanged, kWriteDelete" : "unchanged, kOverwrite";
+      Long64_t end = file.GetEND();
+      Int_t nkeys = file.GetNkeys();
+      WriteAll(file, hists, options[o], cycles, checksums, what);
+      Check(file.GetEND() == end && file.GetNkeys() == nkeys, Form("%s: end of file and number of keys", what));
+      for (int i = 0; i < nhist; i++) {
+         Check(cycles[i] == cycles0[i] && checksums[i] == checksums0[i], Form("%s: key of h%d", what, i));
+      }
+   }
+
+   // a changed histogram gets a new cycle and checksum
+   for (int o = 0; o < 2; o++) {
+      const char *what = o ? "changed, kWriteDelete" : "changed, kOverwrite";
+      int changed = (3 + 5*o) % nhist;
+      hists[changed]->Fill(0.5);
+      WriteAll(file, hists, options[o], cycles, checksums, what);
+      for (int i = 0; i < nhist; i++) {
+         if (i == changed)
+            Check(cycles[i] == cycles0[i] + 1 && checksums[i] != 0 && checksums[i] != checksums0[i],
+                  Form("%s: new key of h%d", what, i));
+         else
+            Check(cycles[i] == cycles0[i] && checksums[i] == checksums0[i], Form("%s: key of h%d", what, i));
+      }
+      Check(file.GetNkeys() == nhist, Form("%s: number of keys", what));
+      cycles0 = cycles;
+      checksums0 = checksums;
+   }
+
+   // without the tracking all the histograms are written again
+   file.SetChangeTracking(kFALSE);
+   WriteAll(file, hists, TObject::kOverwrite, cycles, checksums, "tracking off");
+   for (int i = 0; i < nhist; i++) {
+      Check(cycles[i] == cycles0[i] + 1 && checksums[i] == 0, Form("tracking off: new key of h%d", i));
+   }
+   Check(file.GetNkeys() == nhist, "tracking off: number of keys");
+
+   file.Close();
+   for (int i = 0; i < nhist; i++) delete hists[i];
+
+   printf("change tracking: %s\n\n", gErrors ? "FAILED" : "ok");
+   return gErrors ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+// This program checks the asynchronous mode of THttpServer (SetAsync):
+// root.json requests are executed in threads, like the ones of an http
+// engine, while the main thread processes the server requests. It checks
+//  -the SnapshotVersion of the replies, which only changes with the object
+//  -that a long-poll request waits until the object changes
+//  -that no more than the allowed number of long-poll requests wait, the
+//   other ones being answered at once
+//
+//  run with
+//     testHttpAsync
+
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "TH1.h"
+#include "THttpCallArg.h"
+#include "THttpServer.h"
+#include "TString.h"
+
+int gErrors = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// root.json request of the histogram, executed in its own thread
+
+class TRequest {
+public:
+   THttpCallArg      fArg;
+   std::atomic<bool> fDone;
+   std::thread       fThread;
+
+   TRequest(THttpServer *serv, const char *query) : fDone(false)
+   {
+      fArg.SetMethod("GET");
+      fArg.SetPathAndFileName("/Test/h/root.json");
+      fArg.SetQuery(query);
+      fThread = std::thread([this, serv]() {
+         serv->ExecuteHttp(&fArg);
+         fDone = true;
+      });
+   }
+   ~TRequest() { fThread.join(); }
+
+   TString Version() { return fArg.GetHeader("SnapshotVersion"); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// process the server requests in the main thread during ms milliseconds,
+/// or until all the requests are done; returns false on timeout
+
+bool Process(THttpServer *serv, const std::vector<TRequest *> &reqs, int ms)
+{
+   auto start = std::chrono::steady_clock::now();
+   while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(ms)) {
+      serv->ProcessRequests();
+      bool done = true;
+      for (size_t i = 0; i < reqs.size(); i++) done = done && reqs[i]->fDone;
+      if (done && !reqs.empty()) return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+   }
+   return reqs.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// execute a request, the main thread processing the server requests
+
+TString Request(THttpServer *serv, const char *query)
+{
+   TRequest req(serv, query);
+   if (!Process(serv, {&req}, 5000)) {
+      printf("FAILED: request %s not answered\n", query);
+      gErrors++;
+   }
+   if (req.fArg.GetContentLength() == 0) {
+      printf("FAILED: empty reply to request %s\n", query);
+      gErrors++;
+   }
+   return req.Version();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// count a failed check
+
+void Check(bool ok, const char *what)
+{
+   if (!ok) {
+      printf("FAILED: %s\n", what);
+      gErrors++;
+   }
+}
+
+int main()
+{
+   printf("\ntestHttpAsync: THttpServer::SetAsync\n\n");
+
+   TH1::AddDirectory(kFALSE);
+   TH1F *h = new TH1F("h", "histogram", 100, 0, 1);
+
+   // no engine, the requests are executed in the threads of this program
+   THttpServer *serv = new THttpServer("");
+   serv->SetTimer(0, kTRUE);
+   serv->SetAsync(kTRUE, 10, 10000, 2);
+   serv->Register("/Test", h);
+
+   // the first request registers the object, it is answered by the main thread
+   Request(serv, "");
+   Process(serv, {}, 50);
+
+   Check(Request(serv, "") == "1", "version of the first snapshot");
+   Process(serv, {}, 50);
+   Check(Request(serv, "") == "1", "version unchanged without change of the object");
+   h->Fill(0.5);
+   Process(serv, {}, 50);
+   Check(Request(serv, "") == "2", "version incremented by a change of the object");
+   printf("snapshot versions: %s\n", gErrors ? "FAILED" : "ok");
+
+   int before = gErrors;
+   {
+      TRequest poll(serv, "longpoll=2");
+      Process(serv, {}, 200);
+      Check(!poll.fDone, "long-poll request waits while the object does not change");
+      h->Fill(0.5);
+      Check(Process(serv, {&poll}, 5000), "long-poll request woken up by a change of the object");
+      Check(poll.Version() == "3", "version returned to the long-poll request");
+   }
+   printf("long-poll wakeup: %s\n", gErrors > before ? "FAILED" : "ok");
+
+   before = gErrors;
+   {
+      TRequest poll1(serv, "longpoll=3"), poll2(serv, "longpoll=3"), poll3(serv, "longpoll=3");
+      std::vector<TRequest *> polls = {&poll1, &poll2, &poll3};
+      Process(serv, {}, 300);
+      int ndone = 0;
+      for (size_t i = 0; i < polls.size(); i++) {
+         if (!polls[i]->fDone) continue;
+         ndone++;
+         Check(polls[i]->Version() == "3", "current version returned when too many requests wait");
+      }
+      Check(ndone == 1, "only two long-poll requests wait");
+      h->Fill(0.5);
+      Check(Process(serv, polls, 5000), "waiting long-poll requests woken up");
+      int nnew = 0;
+      for (size_t i = 0; i < polls.size(); i++)
+         if (polls[i]->Version() == "4") nnew++;
+      Check(nnew == 2, "new version returned to the waiting requests");
+   }
+   printf("long-poll limit: %s\n\n", gErrors > before ? "FAILED" : "ok");
+
+   delete serv;
+   return gErrors ? 1 : 0;
+}
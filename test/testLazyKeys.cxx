@@ -0,0 +1,144 @@
+// This program checks the lazy key loading of TDirectoryFile
+// (TDirectoryFile::SetLazyKeys, rootrc TFile.LazyKeys): a file with several
+// cycles of some keys and a TProcessID is read and updated with the TKeys
+// created on demand, and compared to the same file read with all the keys.
+//
+//  run with
+//     testLazyKeys [nkeys]
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TKey.h"
+#include "TNamed.h"
+#include "TProcessID.h"
+#include "TString.h"
+#include "TSystem.h"
+
+int gErrors = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// count a failed check
+
+void Check(bool ok, const char *what)
+{
+   if (!ok) {
+      printf("FAILED: %s\n", what);
+      gErrors++;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// return the title of the object namecycle, "" if it cannot be read
+
+std::string Title(TFile &file, const char *namecycle)
+{
+   TNamed *obj = dynamic_cast<TNamed *>(file.Get(namecycle));
+   std::string title = obj ? obj->GetTitle() : "";
+   delete obj;
+   return title;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// return "name;cycle class" for every key of the list, in its order
+
+std::vector<std::string> ListKeys(TFile &file)
+{
+   std::vector<std::string> keys;
+   TIter next(file.GetListOfKeys());
+   TKey *key;
+   while ((key = (TKey *)next())) {
+      keys.push_back(Form("%s;%d %s", key->GetName(), key->GetCycle(), key->GetClassName()));
+   }
+   return keys;
+}
+
+int main(int argc, char **argv)
+{
+   int nkeys = (argc > 1) ? atoi(argv[1]) : 1000;
+   const char *filename = "testLazyKeys.root";
+
+   printf("\ntestLazyKeys: %d keys\n\n", nkeys);
+
+   {
+      TFile file(filename, "RECREATE");
+      for (int i = 0; i < nkeys; i++) {
+         TNamed obj(Form("n%d", i), Form("n%d;1", i));
+         obj.Write();
+      }
+      for (int c = 1; c <= 3; c++) {
+         TNamed obj("a", Form("a;%d", c));
+         obj.Write();
+      }
+      file.WriteProcessID(0);
+   }
+
+   // Reference: all the keys are created when the file is opened.
+   TDirectoryFile::SetLazyKeys(kFALSE);
+   std::vector<std::string> refKeys;
+   Int_t refNProcessIDs;
+   {
+      TFile file(filename);
+      refKeys = ListKeys(file);
+      refNProcessIDs = file.GetNProcessIDs();
+   }
+   Check(refNProcessIDs == 1, "one TProcessID in the file");
+
+   TDirectoryFile::SetLazyKeys(kTRUE);
+   {
+      TFile file(filename);
+      Check(file.GetNProcessIDs() == refNProcessIDs, "number of TProcessIDs with lazy keys");
+      Check(file.GetNkeys() == (Int_t)refKeys.size(), "number of keys with lazy keys");
+      TKey *key = file.GetKey("a");
+      Check(key && key->GetCycle() == 3, "GetKey returns the highest cycle");
+      key = file.GetKey("a", 2);
+      Check(key && key->GetCycle() == 2, "GetKey of cycle 2");
+      key = file.GetKey("a", 10);
+      Check(key && key->GetCycle() == 3, "GetKey of a cycle above the highest one");
+      Check(!file.GetKey("missing"), "GetKey of a missing name");
+      Check(Title(file, "a") == "a;3", "Get of the highest cycle");
+      Check(Title(file, "a;1") == "a;1", "Get of cycle 1");
+      Check(Title(file, "a;2") == "a;2", "Get of cycle 2");
+      Check(!file.Get("a;4"), "Get of a missing cycle");
+      Check(Title(file, Form("n%d", nkeys / 2)) == Form("n%d;1", nkeys / 2), "Get of a single cycle key");
+      // The keys created so far must take their place in the list.
+      Check(ListKeys(file) == refKeys, "order of the list of keys with lazy keys");
+   }
+
+   {
+      TFile file(filename, "UPDATE");
+      Check(file.GetNProcessIDs() == refNProcessIDs, "number of TProcessIDs in update mode");
+      Check(Title(file, "n5") == "n5;1", "Get before the update");
+      TNamed n5("n5", "n5 updated");
+      n5.Write(0, TObject::kOverwrite);
+      file.Delete("a;2");
+      TNamed c("c", "c;1");
+      c.Write();
+      // A new TProcessID must not take the number of the one in the file.
+      Check(file.WriteProcessID(0) == refNProcessIDs, "number of a new TProcessID");
+   }
+
+   TDirectoryFile::SetLazyKeys(kFALSE);
+   {
+      TFile file(filename);
+      Check(Title(file, "n5") == "n5 updated", "overwritten key");
+      TKey *key = file.GetKey("n5");
+      Check(key && key->GetCycle() == 1, "cycle of the overwritten key");
+      Check(!file.Get("a;2"), "deleted cycle");
+      Check(Title(file, "a;1") == "a;1" && Title(file, "a;3") == "a;3", "cycles kept by the deletion");
+      Check(Title(file, "c") == "c;1", "key written after a lazy open");
+      Check(Title(file, Form("n%d", nkeys - 1)) == Form("n%d;1", nkeys - 1), "key not read in update mode");
+      key = file.GetKey("ProcessID0");
+      Check(key && key->GetCycle() == 1, "TProcessID of the file kept");
+      Check(file.GetNProcessIDs() == refNProcessIDs + 1, "number of TProcessIDs after the update");
+      // a;2 deleted, c and the new TProcessID added
+      Check(file.GetNkeys() == (Int_t)refKeys.size() + 1, "number of keys after the update");
+   }
+
+   gSystem->Unlink(filename);
+   printf("lazy keys: %s\n\n", gErrors ? "FAILED" : "ok");
+   return gErrors ? 1 : 0;
+}
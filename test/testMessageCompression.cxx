@@ -0,0 +1,231 @@
+// This program checks the compression of the messages in blocks on the
+// implicit multi-threading pool (TMessage::Compress and Uncompress): a message
+// compressed in parallel is uncompressed sequentially and vice versa, and a
+// message below the size of the parallel compression is compressed in one
+// block. It then uploads a file in the background to a parallel merging
+// server (TParallelMergingFile::SetAsyncUpload) running in a separate thread
+// on a local socket.
+//
+//  run with
+//     testMessageCompression [nbins]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "MessageTypes.h"
+#include "RConfigure.h"
+#include "RZip.h"
+#include "TH1.h"
+#include "TMemFile.h"
+#include "TMessage.h"
+#include "TParallelMergingFile.h"
+#include "TRandom3.h"
+#include "TROOT.h"
+#include "TServerSocket.h"
+#include "TSocket.h"
+#include "TString.h"
+#include "TTree.h"
+
+int gErrors = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// count a failed check
+
+void Check(bool ok, const char *what)
+{
+   if (!ok) {
+      printf("FAILED: %s\n", what);
+      gErrors++;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// a message read from a buffer, like the ones received by TSocket::Recv
+
+class TReceivedMessage : public TMessage {
+public:
+   TReceivedMessage(void *buf, Int_t bufsize) : TMessage(buf, bufsize) { }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// enable or disable the implicit multi-threading, return false if it is
+/// not available
+
+bool SetImplicitMT(bool enable)
+{
+#ifdef R__USE_IMT
+   if (enable) ROOT::EnableImplicitMT(4);
+   else ROOT::DisableImplicitMT();
+   return true;
+#else
+   return !enable;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// return the number of compressed blocks of the message
+
+int CountBlocks(const TMessage &mess)
+{
+   int nblocks = 0;
+   unsigned char *bufcur = (unsigned char *)mess.CompBuffer() + 3*sizeof(UInt_t);
+   unsigned char *bufend = (unsigned char *)mess.CompBuffer() + mess.CompLength();
+   while (bufcur < bufend) {
+      int nin, nbuf;
+      if (R__unzip_header(&nin, bufcur, &nbuf) != 0) return -1;
+      bufcur += nin;
+      nblocks++;
+   }
+   return nblocks;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// compress a message with a histogram of nbins, with or without the implicit
+/// multi-threading, uncompress it with or without it and compare the result
+/// to the original message
+
+void CheckCompression(int nbins, bool parallelZip, bool parallelUnzip, const char *what)
+{
+   TRandom3 rnd(45);
+   TH1D h("h", "h", nbins, 0, 1);
+   h.SetDirectory(0);
+   for (int b = 1; b <= nbins; b++) h.SetBinContent(b, rnd.Poisson(100));
+
+   TMessage mess(kMESS_OBJECT);
+   mess.WriteObject(&h);
+   mess.SetCompressionLevel(1);
+
+   if (!SetImplicitMT(parallelZip)) return;
+   Int_t status = mess.Compress();
+   SetImplicitMT(false);
+   Check(status == 0 && mess.CompBuffer(), Form("%s: compression", what));
+   if (status != 0 || !mess.CompBuffer()) return;
+
+   // the parallel compression writes blocks of 1 MB, the sequential one of up to 16 MB
+   Int_t messlen = mess.Length() - 2*sizeof(UInt_t);
+   int nblocks = CountBlocks(mess);
+   int expected = (parallelZip && messlen > 2*1024*1024) ? 1 + (messlen - 1) / (1024*1024) : 1 + (messlen - 1) / 0xffffff;
+   Check(nblocks == expected, Form("%s: %d compressed blocks instead of %d", what, nblocks, expected));
+
+   char *buf = new char[mess.CompLength()];
+   memcpy(buf, mess.CompBuffer(), mess.CompLength());
+   if (!SetImplicitMT(parallelUnzip)) {
+      delete [] buf;
+      return;
+   }
+   TReceivedMessage recv(buf, mess.CompLength());
+   SetImplicitMT(false);
+
+   Check(recv.What() == kMESS_OBJECT && recv.BufferSize() == mess.Length() &&
+         memcmp(recv.Buffer() + 2*sizeof(UInt_t), mess.Buffer() + 2*sizeof(UInt_t), messlen) == 0,
+         Form("%s: uncompressed message", what));
+   TH1D *hrecv = (TH1D *)recv.ReadObject(recv.GetClass());
+   Check(hrecv && hrecv->GetNbinsX() == nbins && hrecv->Integral() == h.Integral(),
+         Form("%s: histogram read from the message", what));
+   delete hrecv;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// a parallel merging server accepting one client, which records the number
+/// of entries and the first value of the tree of every upload
+
+void MergeServer(TServerSocket *ss, std::vector<Long64_t> *entries, std::vector<Double_t> *first)
+{
+   TSocket *s = ss->Accept();
+   if (!s || s == (TSocket *)-1) return;
+   s->Send(0, 0); // kStartConnection
+   s->Send(1, 1); // kProtocol
+
+   while (1) {
+      TMessage *mess = 0;
+      if (s->Recv(mess) <= 0 || !mess) break;
+      if (mess->What() == kMESS_STRING) {
+         delete mess;
+         break;
+      }
+      if (mess->What() == kMESS_ANY) {
+         Int_t clientId;
+         TString filename;
+         Long64_t length;
+         mess->ReadInt(clientId);
+         mess->ReadTString(filename);
+         mess->ReadLong64(length);
+         TMemFile transient(filename, mess->Buffer() + mess->Length(), length);
+         TTree *tree = (TTree *)transient.Get("T");
+         Double_t x = -1;
+         if (tree) {
+            tree->SetBranchAddress("x", &x);
+            tree->GetEntry(0);
+         }
+         entries->push_back(tree ? tree->GetEntries() : -1);
+         first->push_back(x);
+      }
+      delete mess;
+   }
+   s->Close();
+   delete s;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// fill and upload a tree ncycles times in the background, check that the
+/// server received each cycle
+
+void CheckAsyncUpload(int ncycles, int nentries)
+{
+   // the server runs in a separate thread
+   ROOT::EnableThreadSafety();
+   TServerSocket ss(0, kFALSE);
+   Check(ss.IsValid(), "async upload: server socket");
+   if (!ss.IsValid()) return;
+
+   std::vector<Long64_t> entries;
+   std::vector<Double_t> first;
+   std::thread server(MergeServer, &ss, &entries, &first);
+
+   {
+      TParallelMergingFile file(Form("testMessageCompression.root?pmerge=localhost:%d", ss.GetLocalPort()), "RECREATE");
+      file.SetAsyncUpload();
+      Check(file.GetAsyncUpload(), "async upload: enabled");
+      Double_t x;
+      TTree *tree = new TTree("T", "T");
+      tree->Branch("x", &x, "x/D");
+      for (int c = 0; c < ncycles; c++) {
+         for (int i = 0; i < nentries; i++) {
+            x = c*1e6 + i;
+            tree->Fill();
+         }
+         file.Write();
+      }
+      Check(file.WaitForUpload(), "async upload: last upload");
+      file.Close();
+   }
+   server.join();
+   ss.Close();
+
+   Check((int)entries.size() == ncycles, Form("async upload: %d uploads received instead of %d", (int)entries.size(), ncycles));
+   for (UInt_t c = 0; c < entries.size(); c++) {
+      Check(entries[c] == nentries && first[c] == c*1e6, Form("async upload: content of upload %d", c));
+   }
+}
+
+int main(int argc, char **argv)
+{
+   // 8 MB messages, compressed in 8 blocks in parallel
+   int nbins = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+   printf("\ntestMessageCompression: %d bins\n\n", nbins);
+
+   CheckCompression(nbins, true, false, "parallel compression, sequential uncompression");
+   CheckCompression(nbins, false, true, "sequential compression, parallel uncompression");
+   CheckCompression(nbins, true, true, "parallel compression and uncompression");
+   CheckCompression(nbins, false, false, "sequential compression and uncompression");
+   CheckCompression(100000, true, true, "message below the parallel compression size");
+
+   CheckAsyncUpload(4, 100000);
+
+   printf("message compression: %s\n\n", gErrors ? "FAILED" : "ok");
+   return gErrors ? 1 : 0;
+}
@@ -0,0 +1,215 @@
+// This program checks the bulk reading of the objects of a directory
+// (TDirectoryFile::ReadObjects and ReadAll): a file with nested directories,
+// several cycles of some keys and large histograms, whose records need
+// several vectored reads, is read without and with the implicit
+// multi-threading and with the parallel streaming (option "P"). Every object
+// is compared to the one read by TKey::ReadObj.
+//
+//  run with
+//     testReadObjects [nbig]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "RConfigure.h"
+#include "TBufferFile.h"
+#include "TClass.h"
+#include "TFile.h"
+#include "TGraph.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TNamed.h"
+#include "TRandom3.h"
+#include "TROOT.h"
+#include "TString.h"
+#include "TSystem.h"
+
+int gErrors = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// count a failed check
+
+void Check(bool ok, const char *what)
+{
+   if (!ok) {
+      printf("FAILED: %s\n", what);
+      gErrors++;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// return true if both objects are of the same class and stream the same bytes
+
+bool Same(TObject *obj, TObject *ref)
+{
+   if (!obj || !ref || obj->IsA() != ref->IsA()) return false;
+   TBufferFile b1(TBuffer::kWrite), b2(TBuffer::kWrite);
+   obj->Streamer(b1);
+   ref->Streamer(b2);
+   return b1.Length() == b2.Length() && memcmp(b1.Buffer(), b2.Buffer(), b1.Length()) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// write the objects of a directory, with the sub-directories dir0..ndirs-1
+
+void Fill(TDirectory *dir, int nhist, int ndirs, int depth, TRandom3 &rnd)
+{
+   dir->cd();
+   for (int i = 0; i < nhist; i++) {
+      TH1F h(Form("h%d", i), Form("h%d", i), 100, -4, 4);
+      for (int n = 0; n < 1000; n++) h.Fill(rnd.Gaus());
+      h.Write();
+      if (i % 10 == 0) {
+         TH2F h2(Form("hh%d", i), Form("hh%d", i), 40, -4, 4, 40, -4, 4);
+         for (int n = 0; n < 1000; n++) h2.Fill(rnd.Gaus(), rnd.Gaus());
+         h2.Write();
+         TGraph g(20);
+         for (int p = 0; p < 20; p++) g.SetPoint(p, p, rnd.Rndm());
+         g.Write(Form("g%d", i));
+         TNamed n(Form("n%d", i), Form("n%d in %s", i, dir->GetName()));
+         n.Write();
+      }
+   }
+   // several cycles of the same names, ReadAll keeps the last one
+   for (int c = 1; c <= 3; c++) {
+      TNamed n("c", Form("cycle %d", c));
+      n.Write();
+      TH1F h("hc", Form("cycle %d", c), 10, 0, 10);
+      h.Fill(c);
+      h.Write();
+   }
+   if (depth == 0) return;
+   for (int d = 0; d < ndirs; d++) {
+      TDirectory *sub = dir->mkdir(Form("dir%d", d));
+      Fill(sub, nhist / 2, ndirs, depth - 1, rnd);
+      dir->cd();
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// read the objects of every key of dir and of its sub-directories with
+/// ReadObjects and compare them to the ones read by TKey::ReadObj from ref
+
+void CheckReadObjects(TDirectory *dir, TDirectory *ref, const char *option, const char *mode)
+{
+   TList keys, dirs;
+   TIter next(dir->GetListOfKeys());
+   TKey *key;
+   while ((key = (TKey *)next())) {
+      if (strstr(key->GetClassName(), "TDirectory")) dirs.Add(key);
+      else keys.Add(key);
+   }
+
+   TList objects;
+   Int_t nread = ((TDirectoryFile *)dir)->ReadObjects(&keys, &objects, option);
+   Check(nread == keys.GetSize() && objects.GetSize() == keys.GetSize(),
+         Form("%s: number of objects read in %s", mode, dir->GetPath()));
+   TIter nextKey(&keys);
+   TIter nextObj(&objects);
+   while ((key = (TKey *)nextKey())) {
+      TObject *obj = nextObj();
+      TKey *refKey = ref->GetKey(key->GetName(), key->GetCycle());
+      TObject *refObj = refKey ? refKey->ReadObj() : 0;
+      Check(Same(obj, refObj), Form("%s: %s;%d in %s", mode, key->GetName(), key->GetCycle(), dir->GetPath()));
+      delete refObj;
+   }
+   objects.Delete();
+
+   TIter nextDir(&dirs);
+   while ((key = (TKey *)nextDir())) {
+      TDirectory *sub = dir->GetDirectory(key->GetName());
+      TDirectory *refSub = ref->GetDirectory(key->GetName());
+      Check(sub && refSub, Form("%s: directory %s in %s", mode, key->GetName(), dir->GetPath()));
+      if (sub && refSub) CheckReadObjects(sub, refSub, option, mode);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// after ReadAll("dirs*") on the file, read every directory with ReadAll and
+/// compare its histograms to the last key of each name read by TKey::ReadObj
+
+void CheckReadAll(TDirectory *dir, TDirectory *ref, const char *mode)
+{
+   dir->ReadAll();
+
+   std::map<std::string, TKey *> last;
+   TIter next(ref->GetListOfKeys());
+   TKey *key;
+   while ((key = (TKey *)next())) last[key->GetName()] = key;
+
+   Int_t nhist = 0;
+   for (std::map<std::string, TKey *>::iterator it = last.begin(); it != last.end(); ++it) {
+      key = it->second;
+      TClass *cl = TClass::GetClass(key->GetClassName());
+      if (strstr(key->GetClassName(), "TDirectory")) {
+         TDirectory *sub = dynamic_cast<TDirectory *>(dir->GetList()->FindObject(key->GetName()));
+         TDirectory *refSub = ref->GetDirectory(key->GetName());
+         Check(sub && refSub, Form("%s: directory %s read by ReadAll(\"dirs*\")", mode, key->GetName()));
+         if (sub && refSub) CheckReadAll(sub, refSub, mode);
+         continue;
+      }
+      // the other objects are not added to the directory
+      if (!cl || !cl->InheritsFrom(TH1::Class())) continue;
+      nhist++;
+      TObject *obj = dir->GetList()->FindObject(key->GetName());
+      TObject *refObj = key->ReadObj();
+      Check(Same(obj, refObj), Form("%s: %s in %s", mode, key->GetName(), dir->GetPath()));
+      delete refObj;
+   }
+   Check(nhist > 0, Form("%s: histograms in %s", mode, dir->GetPath()));
+}
+
+int main(int argc, char **argv)
+{
+   // 24 MB each, poorly compressed: 4 of them need two vectored reads
+   int nbig = (argc > 1) ? atoi(argv[1]) : 4;
+   const char *filename = "testReadObjects.root";
+
+   printf("\ntestReadObjects: %d large histograms\n\n", nbig);
+
+   {
+      TFile file(filename, "RECREATE");
+      TRandom3 rnd(44);
+      Fill(&file, 200, 3, 2, rnd);
+      file.cd();
+      for (int i = 0; i < nbig; i++) {
+         TH1D h(Form("big%d", i), Form("big%d", i), 3000000, 0, 1);
+         for (int b = 1; b <= 3000000; b++) h.SetBinContent(b, rnd.Rndm());
+         h.Write();
+      }
+   }
+
+   TH1::AddDirectory(kTRUE);
+   TFile ref(filename);
+   const char *modes[] = { "sequential", "implicit MT", "implicit MT, parallel streaming" };
+   const char *options[] = { "", "", "P" };
+   for (int m = 0; m < 3; m++) {
+#ifdef R__USE_IMT
+      if (m == 1) ROOT::EnableImplicitMT(4);
+#else
+      if (m > 0) break;
+#endif
+      {
+         TFile file(filename);
+         CheckReadObjects(&file, &ref, options[m], Form("ReadObjects, %s", modes[m]));
+      }
+      if (m < 2) {
+         TFile file(filename);
+         file.ReadAll("dirs*");
+         CheckReadAll(&file, &ref, Form("ReadAll, %s", modes[m]));
+      }
+   }
+#ifdef R__USE_IMT
+   ROOT::DisableImplicitMT();
+#endif
+   ref.Close();
+
+   gSystem->Unlink(filename);
+   printf("read objects: %s\n\n", gErrors ? "FAILED" : "ok");
+   return gErrors ? 1 : 0;
+}
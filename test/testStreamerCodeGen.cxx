@@ -0,0 +1,166 @@
+// This program checks the functions generated by Cling for the object-wise
+// action sequences (TActionSequence::SetCodeGenerationThreshold).
+// Histograms are written and read by TBufferFile with a threshold of 1, so
+// that the generated functions are used from the second application of each
+// sequence on, and the bytes and the histograms are compared to the ones of
+// the interpreted actions. The sequences of TProfile are then generated while
+// several threads stream profiles at the same time.
+//
+//  run with
+//     testStreamerCodeGen [nthreads]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "TBufferFile.h"
+#include "TClass.h"
+#include "TH1.h"
+#include "TProfile.h"
+#include "TROOT.h"
+#include "TRandom3.h"
+#include "TStreamerInfo.h"
+#include "TStreamerInfoActions.h"
+
+int gErrors = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// stream obj into a new buffer with the current threshold
+
+std::vector<char> WriteObject(const TObject *obj)
+{
+   TBufferFile buf(TBuffer::kWrite);
+   buf.WriteObject(obj);
+   return std::vector<char>(buf.Buffer(), buf.Buffer() + buf.Length());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// read back an object written by WriteObject
+
+TH1 *ReadObject(std::vector<char> &bytes)
+{
+   TBufferFile buf(TBuffer::kRead, bytes.size(), &bytes[0], kFALSE);
+   return (TH1 *)buf.ReadObject(TH1::Class());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// compare the histogram read back to the original one
+
+bool SameHistogram(const TH1 *h, const TH1 *ref)
+{
+   if (!h || h->IsA() != ref->IsA()) return false;
+   if (strcmp(h->GetName(), ref->GetName()) || strcmp(h->GetTitle(), ref->GetTitle())) return false;
+   if (h->GetNbinsX() != ref->GetNbinsX() || h->GetXaxis()->GetXmin() != ref->GetXaxis()->GetXmin() ||
+       h->GetXaxis()->GetXmax() != ref->GetXaxis()->GetXmax()) return false;
+   if (h->GetLineColor() != ref->GetLineColor() || h->GetLineWidth() != ref->GetLineWidth() ||
+       h->GetFillStyle() != ref->GetFillStyle() || h->GetMarkerSize() != ref->GetMarkerSize()) return false;
+   if (h->GetEntries() != ref->GetEntries() || h->GetSumOfWeights() != ref->GetSumOfWeights()) return false;
+   Double_t stats[TH1::kNstat], refStats[TH1::kNstat];
+   h->GetStats(stats);
+   ref->GetStats(refStats);
+   for (int i = 0; i < TH1::kNstat; i++) if (stats[i] != refStats[i]) return false;
+   for (int i = 0; i <= h->GetNbinsX() + 1; i++) {
+      if (h->GetBinContent(i) != ref->GetBinContent(i) || h->GetBinError(i) != ref->GetBinError(i)) return false;
+   }
+   return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// check that code was generated for the sequences of the class
+
+void CheckGenerated(const char *classname)
+{
+   TStreamerInfo *info = (TStreamerInfo *)TClass::GetClass(classname)->GetStreamerInfo();
+   if (!info->GetReadObjectWiseActions()->fCompiled.load() || !info->GetWriteObjectWiseActions()->fCompiled.load()) {
+      printf("%s: no function was generated for its sequences\n", classname);
+      gErrors++;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// write, read and compare the histograms npass times
+
+void RoundTrip(const std::vector<TH1 *> &hists, const std::vector<std::vector<char> > &refBytes, int npass,
+               int &errors)
+{
+   for (int pass = 0; pass < npass; pass++) {
+      for (size_t i = 0; i < hists.size(); i++) {
+         std::vector<char> bytes = WriteObject(hists[i]);
+         if (bytes != refBytes[i]) {
+            printf("%s: the bytes written differ in pass %d\n", hists[i]->GetName(), pass);
+            errors++;
+         }
+         TH1 *h = ReadObject(bytes);
+         if (!SameHistogram(h, hists[i])) {
+            printf("%s: the histogram read back differs in pass %d\n", hists[i]->GetName(), pass);
+            errors++;
+         }
+         delete h;
+      }
+   }
+}
+
+int main(int argc, char **argv)
+{
+   int nthreads = (argc > 1) ? atoi(argv[1]) : 4;
+
+   TH1::AddDirectory(kFALSE);
+   TRandom3 rnd(4357);
+
+   std::vector<TH1 *> hists;
+   std::vector<TH1 *> profiles;
+   for (int i = 0; i < 10; i++) {
+      TH1 *h = (i % 2) ? (TH1 *)new TH1F(Form("hf%d", i), "float histogram", 50 + i, -3, 3)
+                       : (TH1 *)new TH1D(Form("hd%d", i), "double histogram", 50 + i, -3, 3);
+      h->SetLineColor(i + 1);
+      h->SetLineWidth(i % 3 + 1);
+      h->SetFillStyle(3001 + i);
+      h->SetMarkerSize(0.5 + i);
+      h->Sumw2();
+      for (int n = 0; n < 1000; n++) h->Fill(rnd.Gaus(), rnd.Uniform(0.5, 2));
+      hists.push_back(h);
+      TProfile *p = new TProfile(Form("p%d", i), "profile", 20 + i, -3, 3);
+      for (int n = 0; n < 1000; n++) p->Fill(rnd.Gaus(), rnd.Gaus(5, 2));
+      profiles.push_back(p);
+   }
+
+   // The reference bytes are written by the actions.
+   TStreamerInfoActions::TActionSequence::SetCodeGenerationThreshold(0);
+   std::vector<std::vector<char> > refBytes, refProfileBytes;
+   for (size_t i = 0; i < hists.size(); i++) refBytes.push_back(WriteObject(hists[i]));
+   for (size_t i = 0; i < profiles.size(); i++) refProfileBytes.push_back(WriteObject(profiles[i]));
+
+   printf("\ntestStreamerCodeGen: %d histograms, %d profiles, %d threads\n\n", (int)hists.size(),
+          (int)profiles.size(), nthreads);
+
+   TStreamerInfoActions::TActionSequence::SetCodeGenerationThreshold(1);
+   RoundTrip(hists, refBytes, 3, gErrors);
+   const char *classes[] = {"TH1", "TH1F", "TH1D", "TAxis", "TAttLine", "TAttFill", "TAttMarker"};
+   for (size_t i = 0; i < sizeof(classes) / sizeof(classes[0]); i++) CheckGenerated(classes[i]);
+   printf("histograms: %s\n", gErrors ? "FAILED" : "ok");
+
+   // The sequences of TProfile have not been applied yet, the threads race
+   // for their generation.
+   int before = gErrors;
+   ROOT::EnableThreadSafety();
+   std::vector<int> errors(nthreads, 0);
+   std::vector<std::thread> threads;
+   for (int t = 0; t < nthreads; t++) {
+      threads.push_back(std::thread([&, t]() { RoundTrip(profiles, refProfileBytes, 3, errors[t]); }));
+   }
+   for (int t = 0; t < nthreads; t++) {
+      threads[t].join();
+      gErrors += errors[t];
+   }
+   CheckGenerated("TProfile");
+   printf("profiles in threads: %s\n\n", gErrors > before ? "FAILED" : "ok");
+
+   TStreamerInfoActions::TActionSequence::SetCodeGenerationThreshold(0);
+   for (size_t i = 0; i < hists.size(); i++) {
+      delete hists[i];
+      delete profiles[i];
+   }
+   return gErrors ? 1 : 0;
+}
@@ -0,0 +1,310 @@
+// This program checks TWebFile::ReadBuffers against a minimal HTTP/1.1
+// server running in a thread of the program and serving a ROOT file from
+// memory with single and multipart byte range responses. It checks that
+//  -blocks closer than TWebFile::SetGapThreshold are requested as a single
+//   byte range and the bytes read are the ones of the file
+//  -with TWebFile::SetPipelineDepth > 1 several requests are outstanding on
+//   the keep-alive connection
+//  -the blocks are still read correctly when the server closes the
+//   connection while requests are in flight
+//
+//  run with
+//     testWebFile
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TRandom3.h"
+#include "TSystem.h"
+#include "TWebFile.h"
+
+int gErrors = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// HTTP server answering HEAD and GET with Range requests for one file.
+/// The connections are handled one after the other, like TWebFile uses them.
+
+class TRangeServer {
+public:
+   std::vector<char> fData;            // content of the file
+   int               fListen;          // listening socket
+   int               fPort;            // port of the listening socket
+   std::atomic<bool> fStop;            // stop the server
+   std::atomic<int>  fConnections;     // number of connections accepted
+   std::atomic<int>  fRequests;        // number of GET requests answered
+   std::atomic<int>  fRanges;          // number of byte ranges sent
+   std::atomic<int>  fMaxPipelined;    // most requests received and not yet answered
+   std::atomic<int>  fDropAfter;       // if > 0, close the connection after that many more GETs
+   std::thread       fThread;
+
+   TRangeServer(const std::vector<char> &data)
+      : fData(data), fListen(-1), fPort(0), fStop(false), fConnections(0), fRequests(0), fRanges(0),
+        fMaxPipelined(0), fDropAfter(0)
+   {
+      fListen = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in addr;
+      memset(&addr, 0, sizeof(addr));
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      addr.sin_port = 0;
+      socklen_t len = sizeof(addr);
+      if (fListen < 0 || bind(fListen, (sockaddr *)&addr, sizeof(addr)) || listen(fListen, 4) ||
+          getsockname(fListen, (sockaddr *)&addr, &len)) {
+         printf("FAILED: cannot start the HTTP server\n");
+         gErrors++;
+         return;
+      }
+      fPort = ntohs(addr.sin_port);
+      fThread = std::thread([this]() { Run(); });
+   }
+
+   ~TRangeServer()
+   {
+      fStop = true;
+      if (fThread.joinable()) fThread.join();
+      if (fListen >= 0) close(fListen);
+   }
+
+   bool SendAll(int fd, const std::string &s)
+   {
+      size_t sent = 0;
+      while (sent < s.size()) {
+         ssize_t n = send(fd, s.data() + sent, s.size() - sent, MSG_NOSIGNAL);
+         if (n <= 0) return false;
+         sent += n;
+      }
+      return true;
+   }
+
+   /// wait up to ms milliseconds for data and append it to in, false at EOF
+   bool Receive(int fd, std::string &in, int ms)
+   {
+      pollfd pfd = {fd, POLLIN, 0};
+      if (poll(&pfd, 1, ms) <= 0) return true;
+      char buf[16384];
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) return false;
+      in.append(buf, n);
+      return true;
+   }
+
+   std::string Answer(const std::string &request)
+   {
+      char line[256];
+      if (!request.compare(0, 5, "HEAD ")) {
+         snprintf(line, sizeof(line), "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n", (int)fData.size());
+         return line;
+      }
+      size_t r = request.find("Range: bytes=");
+      if (r == std::string::npos) return "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+      std::vector<std::pair<long, long> > ranges;
+      const char *p = request.c_str() + r + 13;
+      while (true) {
+         char *end;
+         long first = strtol(p, &end, 10);
+         long last = strtol(end + 1, &end, 10);
+         ranges.push_back(std::make_pair(first, last));
+         if (*end != ',') break;
+         p = end + 1;
+      }
+      fRequests++;
+      fRanges += ranges.size();
+      const long size = fData.size();
+      std::string out;
+      if (ranges.size() == 1) {
+         snprintf(line, sizeof(line),
+                  "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %ld-%ld/%ld\r\nContent-Length: %ld\r\n\r\n",
+                  ranges[0].first, ranges[0].second, size, ranges[0].second - ranges[0].first + 1);
+         out = line;
+         out.append(&fData[ranges[0].first], ranges[0].second - ranges[0].first + 1);
+         return out;
+      }
+      std::string body;
+      for (size_t i = 0; i < ranges.size(); i++) {
+         snprintf(line, sizeof(line),
+                  "\r\n--RANGES\r\nContent-Type: application/octet-stream\r\nContent-Range: bytes %ld-%ld/%ld\r\n\r\n",
+                  ranges[i].first, ranges[i].second, size);
+         body += line;
+         body.append(&fData[ranges[i].first], ranges[i].second - ranges[i].first + 1);
+      }
+      body += "\r\n--RANGES--\r\n";
+      snprintf(line, sizeof(line),
+               "HTTP/1.1 206 Partial Content\r\nContent-Type: multipart/byteranges; boundary=RANGES\r\n"
+               "Content-Length: %d\r\n\r\n", (int)body.size());
+      return line + body;
+   }
+
+   void Serve(int fd)
+   {
+      std::string in;
+      while (!fStop) {
+         size_t end = in.find("\r\n\r\n");
+         if (end == std::string::npos) {
+            if (!Receive(fd, in, 100)) return;
+            continue;
+         }
+         // give the requests sent ahead the time to arrive, then count them
+         if (!Receive(fd, in, 20)) return;
+         int pending = 0;
+         for (size_t pos = 0; (pos = in.find("\r\n\r\n", pos)) != std::string::npos; pos += 4) pending++;
+         if (pending > fMaxPipelined) fMaxPipelined = pending;
+
+         std::string request = in.substr(0, end + 4);
+         in.erase(0, end + 4);
+         if (!SendAll(fd, Answer(request))) return;
+         if (!request.compare(0, 4, "GET ") && fDropAfter > 0 && --fDropAfter == 0) {
+            // close the connection with requests in flight; the input is
+            // drained so that the responses already sent are not reset
+            shutdown(fd, SHUT_WR);
+            for (int i = 0; i < 50 && Receive(fd, in, 100); i++) {}
+            return;
+         }
+      }
+   }
+
+   void Run()
+   {
+      while (!fStop) {
+         pollfd pfd = {fListen, POLLIN, 0};
+         if (poll(&pfd, 1, 100) <= 0) continue;
+         int fd = accept(fListen, 0, 0);
+         if (fd < 0) continue;
+         fConnections++;
+         Serve(fd);
+         close(fd);
+      }
+   }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// read the blocks with ReadBuffers and compare them to the file
+
+bool ReadBlocks(TWebFile &file, const std::vector<char> &data, std::vector<Long64_t> pos, std::vector<Int_t> len)
+{
+   Long64_t total = 0;
+   for (size_t i = 0; i < len.size(); i++) total += len[i];
+   std::vector<char> buf(total);
+   if (file.ReadBuffers(&buf[0], &pos[0], &len[0], pos.size())) return false;
+   Long64_t k = 0;
+   for (size_t i = 0; i < pos.size(); i++) {
+      if (memcmp(&buf[k], &data[pos[i]], len[i])) return false;
+      k += len[i];
+   }
+   return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// count a failed check
+
+void Check(bool ok, const char *what)
+{
+   if (!ok) {
+      printf("FAILED: %s\n", what);
+      gErrors++;
+   }
+}
+
+int main()
+{
+   const char *filename = "testWebFile.root";
+
+   printf("\ntestWebFile: TWebFile::ReadBuffers\n\n");
+
+   // a file large enough for 1000 blocks, written uncompressed
+   {
+      TH1::AddDirectory(kFALSE);
+      TRandom3 rnd(4357);
+      TFile f(filename, "RECREATE", "", 0);
+      for (int i = 0; i < 50; i++) {
+         TH1F h(Form("h%d", i), "histogram", 1000, 0, 1);
+         for (int n = 0; n < 10000; n++) h.Fill(rnd.Rndm());
+         h.Write();
+      }
+   }
+   std::ifstream in(filename, std::ios::binary);
+   std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+   in.close();
+   gSystem->Unlink(filename);
+
+   TRangeServer server(data);
+   if (gErrors) return 1;
+
+   TWebFile::SetGapThreshold(0);
+   TWebFile::SetPipelineDepth(1);
+   TWebFile file(Form("http://127.0.0.1:%d/%s", server.fPort, filename));
+   if (file.IsZombie()) {
+      printf("FAILED: cannot open the file from the HTTP server\n");
+      return 1;
+   }
+
+   // 10 touching blocks, then 1000 blocks separated by 30 bytes
+   std::vector<Long64_t> tpos, gpos;
+   std::vector<Int_t> tlen, glen;
+   for (int i = 0; i < 10; i++) {
+      tpos.push_back(1000 + i * 50);
+      tlen.push_back(50);
+   }
+   for (int i = 0; i < 1000; i++) {
+      gpos.push_back(2000 + i * 80);
+      glen.push_back(50);
+   }
+   Check(gpos.back() + glen.back() < (Long64_t)data.size(), "file large enough");
+
+   int ranges = server.fRanges;
+   Check(ReadBlocks(file, data, tpos, tlen), "touching blocks");
+   Check(server.fRanges - ranges == 1, "touching blocks read as one range");
+
+   std::vector<Long64_t> fewpos(gpos.begin(), gpos.begin() + 100);
+   std::vector<Int_t> fewlen(glen.begin(), glen.begin() + 100);
+   ranges = server.fRanges;
+   Check(ReadBlocks(file, data, fewpos, fewlen), "blocks with gaps");
+   Check(server.fRanges - ranges == 100, "blocks with gaps above the threshold read as separate ranges");
+
+   TWebFile::SetGapThreshold(64);
+   ranges = server.fRanges;
+   Check(ReadBlocks(file, data, fewpos, fewlen), "blocks with gaps merged");
+   Check(server.fRanges - ranges == 1, "blocks with gaps below the threshold read as one range");
+   TWebFile::SetGapThreshold(0);
+   printf("gap coalescing: %s\n", gErrors ? "FAILED" : "ok");
+
+   int before = gErrors;
+   server.fMaxPipelined = 0;
+   int requests = server.fRequests;
+   Check(ReadBlocks(file, data, gpos, glen), "1000 blocks without pipelining");
+   Check(server.fRequests - requests == 5, "1000 blocks in 5 requests");
+   Check(server.fMaxPipelined == 1, "one request at a time without pipelining");
+
+   TWebFile::SetPipelineDepth(4);
+   server.fMaxPipelined = 0;
+   requests = server.fRequests;
+   Check(ReadBlocks(file, data, gpos, glen), "1000 blocks with pipelining");
+   Check(server.fRequests - requests == 5, "1000 blocks in 5 pipelined requests");
+   Check(server.fMaxPipelined > 1, "several requests outstanding with pipelining");
+   printf("pipelining: %s\n", gErrors > before ? "FAILED" : "ok");
+
+   before = gErrors;
+   int connections = server.fConnections;
+   server.fDropAfter = 2;
+   Check(ReadBlocks(file, data, gpos, glen), "1000 blocks with a connection drop");
+   Check(server.fConnections - connections == 1, "connection reopened once");
+   Check(ReadBlocks(file, data, gpos, glen), "1000 blocks after a connection drop");
+   printf("connection drop: %s\n\n", gErrors > before ? "FAILED" : "ok");
+
+   TWebFile::SetPipelineDepth(0);
+   TWebFile::SetGapThreshold(-1);
+   return gErrors ? 1 : 0;
+}
@@ -69,6 +69,11 @@ namespace TMVA {
       Bool_t DrawProgressBar() const { return fDrawProgressBar; }
       void   SetDrawProgressBar( Bool_t d ) { fDrawProgressBar = d; }
 
+      // number of worker processes used to train the folds of Factory::CrossValidate
+      // and the parameter points of OptimizeTuningParameters (0 or 1: sequential)
+      UInt_t GetNWorkers() const { return fNWorkers; }
+      void   SetNWorkers( UInt_t n ) { fNWorkers = n; }
+
    public:
 
       class VariablePlotting;
@@ -122,11 +127,13 @@ namespace TMVA {
       std::atomic<Bool_t> fSilent;                // no output at all
       std::atomic<Bool_t> fWriteOptionsReference; // if set true: Configurable objects write file with option reference
       std::atomic<Bool_t> fDrawProgressBar;       // draw progress bar to indicate training evolution
+      std::atomic<UInt_t> fNWorkers;              // number of worker processes for cross validation and tuning
 #else
       Bool_t fUseColoredConsole;     // coloured standard output
       Bool_t fSilent;                // no output at all
       Bool_t fWriteOptionsReference; // if set true: Configurable objects write file with option reference
       Bool_t fDrawProgressBar;       // draw progress bar to indicate training evolution
+      UInt_t fNWorkers;              // number of worker processes for cross validation and tuning
 #endif
       mutable MsgLogger* fLogger;   // message logger
       MsgLogger& Log() const { return *fLogger; }
@@ -279,6 +279,26 @@ public:
    /** Compute the sum of all elements in \p A */
    static Scalar_t Sum(const TCpuMatrix<Scalar_t> &A);
 
+   //____________________________________________________________________________
+   //
+   // Minibatch Parallelism
+   //____________________________________________________________________________
+
+   /** Call \p f(i) for i = 0, ..., \p nBatches - 1. Used by the minimizers to
+    *  propagate several batches through independent copies of the network.
+    *  The batches are processed in parallel on the ROOT thread pool if
+    *  implicit multi-threading is enabled. */
+   template <typename Function_t>
+   static void ForEachBatch(size_t nBatches, Function_t && f)
+   {
+      if ((nBatches > 1) && ROOT::IsImplicitMTEnabled()) {
+         tbb::parallel_for(size_t(0), nBatches, f);
+      } else {
+         for (size_t i = 0; i < nBatches; i++) {
+            f(i);
+         }
+      }
+   }
 };
 
 } // namespace DNN
@@ -17,11 +17,13 @@
 #ifndef TMVA_DNN_ARCHITECTURES_CPU_CPUMATRIX
 #define TMVA_DNN_ARCHITECTURES_CPU_CPUMATRIX
 
+#include <algorithm>
 #include <cstddef>
 #include <vector>
 #include "tbb/tbb.h"
 
 #include "TMatrix.h"
+#include "TROOT.h"
 #include "CpuBuffer.h"
 
 namespace TMVA
@@ -36,6 +38,13 @@ namespace DNN
  * BLAS. Provides Map and MapFrom member functions to simplify the application of
  * activation functions and derivatives to matrices.
  *
+ * Element-wise operations are split into ranges of GetNElementsPerTask()
+ * consecutive elements (see ForEachRange() and ReduceRanges()). If implicit
+ * multi-threading is enabled (ROOT::EnableImplicitMT()), the ranges are
+ * processed in parallel on the ROOT thread pool, otherwise serially. The
+ * loop over the elements of a range is contiguous, so that it can be
+ * vectorized by the compiler.
+ *
  * Copying and assignment of TCpuMatrix objects only performs shallow copies, i.e.
  * copying is fast and the resulting objects share the element data.
  *
@@ -80,7 +89,7 @@ public:
    operator TMatrixT<Double_t>() const;
 
    /** Map the given function over the matrix elements. Executed in parallel
-    *  using tbb. */
+    *  if implicit multi-threading is enabled. */
    template <typename Function_t>
    void Map(Function_t &f);
 
@@ -89,6 +98,22 @@ public:
    template <typename Function_t>
    void MapFrom(Function_t &f, const TCpuMatrix & A);
 
+   /** Number of consecutive elements processed by one task in the
+    *  element-wise operations. */
+   static size_t GetNElementsPerTask() {return 4096;}
+
+   /** Call \p f(begin, end) for consecutive ranges of at most
+    *  GetNElementsPerTask() elements covering [0, \p nElements). The ranges
+    *  are processed in parallel if implicit multi-threading is enabled. */
+   template <typename Function_t>
+   static void ForEachRange(size_t nElements, Function_t && f);
+
+   /** Sum of \p f(begin, end) over the ranges of ForEachRange(). The partial
+    *  sums of the ranges are added in a fixed order, so that the result does
+    *  not depend on the number of threads. */
+   template <typename Function_t>
+   static AFloat ReduceRanges(size_t nElements, Function_t && f);
+
    size_t GetNrows() const {return fNRows;}
    size_t GetNcols() const {return fNCols;}
    size_t GetNElements() const {return fNRows * fNCols;}
@@ -109,6 +134,58 @@ private:
 };
 
 // Inline Functions.
+//______________________________________________________________________________
+template<typename AFloat>
+template<typename Function_t>
+inline void TCpuMatrix<AFloat>::ForEachRange(size_t nElements, Function_t && f)
+{
+   size_t nElementsPerTask = GetNElementsPerTask();
+   size_t nTasks = (nElements + nElementsPerTask - 1) / nElementsPerTask;
+
+   if ((nTasks > 1) && ROOT::IsImplicitMTEnabled()) {
+      auto fTask = [nElements, nElementsPerTask, &f](size_t task)
+      {
+         size_t rangeBegin = task * nElementsPerTask;
+         size_t rangeEnd   = std::min(rangeBegin + nElementsPerTask, nElements);
+         f(rangeBegin, rangeEnd);
+      };
+      tbb::parallel_for(size_t(0), nTasks, fTask);
+   } else if (nElements > 0) {
+      f(size_t(0), nElements);
+   }
+}
+
+//______________________________________________________________________________
+template<typename AFloat>
+template<typename Function_t>
+inline AFloat TCpuMatrix<AFloat>::ReduceRanges(size_t nElements, Function_t && f)
+{
+   size_t nElementsPerTask = GetNElementsPerTask();
+   size_t nTasks = (nElements + nElementsPerTask - 1) / nElementsPerTask;
+
+   std::vector<AFloat> partialSums(nTasks);
+   auto fTask = [nElements, nElementsPerTask, &f, &partialSums](size_t task)
+   {
+      size_t rangeBegin = task * nElementsPerTask;
+      size_t rangeEnd   = std::min(rangeBegin + nElementsPerTask, nElements);
+      partialSums[task] = f(rangeBegin, rangeEnd);
+   };
+
+   if ((nTasks > 1) && ROOT::IsImplicitMTEnabled()) {
+      tbb::parallel_for(size_t(0), nTasks, fTask);
+   } else {
+      for (size_t task = 0; task < nTasks; task++) {
+         fTask(task);
+      }
+   }
+
+   AFloat sum = 0.0;
+   for (size_t task = 0; task < nTasks; task++) {
+      sum += partialSums[task];
+   }
+   return sum;
+}
+
 //______________________________________________________________________________
 template<typename AFloat>
 template<typename Function_t>
@@ -116,20 +193,17 @@ inline void TCpuMatrix<AFloat>::Map(Function_t &f)
 {
    AFloat  *data = GetRawDataPointer();
 
-   auto fRange = [data, &f](const tbb::blocked_range<size_t> & range)
+   auto fRange = [data, &f](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-      size_t rangeEnd   = range.end();
-
       for (size_t i = rangeBegin; i != rangeEnd; ++i) {
          data[i] = f(data[i]);
       }
    };
 
-   tbb::blocked_range<size_t> range(0, GetNElements());
-   parallel_for(range, fRange);
+   ForEachRange(GetNElements(), fRange);
 }
 
+//______________________________________________________________________________
 template<typename AFloat>
 template<typename Function_t>
 inline void TCpuMatrix<AFloat>::MapFrom(Function_t &f, const TCpuMatrix &A)
@@ -137,18 +211,14 @@ inline void TCpuMatrix<AFloat>::MapFrom(Function_t &f, const TCpuMatrix &A)
          AFloat  *dataB = GetRawDataPointer();
    const AFloat  *dataA = A.GetRawDataPointer();
 
-   auto fRange = [&dataB, &dataA, &f](const tbb::blocked_range<size_t> & range)
+   auto fRange = [dataB, dataA, &f](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-         size_t rangeEnd   = range.end();
-
-         for (size_t i = rangeBegin; i != rangeEnd; ++i) {
-            dataB[i] = f(dataA[i]);
-         }
+      for (size_t i = rangeBegin; i != rangeEnd; ++i) {
+         dataB[i] = f(dataA[i]);
+      }
    };
 
-   tbb::blocked_range<size_t> range(0, GetNElements());
-   parallel_for(range, fRange);
+   ForEachRange(GetNElements(), fRange);
 }
 
 } // namespace DNN
@@ -281,6 +281,22 @@ public:
 
    /** Compute the sum of all elements in \p A */
    static AFloat Sum(const TCudaMatrix<AFloat> &A);
+
+   //____________________________________________________________________________
+   //
+   // Minibatch Parallelism
+   //____________________________________________________________________________
+
+   /** Call \p f(i) for i = 0, ..., \p nBatches - 1. Used by the minimizers to
+    *  propagate several batches through independent copies of the network.
+    *  The batches are processed one after the other on this architecture. */
+   template <typename Function_t>
+   static void ForEachBatch(size_t nBatches, Function_t && f)
+   {
+      for (size_t i = 0; i < nBatches; i++) {
+         f(i);
+      }
+   }
 };
 
 } // namespace DNN
@@ -242,6 +242,22 @@ public:
    static void Dropout(TMatrixT<Real_t> & A, Real_t dropoutProbability);
 
    ///@}
+
+   //____________________________________________________________________________
+   //
+   // Minibatch Parallelism
+   //____________________________________________________________________________
+
+   /** Call \p f(i) for i = 0, ..., \p nBatches - 1. Used by the minimizers to
+    *  propagate several batches through independent copies of the network.
+    *  The batches are processed one after the other on this architecture. */
+   template <typename Function_t>
+   static void ForEachBatch(size_t nBatches, Function_t && f)
+   {
+      for (size_t i = 0; i < nBatches; i++) {
+         f(i);
+      }
+   }
 };
 
 } // namespace DNN
@@ -107,9 +107,10 @@ public:
 
    /** Perform multiple optimization steps simultaneously. Performs the
     *  backprop algorithm on the input batches given in \p batches on
-    *  the neural networks given in \p nets. The forward and backward propagation
-    *  steps are executed in an interleaving manner in order to exploit potential
-    *  batch-level parallelism for asynchronous device calls.
+    *  the neural networks given in \p nets. The batches are propagated
+    *  through their nets using Architecture_t::ForEachBatch(...), which
+    *  processes them in parallel on architectures that support it. The
+    *  updates of the master net are then applied in the order of the batches.
     */
    template <typename Net_t>
    void Step(Net_t &master,
@@ -162,6 +163,14 @@ public:
    void SetTestInterval(size_t interval)  {fTestInterval = interval;}
    void SetLearningRate(Scalar_t rate)    {fLearningRate = rate;}
    void SetBatchSize(Scalar_t rate)       {fBatchSize    = rate;}
+
+private:
+   /** Forward and backward propagation of each batch in \p batches through
+    *  the corresponding net in \p nets. The nets are independent copies of
+    *  the master net, so the batches can be propagated concurrently. */
+   template <typename Net_t>
+   void PropagateBatches(std::vector<Net_t> &nets,
+                         std::vector<TBatch<Architecture_t>> &batches);
 };
 
 //
@@ -421,44 +430,9 @@ template<typename Architecture_t>
         std::vector<Net_t> & nets,
         std::vector<TBatch<Architecture_t>> & batches)
 {
-   typename Architecture_t::Matrix_t dummy(0,0);
    size_t depth = master.GetDepth();
 
-   // Forward
-   for (size_t j = 0; j < nets.size(); j++) {
-      nets[j].GetLayer(0).Forward(batches[j].GetInput());
-   }
-
-   for (size_t i = 1; i < depth; i++)
-   {
-      for (size_t j = 0; j < nets.size(); j++) {
-         nets[j].GetLayer(i).Forward(nets[j].GetLayer(i-1).GetOutput());
-      }
-   }
-   // Gradients
-   for (size_t j = 0; j < nets.size(); j++) {
-      evaluateGradients<Architecture_t>(
-          nets[j].GetLayer(depth-1).GetActivationGradients(),
-          nets[j].GetLossFunction(),
-          batches[j].GetOutput(),
-          nets[j].GetLayer(depth-1).GetOutput());
-   }
-   // Backward
-   for (size_t i = depth - 1; i > 0; i--)
-   {
-      for (size_t j = 0; j < nets.size(); j++) {
-         nets[j].GetLayer(i).Backward(nets[j].GetLayer(i-1).GetActivationGradients(),
-                                      nets[j].GetLayer(i-1).GetOutput(),
-                                      nets[j].GetRegularization(),
-                                      nets[j].GetWeightDecay());
-      }
-   }
-   for (size_t j = 0; j < nets.size(); j++) {
-      nets[j].GetLayer(0).Backward(dummy,
-                                   batches[j].GetInput(),
-                                   nets[j].GetRegularization(),
-                                   nets[j].GetWeightDecay());
-   }
+   PropagateBatches(nets, batches);
 
    for (size_t j = 0; j < nets.size(); j++) {
       for (size_t i = 0; i < depth; i++)
@@ -488,36 +462,14 @@ void inline TGradientDescent<Architecture_t>::StepMomentum(
         std::vector<TBatch<Architecture_t>> & batches,
         Scalar_t momentum)
 {
-   typename Architecture_t::Matrix_t dummy(0,0);
    size_t depth = master.GetDepth();
 
-   // Forward
-   for (size_t j = 0; j < nets.size(); j++) {
-      nets[j].GetLayer(0).Forward(batches[j].GetInput());
-   }
+   PropagateBatches(nets, batches);
 
-   for (size_t i = 1; i < depth; i++)
-   {
-      for (size_t j = 0; j < nets.size(); j++) {
-         nets[j].GetLayer(i).Forward(nets[j].GetLayer(i-1).GetOutput());
-      }
-   }
-   // Gradients
-   for (size_t j = 0; j < nets.size(); j++) {
-      evaluateGradients<Architecture_t>(
-          nets[j].GetLayer(depth-1).GetActivationGradients(),
-          nets[j].GetLossFunction(),
-          batches[j].GetOutput(),
-          nets[j].GetLayer(depth-1).GetOutput());
-   }
-   // Backward
+   // Accumulate the gradients in the master net.
    for (size_t i = depth - 1; i > 0; i--)
    {
       for (size_t j = 0; j < nets.size(); j++) {
-         nets[j].GetLayer(i).Backward(nets[j].GetLayer(i-1).GetActivationGradients(),
-                                      nets[j].GetLayer(i-1).GetOutput(),
-                                      nets[j].GetRegularization(),
-                                      nets[j].GetWeightDecay());
          Architecture_t::ScaleAdd(master.GetLayer(i).GetWeightGradients(),
                                   nets[j].GetLayer(i).GetWeightGradients(),
                                   - fLearningRate / momentum);
@@ -533,10 +485,6 @@ void inline TGradientDescent<Architecture_t>::StepMomentum(
                                momentum - 1.0);
    }
    for (size_t j = 0; j < nets.size(); j++) {
-      nets[j].GetLayer(0).Backward(dummy,
-                                   batches[j].GetInput(),
-                                   nets[j].GetRegularization(),
-                                   nets[j].GetWeightDecay());
       Architecture_t::ScaleAdd(master.GetLayer(0).GetWeightGradients(),
                                nets[j].GetLayer(0).GetWeightGradients(),
                                - fLearningRate / momentum);
@@ -580,47 +528,9 @@ void inline TGradientDescent<Architecture_t>::StepNesterov(
         std::vector<TBatch<Architecture_t>> & batches,
         Scalar_t momentum)
 {
-   typename Architecture_t::Matrix_t dummy(0,0);
    size_t depth = master.GetDepth();
 
-   // Forward
-   for (size_t j = 0; j < nets.size(); j++) {
-      nets[j].GetLayer(0).Forward(batches[j].GetInput());
-   }
-
-   for (size_t i = 1; i < depth; i++)
-   {
-      for (size_t j = 0; j < nets.size(); j++) {
-         nets[j].GetLayer(i).Forward(nets[j].GetLayer(i-1).GetOutput());
-      }
-   }
-
-   // Gradients
-   for (size_t j = 0; j < nets.size(); j++) {
-      evaluateGradients<Architecture_t>(
-          nets[j].GetLayer(depth-1).GetActivationGradients(),
-          nets[j].GetLossFunction(),
-          batches[j].GetOutput(),
-          nets[j].GetLayer(depth-1).GetOutput());
-   }
-
-   // Backward
-   for (size_t i = depth - 1; i > 0; i--)
-   {
-      for (size_t j = 0; j < nets.size(); j++) {
-         nets[j].GetLayer(i).Backward(nets[j].GetLayer(i-1).GetActivationGradients(),
-                                      nets[j].GetLayer(i-1).GetOutput(),
-                                      nets[j].GetRegularization(),
-                                      nets[j].GetWeightDecay());
-      }
-   }
-
-   for (size_t j = 0; j < nets.size(); j++) {
-      nets[j].GetLayer(0).Backward(dummy,
-                                   batches[j].GetInput(),
-                                   nets[j].GetRegularization(),
-                                   nets[j].GetWeightDecay());
-   }
+   PropagateBatches(nets, batches);
 
    for (size_t i = 0; i < depth; i++)
    {
@@ -662,6 +572,51 @@ void inline TGradientDescent<Architecture_t>::StepNesterov(
    }
 }
 
+//______________________________________________________________________________
+template<typename Architecture_t>
+template <typename Net_t>
+void inline TGradientDescent<Architecture_t>::PropagateBatches(
+        std::vector<Net_t> & nets,
+        std::vector<TBatch<Architecture_t>> & batches)
+{
+   // Created outside of the tasks, since the construction of a matrix may
+   // not be thread-safe. It is only read by the backward propagation.
+   typename Architecture_t::Matrix_t dummy(0,0);
+
+   auto propagate = [&nets, &batches, &dummy](size_t j)
+   {
+      auto & net = nets[j];
+      size_t depth = net.GetDepth();
+
+      // Forward
+      net.GetLayer(0).Forward(batches[j].GetInput());
+      for (size_t i = 1; i < depth; i++) {
+         net.GetLayer(i).Forward(net.GetLayer(i-1).GetOutput());
+      }
+
+      // Gradients
+      evaluateGradients<Architecture_t>(
+          net.GetLayer(depth-1).GetActivationGradients(),
+          net.GetLossFunction(),
+          batches[j].GetOutput(),
+          net.GetLayer(depth-1).GetOutput());
+
+      // Backward
+      for (size_t i = depth - 1; i > 0; i--) {
+         net.GetLayer(i).Backward(net.GetLayer(i-1).GetActivationGradients(),
+                                  net.GetLayer(i-1).GetOutput(),
+                                  net.GetRegularization(),
+                                  net.GetWeightDecay());
+      }
+      net.GetLayer(0).Backward(dummy,
+                               batches[j].GetInput(),
+                               net.GetRegularization(),
+                               net.GetWeightDecay());
+   };
+
+   Architecture_t::ForEachBatch(nets.size(), propagate);
+}
+
 //______________________________________________________________________________
 template<typename Architecture_t>
 template <typename Net_t>
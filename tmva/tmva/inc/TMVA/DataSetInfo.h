@@ -182,6 +182,11 @@ namespace TMVA {
       void               SetSplitOptions(const TString& so) { fSplitOptions = so; fNeedsRebuilding = kTRUE; }
       const TString&     GetSplitOptions() const { return fSplitOptions; }
 
+      // training on a stream of the input trees (StreamTraining split option)
+      void               SetStreamTraining( Bool_t stream, UInt_t bufferSize ) { fStreamTraining = stream; fStreamBufferSize = bufferSize; }
+      Bool_t             IsStreamTraining() const { return fStreamTraining; }
+      UInt_t             GetStreamBufferSize() const { return fStreamBufferSize; }
+
       // root dir
       void               SetRootDir(TDirectory* d) { fOwnRootDir = d; }
       TDirectory*        GetRootDir() const { return fOwnRootDir; }
@@ -214,6 +219,8 @@ namespace TMVA {
 
       TString                    fNormalization;     //
       TString                    fSplitOptions;      //
+      Bool_t                     fStreamTraining;    //! methods supporting it train on a stream of the training trees
+      UInt_t                     fStreamBufferSize;  //! number of events per streamed buffer
 
       Double_t                   fTrainingSumSignalWeights;
       Double_t                   fTrainingSumBackgrWeights;
@@ -68,14 +68,14 @@ namespace TMVA {
       // makes a local copy of the dataset info object
       DataSetInfo& AddDataSetInfo( DataSetInfo& dsi );
 
+      // access to input data
+      DataInputHandler& DataInput() { return *fDataInput; }
+
    private:
 
 
       TMVA::DataSetFactory* fDatasetFactory;
 
-      // access to input data
-      DataInputHandler& DataInput() { return *fDataInput; }
-
       DataInputHandler           *fDataInput;             // source of input data
       TList                      fDataSetInfoCollection; // all registered dataset definitions
       MsgLogger*                 fLogger;   // message logger
@@ -69,12 +69,14 @@ class TRandom3;
 namespace TMVA {
 
    class Event;
+   class QuantizedEventSample;
 
    class DecisionTree : public BinaryTree {
 
    private:
 
       static const Int_t fgRandomSeed; // set nonzero for debugging and zero for random seeds
+      static const UInt_t fgMinEventsForMT; // minimum number of events in a node to scan the variables in parallel
 
    public:
 
@@ -201,6 +203,10 @@ namespace TMVA {
       inline void SetUseExclusiveVars(Bool_t t=kTRUE){fUseExclusiveVars = t;}
       inline void SetNVars(Int_t n){fNvars = n;}
 
+      // grow the tree on the quantized copy of the event sample (histogram training);
+      // the events passed to BuildTree must be part of this sample
+      inline void SetQuantizedSample(const QuantizedEventSample* q){fQuantized = q;}
+
 
    private:
       // utility functions
@@ -211,6 +217,15 @@ namespace TMVA {
       // calculates the purity S/(S+B) of a given event sample
       Double_t SamplePurity(EventList eventSample);
 
+      // histogram training on the quantized event sample
+      struct HistTrainingData;
+      UInt_t   BuildTreeHist( const EventConstList & eventSample );
+      void     FillHist( const HistTrainingData& data, const std::vector<UInt_t>& events, std::vector<Double_t>& hist ) const;
+      void     BuildNodeHist( const HistTrainingData& data, std::vector<UInt_t>& events, std::vector<Double_t>& hist, DecisionTreeNode *node );
+      Double_t TrainNodeHist( const HistTrainingData& data, const std::vector<Double_t>& hist,
+                              Double_t nTotS, Double_t nTotB, Double_t nTotS_unWeighted, Double_t nTotB_unWeighted,
+                              Double_t targetTot, Double_t target2Tot, DecisionTreeNode *node, UInt_t& cutBin );
+
       UInt_t    fNvars;          // number of variables used to separate S and B
       Int_t     fNCuts;          // number of grid point in variable cut scans
       Bool_t    fUseFisherCuts;  // use multivariate splits using the Fisher criterium
@@ -249,6 +264,8 @@ namespace TMVA {
 
       DataSetInfo*  fDataSetInfo;
 
+      const QuantizedEventSample* fQuantized; //! quantized event sample used in histogram training (not owned)
+
 
       ClassDef(DecisionTree,0);               // implementation of a Decision Tree
    };
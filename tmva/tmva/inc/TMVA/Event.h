@@ -79,6 +79,9 @@ namespace TMVA {
 
       ~Event();
 
+      // assignment, the dynamic values of the source are copied like in the copy constructor
+      Event& operator=( const Event& );
+
       // accessors
       Bool_t  IsDynamic()         const {return fDynamic; }
 
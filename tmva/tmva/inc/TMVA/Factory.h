@@ -158,6 +158,9 @@ namespace TMVA {
 
       TDirectory* RootBaseDir() { return (TDirectory*)fgTargetFile; }
 
+      // set up a worker process forked for parallel training, return its private output file
+      static TFile* PrepareWorkerProcess();
+
       Bool_t IsSilentFile();
       Bool_t IsModelPersistence();
       
@@ -191,6 +194,12 @@ namespace TMVA {
 
       void SetInputTreesFromEventAssignTrees();
 
+      // evaluate the classifiers on all events of a sample in worker processes
+      void EvaluateInWorkers( MVector *methods, Types::ETreeType type );
+
+      // set up a worker process forked for the tasks of CrossValidate or EvaluateInWorkers
+      void PrepareWorker();
+
    private:
 
       // data members
@@ -0,0 +1,82 @@
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : FlatForest                                                            *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Forest of decision trees flattened into contiguous node arrays, for       *
+ *      the evaluation of blocks of events                                        *
+ *                                                                                *
+ * Copyright (c) 2016:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+#ifndef ROOT_TMVA_FlatForest
+#define ROOT_TMVA_FlatForest
+
+#include <vector>
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+namespace TMVA {
+
+   class DecisionTree;
+   class DecisionTreeNode;
+
+   class FlatForest {
+
+   public:
+
+      FlatForest();
+      ~FlatForest();
+
+      // flatten the trees; each tree contributes weight*(leaf value) to the sum,
+      // where the leaf value is the one returned by DecisionTree::CheckEvent.
+      // Returns kFALSE (and leaves the forest empty) if a tree uses Fisher cuts
+      Bool_t Build( const std::vector<DecisionTree*>& forest, const std::vector<Double_t>& weights,
+                    Bool_t useYesNoLeaf );
+      void   Clear();
+
+      // add the weighted sum of the leaf values of all trees for nEvents events
+      // to sum[ievt]; the value of variable ivar of event ievt is x[ivar*stride+ievt]
+      void   Evaluate( const Float_t* x, UInt_t stride, UInt_t nEvents, Double_t* sum ) const;
+
+      UInt_t   GetNTrees() const { return fRoot.size(); }
+      UInt_t   GetNNodes() const { return fVar.size(); }
+      UInt_t   GetRoot( UInt_t itree ) const { return fRoot[itree]; }
+      UInt_t   GetDepth( UInt_t itree ) const { return fDepth[itree]; }
+      Double_t GetWeight( UInt_t itree ) const { return fWeight[itree]; }
+
+      // node arrays: a leaf is a node whose two daughters are the node itself.
+      // From an intermediate node the walk continues with GetDaughter(inode, x>=cut)
+      Bool_t   IsLeaf( UInt_t inode ) const { return fDaughter[2*inode] == inode; }
+      UInt_t   GetVar( UInt_t inode ) const { return fVar[inode]; }
+      Float_t  GetCut( UInt_t inode ) const { return fCut[inode]; }
+      UInt_t   GetDaughter( UInt_t inode, Bool_t above ) const { return fDaughter[2*inode+(above?1:0)]; }
+      Double_t GetLeafValue( UInt_t inode ) const { return fLeaf[inode]; }
+
+   private:
+
+      UInt_t AddNode( const DecisionTreeNode* node, Bool_t regression, Bool_t useYesNoLeaf, UInt_t depth, UInt_t& maxDepth );
+
+      std::vector<UInt_t>   fVar;      // selector variable of each node
+      std::vector<Float_t>  fCut;      // cut value of each node
+      std::vector<UInt_t>   fDaughter; // [2*inode+(x>=cut)] next node
+      std::vector<Double_t> fLeaf;     // leaf value of each node (0 for intermediate nodes)
+      std::vector<UInt_t>   fRoot;     // root node of each tree
+      std::vector<UInt_t>   fDepth;    // depth of each tree
+      std::vector<Double_t> fWeight;   // weight of each tree
+      Bool_t                fFailed;   // a node could not be flattened
+   };
+
+} // namespace TMVA
+
+#endif
@@ -53,6 +53,11 @@ namespace TMVA {
 
       virtual Double_t EstimatorFunction( std::vector<Double_t>& parameters ) = 0;
 
+      // estimators for several parameter sets at once (e.g. a population of the GA);
+      // the default calls EstimatorFunction for each set in turn
+      virtual void     EstimatorFunctions( std::vector< std::vector<Double_t> >& parameters,
+                                           std::vector<Double_t>& estimators );
+
       // function to notify the FitterTarget of the progress status of the fitter
       // sender : "GA", "MC", ...
       // progress : "init", "iteration", "last", "stop"
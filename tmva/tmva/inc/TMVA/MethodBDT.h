@@ -59,6 +59,9 @@
 namespace TMVA {
 
    class SeparationBase;
+   class QuantizedEventSample;
+   class FlatForest;
+   class StreamingDataLoader;
 
    class MethodBDT : public MethodBase {
 
@@ -107,6 +110,9 @@ namespace TMVA {
       // calculate the MVA value
       Double_t GetMvaValue( Double_t* err = 0, Double_t* errUpper = 0);
 
+      // calculate the MVA values of many events with the flattened forest
+      void GetBatchMvaValues( const Float_t* inputs, UInt_t nEvents, Double_t* mvaValues );
+
       // get the actual forest size (might be less than fNTrees, the requested one, if boosting is stopped early
       UInt_t   GetNTrees() const {return fForest.size();}
    private:
@@ -139,6 +145,7 @@ namespace TMVA {
       void SetShrinkage(Double_t s){fShrinkage = s;}
       void SetUseNvars(Int_t n){fUseNvars = n;}
       void SetBaggedSampleFraction(Double_t f){fBaggedSampleFraction = f;}
+      void SetMakeClassStyle(const TString& s){fMakeClassStyle = s;}
 
 
       // get the forest
@@ -164,6 +171,11 @@ namespace TMVA {
       void MakeClassInstantiateNode( DecisionTreeNode *n, std::ostream& fout,
                                      const TString& className ) const;
 
+      // classifier response for MakeClassStyle FlatArrays and NestedIf
+      void MakeClassFlatForest( std::ostream& fout, const TString& className ) const;
+      void MakeClassNestedIfNode( std::ostream& fout, const FlatForest& forest, UInt_t inode,
+                                  const TString& indent ) const;
+
       void GetHelpMessage() const;
 
    protected:
@@ -173,6 +185,10 @@ namespace TMVA {
       // Init used in the various constructors
       void Init( void );
 
+      // helpers of MakeClass
+      Bool_t UseFlatMakeClass() const;
+      void   MakeClassPreselection( std::ostream& fout ) const;
+
       void PreProcessNegativeEventWeights();
 
       // boosting algorithm (adaptive boosting)
@@ -200,12 +216,15 @@ namespace TMVA {
       void UpdateTargetsRegression( std::vector<const TMVA::Event*>&,Bool_t first=kFALSE);
       Double_t GetGradBoostMVA(const TMVA::Event *e, UInt_t nTrees);
       void     GetBaggedSubSample(std::vector<const TMVA::Event*>&);
+      void     GetStreamedSubSample();
       Double_t GetWeightedQuantile(std::vector<std::pair<Double_t, Double_t> > vec, const Double_t quantile, const Double_t SumOfWeights = 0.0);
 
       std::vector<const TMVA::Event*>       fEventSample;     // the training events
       std::vector<const TMVA::Event*>       fValidationSample;// the Validation events
       std::vector<const TMVA::Event*>       fSubSample;       // subsample for bagged grad boost
       std::vector<const TMVA::Event*>      *fTrainSample;     // pointer to sample actually used in training (fEventSample or fSubSample) for example
+      StreamingDataLoader            *fStream;          //! reader of the training trees (StreamTraining with BoostType=Bagging)
+      std::vector<const TMVA::Event*>       fStreamedSample;  //! events of the current streamed subsample, owned
 
       Int_t                           fNTrees;          // number of decision trees requested
       std::vector<DecisionTree*>      fForest;          // the collection of decision trees
@@ -233,6 +252,11 @@ namespace TMVA {
       Bool_t                          fUseFisherCuts;   // use multivariate splits using the Fisher criterium
       Double_t                        fMinLinCorrForFisher; // the minimum linear correlation between two variables demanded for use in fisher criterium in node splitting
       Bool_t                          fUseExclusiveVars; // individual variables already used in fisher criterium are not anymore analysed individually for node splitting
+      Bool_t                          fUseHistTraining; // grow the trees on the quantized event sample
+      Int_t                           fNHistBins;       // number of bins per variable in histogram training
+      QuantizedEventSample           *fQuantizedSample; //! quantized event sample used in histogram training
+      FlatForest                     *fFlatForest;      //! flattened forest used in batch evaluation
+      TString                         fMakeClassStyle;  // layout of the forest in the standalone class (Nodes, FlatArrays, NestedIf)
       Bool_t                          fUseYesNoLeaf;    // use sig or bkg classification in leave nodes or sig/bkg
       Double_t                        fNodePurityLimit; // purity limit for sig/bkg nodes
       UInt_t                          fNNodesMax;       // max # of nodes
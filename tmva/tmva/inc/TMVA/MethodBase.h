@@ -91,6 +91,7 @@ namespace TMVA {
    class MethodCuts;
    class MethodBoost;
    class DataSetInfo;
+   class StreamingDataLoader;
 
    class MethodBase : virtual public IMethod, public Configurable {
 
@@ -180,6 +181,10 @@ namespace TMVA {
       // signal/background classification response
       Double_t GetMvaValue( const TMVA::Event* const ev, Double_t* err = 0, Double_t* errUpper = 0 );
 
+      // classification response for nEvents events given as column-major array of the
+      // input variables, inputs[ivar*nEvents+ievt]; the default evaluates them one by one
+      virtual void GetBatchMvaValues( const Float_t* inputs, UInt_t nEvents, Double_t* mvaValues );
+
    protected:
       // helper function to set errors to -1
       void NoErrorCalc(Double_t* const err, Double_t* const errUpper);
@@ -187,6 +192,12 @@ namespace TMVA {
       // signal/background classification response for all current set of data 
       virtual std::vector<Double_t> GetMvaValues(Long64_t firstEvt = 0, Long64_t lastEvt = -1, Bool_t logProgress = false);
 
+      // responses for all events of the current tree type; taken from the cache
+      // filled by the Factory with responses evaluated in worker processes, if any
+      std::vector<Double_t> GetAllMvaValues(Bool_t logProgress = false);
+      void SetMvaValuesCache( Types::ETreeType type, const std::vector<Double_t>& values ) { fMvaValuesCache[type] = values; }
+      void ClearMvaValuesCache() { fMvaValuesCache.clear(); }
+
 
    public:
       // regression response
@@ -383,6 +394,8 @@ namespace TMVA {
 
       mutable const Event*   fTmpEvent; //! temporary event when testing on a different DataSet than the own one
 
+      std::map<Types::ETreeType, std::vector<Double_t> > fMvaValuesCache; //! responses evaluated by the Factory in worker processes
+
       // event reference and update
       // NOTE: these Event accessors make sure that you get the events transformed according to the
       //        particular clasifiers transformation chosen
@@ -445,6 +458,10 @@ namespace TMVA {
 
       Bool_t           HasTrainingTree() const { return Data()->GetNTrainingEvents() != 0; }
 
+      // reader of the training trees if the data set is trained on a stream
+      // (StreamTraining option), 0 otherwise; owned by the caller
+      StreamingDataLoader* CreateStreamingDataLoader( UInt_t seed = 0 ) const;
+
       // ---------- protected auxiliary methods ------------------------------------
 
    protected:
@@ -155,6 +155,14 @@ public:
    void TrainGpu();
    template <typename AFloat>
    void TrainCpu();
+   // Minimization steps over one pass of the streamed training trees
+   // (StreamTraining option), returns the number of batches.
+   template <typename AArchitecture>
+   size_t TrainStreamedEpoch(StreamingDataLoader & stream,
+                             TNet<AArchitecture> & net,
+                             std::vector<TNet<AArchitecture>> & nets,
+                             TGradientDescent<AArchitecture> & minimizer,
+                             Double_t momentum);
 
    virtual Double_t GetMvaValue( Double_t* err=0, Double_t* errUpper=0 );
    virtual const std::vector<Float_t>& GetRegressionValues();
@@ -89,6 +89,13 @@ namespace TMVA
 
       const Ranking* CreateRanking();
 
+      // response for many events, the neighbor searches run in parallel
+      // if implicit multi-threading is enabled
+      void GetBatchMvaValues( const Float_t* inputs, UInt_t nEvents, Double_t* mvaValues );
+
+      // responses for the events firstEvt..lastEvt of the current data set
+      std::vector<Double_t> GetMvaValues( Long64_t firstEvt = 0, Long64_t lastEvt = -1, Bool_t logProgress = false );
+
    protected:
 
       // make ROOT-independent C++ class for classifier response (classifier-specific implementation)
@@ -114,10 +121,16 @@ namespace TMVA
       Double_t PolnKernel(Double_t value) const;
       Double_t GausKernel(const kNN::Event &event_knn, const kNN::Event &event, const std::vector<Double_t> &svec) const;
 
-      Double_t getKernelRadius(const kNN::List &rlist) const;
-      const std::vector<Double_t> getRMS(const kNN::List &rlist, const kNN::Event &event_knn) const;
+      Double_t getKernelRadius(const kNN::ElemVec &rlist) const;
+      const std::vector<Double_t> getRMS(const kNN::ElemVec &rlist, const kNN::Event &event_knn) const;
       
-      double getLDAValue(const kNN::List &rlist, const kNN::Event &event_knn);
+      double getLDAValue(const kNN::ElemVec &rlist, const kNN::Event &event_knn);
+
+      // classifier response for one event, rlist is used for the neighbor search
+      Double_t ComputeMvaValue(const kNN::Event &event_knn, kNN::ElemVec &rlist);
+
+      // classifier response for many events
+      void EvaluateEvents(const kNN::EventVec &events, Double_t* mvaValues);
 
    private:
 
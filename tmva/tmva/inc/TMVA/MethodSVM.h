@@ -139,6 +139,7 @@ namespace TMVA
       Float_t                       fCost;                // cost value
       Float_t                       fTolerance;           // tolerance parameter
       UInt_t                        fMaxIter;             // max number of iteration
+      UInt_t                        fKernelCacheSize;     // memory for the kernel matrix in MB (0: no limit)
       UShort_t                      fNSubSets;            // nr of subsets, default 1
       Float_t                       fBparm;               // free plane coefficient 
       Float_t                       fGamma;               // RBF Kernel parameter
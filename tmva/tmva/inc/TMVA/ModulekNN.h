@@ -105,6 +105,7 @@ namespace TMVA {
       typedef std::vector<TMVA::kNN::Event> EventVec;
       typedef std::pair<const Node<Event> *, VarType> Elem;
       typedef std::list<Elem> List;
+      typedef std::vector<Elem> ElemVec;
 
       std::ostream& operator<<(std::ostream& os, const Event& event);
 
@@ -127,6 +128,10 @@ namespace TMVA {
 
          Bool_t Find(Event event, UInt_t nfind = 100, const std::string &option = "count") const;
          Bool_t Find(UInt_t nfind, const std::string &option) const;
+
+         // search of the flattened tree, does not modify the module and
+         // can be called concurrently from several threads
+         Bool_t Find(const Event &event, UInt_t nfind, ElemVec &result) const;
       
          const EventVec& GetEventVec() const;
 
@@ -144,6 +149,8 @@ namespace TMVA {
 
          Node<Event>* Optimize(UInt_t optimize_depth);
 
+         UInt_t Flatten(const Node<Event> *node);
+
          void ComputeMetric(UInt_t ifrac);
 
          const Event Scale(const Event &event) const;
@@ -160,6 +167,17 @@ namespace TMVA {
 
          std::map<Int_t, Double_t> fVarScale;
 
+         // copy of fTree in contiguous arrays, nodes in depth-first order
+         std::vector<const Node<Event>*> fFlatNode;   // original node
+         std::vector<VarType>            fFlatVar;    // coordinates, fDimn per node
+         std::vector<UInt_t>             fFlatMod;    // split variable
+         std::vector<VarType>            fFlatDis;    // split value
+         std::vector<VarType>            fFlatMin;    // minimum of split variable in sub-tree
+         std::vector<VarType>            fFlatMax;    // maximum of split variable in sub-tree
+         std::vector<Double_t>           fFlatWeight; // event weight
+         std::vector<Int_t>              fFlatLeft;   // left daughter (-1: none)
+         std::vector<Int_t>              fFlatRight;  // right daughter (-1: none)
+
          mutable List  fkNNList;     // latest result from kNN search
          mutable Event fkNNEvent;    // latest event used for kNN search
          
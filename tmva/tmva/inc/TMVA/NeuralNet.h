@@ -1116,13 +1116,16 @@ namespace TMVA
           * \param testPattern test pattern
           * \param minimizer use this minimizer for training (e.g. SGD)
           * \param settings settings used for this training run
+          * \param nextTrainPattern if given, each training cycle runs over the buffers of training
+          *        patterns this function puts into trainPattern, until it returns false
           */
          template <typename Minimizer>
             double train (std::vector<double>& weights, 
                           std::vector<Pattern>& trainPattern, 
                           const std::vector<Pattern>& testPattern, 
                   Minimizer& minimizer,
-                  Settings& settings);
+                  Settings& settings,
+                  std::function<bool (std::vector<Pattern>&)> nextTrainPattern = nullptr);
 
          /*! \brief pre-training for future use
           *
@@ -79,6 +79,9 @@ namespace TMVA {
       void optimizeFit();
 
       Double_t EstimatorFunction( std::vector<Double_t> & );
+      void     EstimatorFunctions( std::vector< std::vector<Double_t> > &, std::vector<Double_t> & );
+      Double_t TrainAndGetFOM( std::vector<Double_t> & );
+      void     PrepareWorker();
 
       Double_t GetFOM();
       
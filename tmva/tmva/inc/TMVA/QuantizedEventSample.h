@@ -0,0 +1,73 @@
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : QuantizedEventSample                                                  *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Copy of a training event sample with every input variable quantized       *
+ *      into at most 256 bins, used by the histogram training of decision trees   *
+ *                                                                                *
+ * Copyright (c) 2016:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+#ifndef ROOT_TMVA_QuantizedEventSample
+#define ROOT_TMVA_QuantizedEventSample
+
+#include <vector>
+#include <unordered_map>
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+namespace TMVA {
+
+   class Event;
+
+   class QuantizedEventSample {
+
+   public:
+
+      // quantize the first nVars input variables of the events into at most nBins bins
+      QuantizedEventSample( const std::vector<const TMVA::Event*>& events, UInt_t nVars, UInt_t nBins = 256 );
+      ~QuantizedEventSample();
+
+      UInt_t GetNEvents() const { return fNEvents; }
+      UInt_t GetNVars()   const { return fNVars; }
+
+      // number of bins of variable ivar, and the largest number of bins of all variables
+      UInt_t GetNBins( UInt_t ivar ) const { return fEdges[ivar].size()+1; }
+      UInt_t GetMaxBins() const { return fMaxBins; }
+
+      // bin numbers of variable ivar for all events (column of the bin matrix),
+      // 0 if the sample is empty
+      const UChar_t* GetColumn( UInt_t ivar ) const
+      { return fBins.empty() ? 0 : &fBins[(size_t)ivar*fNEvents]; }
+
+      // cut value separating bins 0..ibin from bins ibin+1..: an event with value x
+      // is in a bin > ibin if and only if x >= GetCutValue(ivar,ibin)
+      Float_t GetCutValue( UInt_t ivar, UInt_t ibin ) const { return fEdges[ivar][ibin]; }
+
+      // row of the event in the bin matrix, -1 if the event is not part of the sample
+      Int_t GetRow( const TMVA::Event* ev ) const;
+
+   private:
+
+      UInt_t fNEvents;                          // number of events
+      UInt_t fNVars;                            // number of variables
+      UInt_t fMaxBins;                          // largest number of bins of all variables
+      std::vector< std::vector<Float_t> > fEdges; // bin edges of each variable
+      std::vector<UChar_t> fBins;               // bin numbers, column-major [ivar*nEvents+ievt]
+      std::unordered_map<const TMVA::Event*,UInt_t> fRows; // row of each event
+   };
+
+} // namespace TMVA
+
+#endif
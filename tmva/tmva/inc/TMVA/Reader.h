@@ -102,6 +102,11 @@ namespace TMVA {
       Double_t EvaluateMVA( MethodBase* method,           Double_t aux = 0 );
       Double_t EvaluateMVA( const TString& methodTag,     Double_t aux = 0 );
 
+      // returns the MVA responses of nEvents events, the input variables are given
+      // column-major in the order of AddVariable: inputs[ivar*nEvents+ievt]
+      void     EvaluateMVA( const Float_t* inputs, UInt_t nEvents, const TString& methodTag,
+                            Double_t* mvaValues, Double_t aux = 0 );
+
       // returns error on MVA response for given event
       // NOTE: must be called AFTER "EvaluateMVA(...)" call !
       Double_t GetMVAError() const { return fMvaEventError; }
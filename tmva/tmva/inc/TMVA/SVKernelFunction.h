@@ -54,6 +54,10 @@ namespace TMVA {
          
    private:
 
+      // value of the given kernel, does not modify the function and can be
+      // called concurrently
+      Float_t Evaluate( EKernelType kernel, SVEvent* ev1, SVEvent* ev2 ) const;
+
       Float_t fGamma;   // documentation
 
       // vector of gammas for multidimensional gaussian
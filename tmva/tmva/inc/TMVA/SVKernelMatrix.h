@@ -32,6 +32,7 @@
 #include "Rtypes.h"
 #endif
 
+#include <list>
 #include <vector>
 
 namespace TMVA {
@@ -46,21 +47,38 @@ namespace TMVA {
 
       //constructors
       SVKernelMatrix();
-      SVKernelMatrix( std::vector<TMVA::SVEvent*>*, SVKernelFunction* );
+      // the full matrix is computed if its lower triangle fits in cacheSizeMB
+      // (or if cacheSizeMB is 0), otherwise rows are computed on demand and
+      // the most recently used ones are kept within cacheSizeMB
+      SVKernelMatrix( std::vector<TMVA::SVEvent*>*, SVKernelFunction*, UInt_t cacheSizeMB = 0 );
       
       //destructor
       ~SVKernelMatrix();
       
       //functions
+      // the row is owned by the matrix and stays valid until two further rows are requested
       Float_t* GetLine   ( UInt_t );
       Float_t* GetColumn ( UInt_t col ) { return this->GetLine(col);}
       Float_t  GetElement( UInt_t i, UInt_t j );
 
+      Bool_t   IsPrecomputed() const { return fSVKernelMatrix != 0; }
+
    private:
 
-      UInt_t               fSize;              // matrix size
-      SVKernelFunction*    fKernelFunction;    // kernel function
-      Float_t**            fSVKernelMatrix;    // kernel matrix
+      void     ComputeLine( UInt_t line, Float_t* values ) const;
+
+      UInt_t                        fSize;              // matrix size
+      SVKernelFunction*             fKernelFunction;    // kernel function
+      std::vector<TMVA::SVEvent*>*  fInputVectors;      // input events
+      Float_t**                     fSVKernelMatrix;    // lower triangle of kernel matrix (0: rows cached)
+
+      // cache of rows, least recently used row is replaced
+      UInt_t                        fNCacheLines;       // number of cached rows
+      std::vector<Float_t>          fCache;             // cached rows, fSize values each
+      std::vector<Int_t>            fCacheSlot;         // slot of each row in cache (-1: not cached)
+      std::vector<Int_t>            fSlotLine;          // row in each slot (-1: empty)
+      std::list<UInt_t>             fLRU;               // slots, most recently used first
+      std::vector<std::list<UInt_t>::iterator> fSlotLRU; // position of each slot in fLRU
 
       mutable MsgLogger* fLogger;                     //! message logger
       MsgLogger& Log() const { return *fLogger; }
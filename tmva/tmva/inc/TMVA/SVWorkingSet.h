@@ -46,7 +46,8 @@ namespace TMVA {
    public:
 
       SVWorkingSet();
-      SVWorkingSet( std::vector<TMVA::SVEvent*>*, SVKernelFunction*, Float_t , Bool_t);
+      // cacheSizeMB: memory for the kernel matrix, see SVKernelMatrix (0: no limit)
+      SVWorkingSet( std::vector<TMVA::SVEvent*>*, SVKernelFunction*, Float_t , Bool_t, UInt_t cacheSizeMB = 0);
       ~SVWorkingSet();
                 
       Bool_t  ExamineExample( SVEvent*);
@@ -0,0 +1,138 @@
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : StreamingDataLoader                                                   *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Reads the events of the training (or testing) trees of a data set in      *
+ *      shuffled buffers of bounded size, without materializing the full sample   *
+ *                                                                                *
+ * Copyright (c) 2016:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+#ifndef ROOT_TMVA_StreamingDataLoader
+#define ROOT_TMVA_StreamingDataLoader
+
+#include <utility>
+#include <vector>
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+#ifndef ROOT_TString
+#include "TString.h"
+#endif
+#ifndef ROOT_TRandom3
+#include "TRandom3.h"
+#endif
+#ifndef ROOT_TMVA_Types
+#include "TMVA/Types.h"
+#endif
+
+class TTree;
+class TTreeFormula;
+
+namespace TMVA {
+
+   class DataSetInfo;
+   class DataInputHandler;
+   class Event;
+   class MsgLogger;
+
+   class StreamingDataLoader {
+
+   public:
+
+      // stream the trees of the given type (kTraining or kTesting) registered in dataInput;
+      // each call of NextBuffer() returns at most about bufferSize events
+      StreamingDataLoader( DataSetInfo& dsi, DataInputHandler& dataInput, Types::ETreeType type,
+                           UInt_t bufferSize, UInt_t seed = 0 );
+      ~StreamingDataLoader();
+
+      // size of the TTreeCache of the streamed trees (default 30 MB). The
+      // cache size and the branch status of the trees are restored by the
+      // destructor
+      void     SetCacheSize( Long64_t bytes ) { fCacheSize = bytes; }
+
+      // online bagging: every event is repeated k times, with k drawn from a
+      // Poisson distribution of mean fraction (0: no bagging)
+      void     SetBagging( Double_t fraction ) { fBaggingFraction = fraction; }
+
+      // start a new pass over the trees; the entries are read in chunks
+      // (the clusters of the trees) in a new random order
+      void     Rewind();
+
+      // next buffer of events in random order, empty at the end of the pass.
+      // The events are owned by the loader and overwritten by the next call
+      const std::vector<Event*>& NextBuffer();
+
+      UInt_t   GetBufferSize() const { return fBufferSize; }
+      Long64_t GetNEntries()   const { return fNEntries; }
+      UInt_t   GetNTrees()     const { return fTrees.size(); }
+
+   private:
+
+      struct Chunk {
+         UInt_t   fTree;   // index in fTrees
+         Long64_t fFirst;  // first entry of the chunk
+         Long64_t fLast;   // one past the last entry of the chunk
+      };
+
+      // formulas and saved settings of one streamed tree; kept across the
+      // switches between the trees of the shuffled chunks
+      struct TreeState {
+         TreeState() : fCutFormula(0), fWeightFormula(0), fTreeNumber(-1), fBranchesEnabled(kFALSE),
+                       fOwner(0), fPrepared(kFALSE), fStatusSaved(kFALSE), fCacheSize(0) {}
+         std::vector<TTreeFormula*> fInputFormulas;   // input variables
+         std::vector<TTreeFormula*> fTargetFormulas;  // regression targets
+         std::vector<TTreeFormula*> fSpectatorFormulas; // spectators
+         TTreeFormula*              fCutFormula;      // cut of the class of the tree
+         TTreeFormula*              fWeightFormula;   // weight of the class of the tree
+         Int_t                      fTreeNumber;      // chain element the formulas are made for (-1: none)
+         Bool_t                     fBranchesEnabled; // branches of the formulas enabled
+         // the settings of a tree registered several times are saved in the
+         // state of its first registration
+         UInt_t                     fOwner;           // index of the first registration of the tree
+         Bool_t                     fPrepared;        // cache size changed
+         Bool_t                     fStatusSaved;     // branch status changed
+         Long64_t                   fCacheSize;       // cache size of the tree before streaming
+         std::vector<std::pair<TString,Bool_t> > fBranchStatus; // branch status before streaming
+      };
+
+      void   ClearFormulas( TreeState& state );
+      void   Restore( UInt_t itree );
+      void   ReadEntry( Long64_t entry );
+      Event* NewEvent();
+
+      DataSetInfo&               fDataSetInfo;     // variables, targets, spectators, cuts and weights
+      std::vector<TTree*>        fTrees;           // streamed trees
+      std::vector<UInt_t>        fTreeClass;       // class index of each tree
+      std::vector<Double_t>      fTreeWeight;      // weight of each tree
+      std::vector<TreeState>     fTreeStates;      // formulas and saved settings of each tree
+      std::vector<Chunk>         fChunks;          // chunks of all trees, in reading order
+      UInt_t                     fNextChunk;       // chunk being read
+      Long64_t                   fNextEntry;       // next entry to read in this chunk
+      Int_t                      fCurrentTree;     // tree of the chunk being read (-1: none)
+      Long64_t                   fNEntries;        // total number of entries of the streamed trees
+
+      UInt_t                     fBufferSize;      // number of events per buffer
+      std::vector<Event*>        fPool;            // events owned by the loader
+      std::vector<Event*>        fBuffer;          // current buffer (points into fPool)
+      Long64_t                   fCacheSize;       // TTreeCache size in bytes
+      Double_t                   fBaggingFraction; // mean repetition of an event (0: no bagging)
+      TRandom3                   fRandom;          // shuffling and bagging
+
+      mutable MsgLogger*         fLogger;          // message logger
+      MsgLogger& Log() const { return *fLogger; }
+   };
+
+} // namespace TMVA
+
+#endif
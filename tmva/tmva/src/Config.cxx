@@ -50,6 +50,7 @@ TMVA::Config::Config() :
    fSilent               ( kFALSE ),
    fWriteOptionsReference( kFALSE ),
    fDrawProgressBar      ( kTRUE ),
+   fNWorkers             ( 1 ),
    fLogger               ( new MsgLogger("Config") )
 {
    // plotting
@@ -11,11 +11,13 @@
 
  ///////////////////////////////////////////////////////////////////
  // Implementation of the activation functions for multi-threaded //
- // CPU architectures using tbb and BLAS.                         //
+ // CPU architectures using BLAS and implicit multi-threading.    //
+ // The functions are typed in AFloat, so that the loops in Map   //
+ // and MapFrom are not promoted to double and can be vectorized. //
  ///////////////////////////////////////////////////////////////////
 
 #include "TMVA/DNN/Architectures/Cpu.h"
-#include <math.h>
+#include <cmath>
 
 namespace TMVA
 {
@@ -27,7 +29,7 @@ template<typename AFloat>
 void TCpu<AFloat>::IdentityDerivative(TCpuMatrix<AFloat> & B,
                                       const TCpuMatrix<AFloat> &/*A*/)
 {
-   auto f = [](AFloat) {return 1.0;};
+   auto f = [](AFloat) -> AFloat {return 1.0;};
    B.Map(f);
 }
 
@@ -35,7 +37,7 @@ void TCpu<AFloat>::IdentityDerivative(TCpuMatrix<AFloat> & B,
 template<typename AFloat>
 void TCpu<AFloat>::Relu(TCpuMatrix<AFloat> & B)
 {
-   auto f = [](AFloat x) {return (x < 0.0) ? 0.0 : x;};
+   auto f = [](AFloat x) -> AFloat {return (x < 0.0) ? 0.0 : x;};
    B.Map(f);
 }
 
@@ -44,7 +46,7 @@ template<typename AFloat>
 void TCpu<AFloat>::ReluDerivative(TCpuMatrix<AFloat> & B,
                                                const TCpuMatrix<AFloat> &A)
 {
-   auto f = [](AFloat x) {return (x < 0.0) ? 0.0 : 1.0;};
+   auto f = [](AFloat x) -> AFloat {return (x < 0.0) ? 0.0 : 1.0;};
    B.MapFrom(f, A);
 }
 
@@ -52,7 +54,7 @@ void TCpu<AFloat>::ReluDerivative(TCpuMatrix<AFloat> & B,
 template<typename AFloat>
 void TCpu<AFloat>::Sigmoid(TCpuMatrix<AFloat> & B)
 {
-   auto f = [](AFloat x) {return 1.0 / (1.0 + exp(-x));};
+   auto f = [](AFloat x) -> AFloat {return 1.0 / (1.0 + std::exp(-x));};
    B.Map(f);
 }
 
@@ -61,8 +63,8 @@ template<typename AFloat>
 void TCpu<AFloat>::SigmoidDerivative(TCpuMatrix<AFloat> & B,
                                      const TCpuMatrix<AFloat> &A)
 {
-   auto f = [](AFloat x) {
-      AFloat sig = 1.0 / (1.0 + exp(-x));
+   auto f = [](AFloat x) -> AFloat {
+      AFloat sig = 1.0 / (1.0 + std::exp(-x));
       return sig * (1.0 - sig);
    };
    B.MapFrom(f, A);
@@ -72,7 +74,7 @@ void TCpu<AFloat>::SigmoidDerivative(TCpuMatrix<AFloat> & B,
 template<typename AFloat>
 void TCpu<AFloat>::Tanh(TCpuMatrix<AFloat> & B)
 {
-   auto f = [](AFloat x) {return tanh(x);};
+   auto f = [](AFloat x) -> AFloat {return std::tanh(x);};
    B.Map(f);
 }
 
@@ -81,8 +83,8 @@ template<typename AFloat>
 void TCpu<AFloat>::TanhDerivative(TCpuMatrix<AFloat> & B,
                                   const TCpuMatrix<AFloat> &A)
 {
-   auto f = [](AFloat x) {
-      AFloat t = tanh(x);
+   auto f = [](AFloat x) -> AFloat {
+      AFloat t = std::tanh(x);
       return 1 - t * t;
    };
    B.MapFrom(f, A);
@@ -92,7 +94,7 @@ void TCpu<AFloat>::TanhDerivative(TCpuMatrix<AFloat> & B,
 template<typename AFloat>
 void TCpu<AFloat>::SymmetricRelu(TCpuMatrix<AFloat> & B)
 {
-   auto f = [](AFloat x) {return fabs(x);};
+   auto f = [](AFloat x) -> AFloat {return std::fabs(x);};
    B.Map(f);
 }
 
@@ -101,7 +103,7 @@ template<typename AFloat>
 void TCpu<AFloat>::SymmetricReluDerivative(TCpuMatrix<AFloat> & B,
                                            const TCpuMatrix<AFloat> &A)
 {
-   auto f = [](AFloat x) {
+   auto f = [](AFloat x) -> AFloat {
       return (x < 0.0) ? -1.0 : 1.0;
    };
    B.MapFrom(f, A);
@@ -111,7 +113,7 @@ void TCpu<AFloat>::SymmetricReluDerivative(TCpuMatrix<AFloat> & B,
 template<typename AFloat>
 void TCpu<AFloat>::SoftSign(TCpuMatrix<AFloat> & B)
 {
-   auto f = [](AFloat x) {return x / (1 + fabs(x));};
+   auto f = [](AFloat x) -> AFloat {return x / (1 + std::fabs(x));};
    B.Map(f);
 }
 
@@ -120,8 +122,8 @@ template<typename AFloat>
 void TCpu<AFloat>::SoftSignDerivative(TCpuMatrix<AFloat> & B,
                                       const TCpuMatrix<AFloat> &A)
 {
-   auto f = [](AFloat x) {
-      x = 1.0 + fabs(x);
+   auto f = [](AFloat x) -> AFloat {
+      x = 1.0 + std::fabs(x);
       x = 1.0 / (x * x);
       return x;
    };
@@ -132,7 +134,7 @@ void TCpu<AFloat>::SoftSignDerivative(TCpuMatrix<AFloat> & B,
 template<typename AFloat>
 void TCpu<AFloat>::Gauss(TCpuMatrix<AFloat> & B)
 {
-   auto f = [](AFloat x) {return exp(- x * x);};
+   auto f = [](AFloat x) -> AFloat {return std::exp(- x * x);};
    B.Map(f);
 }
 
@@ -141,7 +143,7 @@ template<typename AFloat>
 void TCpu<AFloat>::GaussDerivative(TCpuMatrix<AFloat> & B,
                                    const TCpuMatrix<AFloat> &A)
 {
-   auto f = [](AFloat x) {return - 2.0 * x * exp(- x * x);};
+   auto f = [](AFloat x) -> AFloat {return - 2.0 * x * std::exp(- x * x);};
    B.MapFrom(f, A);
 }
 
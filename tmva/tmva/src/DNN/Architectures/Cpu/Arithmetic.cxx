@@ -16,7 +16,7 @@
 
 #include "TMVA/DNN/Architectures/Cpu.h"
 #include "TMVA/DNN/Architectures/Cpu/Blas.h"
-#include "tbb/tbb.h"
+#include <algorithm>
 
 namespace TMVA
 {
@@ -79,18 +79,14 @@ void TCpu<Real_t>::Hadamard(TCpuMatrix<Real_t> &B,
    const Real_t *dataA      = A.GetRawDataPointer();
          Real_t *dataB      = B.GetRawDataPointer();
 
-   auto f = [&dataA, &dataB](const tbb::blocked_range<size_t> & range)
+   auto f = [dataA, dataB](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-      size_t rangeEnd   = range.end();
-
       for (size_t i = rangeBegin; i != rangeEnd; ++i) {
          dataB[i] *= dataA[i];
       }
    };
 
-   tbb::blocked_range<size_t> range(0, A.GetNElements());
-   parallel_for(range, f);
+   TCpuMatrix<Real_t>::ForEachRange(A.GetNElements(), f);
 }
 
 //____________________________________________________________________________
@@ -134,8 +130,15 @@ template<typename Real_t>
 void TCpu<Real_t>::Copy(TCpuMatrix<Real_t> &B,
                         const TCpuMatrix<Real_t> &A)
 {
-   auto f = [](Real_t x) {return x;};
-   B.MapFrom(f, A);
+   const Real_t *dataA = A.GetRawDataPointer();
+         Real_t *dataB = B.GetRawDataPointer();
+
+   auto f = [dataA, dataB](size_t rangeBegin, size_t rangeEnd)
+   {
+      std::copy(dataA + rangeBegin, dataA + rangeEnd, dataB + rangeBegin);
+   };
+
+   TCpuMatrix<Real_t>::ForEachRange(A.GetNElements(), f);
 }
 
 } // DNN
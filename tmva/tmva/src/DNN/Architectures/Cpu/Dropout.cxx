@@ -26,11 +26,8 @@ void TCpu<AFloat>::Dropout(TCpuMatrix<AFloat> &A,
 {
    AFloat *data = A.GetRawDataPointer();
 
-   auto fRange = [&data, dropoutProbability](const tbb::blocked_range<size_t> & range)
+   auto fRange = [data, dropoutProbability](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-      size_t rangeEnd   = range.end();
-
       TRandom rand(time(nullptr) + rangeBegin);
 
       for (size_t i = rangeBegin; i != rangeEnd; ++i) {
@@ -39,8 +36,7 @@ void TCpu<AFloat>::Dropout(TCpuMatrix<AFloat> &A,
       }
    };
 
-   tbb::blocked_range<size_t> range(0, A.GetNElements());
-   parallel_for(range, fRange);
+   TCpuMatrix<AFloat>::ForEachRange(A.GetNElements(), fRange);
 }
 
 } // namespace DNN
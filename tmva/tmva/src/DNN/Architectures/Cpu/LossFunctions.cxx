@@ -11,10 +11,9 @@
 
  /////////////////////////////////////////////////////////////////////
  // Implementation of the loss functions for the multi-threaded CPU //
- // implementation using tbb and BLAS.                              //
+ // implementation using BLAS and ROOT implicit multi-threading.    //
  /////////////////////////////////////////////////////////////////////
 
-#include "tbb/tbb.h"
 #include "TMVA/DNN/Architectures/Reference.h"
 
 namespace TMVA
@@ -30,13 +29,9 @@ AFloat TCpu<AFloat>::MeanSquaredError(const TCpuMatrix<AFloat> &Y,
    const AFloat  *dataY      = Y.GetRawDataPointer();
    const AFloat  *dataOutput = output.GetRawDataPointer();
 
-   auto f = [&dataY, &dataOutput](const tbb::blocked_range<size_t> & range,
-                                  AFloat partialSum)
+   auto f = [dataY, dataOutput](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-      size_t rangeEnd   = range.end();
-
-      AFloat sum = partialSum;
+      AFloat sum = 0.0;
       for (size_t i = rangeBegin; i != rangeEnd; ++i) {
           AFloat error = dataY[i] - dataOutput[i];
           sum += error * error;
@@ -45,14 +40,8 @@ AFloat TCpu<AFloat>::MeanSquaredError(const TCpuMatrix<AFloat> &Y,
       return sum;
    };
 
-   auto reduction = [](AFloat sum1, AFloat sum2)
-   {
-      return sum1 + sum2;
-   };
-
    AFloat norm = 1.0 / ((AFloat) Y.GetNcols() * Y.GetNrows());
-   tbb::blocked_range<size_t> range(0, Y.GetNElements());
-   return norm * parallel_reduce(range, 0.0, f, reduction);
+   return norm * TCpuMatrix<AFloat>::ReduceRanges(Y.GetNElements(), f);
 }
 
 //______________________________________________________________________________
@@ -68,18 +57,14 @@ void TCpu<AFloat>::MeanSquaredErrorGradients(
    const AFloat  *dataOutput = output.GetRawDataPointer();
    AFloat norm = 1.0 / ((AFloat) Y.GetNrows() * Y.GetNcols());
 
-   auto f = [&dataDY, &dataY, &dataOutput, norm](const tbb::blocked_range<size_t> & range)
+   auto f = [dataDY, dataY, dataOutput, norm](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-      size_t rangeEnd   = range.end();
-
       for (size_t i = rangeBegin; i != rangeEnd; ++i) {
          dataDY[i] = - 2.0 * norm * (dataY[i] - dataOutput[i]);
       }
    };
 
-   tbb::blocked_range<size_t> range(0, Y.GetNElements());
-   parallel_for(range, f);
+   TCpuMatrix<AFloat>::ForEachRange(Y.GetNElements(), f);
 }
 
 //______________________________________________________________________________
@@ -90,29 +75,19 @@ AFloat TCpu<AFloat>::CrossEntropy(const TCpuMatrix<AFloat> &Y,
    const AFloat  *dataY      = Y.GetRawDataPointer();
    const AFloat  *dataOutput = output.GetRawDataPointer();
 
-   auto f = [&dataY, &dataOutput](const tbb::blocked_range<size_t> & range,
-                                  AFloat partialSum)
-   {
-      size_t rangeBegin = range.begin();
-         size_t rangeEnd   = range.end();
-
-         AFloat sum = partialSum;
-         for (size_t i = rangeBegin; i != rangeEnd; ++i) {
-            AFloat y   = dataY[i];
-            AFloat sig = 1.0 / (1.0 + exp(- dataOutput[i]));
-            sum += y * log(sig) + (1.0 - y) * log(1.0 - sig);
-         }
-         return sum;
-   };
-
-   auto reduction = [](AFloat sum1, AFloat sum2)
+   auto f = [dataY, dataOutput](size_t rangeBegin, size_t rangeEnd)
    {
-      return sum1 + sum2;
+      AFloat sum = 0.0;
+      for (size_t i = rangeBegin; i != rangeEnd; ++i) {
+         AFloat y   = dataY[i];
+         AFloat sig = 1.0 / (1.0 + exp(- dataOutput[i]));
+         sum += y * log(sig) + (1.0 - y) * log(1.0 - sig);
+      }
+      return sum;
    };
 
-   tbb::blocked_range<size_t> range(0, Y.GetNElements());
    AFloat norm = 1.0 / ((AFloat) Y.GetNcols() * Y.GetNrows());
-   return - norm * parallel_reduce(range, 0.0, f, reduction);
+   return - norm * TCpuMatrix<AFloat>::ReduceRanges(Y.GetNElements(), f);
 }
 
 //______________________________________________________________________________
@@ -127,11 +102,8 @@ void TCpu<AFloat>::CrossEntropyGradients(
    const AFloat  *dataOutput = output.GetRawDataPointer();
    AFloat norm = 1.0 / ((AFloat) Y.GetNrows() * Y.GetNcols());
 
-   auto f = [&dataDY, &dataY, &dataOutput, norm](const tbb::blocked_range<size_t> & range)
+   auto f = [dataDY, dataY, dataOutput, norm](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-      size_t rangeEnd   = range.end();
-
       for (size_t i = rangeBegin; i != rangeEnd; ++i) {
          AFloat y   = dataY[i];
          AFloat sig = 1.0 / (1.0 + exp(- dataOutput[i]));
@@ -139,8 +111,7 @@ void TCpu<AFloat>::CrossEntropyGradients(
       }
    };
 
-   tbb::blocked_range<size_t> range(0, Y.GetNElements());
-   parallel_for(range, f);
+   TCpuMatrix<AFloat>::ForEachRange(Y.GetNElements(), f);
 }
 
 } // namespace DNN
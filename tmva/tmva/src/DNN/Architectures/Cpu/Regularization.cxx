@@ -11,10 +11,9 @@
 
 ////////////////////////////////////////////////////////////////////
 // Implementation of the regularization functionals and gradients //
-// for the multi-threaded CPU implementation using tbb.           //
+// for the multi-threaded CPU implementation.                     //
 ////////////////////////////////////////////////////////////////////
 
-#include "tbb/tbb.h"
 #include "TMVA/DNN/Architectures/Reference.h"
 
 namespace TMVA
@@ -28,26 +27,16 @@ AFloat TCpu<AFloat>::L1Regularization(const TCpuMatrix<AFloat> &Weights)
 {
    const AFloat  *data = Weights.GetRawDataPointer();
 
-   auto f = [&data](const tbb::blocked_range<size_t> & range,
-                    AFloat partialSum)
+   auto f = [data](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-      size_t rangeEnd   = range.end();
-
-      AFloat sum = partialSum;
+      AFloat sum = 0.0;
       for (size_t i = rangeBegin; i != rangeEnd; ++i) {
          sum += fabs(data[i]);
       }
       return sum;
    };
 
-   auto reduction = [](AFloat sum1, AFloat sum2)
-   {
-      return sum1 + sum2;
-   };
-
-   tbb::blocked_range<size_t> range(0, Weights.GetNElements());
-   return parallel_reduce(range, 0.0, f, reduction);
+   return TCpuMatrix<AFloat>::ReduceRanges(Weights.GetNElements(), f);
 }
 
 //______________________________________________________________________________
@@ -61,19 +50,15 @@ void TCpu<AFloat>::AddL1RegularizationGradients(
          AFloat  *dataB     =  B.GetRawDataPointer();
    const AFloat  *dataA      = A.GetRawDataPointer();
 
-   auto f = [&dataA, &dataB, weightDecay](const tbb::blocked_range<size_t> & range)
+   auto f = [dataA, dataB, weightDecay](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-      size_t rangeEnd   = range.end();
-
       for (size_t i = rangeBegin; i != rangeEnd; ++i) {
          AFloat sign = (dataA[i] < 0.0) ? -1.0 : 1.0;
          dataB[i] += weightDecay * sign;
       }
    };
 
-   tbb::blocked_range<size_t> range(0, A.GetNElements());
-   parallel_for(range, f);
+   TCpuMatrix<AFloat>::ForEachRange(A.GetNElements(), f);
 }
 
 //______________________________________________________________________________
@@ -82,26 +67,16 @@ AFloat TCpu<AFloat>::L2Regularization(const TCpuMatrix<AFloat> &Weights)
 {
    const AFloat  *data = Weights.GetRawDataPointer();
 
-   auto f = [&data](const tbb::blocked_range<size_t> & range,
-                    AFloat partialSum)
+   auto f = [data](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-      size_t rangeEnd   = range.end();
-
-      AFloat sum = partialSum;
+      AFloat sum = 0.0;
       for (size_t i = rangeBegin; i != rangeEnd; ++i) {
           sum += data[i] * data[i];
       }
       return sum;
    };
 
-   auto reduction = [](AFloat sum1, AFloat sum2)
-   {
-      return sum1 + sum2;
-   };
-
-   tbb::blocked_range<size_t> range(0, Weights.GetNElements());
-   return parallel_reduce(range, 0.0, f, reduction);
+   return TCpuMatrix<AFloat>::ReduceRanges(Weights.GetNElements(), f);
 }
 
 //______________________________________________________________________________
@@ -115,18 +90,14 @@ void TCpu<AFloat>::AddL2RegularizationGradients(
          AFloat  *dataB     =  B.GetRawDataPointer();
    const AFloat  *dataA      = A.GetRawDataPointer();
 
-   auto f = [&dataA, &dataB, weightDecay](const tbb::blocked_range<size_t> & range)
+   auto f = [dataA, dataB, weightDecay](size_t rangeBegin, size_t rangeEnd)
    {
-      size_t rangeBegin = range.begin();
-      size_t rangeEnd   = range.end();
-
       for (size_t i = rangeBegin; i != rangeEnd; ++i) {
          dataB[i] += 2.0 * weightDecay * dataA[i];
       }
    };
 
-   tbb::blocked_range<size_t> range(0, A.GetNElements());
-   parallel_for(range, f);
+   TCpuMatrix<AFloat>::ForEachRange(A.GetNElements(), f);
 }
 
 } // namespace DNN
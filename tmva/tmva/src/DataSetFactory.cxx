@@ -639,6 +639,13 @@ TMVA::DataSetFactory::InitOptions( TMVA::DataSetInfo& dsi,
 
    splitSpecs.DeclareOptionRef(fScaleWithPreselEff=kFALSE,"ScaleWithPreselEff","Scale the number of requested events by the eff. of the preselection cuts (or not)" );
 
+   Bool_t streamTraining = kFALSE;
+   splitSpecs.DeclareOptionRef( streamTraining, "StreamTraining",
+                                "Methods supporting it (DNN, BDT with BoostType=Bagging) read the trees registered for training in buffers during the training, instead of keeping all training events in memory (default: false)" );
+   UInt_t streamBufferSize = 100000;
+   splitSpecs.DeclareOptionRef( streamBufferSize, "StreamBufferSize",
+                                "Number of events per buffer with StreamTraining; also the number of training events per class kept in memory if nTrain_<class> is not given (default: 100000)" );
+
    // the number of events
 
    // fill in the numbers
@@ -661,6 +668,12 @@ TMVA::DataSetFactory::InitOptions( TMVA::DataSetInfo& dsi,
    splitSpecs.ParseOptions();
    splitSpecs.CheckForUnusedOptions();
 
+   dsi.SetStreamTraining( streamTraining, streamBufferSize );
+   if (streamTraining) {
+      Log() << kINFO << Form("Dataset[%s] : ",dsi.GetName()) << "StreamTraining: only the DNN and the BDT with BoostType=Bagging "
+            << "are trained on all events of the training trees, the other methods use the events kept in memory" << Endl;
+   }
+
    // output logging verbosity
    if (Verbose()) fLogger->SetMinType( kVERBOSE );
    if (fVerboseLevel.CompareTo("Debug")   ==0) fLogger->SetMinType( kDEBUG );
@@ -745,9 +758,21 @@ TMVA::DataSetFactory::BuildEventVector( TMVA::DataSetInfo& dsi,
          // count number of events in tree before cut
          classEventCounts.nInitialEvents += currentInfo.GetTree()->GetEntries();
 
+         // with StreamTraining, only a sample of the training trees is kept in
+         // memory (for the transformations and the monitoring), the methods
+         // supporting it read the full trees during the training
+         UInt_t maxEvents = 0;
+         if (dsi.IsStreamTraining() && currentInfo.GetTreeType() == Types::kTraining) {
+            maxEvents = classEventCounts.nTrainingEventsRequested > 0 ?
+               UInt_t(classEventCounts.nTrainingEventsRequested) : dsi.GetStreamBufferSize();
+            Log() << kINFO << Form("Dataset[%s] : ",dsi.GetName()) << "StreamTraining: keeping at most " << maxEvents
+                  << " training events of class \'" << dsi.GetClassInfo(cl)->GetName() << "\' in memory" << Endl;
+         }
+
          // loop over events in ntuple
          const UInt_t nEvts = currentInfo.GetTree()->GetEntries();
          for (Long64_t evtIdx = 0; evtIdx < nEvts; evtIdx++) {
+            if (maxEvents > 0 && event_v.size() >= maxEvents) break;
             currentInfo.GetTree()->LoadTree(evtIdx);
 
             // may need to reload tree in case of chains
@@ -76,6 +76,8 @@ TMVA::DataSetInfo::DataSetInfo(const TString& name)
      fClasses( 0 ),
      fNormalization( "NONE" ),
      fSplitOptions(""),
+     fStreamTraining(kFALSE),
+     fStreamBufferSize(100000),
      fTrainingSumSignalWeights(-1),
      fTrainingSumBackgrWeights(-1),
      fTestingSumSignalWeights (-1),
@@ -63,9 +63,15 @@
 #include <algorithm>
 #include <cassert>
 
+#include "RConfigure.h"
 #include "TRandom3.h"
 #include "TMath.h"
 #include "TMatrix.h"
+#include "TROOT.h"
+
+#ifdef R__USE_IMT
+#include "tbb/parallel_for.h"
+#endif
 
 #include "TMVA/MsgLogger.h"
 #include "TMVA/DecisionTree.h"
@@ -83,8 +89,10 @@
 #include "TMVA/IPruneTool.h"
 #include "TMVA/CostComplexityPruneTool.h"
 #include "TMVA/ExpectedErrorPruneTool.h"
+#include "TMVA/QuantizedEventSample.h"
 
 const Int_t TMVA::DecisionTree::fgRandomSeed = 0; // set nonzero for debugging and zero for random seeds
+const UInt_t TMVA::DecisionTree::fgMinEventsForMT = 1000; // nodes with fewer events are trained serially
 
 using std::vector;
 
@@ -136,7 +144,8 @@ TMVA::DecisionTree::DecisionTree():
    fSigClass       (0),
    fTreeID         (0),
    fAnalysisType   (Types::kClassification),
-   fDataSetInfo    (NULL)
+   fDataSetInfo    (NULL),
+   fQuantized      (NULL)
 {
 }
 
@@ -173,7 +182,8 @@ TMVA::DecisionTree::DecisionTree( TMVA::SeparationBase *sepType, Float_t minSize
    fSigClass       (cls),
    fTreeID         (treeID),
    fAnalysisType   (Types::kClassification),
-   fDataSetInfo    (dataInfo)
+   fDataSetInfo    (dataInfo),
+   fQuantized      (NULL)
 {
    if (sepType == NULL) { // it is interpreted as a regression tree, where
                           // currently the separation type (simple least square)
@@ -220,7 +230,8 @@ TMVA::DecisionTree::DecisionTree( const DecisionTree &d ):
    fSigClass   (d.fSigClass),
    fTreeID     (d.fTreeID),
    fAnalysisType(d.fAnalysisType),
-   fDataSetInfo    (d.fDataSetInfo)
+   fDataSetInfo    (d.fDataSetInfo),
+   fQuantized      (d.fQuantized)
 {
    this->SetRoot( new TMVA::DecisionTreeNode ( *((DecisionTreeNode*)(d.GetRoot())) ) );
    this->SetParentTreeInNodes();
@@ -308,6 +319,7 @@ UInt_t TMVA::DecisionTree::BuildTree( const std::vector<const TMVA::Event*> & ev
          Log() << kDEBUG << "\tNote: This number will be taken as absolute minimum in the node, " << Endl;
          Log() << kDEBUG << "      \tin terms of 'weighted events' and unweighted ones !! " << Endl;
       }
+      if (fQuantized) return BuildTreeHist(eventSample);
    }
 
    UInt_t nevents = eventSample.size();
@@ -523,6 +535,346 @@ UInt_t TMVA::DecisionTree::BuildTree( const std::vector<const TMVA::Event*> & ev
    return fNNodes;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// per-tree arrays used by the histogram training
+
+struct TMVA::DecisionTree::HistTrainingData {
+   std::vector<UInt_t>   fRow;       // row of each event in the quantized sample
+   std::vector<Double_t> fWeight;    // (boosted) weight of each event
+   std::vector<Double_t> fOrgWeight; // original weight of each event
+   std::vector<Double_t> fTarget;    // regression target of each event
+   std::vector<Char_t>   fIsSig;     // signal flag of each event
+   std::vector<UInt_t>   fOffset;    // offset of each variable in a node histogram, in bins
+   UInt_t                fNStat;     // number of sums per histogram bin
+};
+
+namespace {
+   // sums kept per bin of a node histogram
+   enum { kSumS = 0, kSumB, kCountS, kCountB, kSumT, kSumT2 };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// build the tree on the quantized copy of the event sample (see
+/// SetQuantizedSample). The node histograms of all variables are filled
+/// from the bin matrix, and the histogram of the larger daughter of a node
+/// is obtained by subtracting the one of the smaller daughter from the
+/// histogram of the parent, so only about half of the events are scanned
+/// at every level of the tree. The possible cuts are the bin edges of the
+/// quantized sample.
+
+UInt_t TMVA::DecisionTree::BuildTreeHist( const EventConstList & eventSample )
+{
+   UInt_t nevents = eventSample.size();
+   if (nevents == 0) {
+      Log() << kFATAL << ":<BuildTreeHist> eventsample Size == 0 " << Endl;
+      return fNNodes;
+   }
+   if (fNvars==0) fNvars = eventSample[0]->GetNVariables();
+   fVariableImportance.resize(fNvars);
+   if (fQuantized->GetNVars() != fNvars) {
+      Log() << kFATAL << "<BuildTreeHist> the quantized sample has " << fQuantized->GetNVars()
+            << " variables, while the tree uses " << fNvars << Endl;
+   }
+
+   HistTrainingData data;
+   data.fRow.resize(nevents);
+   data.fWeight.resize(nevents);
+   data.fOrgWeight.resize(nevents);
+   data.fIsSig.resize(nevents);
+   if (DoRegression()) data.fTarget.resize(nevents);
+   for (UInt_t iev=0; iev<nevents; iev++) {
+      const TMVA::Event* evt = eventSample[iev];
+      Int_t row = fQuantized->GetRow(evt);
+      if (row < 0) {
+         Log() << kFATAL << "<BuildTreeHist> event " << iev << " is not part of the quantized sample" << Endl;
+      }
+      data.fRow[iev]       = row;
+      data.fWeight[iev]    = evt->GetWeight();
+      data.fOrgWeight[iev] = evt->GetOriginalWeight();
+      data.fIsSig[iev]     = (evt->GetClass() == fSigClass);
+      if (DoRegression()) data.fTarget[iev] = evt->GetTarget(0);
+   }
+   data.fNStat = DoRegression() ? 6 : 4;
+   data.fOffset.resize(fNvars+1);
+   data.fOffset[0] = 0;
+   for (UInt_t ivar=0; ivar<fNvars; ivar++) {
+      data.fOffset[ivar+1] = data.fOffset[ivar] + fQuantized->GetNBins(ivar);
+   }
+
+   std::vector<UInt_t> events(nevents);
+   for (UInt_t iev=0; iev<nevents; iev++) events[iev] = iev;
+
+   std::vector<Double_t> hist;
+   FillHist(data, events, hist);
+   BuildNodeHist(data, events, hist, GetRoot());
+
+   return fNNodes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// fill the histograms of all variables for the given events
+
+void TMVA::DecisionTree::FillHist( const HistTrainingData& data, const std::vector<UInt_t>& events,
+                                   std::vector<Double_t>& hist ) const
+{
+   const UInt_t nStat = data.fNStat;
+   hist.assign(data.fOffset[fNvars]*nStat, 0.);
+
+   auto fillVariable = [&](UInt_t ivar) {
+      const UChar_t* column = fQuantized->GetColumn(ivar);
+      Double_t* h = &hist[data.fOffset[ivar]*nStat];
+      for (std::vector<UInt_t>::const_iterator it=events.begin(); it!=events.end(); ++it) {
+         const UInt_t iev = *it;
+         Double_t* hb = h + column[data.fRow[iev]]*nStat;
+         const Double_t w = data.fWeight[iev];
+         if (data.fIsSig[iev]) { hb[kSumS] += w; hb[kCountS] += 1; }
+         else                  { hb[kSumB] += w; hb[kCountB] += 1; }
+         if (nStat > kSumT) {
+            const Double_t t = data.fTarget[iev];
+            hb[kSumT]  += w*t;
+            hb[kSumT2] += w*t*t;
+         }
+      }
+   };
+
+#ifdef R__USE_IMT
+   if (ROOT::IsImplicitMTEnabled() && fNvars > 1 && events.size() >= fgMinEventsForMT) {
+      tbb::parallel_for(UInt_t(0), fNvars, fillVariable);
+   } else {
+      for (UInt_t ivar=0; ivar < fNvars; ivar++) fillVariable(ivar);
+   }
+#else
+   for (UInt_t ivar=0; ivar < fNvars; ivar++) fillVariable(ivar);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// split a node of the histogram training and build its daughters.
+/// "hist" holds the histograms of the events of the node on input and
+/// is reused for one of the daughters.
+
+void TMVA::DecisionTree::BuildNodeHist( const HistTrainingData& data, std::vector<UInt_t>& events,
+                                        std::vector<Double_t>& hist, TMVA::DecisionTreeNode *node )
+{
+   Double_t s=0, b=0;
+   Double_t suw=0, buw=0;
+   Double_t sub=0, bub=0; // unboosted!
+   Double_t target=0, target2=0;
+   for (std::vector<UInt_t>::const_iterator it=events.begin(); it!=events.end(); ++it) {
+      const UInt_t iev = *it;
+      if (data.fIsSig[iev]) {
+         s += data.fWeight[iev];
+         suw += 1;
+         sub += data.fOrgWeight[iev];
+      }
+      else {
+         b += data.fWeight[iev];
+         buw += 1;
+         bub += data.fOrgWeight[iev];
+      }
+      if (DoRegression()) {
+         target  += data.fWeight[iev]*data.fTarget[iev];
+         target2 += data.fWeight[iev]*data.fTarget[iev]*data.fTarget[iev];
+      }
+   }
+
+   node->SetNSigEvents(s);
+   node->SetNBkgEvents(b);
+   node->SetNSigEvents_unweighted(suw);
+   node->SetNBkgEvents_unweighted(buw);
+   node->SetNSigEvents_unboosted(sub);
+   node->SetNBkgEvents_unboosted(bub);
+   node->SetPurity();
+   if (node == this->GetRoot()) {
+      node->SetNEvents(s+b);
+      node->SetNEvents_unweighted(suw+buw);
+      node->SetNEvents_unboosted(sub+bub);
+   }
+
+   Double_t separationGain = 0;
+   UInt_t cutBin = 0;
+   if ((events.size() >= 2*fMinSize  && s+b >= 2*fMinSize) && node->GetDepth() < fMaxDepth 
+       && ( ( s!=0 && b !=0 && !DoRegression()) || ( (s+b)!=0 && DoRegression()) ) ) {
+      separationGain = this->TrainNodeHist(data, hist, s, b, suw, buw, target, target2, node, cutBin);
+   }
+
+   if (separationGain < std::numeric_limits<double>::epsilon()) { // it is a leaf node
+      if (DoRegression()) {
+         node->SetSeparationIndex(fRegType->GetSeparationIndex(s+b,target,target2));
+         node->SetResponse(target/(s+b));
+         if( almost_equal_double(target2/(s+b), target/(s+b)*target/(s+b)) ) {
+            node->SetRMS(0);
+         }else{
+            node->SetRMS(TMath::Sqrt(target2/(s+b) - target/(s+b)*target/(s+b)));
+         }
+      }
+      else {
+         node->SetSeparationIndex(fSepType->GetSeparationIndex(s,b));
+         if   (node->GetPurity() > fNodePurityLimit) node->SetNodeType(1);
+         else node->SetNodeType(-1);
+      }
+      if (node->GetDepth() > this->GetTotalTreeDepth()) this->SetTotalTreeDepth(node->GetDepth());
+      return;
+   }
+
+   // split the events, the cut on the bin number is equivalent to the cut on
+   // the variable value stored in the node
+   const UChar_t* column = fQuantized->GetColumn(node->GetSelector());
+   const Bool_t cutType = node->GetCutType();
+   std::vector<UInt_t> leftSample;  leftSample.reserve(events.size());
+   std::vector<UInt_t> rightSample; rightSample.reserve(events.size());
+   Double_t nRight=0, nLeft=0;
+   Double_t nRightUnBoosted=0, nLeftUnBoosted=0;
+   for (std::vector<UInt_t>::const_iterator it=events.begin(); it!=events.end(); ++it) {
+      const UInt_t iev = *it;
+      if ((column[data.fRow[iev]] > cutBin) == cutType) {
+         rightSample.push_back(iev);
+         nRight += data.fWeight[iev];
+         nRightUnBoosted += data.fOrgWeight[iev];
+      }
+      else {
+         leftSample.push_back(iev);
+         nLeft += data.fWeight[iev];
+         nLeftUnBoosted += data.fOrgWeight[iev];
+      }
+   }
+   std::vector<UInt_t>().swap(events);
+
+   TMVA::DecisionTreeNode *rightNode = new TMVA::DecisionTreeNode(node,'r');
+   fNNodes++;
+   rightNode->SetNEvents(nRight);
+   rightNode->SetNEvents_unboosted(nRightUnBoosted);
+   rightNode->SetNEvents_unweighted(rightSample.size());
+
+   TMVA::DecisionTreeNode *leftNode = new TMVA::DecisionTreeNode(node,'l');
+   fNNodes++;
+   leftNode->SetNEvents(nLeft);
+   leftNode->SetNEvents_unboosted(nLeftUnBoosted);
+   leftNode->SetNEvents_unweighted(leftSample.size());
+
+   node->SetNodeType(0);
+   node->SetLeft(leftNode);
+   node->SetRight(rightNode);
+
+   // fill the histograms of the smaller daughter, and get the ones of the
+   // larger daughter by subtraction from the parent histograms
+   std::vector<Double_t> smallHist;
+   Bool_t rightIsSmall = rightSample.size() < leftSample.size();
+   FillHist(data, rightIsSmall ? rightSample : leftSample, smallHist);
+   for (UInt_t i=0; i<hist.size(); i++) hist[i] -= smallHist[i];
+
+   if (rightIsSmall) {
+      this->BuildNodeHist(data, rightSample, smallHist, rightNode);
+      this->BuildNodeHist(data, leftSample,  hist,      leftNode );
+   } else {
+      this->BuildNodeHist(data, rightSample, hist,      rightNode);
+      this->BuildNodeHist(data, leftSample,  smallHist, leftNode );
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// find the best cut of a node of the histogram training. Same criterion as
+/// TrainNodeFast, but the cumulative distributions are taken from the node
+/// histograms and the cuts are placed at the bin edges of the quantized sample.
+/// The bin of the cut is returned in cutBin.
+
+Double_t TMVA::DecisionTree::TrainNodeHist( const HistTrainingData& data, const std::vector<Double_t>& hist,
+                                            Double_t nTotS, Double_t nTotB,
+                                            Double_t nTotS_unWeighted, Double_t nTotB_unWeighted,
+                                            Double_t targetTot, Double_t target2Tot,
+                                            TMVA::DecisionTreeNode *node, UInt_t& cutBin )
+{
+   const UInt_t nStat = data.fNStat;
+
+   std::vector<Bool_t> useVariable(fNvars, kTRUE);
+   if (fRandomisedTree) { // choose for each node splitting a random subset of variables to choose from
+      Bool_t *useVar = new Bool_t[fNvars];
+      UInt_t *mapVar = new UInt_t[fNvars];
+      UInt_t tmp=fUseNvars;
+      GetRandomisedVariables(useVar,mapVar,tmp);
+      for (UInt_t ivar=0; ivar<fNvars; ivar++) useVariable[ivar] = useVar[ivar];
+      delete [] useVar;
+      delete [] mapVar;
+   }
+
+   Double_t separationGainTotal = -1;
+   Int_t    mxVar = -1;
+   UInt_t   mxBin = 0;
+   Double_t mxSelS = 0, mxSelB = 0;
+
+   for (UInt_t ivar=0; ivar<fNvars; ivar++) {
+      if (!useVariable[ivar]) continue;
+      const Double_t* h = &hist[data.fOffset[ivar]*nStat];
+      const UInt_t nBins = fQuantized->GetNBins(ivar);
+
+      Double_t selS=0, selB=0, selS_unWeighted=0, selB_unWeighted=0, selT=0, selT2=0;
+      for (UInt_t iBin=0; iBin<nBins-1; iBin++) { // the last bin contains "all events" -->skip
+         const Double_t* hb = h + iBin*nStat;
+         selS += hb[kSumS];
+         selB += hb[kSumB];
+         selS_unWeighted += hb[kCountS];
+         selB_unWeighted += hb[kCountB];
+         if (nStat > kSumT) {
+            selT  += hb[kSumT];
+            selT2 += hb[kSumT2];
+         }
+
+         Double_t sl = selS_unWeighted;
+         Double_t bl = selB_unWeighted;
+         Double_t sr = nTotS_unWeighted-sl;
+         Double_t br = nTotB_unWeighted-bl;
+         Double_t slW = selS;
+         Double_t blW = selB;
+         Double_t srW = nTotS-slW;
+         Double_t brW = nTotB-blW;
+         if ( (sl+bl)>0 && (sr+br)>0
+              && ((sl+bl)>=fMinSize && (sr+br)>=fMinSize)
+              && ((slW+blW)>=fMinSize && (srW+brW)>=fMinSize) ) {
+            Double_t sepTmp;
+            if (DoRegression()) {
+               sepTmp = fRegType->GetSeparationGain(selS+selB, selT, selT2, nTotS+nTotB, targetTot, target2Tot);
+            } else {
+               sepTmp = fSepType->GetSeparationGain(selS, selB, nTotS, nTotB);
+            }
+            if (separationGainTotal < sepTmp) {
+               separationGainTotal = sepTmp;
+               mxVar  = ivar;
+               mxBin  = iBin;
+               mxSelS = selS;
+               mxSelB = selB;
+            }
+         }
+      }
+   }
+
+   if (mxVar < 0) return 0;
+
+   Bool_t cutType = kTRUE;
+   if (DoRegression()) {
+      node->SetSeparationIndex(fRegType->GetSeparationIndex(nTotS+nTotB,targetTot,target2Tot));
+      node->SetResponse(targetTot/(nTotS+nTotB));
+      if ( almost_equal_double(target2Tot/(nTotS+nTotB), targetTot/(nTotS+nTotB)*targetTot/(nTotS+nTotB))) {
+         node->SetRMS(0);
+      }else{ 
+         node->SetRMS(TMath::Sqrt(target2Tot/(nTotS+nTotB) - targetTot/(nTotS+nTotB)*targetTot/(nTotS+nTotB)));
+      }
+   }
+   else {
+      node->SetSeparationIndex(fSepType->GetSeparationIndex(nTotS,nTotB));
+      if (mxSelS/nTotS > mxSelB/nTotB) cutType=kTRUE;
+      else cutType=kFALSE;
+   }
+   node->SetSelector((UInt_t)mxVar);
+   node->SetCutValue(fQuantized->GetCutValue(mxVar,mxBin));
+   node->SetCutType(cutType);
+   node->SetSeparationGain(separationGainTotal);
+   node->SetNFisherCoeff(0);
+   fVariableImportance[mxVar] += separationGainTotal*separationGainTotal * (nTotS+nTotB) * (nTotS+nTotB) ;
+
+   cutBin = mxBin;
+   return separationGainTotal;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void TMVA::DecisionTree::FillTree( const std::vector<TMVA::Event*> & eventSample )
@@ -940,7 +1292,7 @@ void TMVA::DecisionTree::GetRandomisedVariables(Bool_t *useVariable, UInt_t *map
 Double_t TMVA::DecisionTree::TrainNodeFast( const EventConstList & eventSample,
                                             TMVA::DecisionTreeNode *node )
 {
-   Double_t  separationGainTotal = -1, sepTmp;
+   Double_t  separationGainTotal = -1;
    Double_t *separationGain    = new Double_t[fNvars+1];
    Int_t    *cutIndex          = new Int_t[fNvars+1];  //-1;
 
@@ -1149,50 +1501,113 @@ Double_t TMVA::DecisionTree::TrainNodeFast( const EventConstList & eventSample,
          nTotB+=eventWeight;
          nTotB_unWeighted++;
       }
-      
-      Int_t iBin=-1;
-      for (UInt_t ivar=0; ivar < cNvars; ivar++) {
-         // now scan trough the cuts for each varable and find which one gives
-         // the best separationGain at the current stage.
-         if ( useVariable[ivar] ) {
-            Double_t eventData;
-            if (ivar < fNvars) eventData = eventSample[iev]->GetValue(ivar); 
-            else { // the fisher variable
-               eventData = fisherCoeff[fNvars];
-               for (UInt_t jvar=0; jvar<fNvars; jvar++)
-                  eventData += fisherCoeff[jvar]*(eventSample[iev])->GetValue(jvar);
-               
-            }
-            // "maximum" is nbins-1 (the "-1" because we start counting from 0 !!
-            iBin = TMath::Min(Int_t(nBins[ivar]-1),TMath::Max(0,int (invBinWidth[ivar]*(eventData-xmin[ivar]) ) ));
-            if (eventSample[iev]->GetClass() == fSigClass) {
-               nSelS[ivar][iBin]+=eventWeight;
-               nSelS_unWeighted[ivar][iBin]++;
-            } 
-            else {
-               nSelB[ivar][iBin]+=eventWeight;
-               nSelB_unWeighted[ivar][iBin]++;
-            }
+   }
+
+   // Fill the cut histogram of one variable, turn it into a cumulative
+   // distribution and find the best cut. The variables are independent of
+   // each other and each histogram is filled in the order of the event sample,
+   // so processing them in parallel gives exactly the same result as the
+   // serial loop.
+   auto trainVariable = [&](UInt_t ivar) {
+      if (!useVariable[ivar]) return;
+
+      for (UInt_t iev=0; iev<nevents; iev++) {
+         Double_t eventWeight =  eventSample[iev]->GetWeight(); 
+         Double_t eventData;
+         if (ivar < fNvars) eventData = eventSample[iev]->GetValue(ivar); 
+         else { // the fisher variable
+            eventData = fisherCoeff[fNvars];
+            for (UInt_t jvar=0; jvar<fNvars; jvar++)
+               eventData += fisherCoeff[jvar]*(eventSample[iev])->GetValue(jvar);
+            
+         }
+         // "maximum" is nbins-1 (the "-1" because we start counting from 0 !!
+         Int_t iBin = TMath::Min(Int_t(nBins[ivar]-1),TMath::Max(0,int (invBinWidth[ivar]*(eventData-xmin[ivar]) ) ));
+         if (eventSample[iev]->GetClass() == fSigClass) {
+            nSelS[ivar][iBin]+=eventWeight;
+            nSelS_unWeighted[ivar][iBin]++;
+         } 
+         else {
+            nSelB[ivar][iBin]+=eventWeight;
+            nSelB_unWeighted[ivar][iBin]++;
+         }
+         if (DoRegression()) {
+            target[ivar][iBin] +=eventWeight*eventSample[iev]->GetTarget(0);
+            target2[ivar][iBin]+=eventWeight*eventSample[iev]->GetTarget(0)*eventSample[iev]->GetTarget(0);
+         }
+      }
+
+      // now turn the "histogram" into a cumulative distribution
+      for (UInt_t ibin=1; ibin < nBins[ivar]; ibin++) {
+         nSelS[ivar][ibin]+=nSelS[ivar][ibin-1];
+         nSelS_unWeighted[ivar][ibin]+=nSelS_unWeighted[ivar][ibin-1];
+         nSelB[ivar][ibin]+=nSelB[ivar][ibin-1];
+         nSelB_unWeighted[ivar][ibin]+=nSelB_unWeighted[ivar][ibin-1];
+         if (DoRegression()) {
+            target[ivar][ibin] +=target[ivar][ibin-1] ;
+            target2[ivar][ibin]+=target2[ivar][ibin-1];
+         }
+      }
+
+      // now select the optimal cut for this variable
+      for (UInt_t iBin=0; iBin<nBins[ivar]-1; iBin++) { // the last bin contains "all events" -->skip
+         // the separationGain is defined as the various indices (Gini, CorssEntropy, e.t.c)
+         // calculated by the "SamplePurities" fom the branches that would go to the
+         // left or the right from this node if "these" cuts were used in the Node:
+         // hereby: nSelS and nSelB would go to the right branch
+         //        (nTotS - nSelS) + (nTotB - nSelB)  would go to the left branch;
+
+         // only allow splits where both daughter nodes match the specified miniumum number
+         // for this use the "unweighted" events, as you are interested in statistically 
+         // significant splits, which is determined by the actual number of entries
+         // for a node, rather than the sum of event weights.
+
+         Double_t sl = nSelS_unWeighted[ivar][iBin];
+         Double_t bl = nSelB_unWeighted[ivar][iBin];
+         Double_t s  = nTotS_unWeighted;
+         Double_t b  = nTotB_unWeighted;
+         Double_t slW = nSelS[ivar][iBin];
+         Double_t blW = nSelB[ivar][iBin];
+         Double_t sW  = nTotS;
+         Double_t bW  = nTotB;
+         Double_t sr = s-sl;
+         Double_t br = b-bl;
+         Double_t srW = sW-slW;
+         Double_t brW = bW-blW;
+         if ( ((sl+bl)>=fMinSize && (sr+br)>=fMinSize)
+              && ((slW+blW)>=fMinSize && (srW+brW)>=fMinSize) 
+              ) {
+
+            Double_t sepTmp;
             if (DoRegression()) {
-               target[ivar][iBin] +=eventWeight*eventSample[iev]->GetTarget(0);
-               target2[ivar][iBin]+=eventWeight*eventSample[iev]->GetTarget(0)*eventSample[iev]->GetTarget(0);
+               sepTmp = fRegType->GetSeparationGain(nSelS[ivar][iBin]+nSelB[ivar][iBin], 
+                                                    target[ivar][iBin],target2[ivar][iBin],
+                                                    nTotS+nTotB,
+                                                    target[ivar][nBins[ivar]-1],target2[ivar][nBins[ivar]-1]);
+            } else {
+               sepTmp = fSepType->GetSeparationGain(nSelS[ivar][iBin], nSelB[ivar][iBin], nTotS, nTotB);
+            }
+            if (separationGain[ivar] < sepTmp) {
+               separationGain[ivar] = sepTmp;  
+               cutIndex[ivar]       = iBin;
             }
          }
       }
-   }   
-   // now turn the "histogram" into a cumulative distribution
+   };
+
+#ifdef R__USE_IMT
+   if (ROOT::IsImplicitMTEnabled() && cNvars > 1 && nevents >= fgMinEventsForMT) {
+      tbb::parallel_for(UInt_t(0), cNvars, trainVariable);
+   } else {
+      for (UInt_t ivar=0; ivar < cNvars; ivar++) trainVariable(ivar);
+   }
+#else
+   for (UInt_t ivar=0; ivar < cNvars; ivar++) trainVariable(ivar);
+#endif
+
+   // sanity checks of the cumulative distributions
    for (UInt_t ivar=0; ivar < cNvars; ivar++) {
       if (useVariable[ivar]) {
-         for (UInt_t ibin=1; ibin < nBins[ivar]; ibin++) {
-            nSelS[ivar][ibin]+=nSelS[ivar][ibin-1];
-            nSelS_unWeighted[ivar][ibin]+=nSelS_unWeighted[ivar][ibin-1];
-            nSelB[ivar][ibin]+=nSelB[ivar][ibin-1];
-            nSelB_unWeighted[ivar][ibin]+=nSelB_unWeighted[ivar][ibin-1];
-            if (DoRegression()) {
-               target[ivar][ibin] +=target[ivar][ibin-1] ;
-               target2[ivar][ibin]+=target2[ivar][ibin-1];
-            }
-         }
          if (nSelS_unWeighted[ivar][nBins[ivar]-1] +nSelB_unWeighted[ivar][nBins[ivar]-1] != eventSample.size()) {
             Log() << kFATAL << "Helge, you have a bug ....nSelS_unw..+nSelB_unw..= "
                   << nSelS_unWeighted[ivar][nBins[ivar]-1] +nSelB_unWeighted[ivar][nBins[ivar]-1] 
@@ -1209,56 +1624,6 @@ Double_t TMVA::DecisionTree::TrainNodeFast( const EventConstList & eventSample,
          }
       }
    }
-   // now select the optimal cuts for each varable and find which one gives
-   // the best separationGain at the current stage
-   for (UInt_t ivar=0; ivar < cNvars; ivar++) {
-      if (useVariable[ivar]) {
-         for (UInt_t iBin=0; iBin<nBins[ivar]-1; iBin++) { // the last bin contains "all events" -->skip
-            // the separationGain is defined as the various indices (Gini, CorssEntropy, e.t.c)
-            // calculated by the "SamplePurities" fom the branches that would go to the
-            // left or the right from this node if "these" cuts were used in the Node:
-            // hereby: nSelS and nSelB would go to the right branch
-            //        (nTotS - nSelS) + (nTotB - nSelB)  would go to the left branch;
-
-            // only allow splits where both daughter nodes match the specified miniumum number
-            // for this use the "unweighted" events, as you are interested in statistically 
-            // significant splits, which is determined by the actual number of entries
-            // for a node, rather than the sum of event weights.
-
-            Double_t sl = nSelS_unWeighted[ivar][iBin];
-            Double_t bl = nSelB_unWeighted[ivar][iBin];
-            Double_t s  = nTotS_unWeighted;
-            Double_t b  = nTotB_unWeighted;
-            Double_t slW = nSelS[ivar][iBin];
-            Double_t blW = nSelB[ivar][iBin];
-            Double_t sW  = nTotS;
-            Double_t bW  = nTotB;
-            Double_t sr = s-sl;
-            Double_t br = b-bl;
-            Double_t srW = sW-slW;
-            Double_t brW = bW-blW;
-            //            std::cout << "sl="<<sl << " bl="<<bl<<" fMinSize="<<fMinSize << "sr="<<sr << " br="<<br  <<std::endl;
-            if ( ((sl+bl)>=fMinSize && (sr+br)>=fMinSize)
-                 && ((slW+blW)>=fMinSize && (srW+brW)>=fMinSize) 
-                 ) {
-
-               if (DoRegression()) {
-                  sepTmp = fRegType->GetSeparationGain(nSelS[ivar][iBin]+nSelB[ivar][iBin], 
-                                                       target[ivar][iBin],target2[ivar][iBin],
-                                                       nTotS+nTotB,
-                                                       target[ivar][nBins[ivar]-1],target2[ivar][nBins[ivar]-1]);
-               } else {
-                  sepTmp = fSepType->GetSeparationGain(nSelS[ivar][iBin], nSelB[ivar][iBin], nTotS, nTotB);
-               }
-               if (separationGain[ivar] < sepTmp) {
-                  separationGain[ivar] = sepTmp;  
-                  cutIndex[ivar]       = iBin;
-               }
-            }
-         }
-      }
-   }
-
 
    //now you have found the best separation cut for each variable, now compare the variables
    for (UInt_t ivar=0; ivar < cNvars; ivar++) {
@@ -175,6 +175,42 @@ TMVA::Event::Event( const Event& event )
 }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// assignment operator; like the copy constructor it takes the values of a
+/// dynamic event, the result is never dynamic. The vectors of this event are
+/// reused, which avoids reallocations when events are recycled
+
+TMVA::Event& TMVA::Event::operator=( const Event& event )
+{
+   if (this == &event) return *this;
+
+   TObject::operator=(event);
+   fTargets             = event.fTargets;
+   fVariableArrangement = event.fVariableArrangement;
+   fClass               = event.fClass;
+   fWeight              = event.fWeight;
+   fBoostWeight         = event.fBoostWeight;
+   fDoNotBoost          = kFALSE;
+
+   if (event.fDynamic) {
+      UInt_t nvar = event.GetNVariables();
+      fValues.clear();
+      fSpectators.clear();
+      UInt_t idx=0;
+      std::vector<Float_t*>::iterator itDyn=event.fValuesDynamic->begin(), itDynEnd=event.fValuesDynamic->end();
+      for (; itDyn!=itDynEnd; ++itDyn, ++idx){
+         if (idx < nvar) fValues.push_back( *(*itDyn) );
+         else            fSpectators.push_back( *(*itDyn) );
+      }
+   } else {
+      fValues     = event.fValues;
+      fSpectators = event.fSpectators;
+   }
+   fValuesDynamic = NULL;
+   fDynamic       = kFALSE;
+   return *this;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Event destructor
 
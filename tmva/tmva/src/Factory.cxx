@@ -60,6 +60,11 @@
 #include "TMath.h"
 #include "TObjString.h"
 #include "TSystem.h"
+#include "TParameter.h"
+#include "TVectorD.h"
+#ifndef _WIN32
+#include "TProcPool.h"
+#endif
 
 #include "TMVA/Factory.h"
 #include "TMVA/ClassifierFactory.h"
@@ -88,6 +93,7 @@
 #include "TMVA/ResultsRegression.h"
 #include "TMVA/ResultsMulticlass.h"
 #include <list>
+#include <numeric>
 #include <bitset>
 
 #include "TMVA/Types.h"
@@ -105,6 +111,42 @@ ClassImp(TMVA::Factory)
 #define VIBITS          32
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// run func(task) for the tasks 0..nTasks-1 (folds, methods, ...) and return the
+/// lists it returns, in the order of the tasks (0 for a failed task). With more
+/// than one worker the tasks are run in processes forked by a TProcPool, which
+/// call initWorker() before each task; func must then name each list after its
+/// task, as the results of the workers arrive in any order
+
+template <class F, class I>
+static std::vector<TList *> RunTasks(F func, Int_t nTasks, UInt_t nWorkers, I initWorker)
+{
+   std::vector<TList *> ordered(nTasks, (TList *)0);
+#ifndef _WIN32
+   if (nWorkers > 1 && nTasks > 1) {
+      std::vector<int> tasks(nTasks);
+      std::iota(tasks.begin(), tasks.end(), 0);
+      auto workerTask = [&](int task) -> TList * {
+         initWorker();
+         return func(task);
+      };
+      TProcPool pool(nWorkers);
+      std::vector<TList *> lists = pool.Map(workerTask, tasks);
+      for (auto list : lists) {
+         if (!list) continue;
+         list->SetOwner(kTRUE);
+         Int_t task = TString(list->GetName()).Atoi();
+         if (task >= 0 && task < nTasks && !ordered[task]) ordered[task] = list;
+         else delete list;
+      }
+      return ordered;
+   }
+#endif
+   for (Int_t task = 0; task < nTasks; task++) ordered[task] = func(task);
+   return ordered;
+}
+
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// standard constructor
@@ -970,6 +1012,9 @@ void TMVA::Factory::TestAllMethods()
       MVector *methods=itrMap->second;
       MVector::iterator itrMethod;
 
+      // with several workers, evaluate the classifiers beforehand in parallel
+      EvaluateInWorkers(methods, Types::kTesting);
+
       // iterate over methods and test
       for( itrMethod = methods->begin(); itrMethod != methods->end(); itrMethod++ ) {
 	  Event::SetIsTraining(kFALSE);
@@ -984,6 +1029,128 @@ void TMVA::Factory::TestAllMethods()
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// evaluate the classifiers among methods on all events of the given tree type
+/// in worker processes, if gConfig().SetNWorkers(n) was called with n>1. The
+/// events of every method are split in n ranges, and the (method, range) tasks
+/// are shared by the workers; the responses are put back in event order into
+/// the cache of each method (MethodBase::SetMvaValuesCache), where AddOutput
+/// and GetTrainingEfficiency take them from. The workers do not write the
+/// output file of the factory (see PrepareWorker). Regression and multiclass
+/// methods are evaluated as before, when their output is added
+
+void TMVA::Factory::EvaluateInWorkers( MVector *methods, Types::ETreeType type )
+{
+   const UInt_t nWorkers = gConfig().GetNWorkers();
+   if (nWorkers < 2) return;
+
+   std::vector<MethodBase*> selected;
+   for (MVector::iterator itrMethod = methods->begin(); itrMethod != methods->end(); itrMethod++) {
+      MethodBase* mva = dynamic_cast<MethodBase*>(*itrMethod);
+      if (mva == 0 || mva->DoRegression() || mva->DoMulticlass()) continue;
+      // the cuts compute their training efficiency without the responses
+      if (type == Types::kTraining && mva->GetMethodType() == Types::kCuts) continue;
+      selected.push_back(mva);
+   }
+   if (selected.empty()) return;
+
+   const Int_t nRanges = nWorkers;
+   const Int_t nTasks  = selected.size()*nRanges;
+   Log() << kINFO << "Evaluate " << selected.size() << " classifiers on the "
+         << (type == Types::kTraining ? "training" : "testing") << " sample with " << nWorkers << " workers" << Endl;
+
+   auto evaluateRange = [&](int task) -> TList * {
+      MethodBase* mva = selected[task/nRanges];
+      const Int_t range = task%nRanges;
+      Event::SetIsTraining(kFALSE);
+      mva->Data()->SetCurrentType(type);
+      const Long64_t nEvents = mva->Data()->GetNEvents();
+      const Long64_t first = nEvents*range/nRanges;
+      const Long64_t last  = nEvents*(range+1)/nRanges;
+      std::vector<Double_t> values;
+      if (last > first) values = mva->GetMvaValues(first, last, kFALSE);
+
+      TList *list = new TList();
+      list->SetName(TString::Format("%d", task));
+      TVectorD *vec = new TVectorD(values.size());
+      for (UInt_t i = 0; i < values.size(); i++) (*vec)[i] = values[i];
+      list->Add(vec);
+      return list;
+   };
+
+   std::vector<TList *> lists = RunTasks(evaluateRange, nTasks, nWorkers, [this]() { PrepareWorker(); });
+   for (UInt_t imethod = 0; imethod < selected.size(); imethod++) {
+      std::vector<Double_t> values;
+      Bool_t complete = kTRUE;
+      for (Int_t range = 0; range < nRanges; range++) {
+         TList *list = lists[imethod*nRanges + range];
+         TVectorD *vec = list ? dynamic_cast<TVectorD*>(list->First()) : 0;
+         if (vec == 0) {
+            complete = kFALSE;
+            break;
+         }
+         values.insert(values.end(), vec->GetMatrixArray(), vec->GetMatrixArray() + vec->GetNrows());
+      }
+      if (complete) selected[imethod]->SetMvaValuesCache(type, values);
+      else Log() << kWARNING << "Evaluation of " << selected[imethod]->GetMethodName()
+                 << " failed in a worker, it is evaluated again" << Endl;
+   }
+   for (UInt_t i = 0; i < lists.size(); i++) delete lists[i];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// called in a worker process forked by RunTasks before each of its tasks.
+/// The output file of the factory is replaced by the private output file of
+/// the worker (see PrepareWorkerProcess)
+
+void TMVA::Factory::PrepareWorker()
+{
+   TFile *workerFile = PrepareWorkerProcess();
+   if (workerFile == 0) Log() << kFATAL << "Cannot open the output file of the worker process" << Endl;
+   if (fgTargetFile) fgTargetFile = workerFile;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// set up a process forked to train or evaluate methods concurrently (by
+/// RunTasks, or by OptimizeConfigParameters for the parameter sets) and return
+/// its private output file, a temporary file unlinked at once and opened at
+/// the first call. The worker runs its tasks serially (no nested worker
+/// processes), and must not write the files the parent process opened for
+/// writing: it shares their descriptors with the parent, and would write them
+/// when it closes them at exit. They are made read-only, without their write
+/// cache. Returns 0 if the output file cannot be opened
+
+TFile *TMVA::Factory::PrepareWorkerProcess()
+{
+   static TFile *workerFile = 0; // output file of this worker process
+
+   gConfig().SetNWorkers(1);
+
+   TIter next(gROOT->GetListOfFiles());
+   while (TObject *obj = next()) {
+      TFile *file = dynamic_cast<TFile*>(obj);
+      if (file == 0 || file == workerFile || !file->IsWritable()) continue;
+      file->SetCacheWrite(0);
+      file->SetWritable(kFALSE);
+   }
+   if (gDirectory && gDirectory->GetFile() && gDirectory->GetFile() != workerFile &&
+       !gDirectory->GetFile()->IsWritable()) {
+      gROOT->cd();
+   }
+
+   if (workerFile == 0) {
+      TDirectory::TContext ctxt;
+      TString name = "TMVAWorker";
+      FILE *tmp = gSystem->TempFileName(name);
+      if (tmp) {
+         fclose(tmp);
+         workerFile = TFile::Open(name, "RECREATE");
+         gSystem->Unlink(name);
+      }
+   }
+   return workerFile;
+}
+
 //_______________________________________________________________________
 void TMVA::Factory::MakeClass(const TString& datasetname , const TString& methodTitle ) const
 {
@@ -1118,6 +1285,10 @@ void TMVA::Factory::EvaluateAllMethods( void )
       Bool_t doRegression = kFALSE;
       Bool_t doMulticlass = kFALSE;
 
+      // with several workers, evaluate the classifiers on the training sample
+      // beforehand in parallel (for the training efficiencies)
+      EvaluateInWorkers(methods, Types::kTraining);
+
       // iterate over methods and evaluate
       for (MVector::iterator itrMethod =methods->begin(); itrMethod != methods->end(); itrMethod++) {
 	  Event::SetIsTraining(kFALSE);
@@ -1219,6 +1390,11 @@ void TMVA::Factory::EvaluateAllMethods( void )
 	    }
 	  }
       }
+      // responses evaluated in the workers and not used (e.g. by the cuts)
+      for (MVector::iterator itrMethod =methods->begin(); itrMethod != methods->end(); itrMethod++) {
+         MethodBase* theMethod = dynamic_cast<MethodBase*>(*itrMethod);
+         if (theMethod) theMethod->ClearMvaValuesCache();
+      }
       if (doRegression) {
 
 	  std::vector<TString> vtemps = mname[0];
@@ -2052,6 +2228,14 @@ TH1F* TMVA::Factory::GetImportance(const int nbits,std::vector<Double_t> importa
   return vih1;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// k-fold cross validation of a method. The folds (and with optParams the
+/// parameter optimisation on each fold) are trained concurrently in worker
+/// processes if gConfig().SetNWorkers(n) was called with n>1; every worker
+/// owns a copy of the data loader and of the factory, trains serially, writes
+/// its output to a private temporary file (see PrepareWorker), and sends back
+/// only the ROC integral and curve (or the tuned parameters) of its fold
+
 TMVA::CrossValidationResult TMVA::Factory::CrossValidate(DataLoader * loader, Types::EMVA theMethod, TString methodTitle, const char *theOption, bool optParams, int NumFolds, bool remakeDataSet, float * rocIntegrals)
 {
    Bool_t mstatus=fModelPersistence;
@@ -2070,13 +2254,19 @@ TMVA::CrossValidationResult TMVA::Factory::CrossValidate(DataLoader * loader, Ty
    const int nbits = loader->DefaultDataSetInfo().GetNVariables();
    std::vector<TString> varNames = loader->DefaultDataSetInfo().GetListOfVariables();
 
+   const UInt_t nWorkers = gConfig().GetNWorkers();
+   if (nWorkers > 1) {
+      Log() << kINFO << "Cross validation: " << NumFolds << " folds trained in " << nWorkers << " worker processes" << Endl;
+   }
+
    if(optParams){
 
       std::vector<std::map<TString,Double_t> > foldParameters;
   
       //loader->ValidationKFoldSet();
 
-      for(Int_t i=0; i<NumFolds; ++i){
+      // the tuned parameters of fold i, one TParameter<Double_t> each
+      auto optimiseFold = [&](int i) -> TList * {
          Event::SetIsTraining(kTRUE);
          TString optTitle = methodTitle;
          optTitle += "_opt";
@@ -2094,11 +2284,32 @@ TMVA::CrossValidationResult TMVA::Factory::CrossValidate(DataLoader * loader, Ty
       
          MethodBase* mva = BookMethod(seedloader, theMethod, methodTitle, theOption);
       
-         foldParameters.push_back(mva->OptimizeTuningParameters("ROCIntegral","Minuit"));
+         std::map<TString,Double_t> tuned = mva->OptimizeTuningParameters("ROCIntegral","Minuit");
       
          this->DeleteAllMethods();
       
          fMethodsMap.clear();
+
+         TList *list = new TList();
+         list->SetName(TString::Format("%d",i));
+         list->SetOwner(kTRUE);
+         for (std::map<TString,Double_t>::iterator it=tuned.begin(); it!=tuned.end(); it++) {
+            list->Add(new TParameter<Double_t>(it->first, it->second));
+         }
+         return list;
+      };
+
+      std::vector<TList *> lists = RunTasks(optimiseFold, NumFolds, nWorkers, [this]() { PrepareWorker(); });
+      for (UInt_t i=0; i<lists.size(); i++) {
+         if (!lists[i]) {
+            Log() << kERROR << "Parameter optimisation failed for fold " << i << Endl;
+            continue;
+         }
+         std::map<TString,Double_t> tuned;
+         TIter next(lists[i]);
+         while (TParameter<Double_t> *par = (TParameter<Double_t> *)next()) tuned[par->GetName()] = par->GetVal();
+         foldParameters.push_back(tuned);
+         delete lists[i];
       }
     
       TString optionsString;
@@ -2113,15 +2324,16 @@ TMVA::CrossValidationResult TMVA::Factory::CrossValidate(DataLoader * loader, Ty
             optionsString += it->second;
             if(it!=--foldParameters.at(t).end()){ optionsString += ":"; }
          }
-         auto result=CrossValidate(loader, theMethod, methodTitle, optionsString, false, false);
+         auto result=CrossValidate(loader, theMethod, methodTitle, optionsString, false, NumFolds, false);
          parameterPerformance.push_back(result.GetROCAverage());
       }
    }
 
 
    if(!optParams){
-    
-      for(Int_t fold=0; fold<NumFolds; ++fold){
+
+      // the ROC integral (a TParameter<Float_t>) and the ROC curve of a fold
+      auto trainFold = [&](int fold) -> TList * {
          TString foldTitle = methodTitle;
          foldTitle += "_fold";
          foldTitle += fold+1;
@@ -2141,14 +2353,17 @@ TMVA::CrossValidationResult TMVA::Factory::CrossValidate(DataLoader * loader, Ty
          TrainAllMethods();
          TestAllMethods();
          EvaluateAllMethods();
-         fResults.SetROCValue(fold,GetROCIntegral(seedloader->GetName(), methodTitle));
+
+         TList *list = new TList();
+         list->SetName(TString::Format("%d",fold));
+         list->SetOwner(kTRUE);
+         list->Add(new TParameter<Float_t>("ROCIntegral", GetROCIntegral(seedloader->GetName(), methodTitle)));
          auto  gr=GetROCCurve(seedloader->GetName(), methodTitle, true);
          
          gr->SetLineColor(fold+1);
          gr->SetLineWidth(2);
          gr->SetTitle(seedloader->GetName());
-        
-         fResults.GetROCCurves()->Add(gr);
+         list->Add(gr);
          
          TMVA::MethodBase * smethod = dynamic_cast<TMVA::MethodBase*>(fMethodsMap[seedloader->GetName()][0][0]);
          TMVA::ResultsClassification * sresults = (TMVA::ResultsClassification*)smethod->Data()->GetResults(smethod->GetMethodName(), Types::kTesting, Types::kClassification);
@@ -2158,6 +2373,23 @@ TMVA::CrossValidationResult TMVA::Factory::CrossValidate(DataLoader * loader, Ty
          this->DeleteAllMethods();
       
          fMethodsMap.clear();
+         return list;
+      };
+
+      std::vector<TList *> lists = RunTasks(trainFold, NumFolds, nWorkers, [this]() { PrepareWorker(); });
+      for(Int_t fold=0; fold<NumFolds; ++fold){
+         if (!lists[fold]) {
+            Log() << kERROR << "Training failed for fold " << fold+1 << Endl;
+            continue;
+         }
+         TParameter<Float_t> *roc = (TParameter<Float_t> *)lists[fold]->FindObject("ROCIntegral");
+         if (roc) fResults.SetROCValue(fold,roc->GetVal());
+         TGraph *gr = dynamic_cast<TGraph *>(lists[fold]->At(1));
+         if (gr) {
+            lists[fold]->Remove(gr);
+            fResults.GetROCCurves()->Add(gr);
+         }
+         delete lists[fold];
       }
    }
   
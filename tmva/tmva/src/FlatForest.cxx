@@ -0,0 +1,165 @@
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : FlatForest                                                            *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Forest of decision trees flattened into contiguous node arrays, for       *
+ *      the evaluation of blocks of events                                        *
+ *                                                                                *
+ * Copyright (c) 2016:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+//_______________________________________________________________________
+//
+// FlatForest
+//
+// The nodes of all trees of a forest are stored in a few contiguous
+// arrays (selector variable, cut value, daughter indices, leaf value)
+// instead of heap allocated DecisionTreeNode objects. The cut type of
+// a node is folded into the order of its daughters, and a leaf points
+// to itself, so that an event is passed through a tree by exactly
+// "depth" identical steps without any branch on the node type.
+// Evaluate() walks a block of events through one tree at a time,
+// which keeps the nodes of the tree in cache and lets the compiler
+// vectorise the loop over the events of the block.
+//_______________________________________________________________________
+
+#include "TMVA/FlatForest.h"
+#include "TMVA/DecisionTree.h"
+#include "TMVA/DecisionTreeNode.h"
+
+namespace {
+   // number of events walked through a tree together
+   const UInt_t kBlockSize = 64;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// constructor
+
+TMVA::FlatForest::FlatForest() :
+   fFailed(kFALSE)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// destructor
+
+TMVA::FlatForest::~FlatForest()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// remove all trees
+
+void TMVA::FlatForest::Clear()
+{
+   fVar.clear();
+   fCut.clear();
+   fDaughter.clear();
+   fLeaf.clear();
+   fRoot.clear();
+   fDepth.clear();
+   fWeight.clear();
+   fFailed = kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// flatten the trees of the forest. The leaf value is the response for
+/// regression trees, and the node type (useYesNoLeaf) or the purity
+/// otherwise, as in DecisionTree::CheckEvent
+
+Bool_t TMVA::FlatForest::Build( const std::vector<DecisionTree*>& forest, const std::vector<Double_t>& weights,
+                                Bool_t useYesNoLeaf )
+{
+   Clear();
+   for (UInt_t itree=0; itree<forest.size() && !fFailed; itree++) {
+      UInt_t maxDepth = 0;
+      fRoot.push_back(AddNode(forest[itree]->GetRoot(), forest[itree]->DoRegression(), useYesNoLeaf, 0, maxDepth));
+      fDepth.push_back(maxDepth);
+      fWeight.push_back(weights[itree]);
+   }
+   if (fFailed) {
+      Clear();
+      return kFALSE;
+   }
+   return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// add a node and its daughters, return the index of the node
+
+UInt_t TMVA::FlatForest::AddNode( const DecisionTreeNode* node, Bool_t regression, Bool_t useYesNoLeaf,
+                                  UInt_t depth, UInt_t& maxDepth )
+{
+   UInt_t inode = fVar.size();
+   fVar.push_back(0);
+   fCut.push_back(0);
+   fDaughter.push_back(inode);
+   fDaughter.push_back(inode);
+   fLeaf.push_back(0);
+   if (depth > maxDepth) maxDepth = depth;
+
+   if (node == 0) {
+      fFailed = kTRUE;
+      return inode;
+   }
+
+   if (node->GetNodeType() != 0) { // leaf
+      if (regression)        fLeaf[inode] = node->GetResponse();
+      else if (useYesNoLeaf) fLeaf[inode] = Double_t(node->GetNodeType());
+      else                   fLeaf[inode] = node->GetPurity();
+      return inode;
+   }
+
+   if (node->GetNFisherCoeff() != 0 || node->GetLeft() == 0 || node->GetRight() == 0) {
+      fFailed = kTRUE;
+      return inode;
+   }
+
+   fVar[inode] = node->GetSelector();
+   fCut[inode] = node->GetCutValue();
+   UInt_t right = AddNode(node->GetRight(), regression, useYesNoLeaf, depth+1, maxDepth);
+   UInt_t left  = AddNode(node->GetLeft(),  regression, useYesNoLeaf, depth+1, maxDepth);
+   // an event goes right if (x>=cut) == cutType
+   fDaughter[2*inode+1] = node->GetCutType() ? right : left;
+   fDaughter[2*inode]   = node->GetCutType() ? left  : right;
+   return inode;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// add the weighted leaf values of all trees for nEvents events to sum
+
+void TMVA::FlatForest::Evaluate( const Float_t* x, UInt_t stride, UInt_t nEvents, Double_t* sum ) const
+{
+   const UInt_t*   var      = fVar.empty() ? 0 : &fVar[0];
+   const Float_t*  cut      = fCut.empty() ? 0 : &fCut[0];
+   const UInt_t*   daughter = fDaughter.empty() ? 0 : &fDaughter[0];
+   const Double_t* leaf     = fLeaf.empty() ? 0 : &fLeaf[0];
+
+   UInt_t node[kBlockSize];
+   for (UInt_t first=0; first<nEvents; first+=kBlockSize) {
+      const UInt_t n = (nEvents-first < kBlockSize) ? nEvents-first : kBlockSize;
+      const Float_t* xb = x + first;
+      Double_t* sb = sum + first;
+      for (UInt_t itree=0; itree<fRoot.size(); itree++) {
+         const UInt_t root = fRoot[itree];
+         for (UInt_t k=0; k<n; k++) node[k] = root;
+         for (UInt_t d=0; d<fDepth[itree]; d++) {
+            for (UInt_t k=0; k<n; k++) {
+               const UInt_t i = node[k];
+               node[k] = daughter[2*i + (xb[var[i]*stride+k] >= cut[i])];
+            }
+         }
+         const Double_t w = fWeight[itree];
+         for (UInt_t k=0; k<n; k++) sb[k] += w*leaf[node[k]];
+      }
+   }
+}
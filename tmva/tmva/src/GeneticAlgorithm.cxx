@@ -158,10 +158,17 @@ Double_t TMVA::GeneticAlgorithm::CalculateFitness()
 
 #else 
 
+   // the estimators of the whole population are requested at once, so that
+   // the fitter target may evaluate them concurrently
+   std::vector< std::vector<Double_t> > factors;
+   for ( int index = 0; index < fPopulation.GetPopulationSize(); ++index )
+      factors.push_back( fPopulation.GetGenes(index)->GetFactors() );
+   std::vector<Double_t> estimators;
+   fFitterTarget.EstimatorFunctions( factors, estimators );
+
    for ( int index = 0; index < fPopulation.GetPopulationSize(); ++index ) {
       GeneticGenes* genes = fPopulation.GetGenes(index);
-      Double_t fitness = NewFitness( genes->GetFitness(),
-                                     fFitterTarget.EstimatorFunction(genes->GetFactors()) );
+      Double_t fitness = NewFitness( genes->GetFitness(), estimators[index] );
       genes->SetFitness( fitness );
       
       if ( fBestFitness  > fitness )
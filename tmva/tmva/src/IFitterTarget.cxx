@@ -45,3 +45,13 @@ TMVA::IFitterTarget::IFitterTarget()
 {
 }            
 
+////////////////////////////////////////////////////////////////////////////////
+/// fill estimators with the estimator of each parameter set, in the same
+/// order; targets which can evaluate several sets concurrently override it
+
+void TMVA::IFitterTarget::EstimatorFunctions( std::vector< std::vector<Double_t> >& parameters,
+                                              std::vector<Double_t>& estimators )
+{
+   estimators.resize(parameters.size());
+   for (UInt_t i=0; i<parameters.size(); i++) estimators[i] = EstimatorFunction(parameters[i]);
+}
@@ -123,6 +123,7 @@
 #include "TMVA/CrossEntropy.h"
 #include "TMVA/DecisionTree.h"
 #include "TMVA/DataSet.h"
+#include "TMVA/FlatForest.h"
 #include "TMVA/GiniIndex.h"
 #include "TMVA/GiniIndexWithLaplace.h"
 #include "TMVA/Interval.h"
@@ -132,11 +133,13 @@
 #include "TMVA/MsgLogger.h"
 #include "TMVA/OptimizeConfigParameters.h"
 #include "TMVA/PDF.h"
+#include "TMVA/QuantizedEventSample.h"
 #include "TMVA/Ranking.h"
 #include "TMVA/Results.h"
 #include "TMVA/ResultsMulticlass.h"
 #include "TMVA/SdivSqrtSplusB.h"
 #include "TMVA/SeparationBase.h"
+#include "TMVA/StreamingDataLoader.h"
 #include "TMVA/Timer.h"
 #include "TMVA/Tools.h"
 #include "TMVA/Types.h"
@@ -161,6 +164,7 @@ TMVA::MethodBDT::MethodBDT( const TString& jobName,
                             const TString& theOption ) :
    TMVA::MethodBase( jobName, Types::kBDT, methodTitle, theData, theOption)
    , fTrainSample(0)
+   , fStream(0)
    , fNTrees(0)
    , fSigToBkgFraction(0) 
    , fAdaBoostBeta(0)
@@ -176,6 +180,11 @@ TMVA::MethodBDT::MethodBDT( const TString& jobName,
    , fUseFisherCuts(0)        // don't use this initialisation, only here to make  Coverity happy. Is set in DeclarOptions()
    , fMinLinCorrForFisher(.8) // don't use this initialisation, only here to make  Coverity happy. Is set in DeclarOptions()
    , fUseExclusiveVars(0)     // don't use this initialisation, only here to make  Coverity happy. Is set in DeclarOptions()
+   , fUseHistTraining(kFALSE)
+   , fNHistBins(256)
+   , fQuantizedSample(0)
+   , fFlatForest(0)
+   , fMakeClassStyle("Nodes")
    , fUseYesNoLeaf(kFALSE)
    , fNodePurityLimit(0)
    , fNNodesMax(0)
@@ -214,6 +223,7 @@ TMVA::MethodBDT::MethodBDT( DataSetInfo& theData,
                             const TString& theWeightFile)
    : TMVA::MethodBase( Types::kBDT, theData, theWeightFile)
    , fTrainSample(0)
+   , fStream(0)
    , fNTrees(0)
    , fSigToBkgFraction(0) 
    , fAdaBoostBeta(0)
@@ -229,6 +239,11 @@ TMVA::MethodBDT::MethodBDT( DataSetInfo& theData,
    , fUseFisherCuts(0)        // don't use this initialisation, only here to make  Coverity happy. Is set in DeclarOptions()
    , fMinLinCorrForFisher(.8) // don't use this initialisation, only here to make  Coverity happy. Is set in DeclarOptions()
    , fUseExclusiveVars(0)     // don't use this initialisation, only here to make  Coverity happy. Is set in DeclarOptions()
+   , fUseHistTraining(kFALSE)
+   , fNHistBins(256)
+   , fQuantizedSample(0)
+   , fFlatForest(0)
+   , fMakeClassStyle("Nodes")
    , fUseYesNoLeaf(kFALSE)
    , fNodePurityLimit(0)
    , fNNodesMax(0)
@@ -298,6 +313,9 @@ Bool_t TMVA::MethodBDT::HasAnalysisType( Types::EAnalysisType type, UInt_t numbe
 /// nCuts:           the number of steps in the optimisation of the cut for a node (if < 0, then
 ///                  step size is determined by the events)
 /// UseFisherCuts:   use multivariate splits using the Fisher criterion
+/// UseHistTraining: quantize the input variables once into at most NHistBins bins and
+///                  grow the trees from per-bin sums (histogram training)
+/// NHistBins        number of bins per variable in histogram training (2..256)
 /// UseYesNoLeaf     decide if the classification is done simply by the node type, or the S/B
 ///                  (from the training) in the leaf node
 /// NodePurityLimit  the minimum purity to classify a node as a signal node (used in pruning and boosting to determine
@@ -312,6 +330,10 @@ Bool_t TMVA::MethodBDT::HasAnalysisType( Types::EAnalysisType type, UInt_t numbe
 ///                         DecreaseBoostWeight     Boost ev. with neg. weight with 1/boostweight instead of boostweight
 ///                         PairNegWeightsGlobal    Pair ev. with neg. and pos. weights in traning sample and "annihilate" them 
 /// MaxDepth         maximum depth of the decision tree allowed before further splitting is stopped
+/// MakeClassStyle   layout of the forest in the standalone class written by MakeClass
+///                  known: Nodes       // linked node objects (default)
+///                         FlatArrays  // static node arrays walked without branches
+///                         NestedIf    // one function of nested if statements per tree
 
 void TMVA::MethodBDT::DeclareOptions()
 {
@@ -326,6 +348,8 @@ void TMVA::MethodBDT::DeclareOptions()
    DeclareOptionRef(fMinNodeSizeS=tmp, "MinNodeSize", "Minimum percentage of training events required in a leaf node (default: Classification: 5%, Regression: 0.2%)");
    // MinNodeSize:     minimum percentage of training events in a leaf node (leaf criteria, stop splitting)
    DeclareOptionRef(fNCuts, "nCuts", "Number of grid points in variable range used in finding optimal cut in node splitting");
+   DeclareOptionRef(fUseHistTraining=kFALSE, "UseHistTraining", "Quantize the input variables once and grow the trees from the per-bin sums of the quantized sample (faster for large samples, the cuts are placed at the bin edges)");
+   DeclareOptionRef(fNHistBins=256, "NHistBins", "Number of bins per variable (at most 256) used with UseHistTraining, the bin edges are chosen at the quantiles of each variable");
 
    DeclareOptionRef(fBoostType, "BoostType", "Boosting type for the trees in the forest (note: AdaCost is still experimental)");
 
@@ -399,6 +423,11 @@ void TMVA::MethodBDT::DeclareOptions()
 
    DeclareOptionRef(fDoPreselection=kFALSE,"DoPreselection","and and apply automatic pre-selection for 100% efficient signal (bkg) cuts prior to training");
 
+   DeclareOptionRef(fMakeClassStyle="Nodes","MakeClassStyle","Layout of the forest in the standalone class written by MakeClass (FlatArrays and NestedIf are only available for classification without Fisher cuts)");
+   AddPreDefVal(TString("Nodes"));
+   AddPreDefVal(TString("FlatArrays"));
+   AddPreDefVal(TString("NestedIf"));
+
 
    DeclareOptionRef(fSigToBkgFraction=1,"SigToBkgFraction","Sig to Bkg ratio used in Training (similar to NodePurityLimit, which cannot be used in real adaboost"); 
 
@@ -553,6 +582,16 @@ void TMVA::MethodBDT::ProcessOptions()
          fNCuts=20;
       }
    }
+   if (fUseHistTraining) {
+      if (fUseFisherCuts) {
+         Log() << kWARNING << "UseFisherCuts is not available with UseHistTraining --> I switch off UseHistTraining" << Endl;
+         fUseHistTraining = kFALSE;
+      }
+      if (fNHistBins < 2 || fNHistBins > 256) {
+         Log() << kWARNING << "NHistBins=" << fNHistBins << " is out of the range 2..256 used in histogram training --> I set it to 256" << Endl;
+         fNHistBins = 256;
+      }
+   }
    if (fRandomisedTrees){
       Log() << kINFO << " Randomised trees use no pruning" << Endl;
       fPruneMethod = DecisionTree::kNoPruning;
@@ -693,6 +732,7 @@ void TMVA::MethodBDT::Reset( void )
    // remove all the trees 
    for (UInt_t i=0; i<fForest.size();           i++) delete fForest[i];
    fForest.clear();
+   delete fFlatForest; fFlatForest = 0;
 
    fBoostWeights.clear();
    if (fMonitorNtuple) { fMonitorNtuple->Delete(); fMonitorNtuple=NULL; }
@@ -716,6 +756,10 @@ void TMVA::MethodBDT::Reset( void )
 TMVA::MethodBDT::~MethodBDT( void )
 {
    for (UInt_t i=0; i<fForest.size();           i++) delete fForest[i];
+   delete fQuantizedSample;
+   delete fFlatForest;
+   delete fStream;
+   for (UInt_t i=0; i<fStreamedSample.size(); i++) delete fStreamedSample[i];
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -863,7 +907,11 @@ void TMVA::MethodBDT::InitEventSample( void )
    }
    
    fTrainSample = &fEventSample;
-   if (fBaggedBoost){
+   if (fStream){
+      GetStreamedSubSample();
+      fTrainSample = &fSubSample;
+   }
+   else if (fBaggedBoost){
       GetBaggedSubSample(fEventSample);
       fTrainSample = &fSubSample;
    }
@@ -1104,6 +1152,30 @@ void TMVA::MethodBDT::Train()
 {
    TMVA::DecisionTreeNode::fgIsTraining=true;
 
+   delete fFlatForest; fFlatForest = 0;
+
+   // with StreamTraining, each bagged tree is grown on the next buffer read
+   // from the training trees instead of a resampling of the events in memory
+   delete fStream; fStream = 0;
+   if (DataInfo().IsStreamTraining()) {
+      if (fBoostType != "Bagging") {
+         Log() << kWARNING << "StreamTraining is only supported with BoostType=Bagging, "
+               << "the training events kept in memory are used" << Endl;
+      }
+      else {
+         fStream = CreateStreamingDataLoader(1234);
+         if (fStream) {
+            fStream->SetBagging(fBaggedSampleFraction);
+            if (fUseHistTraining) {
+               Log() << kWARNING << "UseHistTraining is not available with StreamTraining --> I switch off UseHistTraining" << Endl;
+               fUseHistTraining = kFALSE;
+            }
+            Log() << kINFO << "Each tree is grown on a bagged buffer of " << fStream->GetBufferSize()
+                  << " events streamed from the " << fStream->GetNEntries() << " entries of the training trees" << Endl;
+         }
+      }
+   }
+
    // fill the STL Vector with the event sample
    // (needs to be done here and cannot be done in "init" as the options need to be 
    // known). 
@@ -1216,6 +1288,14 @@ void TMVA::MethodBDT::Train()
       InitGradBoost(fEventSample);
    }
 
+   // quantize the input variables once for the histogram training
+   if (fUseHistTraining) {
+      delete fQuantizedSample;
+      fQuantizedSample = new QuantizedEventSample(fEventSample, GetNvar(), fNHistBins);
+      Log() << kINFO << "Histogram training: input variables quantized into at most "
+            << fQuantizedSample->GetMaxBins() << " bins" << Endl;
+   }
+
    Int_t itree=0;
    Bool_t continueBoost=kTRUE;
    //for (int itree=0; itree<fNTrees; itree++) {
@@ -1243,6 +1323,7 @@ void TMVA::MethodBDT::Train()
                                                  fRandomisedTrees, fUseNvars, fUsePoissonNvars, fMaxDepth,
                                                  itree*nClasses+i, fNodePurityLimit, itree*nClasses+1));
             fForest.back()->SetNVars(GetNvar());
+            if (fQuantizedSample) fForest.back()->SetQuantizedSample(fQuantizedSample);
             if (fUseFisherCuts) {
                fForest.back()->SetUseFisherCuts();
                fForest.back()->SetMinLinCorrForFisher(fMinLinCorrForFisher); 
@@ -1267,6 +1348,7 @@ void TMVA::MethodBDT::Train()
                                               fRandomisedTrees, fUseNvars, fUsePoissonNvars, fMaxDepth,
                                               itree, fNodePurityLimit, itree));
          fForest.back()->SetNVars(GetNvar());
+         if (fQuantizedSample) fForest.back()->SetQuantizedSample(fQuantizedSample);
          if (fUseFisherCuts) {
             fForest.back()->SetUseFisherCuts();
             fForest.back()->SetMinLinCorrForFisher(fMinLinCorrForFisher); 
@@ -1348,10 +1430,18 @@ void TMVA::MethodBDT::Train()
    // reset all previously stored/accumulated BOOST weights in the event sample
    //   for (UInt_t iev=0; iev<fEventSample.size(); iev++) fEventSample[iev]->SetBoostWeight(1.);
    Log() << kDEBUG << "Now I delete the privat data sample"<< Endl;
+   for (UInt_t i=0; i<fForest.size(); i++) fForest[i]->SetQuantizedSample(0);
+   delete fQuantizedSample;
+   fQuantizedSample = 0;
    for (UInt_t i=0; i<fEventSample.size();      i++) delete fEventSample[i];
    for (UInt_t i=0; i<fValidationSample.size(); i++) delete fValidationSample[i];
+   for (UInt_t i=0; i<fStreamedSample.size();   i++) delete fStreamedSample[i];
    fEventSample.clear();
    fValidationSample.clear();
+   fStreamedSample.clear();
+   fSubSample.clear();
+   delete fStream;
+   fStream = 0;
 
 }
 
@@ -1604,7 +1694,10 @@ Double_t TMVA::MethodBDT::Boost( std::vector<const TMVA::Event*>& eventSample, D
       Log() << kFATAL << "<Boost> unknown boost option " << fBoostType<< " called" << Endl;
    }
 
-   if (fBaggedBoost){
+   if (fStream){
+      GetStreamedSubSample();
+   }
+   else if (fBaggedBoost){
       GetBaggedSubSample(fEventSample);
    }
 
@@ -2051,6 +2144,53 @@ void TMVA::MethodBDT::GetBaggedSubSample(std::vector<const TMVA::Event*>& eventS
 
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// fills fSubSample with the next buffer streamed from the training trees
+/// (StreamTraining). The events of the buffer are repeated a Poisson
+/// distributed number of times of mean fBaggedSampleFraction, and filtered
+/// and normalised as the events of fEventSample in InitEventSample. After
+/// the last buffer, the next pass over the trees is started
+
+void TMVA::MethodBDT::GetStreamedSubSample()
+{
+   for (UInt_t i=0; i<fStreamedSample.size(); i++) delete fStreamedSample[i];
+   fStreamedSample.clear();
+   fSubSample.clear();
+
+   const std::vector<TMVA::Event*>* buffer = &fStream->NextBuffer();
+   if (buffer->empty()) {
+      fStream->Rewind();
+      buffer = &fStream->NextBuffer();
+      if (buffer->empty()) Log() << kFATAL << "<GetStreamedSubSample> no event read from the training trees" << Endl;
+   }
+
+   Double_t sumSigW=0, sumBkgW=0;
+   for (UInt_t ievt=0; ievt<buffer->size(); ievt++) {
+      Event* event = new Event( *GetTransformationHandler().Transform((*buffer)[ievt]) );
+      if ((fDoPreselection && TMath::Abs(ApplyPreselectionCuts(event)) > 0.05) ||
+          (event->GetWeight() < 0 && (IgnoreEventsWithNegWeightsInTraining() || fNoNegWeightsInTraining)) ||
+          event->GetWeight() == 0) {
+         delete event;
+         continue;
+      }
+      if (DataInfo().IsSignal(event)) sumSigW += event->GetWeight();
+      else                            sumBkgW += event->GetWeight();
+      fStreamedSample.push_back(event);
+   }
+
+   if (!DoRegression() && sumSigW && sumBkgW) {
+      Double_t nevents = fStreamedSample.size();
+      Double_t normSig = nevents/((1+fSigToBkgFraction)*sumSigW)*fSigToBkgFraction;
+      Double_t normBkg = nevents/((1+fSigToBkgFraction)*sumBkgW);
+      for (UInt_t ievt=0; ievt<fStreamedSample.size(); ievt++) {
+         Event* event = const_cast<Event*>(fStreamedSample[ievt]);
+         event->SetBoostWeight(DataInfo().IsSignal(event) ? normSig : normBkg);
+      }
+   }
+
+   fSubSample = fStreamedSample;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// a special boosting only for Regression ...
 /// maybe I'll implement it later...
@@ -2216,6 +2356,7 @@ void TMVA::MethodBDT::ReadWeightsFromXML(void* parent) {
    for (i=0; i<fForest.size(); i++) delete fForest[i];
    fForest.clear();
    fBoostWeights.clear();
+   delete fFlatForest; fFlatForest = 0;
 
    UInt_t ntrees;
    UInt_t analysisType;
@@ -2284,6 +2425,8 @@ void  TMVA::MethodBDT::ReadWeightsFromStream( std::istream& istr )
    //   Types::EAnalysisType analysisType;
    Int_t analysisType(0);
 
+   delete fFlatForest; fFlatForest = 0;
+
    // coverity[tainted_data_argument]
    istr >> dummy >> fNTrees;
    Log() << kINFO << "Read " << fNTrees << " Decision trees" << Endl;
@@ -2361,6 +2504,71 @@ Double_t TMVA::MethodBDT::PrivateGetMvaValue(const TMVA::Event* ev, Double_t* er
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Return the MVA values of nEvents events given as column-major array of the
+/// input variables, inputs[ivar*nEvents+ievt]. The forest is flattened into
+/// contiguous node arrays (FlatForest) on first use and the events are passed
+/// through it in blocks; the variable transformations are applied to the
+/// events of a block before the trees are evaluated. The result is identical to the one of
+/// GetMvaValue. Regression, multiclass, preselection cuts and Fisher cuts use
+/// the event-by-event evaluation.
+
+void TMVA::MethodBDT::GetBatchMvaValues( const Float_t* inputs, UInt_t nEvents, Double_t* mvaValues )
+{
+   const Bool_t gradBoost = (fBoostType=="Grad");
+   if (DoRegression() || DoMulticlass() || fDoPreselection || fForest.empty()) {
+      MethodBase::GetBatchMvaValues(inputs, nEvents, mvaValues);
+      return;
+   }
+   if (fFlatForest == 0) {
+      fFlatForest = new FlatForest();
+      std::vector<Double_t> weights(fForest.size(), 1.);
+      if (!gradBoost) for (UInt_t itree=0; itree<fForest.size(); itree++) weights[itree] = fBoostWeights[itree];
+      if (!fFlatForest->Build(fForest, weights, gradBoost ? kFALSE : fUseYesNoLeaf)) {
+         Log() << kINFO << "<GetBatchMvaValues> the forest uses Fisher cuts and is evaluated event by event" << Endl;
+      }
+   }
+   if (fFlatForest->GetNTrees() == 0) {
+      MethodBase::GetBatchMvaValues(inputs, nEvents, mvaValues);
+      return;
+   }
+
+   Double_t norm = 0;
+   for (UInt_t itree=0; itree<fForest.size(); itree++) norm += fBoostWeights[itree];
+
+   const UInt_t nvar = GetNvar();
+   const Bool_t transform = GetTransformationHandler().GetNumOfTransformations() > 0;
+   const UInt_t blockSize = 256;
+   std::vector<Float_t> block;
+   Event ev(std::vector<Float_t>(nvar), 0);
+   if (transform) block.resize(nvar*blockSize);
+
+   for (UInt_t first=0; first<nEvents; first+=blockSize) {
+      const UInt_t n = TMath::Min(blockSize, nEvents-first);
+      const Float_t* x = inputs+first;
+      UInt_t stride = nEvents;
+      if (transform) {
+         for (UInt_t k=0; k<n; k++) {
+            for (UInt_t ivar=0; ivar<nvar; ivar++) ev.SetVal(ivar, inputs[ivar*nEvents+first+k]);
+            const Event* tev = GetTransformationHandler().Transform(&ev);
+            for (UInt_t ivar=0; ivar<nvar; ivar++) block[ivar*n+k] = tev->GetValue(ivar);
+         }
+         x = &block[0];
+         stride = n;
+      }
+
+      Double_t* sum = mvaValues+first;
+      for (UInt_t k=0; k<n; k++) sum[k] = 0;
+      fFlatForest->Evaluate(x, stride, n, sum);
+
+      if (gradBoost) {
+         for (UInt_t k=0; k<n; k++) sum[k] = 2.0/(1.0+exp(-2.0*sum[k]))-1;
+      } else {
+         for (UInt_t k=0; k<n; k++) sum[k] = ( norm > std::numeric_limits<double>::epsilon() ) ? sum[k]/norm : 0;
+      }
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// get the multiclass MVA response for the BDT classifier
 
@@ -2619,6 +2827,11 @@ void TMVA::MethodBDT::GetHelpMessage() const
 
 void TMVA::MethodBDT::MakeClassSpecific( std::ostream& fout, const TString& className ) const
 {
+   if (UseFlatMakeClass()) {
+      MakeClassFlatForest( fout, className );
+      return;
+   }
+
    TString nodeName = className;
    nodeName.ReplaceAll("Read","");
    nodeName.Append("Node");
@@ -2629,22 +2842,7 @@ void TMVA::MethodBDT::MakeClassSpecific( std::ostream& fout, const TString& clas
    fout << "double " << className << "::GetMvaValue__( const std::vector<double>& inputValues ) const" << std::endl;
    fout << "{" << std::endl;
    fout << "   double myMVA = 0;" << std::endl;
-   if (fDoPreselection){
-      for (UInt_t ivar = 0; ivar< fIsLowBkgCut.size(); ivar++){
-         if (fIsLowBkgCut[ivar]){
-            fout << "   if (inputValues["<<ivar<<"] < " << fLowBkgCut[ivar] << ") return -1;  // is background preselection cut" << std::endl;
-         }
-         if (fIsLowSigCut[ivar]){
-            fout << "   if (inputValues["<<ivar<<"] < "<< fLowSigCut[ivar] << ") return  1;  // is signal preselection cut" << std::endl;
-         }
-         if (fIsHighBkgCut[ivar]){
-            fout << "   if (inputValues["<<ivar<<"] > "<<fHighBkgCut[ivar] <<")  return -1;  // is background preselection cut" << std::endl;
-         }
-         if (fIsHighSigCut[ivar]){
-            fout << "   if (inputValues["<<ivar<<"] > "<<fHighSigCut[ivar]<<")  return  1;  // is signal preselection cut" << std::endl;
-         }
-      }
-   }
+   if (fDoPreselection) MakeClassPreselection( fout );
 
    if (fBoostType!="Grad"){
       fout << "   double norm  = 0;" << std::endl;
@@ -2695,6 +2893,13 @@ void TMVA::MethodBDT::MakeClassSpecific( std::ostream& fout, const TString& clas
 
 void TMVA::MethodBDT::MakeClassSpecificHeader(  std::ostream& fout, const TString& className) const
 {
+   if (fMakeClassStyle != "Nodes" && !UseFlatMakeClass()) {
+      Log() << kWARNING << "MakeClassStyle=" << fMakeClassStyle << " is only available for classification without Fisher cuts"
+            << " --> the standalone class is written with MakeClassStyle=Nodes" << Endl;
+   }
+   // the flattened forest does not need any auxiliary class
+   if (UseFlatMakeClass()) return;
+
    TString nodeName = className;
    nodeName.ReplaceAll("Read","");
    nodeName.Append("Node");
@@ -2844,6 +3049,213 @@ void TMVA::MethodBDT::MakeClassInstantiateNode( DecisionTreeNode *n, std::ostrea
         << n->GetResponse() << ") ";
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// write the preselection cuts at the beginning of GetMvaValue__ of the standalone class
+
+void TMVA::MethodBDT::MakeClassPreselection( std::ostream& fout ) const
+{
+   for (UInt_t ivar = 0; ivar< fIsLowBkgCut.size(); ivar++){
+      if (fIsLowBkgCut[ivar]){
+         fout << "   if (inputValues["<<ivar<<"] < " << fLowBkgCut[ivar] << ") return -1;  // is background preselection cut" << std::endl;
+      }
+      if (fIsLowSigCut[ivar]){
+         fout << "   if (inputValues["<<ivar<<"] < "<< fLowSigCut[ivar] << ") return  1;  // is signal preselection cut" << std::endl;
+      }
+      if (fIsHighBkgCut[ivar]){
+         fout << "   if (inputValues["<<ivar<<"] > "<<fHighBkgCut[ivar] <<")  return -1;  // is background preselection cut" << std::endl;
+      }
+      if (fIsHighSigCut[ivar]){
+         fout << "   if (inputValues["<<ivar<<"] > "<<fHighSigCut[ivar]<<")  return  1;  // is signal preselection cut" << std::endl;
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// true if MakeClass writes the forest as flattened arrays or nested if statements
+/// (MakeClassStyle FlatArrays or NestedIf) instead of linked node objects
+
+Bool_t TMVA::MethodBDT::UseFlatMakeClass() const
+{
+   if (fMakeClassStyle != "FlatArrays" && fMakeClassStyle != "NestedIf") return kFALSE;
+   if (DoRegression() || DoMulticlass() || fUseFisherCuts || fForest.empty()) return kFALSE;
+   return kTRUE;
+}
+
+namespace {
+   // write a cut value as float literal that converts back to the same float
+   void WriteFloatLiteral( std::ostream& fout, Float_t x )
+   {
+      std::ios_base::fmtflags flags = fout.flags();
+      std::streamsize prec = fout.precision();
+      fout << std::scientific << std::setprecision(8) << x << "f";
+      fout.flags(flags);
+      fout.precision(prec);
+   }
+   // write a double literal that converts back to the same double
+   void WriteDoubleLiteral( std::ostream& fout, Double_t x )
+   {
+      std::ios_base::fmtflags flags = fout.flags();
+      std::streamsize prec = fout.precision();
+      fout << std::scientific << std::setprecision(16) << x;
+      fout.flags(flags);
+      fout.precision(prec);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Write the classifier response of the standalone class for a flattened forest.
+/// With MakeClassStyle=FlatArrays the nodes of all trees are written as static
+/// constant arrays (see FlatForest) and every tree is walked by a fixed number
+/// of branch-free steps; with MakeClassStyle=NestedIf every tree becomes a
+/// function of nested if statements, which the compiler can inline. The cuts
+/// are compared as in DecisionTreeNode::GoesRight and the trees are summed in
+/// the same order as in GetMvaValue, so the response is the one of the Reader.
+
+void TMVA::MethodBDT::MakeClassFlatForest( std::ostream& fout, const TString& className ) const
+{
+   const Bool_t gradBoost = (fBoostType=="Grad");
+   const Bool_t nestedIf  = (fMakeClassStyle=="NestedIf");
+
+   FlatForest forest;
+   std::vector<Double_t> weights(fForest.size(), 1.);
+   if (!gradBoost) for (UInt_t itree=0; itree<fForest.size(); itree++) weights[itree] = fBoostWeights[itree];
+   if (!forest.Build(fForest, weights, gradBoost ? kFALSE : fUseYesNoLeaf)) {
+      Log() << kFATAL << "<MakeClassFlatForest> the forest could not be flattened" << Endl;
+      return;
+   }
+   Double_t norm = 0;
+   for (UInt_t itree=0; itree<fForest.size(); itree++) norm += fBoostWeights[itree];
+
+   const UInt_t nTrees = forest.GetNTrees();
+   const UInt_t nNodes = forest.GetNNodes();
+
+   // remaining members of the class
+   if (nestedIf) {
+      for (UInt_t itree=0; itree<nTrees; itree++)
+         fout << "   double Tree" << itree << "( const std::vector<double>& x ) const;" << std::endl;
+   }
+   else {
+      fout << "   static const int    fRoot[" << nTrees << "];         // root node of each tree" << std::endl;
+      fout << "   static const int    fDepth[" << nTrees << "];        // number of steps from the root to the deepest leaf" << std::endl;
+      fout << "   static const int    fVar[" << nNodes << "];          // selector variable of each node" << std::endl;
+      fout << "   static const float  fCut[" << nNodes << "];          // cut value of each node" << std::endl;
+      fout << "   static const int    fDaughter[" << 2*nNodes << "];   // [2*inode+(x>=cut)] next node, leaves point to themselves" << std::endl;
+      fout << "   static const double fLeaf[" << nNodes << "];         // leaf value of each node" << std::endl;
+   }
+   fout << "   static const double fBoostWeights[" << nTrees << "]; // the weights applied in the individual boosts" << std::endl;
+   fout << "};" << std::endl << std::endl;
+
+   // classifier response
+   fout << "double " << className << "::GetMvaValue__( const std::vector<double>& inputValues ) const" << std::endl;
+   fout << "{" << std::endl;
+   if (fDoPreselection) MakeClassPreselection( fout );
+   fout << "   double myMVA = 0;" << std::endl;
+   if (nestedIf) {
+      for (UInt_t itree=0; itree<nTrees; itree++)
+         fout << "   myMVA += fBoostWeights[" << itree << "] * Tree" << itree << "( inputValues );" << std::endl;
+   }
+   else {
+      fout << "   for (int itree=0; itree<" << nTrees << "; itree++) {" << std::endl;
+      fout << "      int inode = fRoot[itree];" << std::endl;
+      fout << "      for (int idepth=0; idepth<fDepth[itree]; idepth++)" << std::endl;
+      fout << "         inode = fDaughter[2*inode + (inputValues[fVar[inode]] >= fCut[inode])];" << std::endl;
+      fout << "      myMVA += fBoostWeights[itree] * fLeaf[inode];" << std::endl;
+      fout << "   }" << std::endl;
+   }
+   if (gradBoost) {
+      fout << "   return 2.0/(1.0+exp(-2.0*myMVA))-1.0;" << std::endl;
+   }
+   else if (norm > std::numeric_limits<double>::epsilon()) {
+      fout << "   return myMVA / ";
+      WriteDoubleLiteral( fout, norm );
+      fout << ";" << std::endl;
+   }
+   else {
+      fout << "   return 0;" << std::endl;
+   }
+   fout << "}" << std::endl << std::endl;
+
+   if (nestedIf) {
+      for (UInt_t itree=0; itree<nTrees; itree++) {
+         fout << "inline double " << className << "::Tree" << itree << "( const std::vector<double>& x ) const" << std::endl;
+         fout << "{" << std::endl;
+         MakeClassNestedIfNode( fout, forest, forest.GetRoot(itree), "   " );
+         fout << "}" << std::endl << std::endl;
+      }
+   }
+   else {
+      fout << "const int " << className << "::fRoot[" << nTrees << "] = {";
+      for (UInt_t itree=0; itree<nTrees; itree++)
+         fout << (itree%10==0 ? "\n   " : " ") << forest.GetRoot(itree) << (itree+1<nTrees ? "," : "");
+      fout << " };" << std::endl;
+      fout << "const int " << className << "::fDepth[" << nTrees << "] = {";
+      for (UInt_t itree=0; itree<nTrees; itree++)
+         fout << (itree%10==0 ? "\n   " : " ") << forest.GetDepth(itree) << (itree+1<nTrees ? "," : "");
+      fout << " };" << std::endl;
+      fout << "const int " << className << "::fVar[" << nNodes << "] = {";
+      for (UInt_t inode=0; inode<nNodes; inode++)
+         fout << (inode%10==0 ? "\n   " : " ") << forest.GetVar(inode) << (inode+1<nNodes ? "," : "");
+      fout << " };" << std::endl;
+      fout << "const float " << className << "::fCut[" << nNodes << "] = {";
+      for (UInt_t inode=0; inode<nNodes; inode++) {
+         fout << (inode%4==0 ? "\n   " : " ");
+         WriteFloatLiteral( fout, forest.GetCut(inode) );
+         if (inode+1<nNodes) fout << ",";
+      }
+      fout << " };" << std::endl;
+      fout << "const int " << className << "::fDaughter[" << 2*nNodes << "] = {";
+      for (UInt_t inode=0; inode<nNodes; inode++)
+         fout << (inode%5==0 ? "\n   " : " ") << forest.GetDaughter(inode,kFALSE) << ", " << forest.GetDaughter(inode,kTRUE)
+              << (inode+1<nNodes ? "," : "");
+      fout << " };" << std::endl;
+      fout << "const double " << className << "::fLeaf[" << nNodes << "] = {";
+      for (UInt_t inode=0; inode<nNodes; inode++) {
+         fout << (inode%4==0 ? "\n   " : " ");
+         WriteDoubleLiteral( fout, forest.GetLeafValue(inode) );
+         if (inode+1<nNodes) fout << ",";
+      }
+      fout << " };" << std::endl;
+   }
+   fout << "const double " << className << "::fBoostWeights[" << nTrees << "] = {";
+   for (UInt_t itree=0; itree<nTrees; itree++) {
+      fout << (itree%4==0 ? "\n   " : " ");
+      WriteDoubleLiteral( fout, forest.GetWeight(itree) );
+      if (itree+1<nTrees) fout << ",";
+   }
+   fout << " };" << std::endl << std::endl;
+
+   // the forest is static, nothing to initialise or to clean up
+   fout << "void " << className << "::Initialize()" << std::endl;
+   fout << "{" << std::endl;
+   fout << "}" << std::endl << std::endl;
+   fout << "// Clean up" << std::endl;
+   fout << "inline void " << className << "::Clear() " << std::endl;
+   fout << "{" << std::endl;
+   fout << "}" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// recursively write a node of the flattened forest as nested if statements
+
+void TMVA::MethodBDT::MakeClassNestedIfNode( std::ostream& fout, const FlatForest& forest, UInt_t inode,
+                                             const TString& indent ) const
+{
+   if (forest.IsLeaf(inode)) {
+      fout << indent << "return ";
+      WriteDoubleLiteral( fout, forest.GetLeafValue(inode) );
+      fout << ";" << std::endl;
+      return;
+   }
+   fout << indent << "if (x[" << forest.GetVar(inode) << "] >= ";
+   WriteFloatLiteral( fout, forest.GetCut(inode) );
+   fout << ") {" << std::endl;
+   MakeClassNestedIfNode( fout, forest, forest.GetDaughter(inode,kTRUE), indent+"   " );
+   fout << indent << "}" << std::endl;
+   fout << indent << "else {" << std::endl;
+   MakeClassNestedIfNode( fout, forest, forest.GetDaughter(inode,kFALSE), indent+"   " );
+   fout << indent << "}" << std::endl;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// find useful preselection cuts that will be applied before
 /// and Decision Tree training.. (and of course also applied
@@ -94,6 +94,7 @@
 
 #include "TMVA/Config.h"
 #include "TMVA/DataSetInfo.h"
+#include "TMVA/DataSetManager.h"
 #include "TMVA/DataSet.h"
 #include "TMVA/Factory.h"
 #include "TMVA/MsgLogger.h"
@@ -108,6 +109,7 @@
 #include "TMVA/ResultsRegression.h"
 #include "TMVA/ResultsMulticlass.h"
 #include "TMVA/RootFinder.h"
+#include "TMVA/StreamingDataLoader.h"
 #include "TMVA/Timer.h"
 #include "TMVA/Tools.h"
 #include "TMVA/TSpline1.h"
@@ -739,6 +741,22 @@ Double_t TMVA::MethodBase::GetMvaValue( const Event* const ev, Double_t* err, Do
    return val;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// classification response for nEvents events. The input variables are given as
+/// column-major array, inputs[ivar*nEvents+ievt]. This default implementation
+/// evaluates the events one by one through GetMvaValue, methods can override it
+/// with a faster evaluation of many events
+
+void TMVA::MethodBase::GetBatchMvaValues( const Float_t* inputs, UInt_t nEvents, Double_t* mvaValues )
+{
+   const UInt_t nvar = DataInfo().GetNVariables();
+   Event ev(std::vector<Float_t>(nvar), 0);
+   for (UInt_t ievt=0; ievt<nEvents; ievt++) {
+      for (UInt_t ivar=0; ivar<nvar; ivar++) ev.SetVal(ivar, inputs[ivar*nEvents+ievt]);
+      mvaValues[ievt] = GetMvaValue(&ev);
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// uses a pre-set cut on the MVA output (SetSignalReferenceCut and SetSignalReferenceCutOrientation)
 /// for a quick determination if an event would be selected as signal or background
@@ -766,7 +784,7 @@ void TMVA::MethodBase::AddClassifierOutput( Types::ETreeType type )
 
 
    Long64_t nEvents =  Data()->GetNEvents();
-   std::vector<Double_t> mvaValues = GetMvaValues(0, nEvents, true); 
+   std::vector<Double_t> mvaValues = GetAllMvaValues(true); 
 
    
    clRes->Resize( nEvents );
@@ -806,13 +824,13 @@ std::vector<Double_t> TMVA::MethodBase::GetMvaValues(Long64_t firstEvt, Long64_t
 
    for (Int_t ievt=firstEvt; ievt<lastEvt; ievt++) {
       Data()->SetCurrentEvent(ievt);
-      values[ievt] = GetMvaValue();
+      values[ievt-firstEvt] = GetMvaValue();
 
       // print progress
       if (logProgress) {
          Int_t modulo = Int_t(nEvents/100);
          if (modulo <= 0 ) modulo = 1;
-         if (ievt%modulo == 0) timer.DrawProgressBar( ievt );
+         if ((ievt-firstEvt)%modulo == 0) timer.DrawProgressBar( ievt-firstEvt );
       }
    }
    if (logProgress) {
@@ -824,6 +842,25 @@ std::vector<Double_t> TMVA::MethodBase::GetMvaValues(Long64_t firstEvt, Long64_t
    return values;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// get the MVA values for all the events of the current Data type. If the
+/// Factory has evaluated them in worker processes (SetMvaValuesCache), they are
+/// taken (and removed) from the cache instead of being computed again
+
+std::vector<Double_t> TMVA::MethodBase::GetAllMvaValues(Bool_t logProgress)
+{
+   std::map<Types::ETreeType, std::vector<Double_t> >::iterator it = fMvaValuesCache.find(Data()->GetCurrentType());
+   if (it != fMvaValuesCache.end()) {
+      std::vector<Double_t> values;
+      values.swap(it->second);
+      fMvaValuesCache.erase(it);
+      if ((Long64_t)values.size() == Data()->GetNEvents()) return values;
+      Log() << kWARNING << Form("Dataset[%s] : ",DataInfo().GetName()) << "Discard " << values.size()
+            << " responses evaluated in worker processes for " << Data()->GetNEvents() << " events" << Endl;
+   }
+   return GetMvaValues(0, Data()->GetNEvents(), logProgress);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// prepare tree branch with the method's discriminating variable
 
@@ -2429,7 +2466,7 @@ Double_t TMVA::MethodBase::GetTrainingEfficiency(const TString& theString)
       // sign if cut
       Int_t sign = (fCutOrientation == kPositive) ? +1 : -1;
 
-      std::vector<Double_t> mvaValues = GetMvaValues(0,Data()->GetNEvents());
+      std::vector<Double_t> mvaValues = GetAllMvaValues();
       assert( (Long64_t) mvaValues.size() == Data()->GetNEvents()); 
 
       // this method is unbinned
@@ -3138,6 +3175,29 @@ const std::vector<TMVA::Event*>& TMVA::MethodBase::GetEventCollection( Types::ET
    return *(fEventCollections.at(idx));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// create a reader of the training trees if the data set is to be trained on a
+/// stream (StreamTraining option of PrepareTrainingAndTestTree), 0 otherwise.
+/// The events of the streamed buffers are not transformed
+
+TMVA::StreamingDataLoader* TMVA::MethodBase::CreateStreamingDataLoader( UInt_t seed ) const
+{
+   if (!DataInfo().IsStreamTraining()) return 0;
+   DataSetManager* dsm = DataInfo().GetDataSetManager();
+   if (dsm == 0) {
+      Log() << kWARNING << "No data set manager, cannot stream the training trees" << Endl;
+      return 0;
+   }
+   StreamingDataLoader* loader = new StreamingDataLoader( DataInfo(), dsm->DataInput(), Types::kTraining,
+                                                          DataInfo().GetStreamBufferSize(), seed );
+   if (loader->GetNTrees() == 0) {
+      Log() << kWARNING << "No tree registered for training, the events kept in memory are used" << Endl;
+      delete loader;
+      return 0;
+   }
+   return loader;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// calculates the TMVA version string from the training version code on the fly
 
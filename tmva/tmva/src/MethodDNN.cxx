@@ -42,6 +42,7 @@
 #include "TMVA/Tools.h"
 #include "TMVA/Config.h"
 #include "TMVA/Ranking.h"
+#include "TMVA/StreamingDataLoader.h"
 
 #include "TMVA/DNN/Net.h"
 #include "TMVA/DNN/Architectures/Reference.h"
@@ -50,6 +51,7 @@
 #include "TMVA/Monitoring.h"
 
 #include <algorithm>
+#include <memory>
 #include <iostream>
 #include <string>
 #include <iomanip>
@@ -514,44 +516,48 @@ void TMVA::MethodDNN::Train()
    const std::vector<TMVA::Event*>& eventCollectionTraining = GetEventCollection (Types::kTraining);
    const std::vector<TMVA::Event*>& eventCollectionTesting  = GetEventCollection (Types::kTesting);
 
-   for (auto &event : eventCollectionTraining) {
+   auto addPattern = [this](const TMVA::Event* event, std::vector<Pattern>& pattern) {
       const std::vector<Float_t>& values = event->GetValues();
       if (fAnalysisType == Types::kClassification) {
          double outputValue = event->GetClass () == 0 ? 0.9 : 0.1;
-         trainPattern.push_back(Pattern (values.begin(),
-                                         values.end(),
-                                         outputValue,
-                                         event->GetWeight()));
-         trainPattern.back().addInput(1.0);
+         pattern.push_back(Pattern (values.begin(),
+                                    values.end(),
+                                    outputValue,
+                                    event->GetWeight()));
+         pattern.back().addInput(1.0);
       } else {
          const std::vector<Float_t>& targets = event->GetTargets ();
-         trainPattern.push_back(Pattern(values.begin(),
-                                        values.end(),
-                                        targets.begin(),
-                                        targets.end(),
-                                        event->GetWeight ()));
-         trainPattern.back ().addInput (1.0); // bias node
-      }
-   }
-
-   for (auto &event : eventCollectionTesting) {
-      const std::vector<Float_t>& values = event->GetValues();
-      if (fAnalysisType == Types::kClassification) {
-         double outputValue = event->GetClass () == 0 ? 0.9 : 0.1;
-         testPattern.push_back(Pattern (values.begin(),
-                                         values.end(),
-                                         outputValue,
-                                         event->GetWeight()));
-         testPattern.back().addInput(1.0);
-      } else {
-         const std::vector<Float_t>& targets = event->GetTargets ();
-         testPattern.push_back(Pattern(values.begin(),
-                                        values.end(),
-                                        targets.begin(),
-                                        targets.end(),
-                                        event->GetWeight ()));
-         testPattern.back ().addInput (1.0); // bias node
+         pattern.push_back(Pattern(values.begin(),
+                                   values.end(),
+                                   targets.begin(),
+                                   targets.end(),
+                                   event->GetWeight ()));
+         pattern.back ().addInput (1.0); // bias node
       }
+   };
+
+   for (auto &event : eventCollectionTraining) addPattern(event, trainPattern);
+   for (auto &event : eventCollectionTesting)  addPattern(event, testPattern);
+
+   // With StreamTraining each training cycle runs over the buffers of the
+   // streamed training trees, transformed like the events kept in memory.
+   std::unique_ptr<StreamingDataLoader> stream(CreateStreamingDataLoader());
+   std::function<bool (std::vector<Pattern>&)> nextTrainPattern;
+   if (stream) {
+      Log() << kINFO << "Streaming " << stream->GetNEntries()
+            << " entries of the training trees in buffers of "
+            << stream->GetBufferSize() << " events." << Endl;
+      stream->Rewind();
+      nextTrainPattern = [this, &stream, &addPattern](std::vector<Pattern>& pattern) {
+         const std::vector<Event*>& buffer = stream->NextBuffer();
+         if (buffer.empty()) {
+            stream->Rewind();
+            return false;
+         }
+         pattern.clear();
+         for (auto &event : buffer) addPattern(GetTransformationHandler().Transform(event), pattern);
+         return true;
+      };
    }
 
    TMVA::DNN::Net      net;
@@ -651,7 +657,7 @@ void TMVA::MethodDNN::Train()
       DNN::Steepest minimizer(ptrSettings->learningRate(),
                               ptrSettings->momentum(),
                               ptrSettings->repetitions());
-      net.train(weights, trainPattern, testPattern, minimizer, *ptrSettings.get());
+      net.train(weights, trainPattern, testPattern, minimizer, *ptrSettings.get(), nextTrainPattern);
       ptrSettings.reset();
       Log () << kINFO << Endl;
       idxSetting++;
@@ -679,6 +685,65 @@ void TMVA::MethodDNN::Train()
    }
 }
 
+//______________________________________________________________________________
+template <typename AArchitecture>
+size_t TMVA::MethodDNN::TrainStreamedEpoch(StreamingDataLoader & stream,
+                                           TNet<AArchitecture> & net,
+                                           std::vector<TNet<AArchitecture>> & nets,
+                                           TGradientDescent<AArchitecture> & minimizer,
+                                           Double_t momentum)
+{
+   using DataLoader_t = TDataLoader<TMVAInput_t, AArchitecture>;
+
+   // The buffers hold untransformed events, the transformed events are
+   // copied into events owned by this function.
+   const Bool_t transform =
+      GetTransformationHandler().GetTransformationList().GetEntries() > 0;
+   std::vector<Event *> transformed{};
+   TMVAInput_t events{};
+
+   size_t nThreads = nets.size();
+   size_t nBatches = 0;
+   std::vector<TBatch<AArchitecture>> batches{};
+   stream.Rewind();
+   for (;;) {
+      const TMVAInput_t & buffer = stream.NextBuffer();
+      if (buffer.empty()) break;
+
+      size_t batchesInBuffer = buffer.size() / net.GetBatchSize();
+      batchesInBuffer -= batchesInBuffer % nThreads;
+      if (batchesInBuffer == 0) continue;
+
+      if (transform) {
+         events.clear();
+         for (size_t i = 0; i < buffer.size(); i++) {
+            if (i == transformed.size()) transformed.push_back(new Event(*buffer[i]));
+            *transformed[i] = *GetTransformationHandler().Transform(buffer[i]);
+            events.push_back(transformed[i]);
+         }
+      }
+
+      DataLoader_t data(transform ? events : buffer, buffer.size(),
+                        net.GetBatchSize(), net.GetInputWidth(),
+                        net.GetOutputWidth(), nThreads);
+      for (size_t i = 0; i < batchesInBuffer; i += nThreads) {
+         batches.clear();
+         for (size_t j = 0; j < nThreads; j++) {
+            batches.push_back(data.GetBatch());
+         }
+         if (momentum > 0.0) {
+            minimizer.StepMomentum(net, nets, batches, momentum);
+         } else {
+            minimizer.Step(net, nets, batches);
+         }
+      }
+      nBatches += batchesInBuffer;
+   }
+
+   for (size_t i = 0; i < transformed.size(); i++) delete transformed[i];
+   return nBatches;
+}
+
 //______________________________________________________________________________
 void TMVA::MethodDNN::TrainGpu()
 {
@@ -742,6 +807,15 @@ void TMVA::MethodDNN::TrainGpu()
       size_t stepCount = 0;
       size_t batchesInEpoch = nTrainingSamples / net.GetBatchSize();
 
+      // With StreamTraining the epochs run over the training trees, the
+      // events kept in memory are only used for the training error.
+      std::unique_ptr<StreamingDataLoader> stream(CreateStreamingDataLoader());
+      if (stream) {
+         Log() << kINFO << "Streaming " << stream->GetNEntries()
+               << " entries of the training trees in buffers of "
+               << stream->GetBufferSize() << " events." << Endl;
+      }
+
       std::chrono::time_point<std::chrono::system_clock> start, end;
       start = std::chrono::system_clock::now();
 
@@ -758,18 +832,23 @@ void TMVA::MethodDNN::TrainGpu()
          stepCount++;
 
          // Perform minimization steps for a full epoch.
-         trainingData.Shuffle();
-         for (size_t i = 0; i < batchesInEpoch; i += nThreads) {
-             batches.clear();
-             for (size_t j = 0; j < nThreads; j++) {
-                 batches.reserve(nThreads);
-                 batches.push_back(trainingData.GetBatch());
-             }
-             if (settings.momentum > 0.0) {
-                 minimizer.StepMomentum(net, nets, batches, settings.momentum);
-             } else {
-                 minimizer.Step(net, nets, batches);
-             }
+         if (stream) {
+            batchesInEpoch = TrainStreamedEpoch(*stream, net, nets, minimizer,
+                                                settings.momentum);
+         } else {
+            trainingData.Shuffle();
+            for (size_t i = 0; i < batchesInEpoch; i += nThreads) {
+                batches.clear();
+                for (size_t j = 0; j < nThreads; j++) {
+                    batches.reserve(nThreads);
+                    batches.push_back(trainingData.GetBatch());
+                }
+                if (settings.momentum > 0.0) {
+                    minimizer.StepMomentum(net, nets, batches, settings.momentum);
+                } else {
+                    minimizer.Step(net, nets, batches);
+                }
+            }
          }
 
          if ((stepCount % minimizer.GetTestInterval()) == 0) {
@@ -892,6 +971,15 @@ void TMVA::MethodDNN::TrainCpu()
       size_t stepCount = 0;
       size_t batchesInEpoch = nTrainingSamples / net.GetBatchSize();
 
+      // With StreamTraining the epochs run over the training trees, the
+      // events kept in memory are only used for the training error.
+      std::unique_ptr<StreamingDataLoader> stream(CreateStreamingDataLoader());
+      if (stream) {
+         Log() << kINFO << "Streaming " << stream->GetNEntries()
+               << " entries of the training trees in buffers of "
+               << stream->GetBufferSize() << " events." << Endl;
+      }
+
       std::chrono::time_point<std::chrono::system_clock> start, end;
       start = std::chrono::system_clock::now();
 
@@ -907,18 +995,23 @@ void TMVA::MethodDNN::TrainCpu()
       {
          stepCount++;
          // Perform minimization steps for a full epoch.
-         trainingData.Shuffle();
-         for (size_t i = 0; i < batchesInEpoch; i += nThreads) {
-             batches.clear();
-             for (size_t j = 0; j < nThreads; j++) {
-                 batches.reserve(nThreads);
-                 batches.push_back(trainingData.GetBatch());
-             }
-             if (settings.momentum > 0.0) {
-                 minimizer.StepMomentum(net, nets, batches, settings.momentum);
-             } else {
-                 minimizer.Step(net, nets, batches);
-             }
+         if (stream) {
+            batchesInEpoch = TrainStreamedEpoch(*stream, net, nets, minimizer,
+                                                settings.momentum);
+         } else {
+            trainingData.Shuffle();
+            for (size_t i = 0; i < batchesInEpoch; i += nThreads) {
+                batches.clear();
+                for (size_t j = 0; j < nThreads; j++) {
+                    batches.reserve(nThreads);
+                    batches.push_back(trainingData.GetBatch());
+                }
+                if (settings.momentum > 0.0) {
+                    minimizer.StepMomentum(net, nets, batches, settings.momentum);
+                } else {
+                    minimizer.Step(net, nets, batches);
+                }
+            }
          }
 
          if ((stepCount % minimizer.GetTestInterval()) == 0) {
@@ -39,10 +39,16 @@
 #include <cstdlib>
 
 // ROOT
+#include "RConfigure.h"
 #include "TFile.h"
 #include "TMath.h"
+#include "TROOT.h"
 #include "TTree.h"
 
+#ifdef R__USE_IMT
+#include "tbb/parallel_for.h"
+#endif
+
 // TMVA
 #include "TMVA/ClassifierFactory.h"
 #include "TMVA/DataSetInfo.h"
@@ -51,6 +57,7 @@
 #include "TMVA/MethodBase.h"
 #include "TMVA/MsgLogger.h"
 #include "TMVA/Ranking.h"
+#include "TMVA/Timer.h"
 #include "TMVA/Tools.h"
 #include "TMVA/Types.h"
 
@@ -304,7 +311,6 @@ Double_t TMVA::MethodKNN::GetMvaValue( Double_t* err, Double_t* errUpper )
    const Event *ev = GetEvent();
    const Int_t nvar = GetNVariables();
    const Double_t weight = ev->GetWeight();
-   const UInt_t knn = static_cast<UInt_t>(fnkNN);
 
    kNN::VarVec vvec(static_cast<UInt_t>(nvar), 0.0);
    
@@ -314,11 +320,23 @@ Double_t TMVA::MethodKNN::GetMvaValue( Double_t* err, Double_t* errUpper )
 
    // search for fnkNN+2 nearest neighbors, pad with two 
    // events to avoid Monte-Carlo events with zero distance
-   // most of CPU time is spent in this recursive function
+   // most of CPU time is spent in this search
    const kNN::Event event_knn(vvec, weight, 3);
-   fModule->Find(event_knn, knn + 2);
+   kNN::ElemVec rlist;
+
+   return ComputeMvaValue(event_knn, rlist);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compute classifier response for one event. Apart from the LDA option the
+/// method is not modified, so that several events can be evaluated concurrently
+
+Double_t TMVA::MethodKNN::ComputeMvaValue(const kNN::Event &event_knn, kNN::ElemVec &rlist)
+{
+   const UInt_t knn = static_cast<UInt_t>(fnkNN);
+
+   fModule->Find(event_knn, knn + 2, rlist);
 
-   const kNN::List &rlist = fModule->GetkNNList();
    if (rlist.size() != knn + 2) {
       Log() << kFATAL << "kNN result list is empty" << Endl;
       return -100.0;  
@@ -366,7 +384,7 @@ Double_t TMVA::MethodKNN::GetMvaValue( Double_t* err, Double_t* errUpper )
    UInt_t count_all = 0;
    Double_t weight_all = 0, weight_sig = 0, weight_bac = 0;
 
-   for (kNN::List::const_iterator lit = rlist.begin(); lit != rlist.end(); ++lit) {
+   for (kNN::ElemVec::const_iterator lit = rlist.begin(); lit != rlist.end(); ++lit) {
 
       // get reference to current node to make code more readable
       const kNN::Node<kNN::Event> &node = *(lit->first);
@@ -428,6 +446,104 @@ Double_t TMVA::MethodKNN::GetMvaValue( Double_t* err, Double_t* errUpper )
    return weight_sig/weight_all;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Compute classifier response for the events in [firstEvt, lastEvt) of the
+/// current data set type. The input variables of all events are copied first,
+/// the neighbor searches then run in parallel (see EvaluateEvents)
+
+std::vector<Double_t> TMVA::MethodKNN::GetMvaValues(Long64_t firstEvt, Long64_t lastEvt, Bool_t logProgress)
+{
+   Long64_t nEvents = Data()->GetNEvents();
+   if (firstEvt > lastEvt || lastEvt > nEvents) lastEvt = nEvents;
+   if (firstEvt < 0) firstEvt = 0;
+   std::vector<Double_t> values(lastEvt-firstEvt);
+   nEvents = values.size();
+   if (nEvents == 0) return values;
+
+   Timer timer( nEvents, GetName(), kTRUE );
+
+   if (logProgress)
+      Log() << kHEADER << Form("[%s] : ",DataInfo().GetName()) << "Evaluation of " << GetMethodName() << " on "
+            << (Data()->GetCurrentType()==Types::kTraining?"training":"testing") << " sample (" << nEvents << " events)" << Endl;
+
+   const UInt_t nvar = GetNVariables();
+   kNN::EventVec events;
+   events.reserve(nEvents);
+   kNN::VarVec vvec(nvar, 0.0);
+   for (Long64_t ievt=firstEvt; ievt<lastEvt; ievt++) {
+      Data()->SetCurrentEvent(ievt);
+      const Event *ev = GetEvent();
+      for (UInt_t ivar = 0; ivar < nvar; ++ivar) vvec[ivar] = ev->GetValue(ivar);
+      events.push_back(kNN::Event(vvec, ev->GetWeight(), 3));
+   }
+
+   EvaluateEvents(events, &values[0]);
+
+   if (logProgress) {
+      Log() << kINFO
+            << "Elapsed time for evaluation of " << nEvents <<  " events: "
+            << timer.GetElapsedTime() << "       " << Endl;
+   }
+
+   return values;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// classification response for nEvents events given as column-major array,
+/// inputs[ivar*nEvents+ievt]. The variable transformations are applied to all
+/// events before the neighbor searches, which run in parallel (see EvaluateEvents)
+
+void TMVA::MethodKNN::GetBatchMvaValues( const Float_t* inputs, UInt_t nEvents, Double_t* mvaValues )
+{
+   if (DoRegression() || DoMulticlass()) {
+      MethodBase::GetBatchMvaValues(inputs, nEvents, mvaValues);
+      return;
+   }
+
+   const UInt_t nvar = GetNVariables();
+   kNN::EventVec events;
+   events.reserve(nEvents);
+   kNN::VarVec vvec(nvar, 0.0);
+   Event ev(std::vector<Float_t>(nvar), 0);
+   for (UInt_t ievt=0; ievt<nEvents; ievt++) {
+      for (UInt_t ivar=0; ivar<nvar; ivar++) ev.SetVal(ivar, inputs[ivar*nEvents+ievt]);
+      const Event *tev = GetTransformationHandler().Transform(&ev);
+      for (UInt_t ivar=0; ivar<nvar; ivar++) vvec[ivar] = tev->GetValue(ivar);
+      events.push_back(kNN::Event(vvec, tev->GetWeight(), 3));
+   }
+
+   EvaluateEvents(events, mvaValues);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Compute classifier response for all events. With implicit multi-threading
+/// the events are split in blocks searched concurrently in the flattened tree
+/// of the module. The LDA option and verbose output are evaluated serially,
+/// since they modify the method or its logger
+
+void TMVA::MethodKNN::EvaluateEvents(const kNN::EventVec &events, Double_t* mvaValues)
+{
+   auto evaluate = [&](UInt_t first, UInt_t last) {
+      kNN::ElemVec rlist;
+      for (UInt_t ievt = first; ievt < last; ++ievt) {
+         mvaValues[ievt] = ComputeMvaValue(events[ievt], rlist);
+      }
+   };
+
+#ifdef R__USE_IMT
+   const UInt_t blockSize = 256;
+   if (ROOT::IsImplicitMTEnabled() && !fUseLDA && Log().GetMinType() > kVERBOSE && events.size() > blockSize) {
+      const UInt_t nBlocks = (events.size() + blockSize - 1)/blockSize;
+      tbb::parallel_for(UInt_t(0), nBlocks, [&](UInt_t iblock) {
+            evaluate(iblock*blockSize, TMath::Min((iblock+1)*blockSize, UInt_t(events.size())));
+         });
+      return;
+   }
+#endif
+
+   evaluate(0, events.size());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ///
 /// Return vector of averages for target values of k-nearest neighbors.
@@ -457,11 +573,11 @@ const std::vector< Float_t >& TMVA::MethodKNN::GetRegressionValues()
 
    // search for fnkNN+2 nearest neighbors, pad with two 
    // events to avoid Monte-Carlo events with zero distance
-   // most of CPU time is spent in this recursive function
+   // most of CPU time is spent in this search
    const kNN::Event event_knn(vvec, evt->GetWeight(), 3);
-   fModule->Find(event_knn, knn + 2);
+   kNN::ElemVec rlist;
+   fModule->Find(event_knn, knn + 2, rlist);
 
-   const kNN::List &rlist = fModule->GetkNNList();
    if (rlist.size() != knn + 2) {
       Log() << kFATAL << "kNN result list is empty" << Endl;
       return *fRegressionReturnVal;
@@ -471,7 +587,7 @@ const std::vector< Float_t >& TMVA::MethodKNN::GetRegressionValues()
    Double_t weight_all = 0;
    UInt_t count_all = 0;
 
-   for (kNN::List::const_iterator lit = rlist.begin(); lit != rlist.end(); ++lit) {
+   for (kNN::ElemVec::const_iterator lit = rlist.begin(); lit != rlist.end(); ++lit) {
 
       // get reference to current node to make code more readable
       const kNN::Node<kNN::Event> &node = *(lit->first);
@@ -868,13 +984,13 @@ Double_t TMVA::MethodKNN::GausKernel(const kNN::Event &event_knn,
 /// Get polynomial kernel radius
 ///
 
-Double_t TMVA::MethodKNN::getKernelRadius(const kNN::List &rlist) const
+Double_t TMVA::MethodKNN::getKernelRadius(const kNN::ElemVec &rlist) const
 {
    Double_t kradius = -1.0;
    UInt_t kcount = 0;
    const UInt_t knn = static_cast<UInt_t>(fnkNN);
 
-   for (kNN::List::const_iterator lit = rlist.begin(); lit != rlist.end(); ++lit)
+   for (kNN::ElemVec::const_iterator lit = rlist.begin(); lit != rlist.end(); ++lit)
       {
          if (!(lit->second > 0.0)) continue;         
       
@@ -892,13 +1008,13 @@ Double_t TMVA::MethodKNN::getKernelRadius(const kNN::List &rlist) const
 /// Get polynomial kernel radius
 ///
 
-const std::vector<Double_t> TMVA::MethodKNN::getRMS(const kNN::List &rlist, const kNN::Event &event_knn) const
+const std::vector<Double_t> TMVA::MethodKNN::getRMS(const kNN::ElemVec &rlist, const kNN::Event &event_knn) const
 {
    std::vector<Double_t> rvec;
    UInt_t kcount = 0;
    const UInt_t knn = static_cast<UInt_t>(fnkNN);
 
-   for (kNN::List::const_iterator lit = rlist.begin(); lit != rlist.end(); ++lit)
+   for (kNN::ElemVec::const_iterator lit = rlist.begin(); lit != rlist.end(); ++lit)
       {
          if (!(lit->second > 0.0)) continue;         
       
@@ -944,11 +1060,11 @@ const std::vector<Double_t> TMVA::MethodKNN::getRMS(const kNN::List &rlist, cons
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Double_t TMVA::MethodKNN::getLDAValue(const kNN::List &rlist, const kNN::Event &event_knn)
+Double_t TMVA::MethodKNN::getLDAValue(const kNN::ElemVec &rlist, const kNN::Event &event_knn)
 {
    LDAEvents sig_vec, bac_vec;
 
-   for (kNN::List::const_iterator lit = rlist.begin(); lit != rlist.end(); ++lit) {
+   for (kNN::ElemVec::const_iterator lit = rlist.begin(); lit != rlist.end(); ++lit) {
        
       // get reference to current node to make code more readable
       const kNN::Node<kNN::Event> &node = *(lit->first);
@@ -100,6 +100,7 @@ ClassImp(TMVA::MethodSVM)
    , fCost(0)
    , fTolerance(0)
    , fMaxIter(0)
+   , fKernelCacheSize(0)
    , fNSubSets(0)
    , fBparm(0)
    , fGamma(0)
@@ -135,6 +136,7 @@ TMVA::MethodSVM::MethodSVM( DataSetInfo& theData, const TString& theWeightFile)
    , fCost(0)
    , fTolerance(0)
    , fMaxIter(0)
+   , fKernelCacheSize(0)
    , fNSubSets(0)
    , fBparm(0)
    , fGamma(0)
@@ -249,6 +251,7 @@ void TMVA::MethodSVM::DeclareOptions()
    }
    DeclareOptionRef( fTolerance = 0.01, "Tol",      "Tolerance parameter" );  //should be fixed
    DeclareOptionRef( fMaxIter   = 1000, "MaxIter",  "Maximum number of training loops" );
+   DeclareOptionRef( fKernelCacheSize = 1024, "KernelCacheSize", "Memory for the kernel matrix in MB; if the matrix is larger, only the most recently used rows are kept (0: no limit)" );
 
 }
 
@@ -375,7 +378,7 @@ void TMVA::MethodSVM::Train()
 
    Log()<< kINFO << "Building SVM Working Set...with "<<fInputData->size()<<" event instances"<< Endl;
    Timer bldwstime( GetName());
-   fWgSet = new SVWorkingSet( fInputData, fSVKernelFunction,fTolerance, DoRegression() );
+   fWgSet = new SVWorkingSet( fInputData, fSVKernelFunction,fTolerance, DoRegression(), fKernelCacheSize );
    Log() << kINFO <<"Elapsed time for Working Set build: "<< bldwstime.GetElapsedTime()<<Endl;
 
    // timing
@@ -195,6 +195,16 @@ void TMVA::kNN::ModulekNN::Clear()
       fTree = 0;
    }
 
+   fFlatNode.clear();
+   fFlatVar.clear();
+   fFlatMod.clear();
+   fFlatDis.clear();
+   fFlatMin.clear();
+   fFlatMax.clear();
+   fFlatWeight.clear();
+   fFlatLeft.clear();
+   fFlatRight.clear();
+
    fVarScale.clear();
    fCount.clear();
    fEvent.clear();
@@ -326,6 +336,18 @@ Bool_t TMVA::kNN::ModulekNN::Fill(const UShort_t odepth, const UInt_t ifrac, con
       }
    }
 
+   // copy the tree into contiguous arrays for the thread-safe search
+   fFlatNode.clear();
+   fFlatVar.clear();
+   fFlatMod.clear();
+   fFlatDis.clear();
+   fFlatMin.clear();
+   fFlatMax.clear();
+   fFlatWeight.clear();
+   fFlatLeft.clear();
+   fFlatRight.clear();
+   Flatten(fTree);
+
    for (std::map<Short_t, UInt_t>::const_iterator it = fCount.begin(); it != fCount.end(); ++it) {
       Log() << kINFO << "<Fill> Class " << it->first << " has " << std::setw(8)
             << it->second << " events" << Endl;
@@ -382,6 +404,91 @@ Bool_t TMVA::kNN::ModulekNN::Find(Event event, const UInt_t nfind, const std::st
    return kTRUE;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// find the nfind closest events in the flattened tree, sorted by distance.
+/// Same result as Find(event, nfind, "count"), but the search is iterative,
+/// reads only the node arrays and writes only to result, so that several
+/// events can be searched concurrently
+
+Bool_t TMVA::kNN::ModulekNN::Find(const Event &event, const UInt_t nfind, ElemVec &result) const
+{
+   result.clear();
+
+   if (fFlatNode.empty()) {
+      Log() << kFATAL << "ModulekNN::Find() - tree has not been filled" << Endl;
+      return kFALSE;
+   }
+   if (fDimn != event.GetNVar()) {
+      Log() << kFATAL << "ModulekNN::Find() - number of dimension does not match training events" << Endl;
+      return kFALSE;
+   }
+   if (nfind < 1) {
+      Log() << kFATAL << "ModulekNN::Find() - requested 0 nearest neighbors" << Endl;
+      return kFALSE;
+   }
+
+   // rescale the variables to the widths of the events in the tree
+   const Event sevent = Scale(event);
+   const VarType *x = &(sevent.GetVars()[0]);
+
+   result.reserve(nfind + 1);
+
+   // nodes are visited in the order of the recursive kNN::Find:
+   // the daughter on the side of the event first
+   std::vector<UInt_t> stack;
+   stack.reserve(64);
+   stack.push_back(0);
+
+   while (!stack.empty()) {
+      const UInt_t inode = stack.back();
+      stack.pop_back();
+
+      const VarType value = x[fFlatMod[inode]];
+
+      if (fFlatWeight[inode] > 0.0) {
+         VarType max_dist = 0.0;
+
+         if (!result.empty()) {
+            max_dist = result.back().second;
+
+            // skip the sub-tree if it is further away than the furthest neighbor
+            if (result.size() == nfind) {
+               const VarType dmax = fFlatMax[inode] - value;
+               const VarType dmin = fFlatMin[inode] - value;
+               if (value > fFlatMax[inode] && dmax*dmax > max_dist) continue;
+               if (value < fFlatMin[inode] && dmin*dmin > max_dist) continue;
+            }
+         }
+
+         const VarType *y = &fFlatVar[inode*fDimn];
+         VarType distance = 0.0;
+         for (UInt_t ivar = 0; ivar < fDimn; ++ivar) {
+            const VarType d = y[ivar] - x[ivar];
+            distance += d*d;
+         }
+
+         if (result.size() < nfind || distance < max_dist) {
+            ElemVec::iterator it = result.begin();
+            while (it != result.end() && !(distance < it->second)) ++it;
+            result.insert(it, Elem(fFlatNode[inode], distance));
+            if (result.size() > nfind) result.pop_back();
+         }
+      }
+
+      const Int_t left = fFlatLeft[inode], right = fFlatRight[inode];
+      if (left >= 0 && right >= 0 && value < fFlatDis[inode]) {
+         stack.push_back(right);
+         stack.push_back(left);
+      }
+      else {
+         if (left  >= 0) stack.push_back(left);
+         if (right >= 0) stack.push_back(right);
+      }
+   }
+
+   return kTRUE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// find in tree
 
@@ -616,6 +723,31 @@ void TMVA::kNN::ModulekNN::ComputeMetric(const UInt_t ifrac)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// append node and its daughters to the flat arrays, return index of node
+
+UInt_t TMVA::kNN::ModulekNN::Flatten(const Node<Event> *node)
+{
+   const UInt_t inode = fFlatNode.size();
+
+   fFlatNode.push_back(node);
+   for (UInt_t ivar = 0; ivar < fDimn; ++ivar) {
+      fFlatVar.push_back(node->GetEvent().GetVar(ivar));
+   }
+   fFlatMod.push_back(node->GetMod());
+   fFlatDis.push_back(node->GetVarDis());
+   fFlatMin.push_back(node->GetVarMin());
+   fFlatMax.push_back(node->GetVarMax());
+   fFlatWeight.push_back(node->GetWeight());
+   fFlatLeft.push_back(-1);
+   fFlatRight.push_back(-1);
+
+   if (node->GetNodeL()) fFlatLeft[inode]  = Flatten(node->GetNodeL());
+   if (node->GetNodeR()) fFlatRight[inode] = Flatten(node->GetNodeR());
+
+   return inode;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// scale each event variable so that rms of variables is approximately 1.0
 /// this allows comparisons of variables with distinct scales and units
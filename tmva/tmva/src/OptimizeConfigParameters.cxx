@@ -24,15 +24,24 @@
 
 #include <limits>
 #include <cstdlib>
+#include <algorithm>
+#include <numeric>
 #include "TMath.h"
 #include "TGraph.h"
 #include "TH1.h"
 #include "TH2.h"
 #include "TDirectory.h"
+#include "TFile.h"
+#include "TParameter.h"
+#ifndef _WIN32
+#include "TProcPool.h"
+#endif
 
+#include "TMVA/Config.h"
 #include "TMVA/DataSet.h"
 #include "TMVA/DataSetInfo.h"
 #include "TMVA/Event.h"
+#include "TMVA/Factory.h"
 #include "TMVA/FitterBase.h"
 #include "TMVA/GeneticFitter.h"
 #include "TMVA/IMethod.h"
@@ -192,31 +201,28 @@ void TMVA::OptimizeConfigParameters::optimizeScan()
       Ntot *= v[i].size();
       Nindividual.push_back(v[i].size());
    }
-   //loop on the total number of differnt combinations
-   
+   // all combinations, trained concurrently if worker processes are configured
+   std::vector< std::vector<Double_t> > points(Ntot);
    for (int i=0; i<Ntot; i++){
-      UInt_t index=0;
       std::vector<int> indices = GetScanIndices(i, Nindividual );
-      for (it=fTuneParameters.begin(), index=0; index< indices.size(); index++, it++){
-         currentParameters[it->first] = v[index][indices[index]];
+      for (UInt_t index=0; index< indices.size(); index++) points[i].push_back(v[index][indices[index]]);
+   }
+   GetMethod()->GetTransformationHandler().CalcTransformations(GetMethod()->Data()->GetEventCollection());
+   std::vector<Double_t> estimators;
+   EstimatorFunctions(points, estimators);
+
+   for (int i=0; i<Ntot; i++){
+      UInt_t index=0;
+      for (it=fTuneParameters.begin(), index=0; index< points[i].size(); index++, it++){
+         currentParameters[it->first] = points[i][index];
       }
       Log() << kINFO << "--------------------------" << Endl;
-      Log() << kINFO <<"Settings being evaluated:" << Endl;
+      Log() << kINFO <<"Settings evaluated:" << Endl;
       for (std::map<TString,Double_t>::iterator it_print=currentParameters.begin(); 
            it_print!=currentParameters.end(); it_print++){
          Log() << kINFO << "  " << it_print->first  << " = " << it_print->second << Endl;
       }
-
-      GetMethod()->Reset();
-      GetMethod()->SetTuneParameters(currentParameters);
-      // now do the training for the current parameters:
-      GetMethod()->BaseDir()->cd();
-      if (i==0) GetMethod()->GetTransformationHandler().CalcTransformations(
-                                                                            GetMethod()->Data()->GetEventCollection());
-      Event::SetIsTraining(kTRUE);
-      GetMethod()->Train();
-      Event::SetIsTraining(kFALSE);
-      currentFOM = GetFOM(); 
+      currentFOM = -estimators[i];
       Log() << kINFO << "FOM was found : " << currentFOM << "; current best is " << bestFOM << Endl;
       
       if (currentFOM > bestFOM) {
@@ -307,32 +313,124 @@ Double_t TMVA::OptimizeConfigParameters::EstimatorFunction( std::vector<Double_t
       //           <<" already --> FOM="<< iter->second <<std::endl; 
       return iter->second;
    }else{
-      std::map<TString,Double_t> currentParameters;
-      Int_t icount =0; // map "pars" to the  map of Tuneparameter, make sure
-                       // you never screw up this order!!
-      std::map<TString, TMVA::Interval*>::iterator it;
-      for (it=fTuneParameters.begin(); it!=fTuneParameters.end(); it++){
-         currentParameters[it->first] = pars[icount++];
-      }
-      GetMethod()->Reset();
-      GetMethod()->SetTuneParameters(currentParameters);
-      GetMethod()->BaseDir()->cd();
-      
+      Double_t currentFOM = TrainAndGetFOM(pars);
+      fAlreadyTrainedParCombination.insert(std::make_pair(pars,-currentFOM));
+      return  -currentFOM;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// return the estimators of several parameter sets (e.g. the population of the
+/// genetic algorithm or the points of the scan). With more than one worker
+/// process (gConfig().SetNWorkers(n)), the parameter sets not trained yet are
+/// trained concurrently in processes forked by a TProcPool, each with its own
+/// copy of the method and of the data set; only the figures of merit are sent
+/// back. The results do not depend on the number of workers
+
+void TMVA::OptimizeConfigParameters::EstimatorFunctions( std::vector< std::vector<Double_t> > & parameters,
+                                                         std::vector<Double_t> & estimators )
+{
+#ifndef _WIN32
+   // parameter sets not trained yet, each only once
+   std::vector< std::vector<Double_t> > points;
+   for (UInt_t i=0; i<parameters.size(); i++) {
+      if (fAlreadyTrainedParCombination.find(parameters[i]) != fAlreadyTrainedParCombination.end()) continue;
+      if (std::find(points.begin(), points.end(), parameters[i]) != points.end()) continue;
+      points.push_back(parameters[i]);
+   }
+
+   const UInt_t nWorkers = gConfig().GetNWorkers();
+   if (nWorkers > 1 && points.size() > 1) {
       if (fNotDoneYet){
          GetMethod()->GetTransformationHandler().
             CalcTransformations(GetMethod()->Data()->GetEventCollection());
          fNotDoneYet=kFALSE;
       }
-      Event::SetIsTraining(kTRUE);
-      GetMethod()->Train();
-      Event::SetIsTraining(kFALSE);
 
-      
-      Double_t currentFOM = GetFOM(); 
-      
-      fAlreadyTrainedParCombination.insert(std::make_pair(pars,-currentFOM));
-      return  -currentFOM;
+      // the returned parameter is named after the index of the set, the
+      // results of the workers arrive in any order
+      auto trainPoint = [&](int i) -> TParameter<Double_t> * {
+         PrepareWorker();
+         Double_t fom = TrainAndGetFOM(points[i]);
+         return new TParameter<Double_t>(TString::Format("%d",i), fom);
+      };
+      std::vector<int> indices(points.size());
+      std::iota(indices.begin(), indices.end(), 0);
+
+      Log() << kINFO << "Train " << points.size() << " parameter sets in " << nWorkers << " worker processes" << Endl;
+      TProcPool pool(nWorkers);
+      std::vector<TParameter<Double_t> *> results = pool.Map(trainPoint, indices);
+
+      std::vector<Double_t> foms(points.size(), 0);
+      std::vector<Bool_t>   done(points.size(), kFALSE);
+      for (UInt_t i=0; i<results.size(); i++) {
+         if (!results[i]) continue;
+         Int_t index = TString(results[i]->GetName()).Atoi();
+         if (index >= 0 && index < Int_t(points.size())) {
+            foms[index] = results[i]->GetVal();
+            done[index] = kTRUE;
+         }
+         delete results[i];
+      }
+      for (UInt_t i=0; i<points.size(); i++) {
+         if (!done[i]) {
+            Log() << kWARNING << "Worker failed for parameter set " << i << ", train it again in this process" << Endl;
+            EstimatorFunction(points[i]);
+            continue;
+         }
+         fFOMvsIter.push_back(foms[i]);
+         fAlreadyTrainedParCombination.insert(std::make_pair(points[i],-foms[i]));
+      }
+   }
+#endif
+
+   estimators.resize(parameters.size());
+   for (UInt_t i=0; i<parameters.size(); i++) estimators[i] = EstimatorFunction(parameters[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// called in a worker process of EstimatorFunctions before each parameter set.
+/// The directories of the method are in the output file of the factory, which
+/// the worker shares with the parent process: they are moved to the private
+/// output file of the worker (see Factory::PrepareWorkerProcess)
+
+void TMVA::OptimizeConfigParameters::PrepareWorker()
+{
+   TFile *workerFile = Factory::PrepareWorkerProcess();
+   if (workerFile == 0) Log() << kFATAL << "Cannot open the output file of the worker process" << Endl;
+   if (GetMethod()->GetFile() != workerFile) {
+      GetMethod()->SetFile(workerFile);
+      GetMethod()->SetMethodBaseDir(0);
+      GetMethod()->SetBaseDir(0);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// train the method with the given parameters and return the figure of merit
+
+Double_t TMVA::OptimizeConfigParameters::TrainAndGetFOM( std::vector<Double_t> & pars)
+{
+   std::map<TString,Double_t> currentParameters;
+   Int_t icount =0; // map "pars" to the  map of Tuneparameter, make sure
+                    // you never screw up this order!!
+   std::map<TString, TMVA::Interval*>::iterator it;
+   for (it=fTuneParameters.begin(); it!=fTuneParameters.end(); it++){
+      currentParameters[it->first] = pars[icount++];
+   }
+   GetMethod()->Reset();
+   GetMethod()->SetTuneParameters(currentParameters);
+   GetMethod()->BaseDir()->cd();
+   
+   if (fNotDoneYet){
+      GetMethod()->GetTransformationHandler().
+         CalcTransformations(GetMethod()->Data()->GetEventCollection());
+      fNotDoneYet=kFALSE;
    }
+   Event::SetIsTraining(kTRUE);
+   GetMethod()->Train();
+   Event::SetIsTraining(kFALSE);
+
+   return GetFOM(); 
 }
 
 ////////////////////////////////////////////////////////////////////////////////
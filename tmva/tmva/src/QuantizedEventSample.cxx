@@ -0,0 +1,102 @@
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : QuantizedEventSample                                                  *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Copy of a training event sample with every input variable quantized       *
+ *      into at most 256 bins, used by the histogram training of decision trees   *
+ *                                                                                *
+ * Copyright (c) 2016:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+//_______________________________________________________________________
+//
+// QuantizedEventSample
+//
+// The input variables of the training events are quantized once into
+// at most 256 bins per variable and stored as a column-major matrix of
+// bytes. The bin edges are chosen at the quantiles of the (unweighted)
+// distribution of each variable, half way between two neighbouring
+// distinct values. A variable with fewer distinct values than bins gets
+// one bin per value. Decision trees grown on this sample only need to
+// accumulate per-bin sums instead of re-reading the event values at
+// every node.
+//_______________________________________________________________________
+
+#include <algorithm>
+
+#include "TMVA/QuantizedEventSample.h"
+#include "TMVA/Event.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// quantize the first nVars input variables of the events into at most
+/// nBins (<= 256) bins
+
+TMVA::QuantizedEventSample::QuantizedEventSample( const std::vector<const TMVA::Event*>& events,
+                                                  UInt_t nVars, UInt_t nBins ) :
+   fNEvents(events.size()),
+   fNVars(nVars),
+   fMaxBins(1),
+   fEdges(nVars)
+{
+   if (nBins > 256) nBins = 256;
+   if (nBins < 2)   nBins = 2;
+
+   if (fNEvents == 0) return;
+
+   // the size of the bin matrix may exceed the range of UInt_t
+   fBins.resize((size_t)fNVars*fNEvents);
+   fRows.reserve(fNEvents);
+   for (UInt_t ievt=0; ievt<fNEvents; ievt++) fRows.insert(std::make_pair(events[ievt],ievt));
+
+   std::vector<Float_t> values(fNEvents);
+   for (UInt_t ivar=0; ivar<fNVars; ivar++) {
+      for (UInt_t ievt=0; ievt<fNEvents; ievt++) values[ievt] = events[ievt]->GetValue(ivar);
+      std::sort(values.begin(), values.end());
+
+      // place the edges at the quantiles, between two distinct values
+      std::vector<Float_t>& edges = fEdges[ivar];
+      for (UInt_t ibin=1; ibin<nBins; ibin++) {
+         UInt_t i = (UInt_t)((ULong64_t)ibin*fNEvents/nBins);
+         if (i==0 || i>=fNEvents) continue;
+         // move to the next change of value at or after the quantile
+         const Float_t* up = std::upper_bound(&values[0]+i-1, &values[0]+fNEvents, values[i-1]);
+         if (up == &values[0]+fNEvents) break;
+         Float_t edge = 0.5f*(*(up-1) + *up);
+         if (!(edge > *(up-1))) edge = *up;
+         if (edges.empty() || edge > edges.back()) edges.push_back(edge);
+      }
+      if (edges.size()+1 > fMaxBins) fMaxBins = edges.size()+1;
+
+      UChar_t* column = &fBins[(size_t)ivar*fNEvents];
+      for (UInt_t ievt=0; ievt<fNEvents; ievt++) {
+         Float_t x = events[ievt]->GetValue(ivar);
+         column[ievt] = std::upper_bound(edges.begin(), edges.end(), x) - edges.begin();
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// destructor
+
+TMVA::QuantizedEventSample::~QuantizedEventSample()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// row of the event in the bin matrix, -1 if the event is not part of the sample
+
+Int_t TMVA::QuantizedEventSample::GetRow( const TMVA::Event* ev ) const
+{
+   std::unordered_map<const TMVA::Event*,UInt_t>::const_iterator it = fRows.find(ev);
+   if (it == fRows.end()) return -1;
+   return it->second;
+}
@@ -560,6 +560,49 @@ Double_t TMVA::Reader::EvaluateMVA( const TString& methodTag, Double_t aux )
    return this->EvaluateMVA( kl, aux );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Evaluate the MVA for nEvents events at once and store the responses in
+/// mvaValues[0..nEvents-1]. The input variables are given as column-major
+/// array in the order in which they were added to the reader,
+/// inputs[ivar*nEvents+ievt]. Methods providing a batch evaluation (BDT)
+/// process the events in blocks, the others evaluate them one by one.
+/// Events with a NaN input get the MVA value -999.
+/// The parameter aux is obligatory for the cuts method where it represents the efficiency cutoff
+
+void TMVA::Reader::EvaluateMVA( const Float_t* inputs, UInt_t nEvents, const TString& methodTag,
+                                Double_t* mvaValues, Double_t aux )
+{
+   IMethod* imeth = FindMVA( methodTag );
+   MethodBase* meth = dynamic_cast<TMVA::MethodBase*>(imeth);
+   if (meth==0) {
+      for (UInt_t ievt=0; ievt<nEvents; ievt++) mvaValues[ievt] = 0;
+      return;
+   }
+
+   if (meth->GetMethodType() == TMVA::Types::kCuts) {
+      TMVA::MethodCuts* mc = dynamic_cast<TMVA::MethodCuts*>(meth);
+      if(mc)
+         mc->SetTestSignalEfficiency( aux );
+   }
+
+   meth->GetBatchMvaValues( inputs, nEvents, mvaValues );
+
+   // flag the events with NaN input
+   const UInt_t nvar = DataInfo().GetNVariables();
+   UInt_t nNaN = 0;
+   for (UInt_t ievt=0; ievt<nEvents; ievt++) {
+      for (UInt_t ivar=0; ivar<nvar; ivar++) {
+         if (TMath::IsNaN(inputs[ivar*nEvents+ievt])) {
+            mvaValues[ievt] = -999;
+            nNaN++;
+            break;
+         }
+      }
+   }
+   if (nNaN > 0)
+      Log() << kERROR << nNaN << " events have a NaN input variable --> return MVA value -999, \n that's all I can do, please fix or remove these events." << Endl;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// evaluates the MVA
 
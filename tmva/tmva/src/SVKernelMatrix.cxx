@@ -38,42 +38,112 @@
 #include "TMVA/SVKernelFunction.h"
 #include "TMVA/Types.h"
 
+#include "RConfigure.h"
 #include "RtypesCore.h"
+#include "TMath.h"
+#include "TROOT.h"
+
+#ifdef R__USE_IMT
+#include "tbb/parallel_for.h"
+#endif
 
 #include <iostream>
 #include <stdexcept>
 
+namespace {
+   // number of kernel values computed together by one task
+   const UInt_t kBlockSize = 4096;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// constructor
 
 TMVA::SVKernelMatrix::SVKernelMatrix()
    : fSize(0),
      fKernelFunction(0),
+     fInputVectors(0),
      fSVKernelMatrix(0),
+     fNCacheLines(0),
      fLogger( new MsgLogger("ResultsRegression", kINFO) )
 {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// constructor
+/// constructor. The lower triangle of the kernel matrix is computed if it fits
+/// in cacheSizeMB megabytes (or if cacheSizeMB is 0), the rows are then computed
+/// in parallel with implicit multi-threading. Otherwise the rows are computed when
+/// they are requested and kept in a cache of cacheSizeMB megabytes (at least two
+/// rows), the least recently used row being replaced
 
-TMVA::SVKernelMatrix::SVKernelMatrix( std::vector<TMVA::SVEvent*>* inputVectors, SVKernelFunction* kernelFunction )
+TMVA::SVKernelMatrix::SVKernelMatrix( std::vector<TMVA::SVEvent*>* inputVectors, SVKernelFunction* kernelFunction,
+                                      UInt_t cacheSizeMB )
    : fSize(inputVectors->size()),
      fKernelFunction(kernelFunction),
+     fInputVectors(inputVectors),
+     fSVKernelMatrix(0),
+     fNCacheLines(2),
      fLogger( new MsgLogger("SVKernelMatrix", kINFO) )
 {
-   fSVKernelMatrix = new Float_t*[fSize];
+   const Double_t cacheSize = Double_t(cacheSizeMB)*1024*1024;
+   const Double_t matrixSize = 0.5*fSize*(fSize+1.)*sizeof(Float_t);
+   const Double_t lineSize = Double_t(fSize)*sizeof(Float_t);
+
+   if (cacheSizeMB == 0 || matrixSize <= cacheSize) {
+      fSVKernelMatrix = new Float_t*[fSize];
+      try{
+         for (UInt_t i = 0; i < fSize; i++) fSVKernelMatrix[i] = new Float_t[i+1];
+      }catch(...){
+         Log() << kFATAL << "Input data too large. Not enough memory to allocate memory for Support Vector Kernel Matrix. Please reduce the number of input events, set a kernel cache size or use a different method."<<Endl;
+      }
+      // We compute the diagonal and one half of the off diagonal. When reading back we use
+      // the symmetry of i,j to j,i to ensure the correct values are returned.
+      auto computeRows = [&](UInt_t first, UInt_t last) {
+         for (UInt_t i = first; i < last; i++) {
+            for (UInt_t j = 0; j <=i; j++) {
+               fSVKernelMatrix[i][j] = fKernelFunction->Evaluate((*inputVectors)[i], (*inputVectors)[j]);
+            }
+         }
+      };
+#ifdef R__USE_IMT
+      if (ROOT::IsImplicitMTEnabled()) {
+         // blocks of rows with about kBlockSize*kBlockSize/2 values each
+         std::vector<UInt_t> bounds(1, 0);
+         Double_t nValues = 0;
+         for (UInt_t i = 0; i < fSize; i++) {
+            nValues += i+1;
+            if (nValues >= 0.5*kBlockSize*kBlockSize) { bounds.push_back(i+1); nValues = 0; }
+         }
+         if (bounds.back() != fSize) bounds.push_back(fSize);
+         tbb::parallel_for(UInt_t(0), UInt_t(bounds.size()-1), [&](UInt_t iblock) {
+               computeRows(bounds[iblock], bounds[iblock+1]);
+            });
+      }
+      else {
+         computeRows(0, fSize);
+      }
+#else
+      computeRows(0, fSize);
+#endif
+   }
+   else {
+      if (cacheSize/lineSize > fNCacheLines) fNCacheLines = UInt_t(cacheSize/lineSize);
+      if (fNCacheLines > fSize) fNCacheLines = fSize;
+      Log() << kINFO << "Kernel matrix of " << fSize << " events does not fit in " << cacheSizeMB
+            << " MB, caching " << fNCacheLines << " rows" << Endl;
+   }
+
+   // cache of rows returned by GetLine; for the full matrix two rows only
+   if (fSVKernelMatrix) fNCacheLines = 2;
    try{
-      for (UInt_t i = 0; i < fSize; i++) fSVKernelMatrix[i] = new Float_t[i+1];
+      fCache.resize(size_t(fNCacheLines)*fSize);
    }catch(...){
-      Log() << kFATAL << "Input data too large. Not enough memory to allocate memory for Support Vector Kernel Matrix. Please reduce the number of input events or use a different method."<<Endl;
+      Log() << kFATAL << "Not enough memory to allocate the kernel matrix cache of " << fNCacheLines << " rows" << Endl;
    }
-   // We compute the diagonal and one half of the off diagonal. When reading back we use
-   // the symmetry of i,j to j,i to ensure the correct values are returned.
-   for (UInt_t i = 0; i < fSize; i++) {
-      for (UInt_t j = 0; j <=i; j++) {
-         fSVKernelMatrix[i][j] = fKernelFunction->Evaluate((*inputVectors)[i], (*inputVectors)[j]);
-      }
+   fCacheSlot.assign(fSize, -1);
+   fSlotLine.assign(fNCacheLines, -1);
+   fSlotLRU.resize(fNCacheLines);
+   for (UInt_t islot = 0; islot < fNCacheLines; islot++) {
+      fSlotLRU[islot] = fLRU.insert(fLRU.end(), islot);
    }
 }
 
@@ -82,31 +152,73 @@ TMVA::SVKernelMatrix::SVKernelMatrix( std::vector<TMVA::SVEvent*>* inputVectors,
 
 TMVA::SVKernelMatrix::~SVKernelMatrix()
 {
-   for (UInt_t i = fSize -1; i > 0; i--) {
-      delete[] fSVKernelMatrix[i];
-      fSVKernelMatrix[i] = 0;
+   if (fSVKernelMatrix) {
+      for (UInt_t i = 0; i < fSize; i++) {
+         delete[] fSVKernelMatrix[i];
+         fSVKernelMatrix[i] = 0;
+      }
+      delete[] fSVKernelMatrix;
+      fSVKernelMatrix = 0;
    }
-   delete[] fSVKernelMatrix;
-   fSVKernelMatrix = 0;
+   delete fLogger;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// returns a row of the kernel matrix
+/// compute a row of the kernel matrix, from the lower triangle if it has been
+/// computed and otherwise in blocks of the row, in parallel with implicit
+/// multi-threading
+
+void TMVA::SVKernelMatrix::ComputeLine( UInt_t line, Float_t* values ) const
+{
+   if (fSVKernelMatrix) {
+      for( UInt_t i = 0; i <line; i++)
+         values[i] = fSVKernelMatrix[line][i];
+      for( UInt_t i = line; i < fSize; i++)
+         values[i] = fSVKernelMatrix[i][line];
+      return;
+   }
+
+   // same order of the arguments as for the lower triangle
+   SVEvent* ev = (*fInputVectors)[line];
+   auto computeBlock = [&](UInt_t first, UInt_t last) {
+      for (UInt_t i = first; i < last; i++) {
+         values[i] = (i < line) ? fKernelFunction->Evaluate(ev, (*fInputVectors)[i])
+                                : fKernelFunction->Evaluate((*fInputVectors)[i], ev);
+      }
+   };
+#ifdef R__USE_IMT
+   const UInt_t nBlocks = (fSize + kBlockSize - 1)/kBlockSize;
+   if (ROOT::IsImplicitMTEnabled() && nBlocks > 1) {
+      tbb::parallel_for(UInt_t(0), nBlocks, [&](UInt_t iblock) {
+            computeBlock(iblock*kBlockSize, TMath::Min((iblock+1)*kBlockSize, fSize));
+         });
+      return;
+   }
+#endif
+   computeBlock(0, fSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// returns a row of the kernel matrix. The row is owned by the matrix and stays
+/// valid until two further rows have been requested
 
 Float_t* TMVA::SVKernelMatrix::GetLine( UInt_t line )
 {
-   Float_t* fLine = NULL;
    if (line >= fSize) {
       return NULL;
    }
-   else {
-      fLine = new Float_t[fSize];
-      for( UInt_t i = 0; i <line; i++)
-         fLine[i] = fSVKernelMatrix[line][i];
-      for( UInt_t i = line; i < fSize; i++)
-         fLine[i] = fSVKernelMatrix[i][line];
-      return fLine;
+
+   Int_t islot = fCacheSlot[line];
+   if (islot < 0) {
+      // replace the least recently used row
+      islot = fLRU.back();
+      if (fSlotLine[islot] >= 0) fCacheSlot[fSlotLine[islot]] = -1;
+      fSlotLine[islot] = line;
+      fCacheSlot[line] = islot;
+      ComputeLine(line, &fCache[size_t(islot)*fSize]);
    }
+   fLRU.splice(fLRU.begin(), fLRU, fSlotLRU[islot]);
+   return &fCache[size_t(islot)*fSize];
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -114,6 +226,12 @@ Float_t* TMVA::SVKernelMatrix::GetLine( UInt_t line )
 
 Float_t TMVA::SVKernelMatrix::GetElement(UInt_t i, UInt_t j)
 { 
-   if (i > j) return fSVKernelMatrix[i][j]; 
-   else       return fSVKernelMatrix[j][i]; // it's symmetric, ;)
+   if (fSVKernelMatrix) {
+      if (i > j) return fSVKernelMatrix[i][j]; 
+      else       return fSVKernelMatrix[j][i]; // it's symmetric, ;)
+   }
+   if (fCacheSlot[i] >= 0) return fCache[size_t(fCacheSlot[i])*fSize + j];
+   if (fCacheSlot[j] >= 0) return fCache[size_t(fCacheSlot[j])*fSize + i];
+   if (i > j) return fKernelFunction->Evaluate((*fInputVectors)[i], (*fInputVectors)[j]);
+   else       return fKernelFunction->Evaluate((*fInputVectors)[j], (*fInputVectors)[i]);
 }
@@ -34,12 +34,56 @@
 #include "TMVA/Types.h"
 
 
+#include "RConfigure.h"
 #include "TMath.h"
 #include "TRandom3.h"
+#include "TROOT.h"
+
+#ifdef R__USE_IMT
+#include "tbb/parallel_for.h"
+#endif
 
 #include <iostream>
 #include <vector>
 
+namespace {
+   // number of events per chunk of the loops over all events. The chunks do not
+   // depend on the number of threads, and partial results are combined in the
+   // order of the chunks, so that the training does not depend on the threads
+   const UInt_t kChunkSize = 4096;
+
+   UInt_t GetNChunks(UInt_t n) { return (n + kChunkSize - 1)/kChunkSize; }
+
+   ////////////////////////////////////////////////////////////////////////////////
+   /// call func(ichunk, first, last) for all chunks [first, last) of [0, n),
+   /// concurrently if implicit multi-threading is enabled
+
+   template <typename F>
+   void ForEachChunk(UInt_t n, F func)
+   {
+      const UInt_t nChunks = GetNChunks(n);
+#ifdef R__USE_IMT
+      if (ROOT::IsImplicitMTEnabled() && nChunks > 1) {
+         tbb::parallel_for(UInt_t(0), nChunks, [&](UInt_t ichunk) {
+               func(ichunk, ichunk*kChunkSize, TMath::Min((ichunk+1)*kChunkSize, n));
+            });
+         return;
+      }
+#endif
+      for (UInt_t ichunk = 0; ichunk < nChunks; ichunk++) {
+         func(ichunk, ichunk*kChunkSize, TMath::Min((ichunk+1)*kChunkSize, n));
+      }
+   }
+
+   // largest and smallest error cache of a chunk of events (first occurrence)
+   struct ErrorCacheRange {
+      Float_t fLow;
+      Float_t fUp;
+      TMVA::SVEvent* fEventLow;
+      TMVA::SVEvent* fEventUp;
+   };
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// constructor
 
@@ -62,7 +106,7 @@ TMVA::SVWorkingSet::SVWorkingSet()
 /// constructor
 
 TMVA::SVWorkingSet::SVWorkingSet(std::vector<TMVA::SVEvent*>*inputVectors, SVKernelFunction* kernelFunction,
-                                 Float_t tol, Bool_t doreg)
+                                 Float_t tol, Bool_t doreg, UInt_t cacheSizeMB)
    : fdoRegression(doreg),
      fInputData(inputVectors),
      fSupVec(0),
@@ -74,11 +118,10 @@ TMVA::SVWorkingSet::SVWorkingSet(std::vector<TMVA::SVEvent*>*inputVectors, SVKer
      fTolerance(tol),      
      fLogger( new MsgLogger( "SVWorkingSet", kINFO ) )
 {
-   fKMatrix = new TMVA::SVKernelMatrix(inputVectors, kernelFunction);
-   Float_t *pt;
+   // the rows of the kernel matrix are requested from fKMatrix when needed,
+   // the index of an event is its row
+   fKMatrix = new TMVA::SVKernelMatrix(inputVectors, kernelFunction, cacheSizeMB);
    for( UInt_t i = 0; i < fInputData->size(); i++){ 
-      pt = fKMatrix->GetLine(i);
-      fInputData->at(i)->SetLine(pt);
       fInputData->at(i)->SetNs(i);
       if(fdoRegression) fInputData->at(i)->SetErrorCache(fInputData->at(i)->GetTarget());
    }
@@ -127,16 +170,19 @@ Bool_t TMVA::SVWorkingSet::ExamineExample( TMVA::SVEvent* jevt )
    Float_t fErrorC_J = 0.;
    if( jevt->GetIdx()==0) fErrorC_J = jevt->GetErrorCache();
    else{
-      Float_t *fKVals = jevt->GetLine();
+      const Float_t *fKVals = fKMatrix->GetLine(jevt->GetNs());
+      const std::vector<TMVA::SVEvent*> &data = *fInputData;
+      std::vector<Float_t> partial(GetNChunks(data.size()), 0.);
+      ForEachChunk(data.size(), [&](UInt_t ichunk, UInt_t first, UInt_t last) {
+            Float_t sum = 0.;
+            for (UInt_t k = first; k < last; k++) {
+               if(data[k]->GetAlpha()>0)
+                  sum += data[k]->GetAlpha()*data[k]->GetTypeFlag()*fKVals[k];
+            }
+            partial[ichunk] = sum;
+         });
       fErrorC_J = 0.;
-      std::vector<TMVA::SVEvent*>::iterator idIter;
-      
-      UInt_t k=0;
-      for(idIter = fInputData->begin(); idIter != fInputData->end(); idIter++){
-         if((*idIter)->GetAlpha()>0)
-            fErrorC_J += (*idIter)->GetAlpha()*(*idIter)->GetTypeFlag()*fKVals[k];
-         k++;
-      }
+      for (UInt_t ichunk = 0; ichunk < partial.size(); ichunk++) fErrorC_J += partial[ichunk];
       
      
       fErrorC_J -= jevt->GetTypeFlag();
@@ -303,16 +349,16 @@ Bool_t TMVA::SVWorkingSet::TakeStep(TMVA::SVEvent* ievt,TMVA::SVEvent* jevt )
    Float_t dL_I = type_I * ( newAlpha_I - alpha_I );
    Float_t dL_J = type_J * ( newAlpha_J - alpha_J );  
 
-   Int_t k = 0; 
-   for(idIter = fInputData->begin(); idIter != fInputData->end(); idIter++){
-      k++;
-      if((*idIter)->GetIdx()==0){
-         Float_t ii = fKMatrix->GetElement(ievt->GetNs(), (*idIter)->GetNs());
-         Float_t jj = fKMatrix->GetElement(jevt->GetNs(), (*idIter)->GetNs());
-         
-         (*idIter)->UpdateErrorCache(dL_I * ii + dL_J * jj);       
-      }
-   }
+   const std::vector<TMVA::SVEvent*> &data = *fInputData;
+   const Float_t *kVals_I = fKMatrix->GetLine(ievt->GetNs());
+   const Float_t *kVals_J = fKMatrix->GetLine(jevt->GetNs());
+   ForEachChunk(data.size(), [&](UInt_t, UInt_t first, UInt_t last) {
+         for (UInt_t k = first; k < last; k++) {
+            if(data[k]->GetIdx()==0){
+               data[k]->UpdateErrorCache(dL_I * kVals_I[k] + dL_J * kVals_J[k]);
+            }
+         }
+      });
    ievt->SetAlpha(newAlpha_I);
    jevt->SetAlpha(newAlpha_J);
    // set new indexes
@@ -328,18 +374,33 @@ Bool_t TMVA::SVWorkingSet::TakeStep(TMVA::SVEvent* ievt,TMVA::SVEvent* jevt )
    fB_low = -1*1e30;
    fB_up = 1e30;
    
-   for(idIter = fInputData->begin(); idIter != fInputData->end(); idIter++){
-      if((*idIter)->GetIdx()==0){
-         if((*idIter)->GetErrorCache()> fB_low){
-            fB_low = (*idIter)->GetErrorCache();
-            fTEventLow = (*idIter);
-         }
-         if( (*idIter)->GetErrorCache()< fB_up){
-            fB_up =(*idIter)->GetErrorCache();
-            fTEventUp = (*idIter);
+   std::vector<ErrorCacheRange> ranges(GetNChunks(data.size()));
+   ForEachChunk(data.size(), [&](UInt_t ichunk, UInt_t first, UInt_t last) {
+         ErrorCacheRange r = { Float_t(-1*1e30), Float_t(1e30), 0, 0 };
+         for (UInt_t k = first; k < last; k++) {
+            if(data[k]->GetIdx()==0){
+               if(data[k]->GetErrorCache()> r.fLow){
+                  r.fLow = data[k]->GetErrorCache();
+                  r.fEventLow = data[k];
+               }
+               if( data[k]->GetErrorCache()< r.fUp){
+                  r.fUp = data[k]->GetErrorCache();
+                  r.fEventUp = data[k];
+               }
+            }
          }
+         ranges[ichunk] = r;
+      });
+   for (UInt_t ichunk = 0; ichunk < ranges.size(); ichunk++) {
+      if (ranges[ichunk].fEventLow && ranges[ichunk].fLow > fB_low) {
+         fB_low = ranges[ichunk].fLow;
+         fTEventLow = ranges[ichunk].fEventLow;
+      }
+      if (ranges[ichunk].fEventUp && ranges[ichunk].fUp < fB_up) {
+         fB_up = ranges[ichunk].fUp;
+         fTEventUp = ranges[ichunk].fEventUp;
       }
-   }                             
+   }
 
    // for optimized alfa's
    if (fB_low < TMath::Max(ievt->GetErrorCache(), jevt->GetErrorCache())) {
@@ -627,17 +688,17 @@ Bool_t TMVA::SVWorkingSet::TakeStepReg(TMVA::SVEvent* ievt,TMVA::SVEvent* jevt )
       const Float_t diff_alpha_j = jevt->GetDeltaAlpha()+b_alpha_j_p - jevt->GetAlpha();
 
       //update error cache
-      Int_t k = 0; 
-      for(idIter = fInputData->begin(); idIter != fInputData->end(); idIter++){
-         k++;
-         //there will be some changes in Idx notation
-         if((*idIter)->GetIdx()==0){
-            Float_t k_ii = fKMatrix->GetElement(ievt->GetNs(), (*idIter)->GetNs());
-            Float_t k_jj = fKMatrix->GetElement(jevt->GetNs(), (*idIter)->GetNs());
-         
-            (*idIter)->UpdateErrorCache(diff_alpha_i * k_ii + diff_alpha_j * k_jj);
-         }
-      }
+      const std::vector<TMVA::SVEvent*> &data = *fInputData;
+      const Float_t *kVals_I = fKMatrix->GetLine(ievt->GetNs());
+      const Float_t *kVals_J = fKMatrix->GetLine(jevt->GetNs());
+      ForEachChunk(data.size(), [&](UInt_t, UInt_t first, UInt_t last) {
+            for (UInt_t k = first; k < last; k++) {
+               //there will be some changes in Idx notation
+               if(data[k]->GetIdx()==0){
+                  data[k]->UpdateErrorCache(diff_alpha_i * kVals_I[k] + diff_alpha_j * kVals_J[k]);
+               }
+            }
+         });
          
       //store new alphas in SVevents
       ievt->SetAlpha(b_alpha_i);
@@ -652,15 +713,29 @@ Bool_t TMVA::SVWorkingSet::TakeStepReg(TMVA::SVEvent* ievt,TMVA::SVEvent* jevt )
       fB_low = -1*1e30;
       fB_up =1e30;
    
-      for(idIter = fInputData->begin(); idIter != fInputData->end(); idIter++){
-         if((!(*idIter)->IsInI3()) && ((*idIter)->GetErrorCache()> fB_low)){
-            fB_low = (*idIter)->GetErrorCache();
-            fTEventLow = (*idIter);
-                  
+      std::vector<ErrorCacheRange> ranges(GetNChunks(data.size()));
+      ForEachChunk(data.size(), [&](UInt_t ichunk, UInt_t first, UInt_t last) {
+            ErrorCacheRange r = { Float_t(-1*1e30), Float_t(1e30), 0, 0 };
+            for (UInt_t k = first; k < last; k++) {
+               if((!data[k]->IsInI3()) && (data[k]->GetErrorCache()> r.fLow)){
+                  r.fLow = data[k]->GetErrorCache();
+                  r.fEventLow = data[k];
+               }
+               if((!data[k]->IsInI2()) && (data[k]->GetErrorCache()< r.fUp)){
+                  r.fUp = data[k]->GetErrorCache();
+                  r.fEventUp = data[k];
+               }
+            }
+            ranges[ichunk] = r;
+         });
+      for (UInt_t ichunk = 0; ichunk < ranges.size(); ichunk++) {
+         if (ranges[ichunk].fEventLow && ranges[ichunk].fLow > fB_low) {
+            fB_low = ranges[ichunk].fLow;
+            fTEventLow = ranges[ichunk].fEventLow;
          }
-         if((!(*idIter)->IsInI2()) && ((*idIter)->GetErrorCache()< fB_up)){
-            fB_up =(*idIter)->GetErrorCache();
-            fTEventUp = (*idIter);
+         if (ranges[ichunk].fEventUp && ranges[ichunk].fUp < fB_up) {
+            fB_up = ranges[ichunk].fUp;
+            fTEventUp = ranges[ichunk].fEventUp;
          }
       }
       return kTRUE;
@@ -679,15 +754,18 @@ Bool_t TMVA::SVWorkingSet::ExamineExampleReg(TMVA::SVEvent* jevt)
       fErrorC_J = jevt->GetErrorCache();
    }
    else{
-      Float_t *fKVals = jevt->GetLine();
+      const Float_t *fKVals = fKMatrix->GetLine(jevt->GetNs());
+      const std::vector<TMVA::SVEvent*> &data = *fInputData;
+      std::vector<Float_t> partial(GetNChunks(data.size()), 0.);
+      ForEachChunk(data.size(), [&](UInt_t ichunk, UInt_t first, UInt_t last) {
+            Float_t sum = 0.;
+            for (UInt_t k = first; k < last; k++) {
+               sum -= data[k]->GetDeltaAlpha()*fKVals[k];
+            }
+            partial[ichunk] = sum;
+         });
       fErrorC_J = 0.;
-      std::vector<TMVA::SVEvent*>::iterator idIter;
-      
-      UInt_t k=0;
-      for(idIter = fInputData->begin(); idIter != fInputData->end(); idIter++){
-         fErrorC_J -= (*idIter)->GetDeltaAlpha()*fKVals[k];
-         k++;
-      }
+      for (UInt_t ichunk = 0; ichunk < partial.size(); ichunk++) fErrorC_J += partial[ichunk];
       
       fErrorC_J += jevt->GetTarget();
       jevt->SetErrorCache(fErrorC_J);
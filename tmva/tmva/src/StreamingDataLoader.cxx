@@ -0,0 +1,373 @@
+
+/**********************************************************************************
+ * Project: TMVA - a Root-integrated toolkit for multivariate data analysis       *
+ * Package: TMVA                                                                  *
+ * Class  : StreamingDataLoader                                                   *
+ * Web    : http://tmva.sourceforge.net                                           *
+ *                                                                                *
+ * Description:                                                                   *
+ *      Reads the events of the training (or testing) trees of a data set in      *
+ *      shuffled buffers of bounded size, without materializing the full sample   *
+ *                                                                                *
+ * Copyright (c) 2016:                                                            *
+ *      CERN, Switzerland                                                         *
+ *                                                                                *
+ * Redistribution and use in source and binary forms, with or without             *
+ * modification, are permitted according to the terms listed in LICENSE           *
+ * (http://tmva.sourceforge.net/LICENSE)                                          *
+ **********************************************************************************/
+
+//_______________________________________________________________________
+//
+// StreamingDataLoader
+//
+// Reads the events of the trees registered explicitly for training (or
+// testing) in the DataInputHandler of a data set, for the methods that
+// can train on a stream of events instead of the in-memory DataSet
+// (see the StreamTraining option of PrepareTrainingAndTestTree).
+//
+// The entries of the trees are split into chunks, the clusters of the
+// trees (fixed blocks of entries for chains). Each pass over the data
+// reads the chunks in a new random order and fills buffers of about
+// bufferSize events, which are shuffled before they are handed out.
+// Only the branches used by the input, target, spectator, cut and
+// weight expressions are enabled and added to the TTreeCache, so a
+// chunk is read with a few large reads of the needed columns. The
+// memory used does not depend on the number of entries of the trees.
+// The formulas and the cache of each tree are set up once, not at each
+// switch between the trees of the shuffled chunks, and the branch
+// status and cache size of the trees are restored by the destructor.
+//
+// The events are not transformed and their weights are not
+// renormalized (NormMode); the methods apply their own
+// transformations. With SetBagging(fraction) every event is repeated
+// a Poisson distributed number of times, which draws a bootstrap
+// sample on the fly (online bagging).
+//_______________________________________________________________________
+
+#include <algorithm>
+
+#include "TTree.h"
+#include "TChain.h"
+#include "TLeaf.h"
+#include "TBranch.h"
+#include "TTreeFormula.h"
+#include "TMath.h"
+
+#include "TMVA/StreamingDataLoader.h"
+#include "TMVA/DataSetInfo.h"
+#include "TMVA/DataInputHandler.h"
+#include "TMVA/ClassInfo.h"
+#include "TMVA/VariableInfo.h"
+#include "TMVA/Event.h"
+#include "TMVA/MsgLogger.h"
+
+namespace {
+   // number of entries per chunk for chains, which have no cluster iterator
+   const Long64_t kChainChunkSize = 10000;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// constructor: collect the trees of the given type and split them into chunks
+
+TMVA::StreamingDataLoader::StreamingDataLoader( DataSetInfo& dsi, DataInputHandler& dataInput,
+                                                Types::ETreeType type, UInt_t bufferSize, UInt_t seed ) :
+   fDataSetInfo(dsi),
+   fNextChunk(0),
+   fNextEntry(0),
+   fCurrentTree(-1),
+   fNEntries(0),
+   fBufferSize(bufferSize > 0 ? bufferSize : 1),
+   fCacheSize(30000000),
+   fBaggingFraction(0),
+   fRandom(seed),
+   fLogger( new MsgLogger("StreamingDataLoader", kINFO) )
+{
+   if (type != Types::kTraining && type != Types::kTesting) {
+      Log() << kFATAL << "<StreamingDataLoader> only training or testing trees can be streamed" << Endl;
+   }
+
+   for (UInt_t cl=0; cl<dsi.GetNClasses(); cl++) {
+      const TString& className = dsi.GetClassInfo(cl)->GetName();
+      UInt_t nSkipped = 0;
+      std::vector<TreeInfo>::const_iterator treeIt = dataInput.begin(className);
+      for (; treeIt!=dataInput.end(className); treeIt++) {
+         if (treeIt->GetTreeType() != type) {
+            if (treeIt->GetTreeType() == Types::kMaxTreeType) nSkipped++;
+            continue;
+         }
+         fTrees.push_back(treeIt->GetTree());
+         fTreeClass.push_back(cl);
+         fTreeWeight.push_back(treeIt->GetWeight());
+      }
+      if (nSkipped > 0) {
+         Log() << kWARNING << nSkipped << " tree(s) of class \"" << className << "\" are not registered explicitly for "
+               << (type == Types::kTraining ? "training" : "testing") << " and are not streamed" << Endl;
+      }
+   }
+   if (fTrees.empty()) {
+      Log() << kWARNING << "<StreamingDataLoader> no tree to stream; register the trees with "
+            << "Types::kTraining or Types::kTesting" << Endl;
+   }
+
+   fTreeStates.resize(fTrees.size());
+   for (UInt_t itree=0; itree<fTrees.size(); itree++) {
+      TTree* tree = fTrees[itree];
+      fTreeStates[itree].fOwner = std::find(fTrees.begin(), fTrees.end(), tree) - fTrees.begin();
+      Long64_t nentries = tree->GetEntries();
+      fNEntries += nentries;
+      Chunk chunk;
+      chunk.fTree = itree;
+      if (tree->InheritsFrom(TChain::Class())) {
+         for (Long64_t first=0; first<nentries; first+=kChainChunkSize) {
+            chunk.fFirst = first;
+            chunk.fLast  = TMath::Min(first+kChainChunkSize, nentries);
+            fChunks.push_back(chunk);
+         }
+      } else {
+         TTree::TClusterIterator clusterIt = tree->GetClusterIterator(0);
+         Long64_t first;
+         while ((first = clusterIt()) < nentries) {
+            chunk.fFirst = first;
+            chunk.fLast  = TMath::Min(clusterIt.GetNextEntry(), nentries);
+            fChunks.push_back(chunk);
+         }
+      }
+   }
+
+   Rewind();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// destructor: give the trees back in the state they were handed over
+
+TMVA::StreamingDataLoader::~StreamingDataLoader()
+{
+   for (UInt_t itree=0; itree<fTrees.size(); itree++) Restore(itree);
+   for (UInt_t i=0; i<fPool.size(); i++) delete fPool[i];
+   delete fLogger;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// delete the formulas of a tree
+
+void TMVA::StreamingDataLoader::ClearFormulas( TreeState& state )
+{
+   for (UInt_t i=0; i<state.fInputFormulas.size(); i++)     delete state.fInputFormulas[i];
+   for (UInt_t i=0; i<state.fTargetFormulas.size(); i++)    delete state.fTargetFormulas[i];
+   for (UInt_t i=0; i<state.fSpectatorFormulas.size(); i++) delete state.fSpectatorFormulas[i];
+   state.fInputFormulas.clear();
+   state.fTargetFormulas.clear();
+   state.fSpectatorFormulas.clear();
+   delete state.fCutFormula;    state.fCutFormula = 0;
+   delete state.fWeightFormula; state.fWeightFormula = 0;
+   state.fTreeNumber = -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// delete the formulas of a tree and restore its branch status and cache size.
+/// The cache is recreated with its original size, in its learning phase
+
+void TMVA::StreamingDataLoader::Restore( UInt_t itree )
+{
+   TreeState& state = fTreeStates[itree];
+   ClearFormulas(state);
+   state.fBranchesEnabled = kFALSE;
+   if (!state.fPrepared) return;
+   TTree* tree = fTrees[itree];
+   for (UInt_t i=0; i<state.fBranchStatus.size(); i++) {
+      tree->SetBranchStatus(state.fBranchStatus[i].first, state.fBranchStatus[i].second);
+   }
+   tree->SetCacheSize(0);
+   if (state.fCacheSize > 0) tree->SetCacheSize(state.fCacheSize);
+   state.fBranchStatus.clear();
+   state.fPrepared = kFALSE;
+   state.fStatusSaved = kFALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// start a new pass: shuffle the order of the chunks
+
+void TMVA::StreamingDataLoader::Rewind()
+{
+   for (UInt_t i=fChunks.size(); i>1; i--) std::swap(fChunks[i-1], fChunks[fRandom.Integer(i)]);
+   fNextChunk = 0;
+   fNextEntry = fChunks.empty() ? 0 : fChunks[0].fFirst;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// read the next buffer of events and shuffle it
+
+const std::vector<TMVA::Event*>& TMVA::StreamingDataLoader::NextBuffer()
+{
+   fBuffer.clear();
+   while (fBuffer.size() < fBufferSize && fNextChunk < fChunks.size()) {
+      const Chunk& chunk = fChunks[fNextChunk];
+      fCurrentTree = chunk.fTree;
+      ReadEntry(fNextEntry);
+      if (++fNextEntry >= chunk.fLast) {
+         fNextChunk++;
+         if (fNextChunk < fChunks.size()) fNextEntry = fChunks[fNextChunk].fFirst;
+      }
+   }
+   for (UInt_t i=fBuffer.size(); i>1; i--) std::swap(fBuffer[i-1], fBuffer[fRandom.Integer(i)]);
+   return fBuffer;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// read one entry of the current tree and append the accepted events to the buffer
+
+void TMVA::StreamingDataLoader::ReadEntry( Long64_t entry )
+{
+   TTree* tree = fTrees[fCurrentTree];
+   TreeState& state = fTreeStates[fCurrentTree];
+   TreeState& owner = fTreeStates[state.fOwner];
+
+   // the first time the tree is read: save its cache size and set up the cache
+   if (!owner.fPrepared) {
+      owner.fPrepared = kTRUE;
+      owner.fCacheSize = tree->GetCacheSize();
+      tree->SetCacheSize(fCacheSize);
+   }
+
+   if (tree->LoadTree(entry) < 0) return;
+
+   const UInt_t cl = fTreeClass[fCurrentTree];
+
+   // create the formulas for a new tree, or a new element of a chain
+   if (tree->GetTreeNumber() != state.fTreeNumber) {
+      ClearFormulas(state);
+      state.fTreeNumber = tree->GetTreeNumber();
+      TTree* tr = tree->GetTree();
+
+      std::vector<TTreeFormula*> all;
+      for (UInt_t i=0; i<fDataSetInfo.GetNVariables(); i++) {
+         const VariableInfo& info = fDataSetInfo.GetVariableInfo(i);
+         state.fInputFormulas.push_back(new TTreeFormula(Form("Formula%s", info.GetInternalName().Data()), info.GetExpression(), tr));
+         all.push_back(state.fInputFormulas.back());
+      }
+      for (UInt_t i=0; i<fDataSetInfo.GetNTargets(); i++) {
+         const VariableInfo& info = fDataSetInfo.GetTargetInfo(i);
+         state.fTargetFormulas.push_back(new TTreeFormula(Form("Formula%s", info.GetInternalName().Data()), info.GetExpression(), tr));
+         all.push_back(state.fTargetFormulas.back());
+      }
+      for (UInt_t i=0; i<fDataSetInfo.GetNSpectators(); i++) {
+         const VariableInfo& info = fDataSetInfo.GetSpectatorInfo(i);
+         state.fSpectatorFormulas.push_back(new TTreeFormula(Form("Formula%s", info.GetInternalName().Data()), info.GetExpression(), tr));
+         all.push_back(state.fSpectatorFormulas.back());
+      }
+      const TString cut(fDataSetInfo.GetClassInfo(cl)->GetCut().GetTitle());
+      if (cut != "") {
+         state.fCutFormula = new TTreeFormula(Form("CutClass%i", cl), cut, tr);
+         all.push_back(state.fCutFormula);
+      }
+      const TString weight = fDataSetInfo.GetClassInfo(cl)->GetWeight();
+      if (weight != "") {
+         state.fWeightFormula = new TTreeFormula("FormulaWeight", weight, tr);
+         all.push_back(state.fWeightFormula);
+      }
+
+      // enable only the branches used by the formulas; for a chain the status
+      // is set on the chain, which applies it to all of its elements
+      if (!owner.fStatusSaved) {
+         owner.fStatusSaved = kTRUE;
+         std::vector<TObjArray*> lists(1, tr->GetListOfBranches());
+         for (UInt_t il=0; il<lists.size(); il++) {
+            TIter next(lists[il]);
+            TBranch* br;
+            while ((br = (TBranch*)next())) {
+               owner.fBranchStatus.push_back(std::make_pair(TString(br->GetName()), !br->TestBit(kDoNotProcess)));
+               if (br->GetListOfBranches()->GetEntriesFast() > 0) lists.push_back(br->GetListOfBranches());
+            }
+         }
+         tree->SetBranchStatus("*", 0);
+      }
+      for (UInt_t i=0; i<all.size(); i++) {
+         if (all[i]->GetNdim() <= 0) {
+            Log() << kFATAL << "Expression " << all[i]->GetTitle() << " could not be resolved to a valid formula" << Endl;
+         }
+         for (Int_t bi=0; bi<all[i]->GetNcodes(); bi++) {
+            TLeaf* leaf = all[i]->GetLeaf(bi);
+            if (!leaf) continue;
+            if (!state.fBranchesEnabled) tree->SetBranchStatus(leaf->GetBranch()->GetName(), 1);
+            tr->AddBranchToCache(leaf->GetBranch(), kTRUE);
+         }
+      }
+      state.fBranchesEnabled = kTRUE;
+      tr->StopCacheLearningPhase();
+   }
+
+   // array-valued expressions give one event per element
+   Int_t sizeOfArrays = 1;
+   for (UInt_t ivar=0; ivar<state.fInputFormulas.size(); ivar++) {
+      Int_t ndata = state.fInputFormulas[ivar]->GetNdata();
+      if (ndata == 1) continue;
+      if (sizeOfArrays == 1) sizeOfArrays = ndata;
+      else if (sizeOfArrays != ndata) {
+         Log() << kFATAL << "Multiple array-type expressions of different length in entry " << entry
+               << " of tree " << tree->GetName() << Endl;
+      }
+   }
+
+   for (Int_t idata=0; idata<sizeOfArrays; idata++) {
+      if (state.fCutFormula) {
+         Float_t cutVal = (state.fCutFormula->GetNdata() == 1 ? state.fCutFormula->EvalInstance(0) : state.fCutFormula->EvalInstance(idata));
+         if (TMath::IsNaN(cutVal) || cutVal < 0.5) continue;
+      }
+
+      Double_t weight = fTreeWeight[fCurrentTree];
+      if (state.fWeightFormula) {
+         weight *= (state.fWeightFormula->GetNdata() == 1 ? state.fWeightFormula->EvalInstance(0) : state.fWeightFormula->EvalInstance(idata));
+         if (TMath::IsNaN(weight)) continue;
+      }
+
+      Int_t repeat = 1;
+      if (fBaggingFraction > 0) {
+         repeat = Int_t(fRandom.PoissonD(fBaggingFraction));
+         if (repeat == 0) continue;
+      }
+
+      Event* ev = NewEvent();
+      Bool_t containsNaN = kFALSE;
+      for (UInt_t ivar=0; ivar<state.fInputFormulas.size(); ivar++) {
+         TTreeFormula* formula = state.fInputFormulas[ivar];
+         Float_t val = (formula->GetNdata() == 1 ? formula->EvalInstance(0) : formula->EvalInstance(idata));
+         if (TMath::IsNaN(val)) containsNaN = kTRUE;
+         ev->SetVal(ivar, val);
+      }
+      for (UInt_t itgt=0; itgt<state.fTargetFormulas.size(); itgt++) {
+         TTreeFormula* formula = state.fTargetFormulas[itgt];
+         Float_t val = (formula->GetNdata() == 1 ? formula->EvalInstance(0) : formula->EvalInstance(idata));
+         if (TMath::IsNaN(val)) containsNaN = kTRUE;
+         ev->SetTarget(itgt, val);
+      }
+      for (UInt_t ispec=0; ispec<state.fSpectatorFormulas.size(); ispec++) {
+         TTreeFormula* formula = state.fSpectatorFormulas[ispec];
+         ev->SetSpectator(ispec, formula->GetNdata() == 1 ? formula->EvalInstance(0) : formula->EvalInstance(idata));
+      }
+      if (containsNaN) continue; // the event is not added to the buffer and is reused
+      ev->SetClass(cl);
+      ev->SetWeight(weight);
+      ev->SetBoostWeight(1.);
+
+      fBuffer.push_back(ev);
+      for (Int_t i=1; i<repeat; i++) {
+         Event* copy = NewEvent();
+         *copy = *ev;
+         fBuffer.push_back(copy);
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// the event following the last one of the buffer, taken from the pool
+
+TMVA::Event* TMVA::StreamingDataLoader::NewEvent()
+{
+   if (fBuffer.size() < fPool.size()) return fPool[fBuffer.size()];
+   std::vector<Float_t> vars(fDataSetInfo.GetNVariables());
+   std::vector<Float_t> tgts(fDataSetInfo.GetNTargets());
+   std::vector<Float_t> spec(fDataSetInfo.GetNSpectators());
+   fPool.push_back(new Event(vars, tgts, spec));
+   return fPool.back();
+}
@@ -0,0 +1,207 @@
+// @(#)root/tmva $Id$
+
+/*************************************************************************
+ * Copyright (C) 2016, CERN                                              *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////
+// Training throughput of the reference and the multi-threaded CPU  //
+// implementations of DNNs. A 784-256-128-10 network is trained on  //
+// MNIST-like data (10 random class prototypes plus gaussian noise) //
+// with the cross entropy loss. The CPU architecture is timed with  //
+// 1, 2, 4, ... threads of the ROOT implicit multi-threading pool,  //
+// once with a single net (parallelism within the kernels only) and //
+// once with one net per thread (batch-level parallelism).          //
+//                                                                  //
+// The BLAS calls may use threads of their own. For the numbers to  //
+// be meaningful run with OPENBLAS_NUM_THREADS=1 (or the equivalent //
+// setting of the BLAS implementation in use).                      //
+//////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+#include "TMatrix.h"
+#include "TRandom3.h"
+#include "TROOT.h"
+#include "tbb/task_arena.h"
+#include "TMVA/DNN/Architectures/Reference.h"
+#include "TMVA/DNN/Architectures/Cpu.h"
+#include "TMVA/DNN/Minimizers.h"
+#include "TMVA/DNN/Net.h"
+
+using namespace TMVA::DNN;
+
+const size_t kInputWidth  = 784;
+const size_t kOutputWidth = 10;
+const size_t kBatchSize   = 100;
+
+/** Fill X with nSamples events drawn around kOutputWidth random prototypes
+ *  and Y with the corresponding one-hot encoded class labels. */
+void makeData(TMatrixT<Double_t> &X, TMatrixT<Double_t> &Y)
+{
+   TRandom3 rand(4357);
+   TMatrixT<Double_t> prototypes(kOutputWidth, kInputWidth);
+   for (size_t i = 0; i < kOutputWidth; i++) {
+      for (size_t j = 0; j < kInputWidth; j++) {
+         prototypes(i, j) = rand.Uniform();
+      }
+   }
+
+   for (Int_t i = 0; i < X.GetNrows(); i++) {
+      size_t label = i % kOutputWidth;
+      for (size_t j = 0; j < kInputWidth; j++) {
+         X(i, j) = prototypes(label, j) + 0.5 * rand.Gaus();
+      }
+      for (size_t j = 0; j < kOutputWidth; j++) {
+         Y(i, j) = (j == label) ? 1.0 : 0.0;
+      }
+   }
+}
+
+/** Train the benchmark net for \p nEpochs epochs on the given data, using
+ *  \p nNets copies of the net per step. Returns the number of training
+ *  samples processed per second. */
+template <typename Architecture>
+double benchmarkTraining(const TMatrixT<Double_t> &X,
+                         const TMatrixT<Double_t> &Y,
+                         size_t nEpochs,
+                         size_t nNets)
+{
+   using Net_t  = TNet<Architecture>;
+   using Data_t = MatrixInput_t;
+
+   size_t nSamples = X.GetNrows();
+
+   Net_t net(kBatchSize, kInputWidth, ELossFunction::kCrossEntropy);
+   net.AddLayer(256, EActivationFunction::kRelu);
+   net.AddLayer(128, EActivationFunction::kRelu);
+   net.AddLayer(kOutputWidth, EActivationFunction::kIdentity);
+   net.Initialize(EInitialization::kGauss);
+
+   std::vector<Net_t> nets{};
+   nets.reserve(nNets);
+   for (size_t i = 0; i < nNets; i++) {
+      nets.push_back(net);
+      for (size_t j = 0; j < net.GetDepth(); j++) {
+         Architecture::Copy(nets.back().GetLayer(j).GetWeights(),
+                            net.GetLayer(j).GetWeights());
+         Architecture::Copy(nets.back().GetLayer(j).GetBiases(),
+                            net.GetLayer(j).GetBiases());
+      }
+   }
+
+   TGradientDescent<Architecture> minimizer(0.001, 1, 1);
+   Data_t data(X, Y);
+   // One buffer per net, the batches of a step are propagated concurrently.
+   TDataLoader<Data_t, Architecture> loader(data, nSamples, kBatchSize,
+                                            kInputWidth, kOutputWidth, nNets);
+   size_t nBatches = (nSamples / kBatchSize / nNets) * nNets;
+
+   std::chrono::time_point<std::chrono::system_clock> start, end;
+   start = std::chrono::system_clock::now();
+   for (size_t epoch = 0; epoch < nEpochs; epoch++) {
+      loader.Shuffle();
+      std::vector<TBatch<Architecture>> batches{};
+      for (size_t i = 0; i < nBatches; i += nNets) {
+         batches.clear();
+         for (size_t j = 0; j < nNets; j++) {
+            batches.push_back(loader.GetBatch());
+         }
+         minimizer.Step(net, nets, batches);
+      }
+   }
+   end = std::chrono::system_clock::now();
+
+   std::chrono::duration<double> elapsed = end - start;
+   return nEpochs * nBatches * kBatchSize / elapsed.count();
+}
+
+/** Same as benchmarkTraining() for the reference architecture, for which
+ *  the batches are copied directly from the data matrices. */
+double benchmarkReference(const TMatrixT<Double_t> &X,
+                          const TMatrixT<Double_t> &Y,
+                          size_t nEpochs)
+{
+   using Architecture = TReference<Real_t>;
+   using Net_t        = TNet<Architecture>;
+
+   size_t nSamples = X.GetNrows();
+
+   Net_t net(kBatchSize, kInputWidth, ELossFunction::kCrossEntropy);
+   net.AddLayer(256, EActivationFunction::kRelu);
+   net.AddLayer(128, EActivationFunction::kRelu);
+   net.AddLayer(kOutputWidth, EActivationFunction::kIdentity);
+   net.Initialize(EInitialization::kGauss);
+
+   TGradientDescent<Architecture> minimizer(0.001, 1, 1);
+   TMatrixT<Real_t> input(kBatchSize, kInputWidth), output(kBatchSize, kOutputWidth);
+   size_t nBatches = nSamples / kBatchSize;
+
+   std::chrono::time_point<std::chrono::system_clock> start, end;
+   start = std::chrono::system_clock::now();
+   for (size_t epoch = 0; epoch < nEpochs; epoch++) {
+      for (size_t i = 0; i < nBatches; i++) {
+         for (size_t j = 0; j < kBatchSize; j++) {
+            for (size_t k = 0; k < kInputWidth; k++) {
+               input(j, k) = X(i * kBatchSize + j, k);
+            }
+            for (size_t k = 0; k < kOutputWidth; k++) {
+               output(j, k) = Y(i * kBatchSize + j, k);
+            }
+         }
+         minimizer.Step(net, input, output);
+      }
+   }
+   end = std::chrono::system_clock::now();
+
+   std::chrono::duration<double> elapsed = end - start;
+   return nEpochs * nBatches * kBatchSize / elapsed.count();
+}
+
+int main(int argc, char **argv)
+{
+   size_t nSamples   = (argc > 1) ? atoi(argv[1]) : 10000;
+   size_t nEpochs    = (argc > 2) ? atoi(argv[2]) : 2;
+   size_t maxThreads = (argc > 3) ? atoi(argv[3]) : 32;
+
+   TMatrixT<Double_t> X(nSamples, kInputWidth), Y(nSamples, kOutputWidth);
+   makeData(X, Y);
+
+   std::cout << std::fixed << std::setprecision(1);
+   std::cout << "Training " << kInputWidth << "-256-128-" << kOutputWidth
+             << " net, " << nSamples << " samples, batch size " << kBatchSize
+             << std::endl << std::endl;
+
+   // The reference implementation is slow, a single epoch is enough.
+   double reference = benchmarkReference(X, Y, 1);
+   std::cout << std::setw(30) << std::left << "Reference" << std::right
+             << std::setw(12) << reference << " samples/s" << std::endl;
+
+   // The size of the thread pool is fixed once it has been created, the
+   // number of threads is limited per measurement with a task arena.
+   ROOT::EnableImplicitMT(maxThreads);
+   for (size_t nThreads = 1; nThreads <= maxThreads; nThreads *= 2) {
+      tbb::task_arena arena(nThreads);
+      double single = 0.0, multiple = 0.0;
+      arena.execute([&]() {
+         single   = benchmarkTraining<TCpu<Real_t>>(X, Y, nEpochs, 1);
+         multiple = benchmarkTraining<TCpu<Real_t>>(X, Y, nEpochs, nThreads);
+      });
+      std::cout << "Cpu, " << std::setw(2) << nThreads << " threads, 1 net      "
+                << std::setw(12) << single << " samples/s"
+                << std::setw(8) << single / reference << " x" << std::endl;
+      std::cout << "Cpu, " << std::setw(2) << nThreads << " threads, "
+                << std::setw(2) << nThreads << " nets     "
+                << std::setw(12) << multiple << " samples/s"
+                << std::setw(8) << multiple / reference << " x" << std::endl;
+   }
+   return 0;
+}
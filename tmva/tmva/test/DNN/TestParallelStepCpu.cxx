@@ -0,0 +1,157 @@
+// @(#)root/tmva $Id$
+
+/*************************************************************************
+ * Copyright (C) 2016, CERN                                              *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see $ROOTSYS/LICENSE.                         *
+ * For the list of contributors see $ROOTSYS/README/CREDITS.             *
+ *************************************************************************/
+
+////////////////////////////////////////////////////////////////////
+// Test the multi-net optimization step of the multi-threaded CPU //
+// implementation of DNNs. The batches of a step are propagated   //
+// through their nets in parallel (TCpu::ForEachBatch) on the     //
+// implicit multi-threading pool. The resulting weights must be   //
+// the same as the ones obtained by a serial loop which fetches   //
+// and processes the batches one at a time.                       //
+////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <vector>
+
+#include "TMatrix.h"
+#include "TRandom3.h"
+#include "TROOT.h"
+#include "TMVA/DNN/Architectures/Cpu.h"
+#include "TMVA/DNN/Minimizers.h"
+#include "TMVA/DNN/Net.h"
+#include "Utility.h"
+
+using namespace TMVA::DNN;
+
+/** Train a copy of \p net for \p nEpochs epochs with \p nNets nets per step,
+ *  once with TGradientDescent::Step(...) and once with a serial loop over the
+ *  batches applying the same updates. Returns the maximum relative error
+ *  between the weights and biases of the two master nets. */
+template <typename Architecture>
+auto testParallelStep(size_t nEpochs, size_t nNets)
+   -> typename Architecture::Scalar_t
+{
+   using Scalar_t = typename Architecture::Scalar_t;
+   using Net_t    = TNet<Architecture>;
+   using Data_t   = MatrixInput_t;
+
+   size_t nSamples  = 2048;
+   size_t nFeatures = 20;
+   size_t batchSize = 32;
+
+   TMatrixT<Double_t> X(nSamples, nFeatures), Y(nSamples, 1);
+   TRandom3 rand(1234);
+   for (size_t i = 0; i < nSamples; i++) {
+      Double_t sum = 0.0;
+      for (size_t j = 0; j < nFeatures; j++) {
+         X(i, j) = rand.Gaus();
+         sum += X(i, j) * (j % 3 - 1.0);
+      }
+      Y(i, 0) = (sum > 0.0) ? 1.0 : 0.0;
+   }
+   Data_t data(X, Y);
+
+   Net_t net(batchSize, nFeatures, ELossFunction::kCrossEntropy);
+   net.AddLayer(32, EActivationFunction::kTanh);
+   net.AddLayer(16, EActivationFunction::kTanh);
+   net.AddLayer(1, EActivationFunction::kIdentity);
+   net.Initialize(EInitialization::kGauss);
+
+   // Copies of the net start from the same weights.
+   Net_t parallelMaster(net), serialMaster(net);
+   std::vector<Net_t> parallelNets{}, serialNets{};
+   parallelNets.reserve(nNets);
+   serialNets.reserve(nNets);
+   for (size_t i = 0; i < nNets; i++) {
+      parallelNets.push_back(net);
+      serialNets.push_back(net);
+   }
+
+   Scalar_t learningRate = 0.01;
+   TGradientDescent<Architecture> minimizer(learningRate, 1, 1);
+   size_t nBatches = (nSamples / batchSize / nNets) * nNets;
+
+   // Parallel: one data loader buffer per net, since all batches of a step
+   // are alive at the same time.
+   TDataLoader<Data_t, Architecture> parallelLoader(data, nSamples, batchSize,
+                                                    nFeatures, 1, nNets);
+   for (size_t epoch = 0; epoch < nEpochs; epoch++) {
+      std::vector<TBatch<Architecture>> batches{};
+      for (size_t i = 0; i < nBatches; i += nNets) {
+         batches.clear();
+         for (size_t j = 0; j < nNets; j++) {
+            batches.push_back(parallelLoader.GetBatch());
+         }
+         minimizer.Step(parallelMaster, parallelNets, batches);
+      }
+   }
+
+   // Serial: each batch is used before the next one is fetched and the
+   // updates of the master net are applied in the same order as in Step().
+   TDataLoader<Data_t, Architecture> serialLoader(data, nSamples, batchSize,
+                                                  nFeatures, 1);
+   for (size_t epoch = 0; epoch < nEpochs; epoch++) {
+      for (size_t i = 0; i < nBatches; i += nNets) {
+         for (size_t j = 0; j < nNets; j++) {
+            auto batch = serialLoader.GetBatch();
+            auto &input  = batch.GetInput();
+            auto &output = batch.GetOutput();
+            serialNets[j].Forward(input);
+            serialNets[j].Backward(input, output);
+            for (size_t k = 0; k < serialMaster.GetDepth(); k++) {
+               auto &masterLayer = serialMaster.GetLayer(k);
+               auto &layer       = serialNets[j].GetLayer(k);
+               Architecture::ScaleAdd(masterLayer.GetWeights(),
+                                      layer.GetWeightGradients(),
+                                      -learningRate);
+               Architecture::Copy(layer.GetWeights(), masterLayer.GetWeights());
+               Architecture::ScaleAdd(masterLayer.GetBiases(),
+                                      layer.GetBiasGradients(),
+                                      -learningRate);
+               Architecture::Copy(layer.GetBiases(), masterLayer.GetBiases());
+            }
+         }
+      }
+   }
+
+   Scalar_t maximumError = 0.0;
+   for (size_t k = 0; k < net.GetDepth(); k++) {
+      TMatrixT<Double_t> W(parallelMaster.GetLayer(k).GetWeights());
+      TMatrixT<Double_t> WRef(serialMaster.GetLayer(k).GetWeights());
+      TMatrixT<Double_t> B(parallelMaster.GetLayer(k).GetBiases());
+      TMatrixT<Double_t> BRef(serialMaster.GetLayer(k).GetBiases());
+      maximumError = std::max(maximumError, (Scalar_t) maximumRelativeError(W, WRef));
+      maximumError = std::max(maximumError, (Scalar_t) maximumRelativeError(B, BRef));
+   }
+   return maximumError;
+}
+
+int main()
+{
+   using Scalar_t = Double_t;
+
+   std::cout << "Testing parallel optimization steps:" << std::endl;
+
+   ROOT::EnableImplicitMT(4);
+
+   Scalar_t maximumError = 0.0;
+   for (size_t nNets : {1, 2, 4, 8}) {
+      Scalar_t error = testParallelStep<TCpu<Scalar_t>>(2, nNets);
+      std::cout << nNets << " nets: Maximum relative error = " << error << std::endl;
+      maximumError = std::max(error, maximumError);
+   }
+
+   ROOT::DisableImplicitMT();
+
+   if (maximumError > 1e-10) {
+      return 1;
+   }
+   return 0;
+}